@@ -21,6 +21,7 @@
 #include "dab_space_shape.h"
 #include "dab_geom_line.h"
 #include "dab_space_ntree_tests.h"
+#include "dab_space_alg_tests.h"
 
 //--------------------------------------------------------------
 void ofApp::setup()
@@ -43,6 +44,7 @@ void ofApp::setup()
 		}
 
 		//dab::space::NtreeTests::get().runTests();
+		//dab::space::SpaceAlgTests::get().runTests();
 
 		//// bezier spline surface test
 		//	std::vector< glm::vec3 > controls(20);
@@ -12,16 +12,17 @@ using namespace dab::space;
 Space::Space(const std::string& pName, SpaceAlg* pSpaceAlg )
 : mName( pName )
 , mSpaceAlg( pSpaceAlg )
+, mSymmetricNeighbors( false )
 {}
 
 Space::~Space()
 {
-	delete mSpaceAlg;
-    
 	mVisibleObjects.clear();
 	mNeighborObjects.clear();
     
 	while( mObjects.size() > 0 ) removeObject( mObjects[0]->spaceObject() );
+    
+	delete mSpaceAlg;
 }
 
 const std::string&
@@ -91,6 +92,21 @@ Space::addObject(SpaceObject* pObject, bool pVisible, NeighborGroupAlg* pNeighbo
 	NeighborGroup* neighborGroup = new NeighborGroup(pObject, this, pVisible, pNeighborGroupAlg);
 	pObject->addNeighborGroup(neighborGroup);
 	SpaceProxyObject* proxyObject = new SpaceProxyObject(pObject, neighborGroup);
+    
+	try
+	{
+		mSpaceAlg->addObject(proxyObject);
+	}
+	catch(Exception& e)
+	{
+		pObject->removeNeighborGroup(neighborGroup);
+		delete proxyObject;
+		delete neighborGroup;
+		
+		e += Exception( "SPACE ERROR: failed to add Space Object to Space " + mName, __FILE__, __FUNCTION__, __LINE__ );
+		throw e;
+	}
+    
 	mObjects.push_back(proxyObject);
 }
 
@@ -126,6 +142,16 @@ Space::removeObject(SpaceObject* pObject) throw (Exception)
 	
 	if( proxyObject == nullptr ) throw Exception( "SPACE ERROR: Space Object Not Found in Space " + mName, __FILE__, __FUNCTION__, __LINE__ );
 	
+	mSpaceAlg->removeObject(proxyObject);
+    
+	// other objects forget the closest feature of a removed shape
+	const SpaceShape* shape = proxyObject->spaceShape();
+	
+	if( shape != nullptr )
+	{
+		for(unsigned int i=0; i<objectCount; ++i) mObjects[i]->removeClosestFeature(shape);
+	}
+    
 	NeighborGroup* neighborGroup = proxyObject->neighborGroup();
 	mObjects.erase(mObjects.begin() + proxyIndex);
 	pObject->removeNeighborGroup(neighborGroup);
@@ -150,6 +176,41 @@ Space::removeObjects() throw (Exception)
     }
 }
 
+bool
+Space::symmetricNeighbors() const
+{
+	return mSymmetricNeighbors;
+}
+
+void
+Space::setSymmetricNeighbors(bool pSymmetricNeighbors, bool pStoreNeighborPairs) throw (Exception)
+{
+	if( pSymmetricNeighbors == true && mSpaceAlg->symmetricNeighborsSupported() == false ) throw Exception( "SPACE ERROR: Space " + mName + " doesn't support symmetric neighbors", __FILE__, __FUNCTION__, __LINE__ );
+	
+	mSymmetricNeighbors = pSymmetricNeighbors;
+	mSpaceAlg->setStoreNeighborPairs( pSymmetricNeighbors == true && pStoreNeighborPairs == true );
+}
+
+unsigned int
+Space::neighborPairCount() const
+{
+	return mSpaceAlg->neighborPairCount();
+}
+
+const SpaceNeighborPair&
+Space::neighborPair(unsigned int pIndex) const throw (Exception)
+{
+	try
+	{
+		return mSpaceAlg->neighborPair(pIndex);
+	}
+	catch(Exception& e)
+	{
+		e += Exception("SPACE ERROR: failed to retrieve neighbor pair from space " + mName, __FILE__, __FUNCTION__, __LINE__);
+		throw e;
+	}
+}
+
 void
 Space::update() throw (Exception)
 {
@@ -163,7 +224,28 @@ Space::update() throw (Exception)
 //		std::cout << "neighbor count " << mNeighborObjects.size() << "\n";
 		
 		mSpaceAlg->updateStructure( mVisibleObjects );
-		mSpaceAlg->updateNeighbors( mNeighborObjects );
+		
+		// symmetric mode requires all objects to search within the same neighbor radius
+		bool symmetricNeighbors = mSymmetricNeighbors && mNeighborObjects.size() > 0;
+		float neighborRadius = symmetricNeighbors ? mNeighborObjects[0]->neighborRadius() : -1.0;
+		
+		if( neighborRadius < 0.0 ) symmetricNeighbors = false;
+		
+		unsigned int neighborObjectCount = mNeighborObjects.size();
+		for(unsigned int oI=1; oI<neighborObjectCount && symmetricNeighbors == true; ++oI)
+		{
+			if( mNeighborObjects[oI]->neighborRadius() != neighborRadius ) symmetricNeighbors = false;
+		}
+		
+		if( symmetricNeighbors == true )
+		{
+			mSpaceAlg->updateSymmetricNeighbors( mVisibleObjects, mNeighborObjects, neighborRadius );
+		}
+		else
+		{
+			mSpaceAlg->clearNeighborPairs();
+			mSpaceAlg->updateNeighbors( mNeighborObjects );
+		}
 		
 		//std::cout << "Space " << mName << " update end\n";
 	}
@@ -8,6 +8,7 @@
 #include <vector>
 #include <Eigen/Dense>
 #include "dab_exception.h"
+#include "dab_space_neighbor_pair.h"
 
 namespace dab
 {
@@ -34,7 +35,7 @@ public:
     /**
      \brief destructor
      */
-    ~Space();
+    virtual ~Space();
     
     /**
      \brief return space name
@@ -121,6 +122,37 @@ public:
      */
     void removeObjects() throw (Exception);
     
+    /**
+     \brief return whether neighbors are calculated in symmetric mode
+     \return true if neighbors are calculated in symmetric mode, false otherwise
+     */
+    bool symmetricNeighbors() const;
+    
+    /**
+     \brief set whether neighbors are calculated in symmetric mode
+     \param pSymmetricNeighbors symmetric mode
+     \param pStoreNeighborPairs store each neighbor pair once in a flat list
+     \exception Exception space alg doesn't support symmetric mode
+     
+     in symmetric mode, each pair of visible objects is evaluated only once and the result is added to both objects.\n
+     symmetric mode is only applied while all objects that can have neighbors share the same neighbor radius, otherwise neighbors are calculated as usual.
+     */
+    void setSymmetricNeighbors(bool pSymmetricNeighbors, bool pStoreNeighborPairs = false) throw (Exception);
+    
+    /**
+     \brief return number of neighbor pairs found during last update
+     \return number of neighbor pairs
+     */
+    unsigned int neighborPairCount() const;
+    
+    /**
+     \brief return neighbor pair found during last update
+     \param pIndex neighbor pair index
+     \return neighbor pair
+     \exception Exception index out of range
+     */
+    const SpaceNeighborPair& neighborPair(unsigned int pIndex) const throw (Exception);
+    
     /**
      \brief update space
      \exception Exception failed to update space
@@ -160,6 +192,7 @@ protected:
     std::vector<SpaceProxyObject*> mVisibleObjects; ///\brief visible space proxy objects
     std::vector<SpaceProxyObject*> mNeighborObjects; ///\brief space proxy objects that can possess neighbors
     
+    bool mSymmetricNeighbors; ///\brief calculate neighbors in symmetric mode
     bool mLock;
 };
 
@@ -0,0 +1,468 @@
+/** \file dab_space_aabb_tree.cpp
+ */
+
+#include "dab_space_aabb_tree.h"
+#include <algorithm>
+#include <sstream>
+
+using namespace dab;
+using namespace dab::space;
+
+SpaceAABBTree::SpaceAABBTree(float pMargin) throw (Exception)
+: mMargin(pMargin)
+, mRoot(-1)
+, mFreeNode(-1)
+, mProxyCount(0)
+{
+    if(pMargin < 0.0) throw Exception("SPACE ERROR: margin " + std::to_string(pMargin) + " must not be negative", __FILE__, __FUNCTION__, __LINE__);
+}
+
+SpaceAABBTree::~SpaceAABBTree()
+{}
+
+float
+SpaceAABBTree::margin() const
+{
+    return mMargin;
+}
+
+void
+SpaceAABBTree::setMargin(float pMargin) throw (Exception)
+{
+    if(pMargin < 0.0) throw Exception("SPACE ERROR: margin " + std::to_string(pMargin) + " must not be negative", __FILE__, __FUNCTION__, __LINE__);
+
+    mMargin = pMargin;
+}
+
+unsigned int
+SpaceAABBTree::proxyCount() const
+{
+    return mProxyCount;
+}
+
+int
+SpaceAABBTree::height() const
+{
+    if(mRoot < 0) return 0;
+
+    return mNodes[mRoot].mHeight;
+}
+
+int
+SpaceAABBTree::createProxy(const float* pMin, const float* pMax, SpaceProxyObject* pObject)
+{
+    int proxy = allocateNode();
+    Node& node = mNodes[proxy];
+
+    for(int d=0; d<3; ++d)
+    {
+        node.mObjectMin[d] = pMin[d];
+        node.mObjectMax[d] = pMax[d];
+        node.mMin[d] = pMin[d] - mMargin;
+        node.mMax[d] = pMax[d] + mMargin;
+    }
+
+    node.mObject = pObject;
+    node.mHeight = 0;
+
+    insertLeaf(proxy);
+    mProxyCount++;
+
+    return proxy;
+}
+
+void
+SpaceAABBTree::destroyProxy(int pProxy)
+{
+    removeLeaf(pProxy);
+    freeNode(pProxy);
+    mProxyCount--;
+}
+
+bool
+SpaceAABBTree::moveProxy(int pProxy, const float* pMin, const float* pMax)
+{
+    Node& node = mNodes[pProxy];
+    bool contained = true;
+    bool oversized = false;
+
+    for(int d=0; d<3; ++d)
+    {
+        node.mObjectMin[d] = pMin[d];
+        node.mObjectMax[d] = pMax[d];
+
+        if(pMin[d] < node.mMin[d] || pMax[d] > node.mMax[d]) contained = false;
+
+        // a fat box that is much larger than needed (e.g. after a shape has shrunk) causes unnecessary query overlaps
+        if(pMin[d] - node.mMin[d] > 4.0 * mMargin || node.mMax[d] - pMax[d] > 4.0 * mMargin) oversized = true;
+    }
+
+    if(contained == true && oversized == false) return false;
+
+    removeLeaf(pProxy);
+
+    for(int d=0; d<3; ++d)
+    {
+        node.mMin[d] = pMin[d] - mMargin;
+        node.mMax[d] = pMax[d] + mMargin;
+    }
+
+    insertLeaf(pProxy);
+
+    return true;
+}
+
+SpaceProxyObject*
+SpaceAABBTree::object(int pProxy) const
+{
+    return mNodes[pProxy].mObject;
+}
+
+void
+SpaceAABBTree::query(const float* pMin, const float* pMax, std::vector<SpaceProxyObject*>& pResults)
+{
+    pResults.clear();
+
+    if(mRoot < 0) return;
+
+    mQueryStack.clear();
+    mQueryStack.push_back(mRoot);
+
+    while(mQueryStack.size() > 0)
+    {
+        const Node& node = mNodes[mQueryStack.back()];
+        mQueryStack.pop_back();
+
+        if( pMin[0] > node.mMax[0] || pMax[0] < node.mMin[0] || pMin[1] > node.mMax[1] || pMax[1] < node.mMin[1] || pMin[2] > node.mMax[2] || pMax[2] < node.mMin[2] ) continue;
+
+        if(node.isLeaf() == true)
+        {
+            if( pMin[0] > node.mObjectMax[0] || pMax[0] < node.mObjectMin[0] || pMin[1] > node.mObjectMax[1] || pMax[1] < node.mObjectMin[1] || pMin[2] > node.mObjectMax[2] || pMax[2] < node.mObjectMin[2] ) continue;
+
+            pResults.push_back(node.mObject);
+        }
+        else
+        {
+            mQueryStack.push_back(node.mChild1);
+            mQueryStack.push_back(node.mChild2);
+        }
+    }
+}
+
+void
+SpaceAABBTree::clear()
+{
+    mNodes.clear();
+    mRoot = -1;
+    mFreeNode = -1;
+    mProxyCount = 0;
+}
+
+int
+SpaceAABBTree::allocateNode()
+{
+    if(mFreeNode < 0)
+    {
+        mNodes.emplace_back();
+        mFreeNode = mNodes.size() - 1;
+        mNodes[mFreeNode].mParent = -1;
+    }
+
+    int nodeIndex = mFreeNode;
+    Node& node = mNodes[nodeIndex];
+
+    mFreeNode = node.mParent;
+    node.mParent = -1;
+    node.mChild1 = -1;
+    node.mChild2 = -1;
+    node.mHeight = 0;
+    node.mObject = nullptr;
+
+    return nodeIndex;
+}
+
+void
+SpaceAABBTree::freeNode(int pNode)
+{
+    Node& node = mNodes[pNode];
+
+    node.mParent = mFreeNode;
+    node.mHeight = -1;
+    mFreeNode = pNode;
+}
+
+void
+SpaceAABBTree::insertLeaf(int pLeaf)
+{
+    if(mRoot < 0)
+    {
+        mRoot = pLeaf;
+        mNodes[pLeaf].mParent = -1;
+        return;
+    }
+
+    // descend towards the sibling whose combination with the leaf least increases the surface area of the tree
+    const float* leafMin = mNodes[pLeaf].mMin;
+    const float* leafMax = mNodes[pLeaf].mMax;
+    int sibling = mRoot;
+
+    while(mNodes[sibling].isLeaf() == false)
+    {
+        const Node& node = mNodes[sibling];
+        float nodeArea = area(node.mMin, node.mMax);
+        float mergedArea = combinedArea(node.mMin, node.mMax, leafMin, leafMax);
+
+        // cost of creating a new parent for this node and the leaf
+        float cost = 2.0 * mergedArea;
+
+        // minimum cost of pushing the leaf further down the tree
+        float inheritanceCost = 2.0 * ( mergedArea - nodeArea );
+
+        float childCosts[2];
+        int children[2] = { node.mChild1, node.mChild2 };
+
+        for(int cI=0; cI<2; ++cI)
+        {
+            const Node& child = mNodes[ children[cI] ];
+            float childArea = combinedArea(child.mMin, child.mMax, leafMin, leafMax);
+            if(child.isLeaf() == false) childArea -= area(child.mMin, child.mMax);
+            childCosts[cI] = childArea + inheritanceCost;
+        }
+
+        if(cost < childCosts[0] && cost < childCosts[1]) break;
+
+        sibling = childCosts[0] < childCosts[1] ? children[0] : children[1];
+    }
+
+    // create new parent of sibling and leaf, node references are taken afterwards since allocation may grow the node pool
+    int newParent = allocateNode();
+    Node& parentNode = mNodes[newParent];
+    Node& siblingNode = mNodes[sibling];
+    Node& leafNode = mNodes[pLeaf];
+    int oldParent = siblingNode.mParent;
+
+    parentNode.mParent = oldParent;
+    parentNode.mHeight = siblingNode.mHeight + 1;
+    parentNode.mChild1 = sibling;
+    parentNode.mChild2 = pLeaf;
+
+    for(int d=0; d<3; ++d)
+    {
+        parentNode.mMin[d] = std::min(siblingNode.mMin[d], leafNode.mMin[d]);
+        parentNode.mMax[d] = std::max(siblingNode.mMax[d], leafNode.mMax[d]);
+    }
+
+    if(oldParent >= 0)
+    {
+        if(mNodes[oldParent].mChild1 == sibling) mNodes[oldParent].mChild1 = newParent;
+        else mNodes[oldParent].mChild2 = newParent;
+    }
+    else
+    {
+        mRoot = newParent;
+    }
+
+    siblingNode.mParent = newParent;
+    leafNode.mParent = newParent;
+
+    refitAncestors( leafNode.mParent );
+}
+
+void
+SpaceAABBTree::removeLeaf(int pLeaf)
+{
+    if(pLeaf == mRoot)
+    {
+        mRoot = -1;
+        return;
+    }
+
+    int parent = mNodes[pLeaf].mParent;
+    int grandParent = mNodes[parent].mParent;
+    int sibling = mNodes[parent].mChild1 == pLeaf ? mNodes[parent].mChild2 : mNodes[parent].mChild1;
+
+    // replace parent by sibling
+    if(grandParent >= 0)
+    {
+        if(mNodes[grandParent].mChild1 == parent) mNodes[grandParent].mChild1 = sibling;
+        else mNodes[grandParent].mChild2 = sibling;
+
+        mNodes[sibling].mParent = grandParent;
+        freeNode(parent);
+
+        refitAncestors(grandParent);
+    }
+    else
+    {
+        mRoot = sibling;
+        mNodes[sibling].mParent = -1;
+        freeNode(parent);
+    }
+
+    mNodes[pLeaf].mParent = -1;
+}
+
+void
+SpaceAABBTree::refitAncestors(int pNode)
+{
+    int nodeIndex = pNode;
+
+    while(nodeIndex >= 0)
+    {
+        nodeIndex = balance(nodeIndex);
+        refit(nodeIndex);
+        nodeIndex = mNodes[nodeIndex].mParent;
+    }
+}
+
+int
+SpaceAABBTree::balance(int pNode)
+{
+    Node& a = mNodes[pNode];
+
+    if(a.isLeaf() == true || a.mHeight < 2) return pNode;
+
+    int iB = a.mChild1;
+    int iC = a.mChild2;
+    Node& b = mNodes[iB];
+    Node& c = mNodes[iC];
+
+    int heightDifference = c.mHeight - b.mHeight;
+
+    // rotate c up
+    if(heightDifference > 1)
+    {
+        int iF = c.mChild1;
+        int iG = c.mChild2;
+
+        c.mChild1 = pNode;
+        c.mParent = a.mParent;
+        a.mParent = iC;
+
+        if(c.mParent >= 0)
+        {
+            if(mNodes[c.mParent].mChild1 == pNode) mNodes[c.mParent].mChild1 = iC;
+            else mNodes[c.mParent].mChild2 = iC;
+        }
+        else
+        {
+            mRoot = iC;
+        }
+
+        // the higher grandchild stays with c, the lower one moves to a
+        if(mNodes[iF].mHeight > mNodes[iG].mHeight)
+        {
+            c.mChild2 = iF;
+            a.mChild2 = iG;
+            mNodes[iG].mParent = pNode;
+        }
+        else
+        {
+            c.mChild2 = iG;
+            a.mChild2 = iF;
+            mNodes[iF].mParent = pNode;
+        }
+
+        refit(pNode);
+        refit(iC);
+
+        return iC;
+    }
+
+    // rotate b up
+    if(heightDifference < -1)
+    {
+        int iD = b.mChild1;
+        int iE = b.mChild2;
+
+        b.mChild1 = pNode;
+        b.mParent = a.mParent;
+        a.mParent = iB;
+
+        if(b.mParent >= 0)
+        {
+            if(mNodes[b.mParent].mChild1 == pNode) mNodes[b.mParent].mChild1 = iB;
+            else mNodes[b.mParent].mChild2 = iB;
+        }
+        else
+        {
+            mRoot = iB;
+        }
+
+        // the higher grandchild stays with b, the lower one moves to a
+        if(mNodes[iD].mHeight > mNodes[iE].mHeight)
+        {
+            b.mChild2 = iD;
+            a.mChild1 = iE;
+            mNodes[iE].mParent = pNode;
+        }
+        else
+        {
+            b.mChild2 = iE;
+            a.mChild1 = iD;
+            mNodes[iD].mParent = pNode;
+        }
+
+        refit(pNode);
+        refit(iB);
+
+        return iB;
+    }
+
+    return pNode;
+}
+
+void
+SpaceAABBTree::refit(int pNode)
+{
+    Node& node = mNodes[pNode];
+    const Node& child1 = mNodes[node.mChild1];
+    const Node& child2 = mNodes[node.mChild2];
+
+    node.mHeight = 1 + std::max(child1.mHeight, child2.mHeight);
+
+    for(int d=0; d<3; ++d)
+    {
+        node.mMin[d] = std::min(child1.mMin[d], child2.mMin[d]);
+        node.mMax[d] = std::max(child1.mMax[d], child2.mMax[d]);
+    }
+}
+
+float
+SpaceAABBTree::combinedArea(const float* pMin1, const float* pMax1, const float* pMin2, const float* pMax2)
+{
+    float x = std::max(pMax1[0], pMax2[0]) - std::min(pMin1[0], pMin2[0]);
+    float y = std::max(pMax1[1], pMax2[1]) - std::min(pMin1[1], pMin2[1]);
+    float z = std::max(pMax1[2], pMax2[2]) - std::min(pMin1[2], pMin2[2]);
+
+    return x * y + y * z + z * x;
+}
+
+float
+SpaceAABBTree::area(const float* pMin, const float* pMax)
+{
+    float x = pMax[0] - pMin[0];
+    float y = pMax[1] - pMin[1];
+    float z = pMax[2] - pMin[2];
+
+    return x * y + y * z + z * x;
+}
+
+SpaceAABBTree::operator std::string() const
+{
+    return info();
+}
+
+std::string
+SpaceAABBTree::info() const
+{
+    std::stringstream stream;
+
+    stream << "SpaceAABBTree\n";
+    stream << "margin: " << mMargin << "\n";
+    stream << "proxyCount: " << mProxyCount << "\n";
+    stream << "height: " << height() << "\n";
+    stream << "nodeCount: " << mNodes.size() << "\n";
+
+    return stream.str();
+}
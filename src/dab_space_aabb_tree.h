@@ -0,0 +1,225 @@
+/** \file dab_space_aabb_tree.h
+ */
+
+#ifndef _dab_space_aabb_tree_h_
+#define _dab_space_aabb_tree_h_
+
+#include <iostream>
+#include <vector>
+#include "dab_exception.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+class SpaceProxyObject;
+
+/**
+ \brief dynamic bounding volume hierarchy of three dimensional axis aligned boxes
+
+ each leaf stores the box of an object enlarged by a margin (fat box). as long as the box of an object stays within its fat box, moving the object doesn't change the tree.\n
+ objects whose box leaves the fat box are removed and reinserted. insertion descends along the smallest increase of surface area, the ancestors of inserted and removed leaves are refit bottom-up and balanced by tree rotations.\n
+ the cost of an update therefore scales with the number of objects that moved beyond their margin rather than with the number of objects.\n
+ queries test fat boxes while descending and the exact boxes of objects at the leaves.
+ */
+class SpaceAABBTree
+{
+public:
+    /**
+     \brief create aabb tree
+     \param pMargin margin by which boxes are enlarged on each side
+     \exception Exception negative margin
+     */
+    SpaceAABBTree(float pMargin = 0.1) throw (Exception);
+    ~SpaceAABBTree();
+
+    float margin() const;
+
+    /**
+     \brief set margin by which boxes are enlarged on each side
+     \param pMargin margin
+     \exception Exception negative margin
+
+     only affects boxes that are inserted afterwards
+     */
+    void setMargin(float pMargin) throw (Exception);
+
+    /**
+     \brief return number of objects stored in tree
+     \return proxy count
+     */
+    unsigned int proxyCount() const;
+
+    /**
+     \brief return height of tree
+     \return height (0: single leaf or empty tree)
+     */
+    int height() const;
+
+    /**
+     \brief insert object
+     \param pMin minimum corner of object box (3 values)
+     \param pMax maximum corner of object box (3 values)
+     \param pObject proxy object
+     \return proxy id
+     */
+    int createProxy(const float* pMin, const float* pMax, SpaceProxyObject* pObject);
+
+    /**
+     \brief remove object
+     \param pProxy proxy id
+     */
+    void destroyProxy(int pProxy);
+
+    /**
+     \brief update box of object
+     \param pProxy proxy id
+     \param pMin minimum corner of object box (3 values)
+     \param pMax maximum corner of object box (3 values)
+     \return true if the object has been reinserted because its box left the fat box or became much smaller than the fat box
+     */
+    bool moveProxy(int pProxy, const float* pMin, const float* pMax);
+
+    /**
+     \brief return object of proxy
+     \param pProxy proxy id
+     \return proxy object
+     */
+    SpaceProxyObject* object(int pProxy) const;
+
+    /**
+     \brief find all objects whose box overlaps search box
+     \param pMin minimum corner of search box (3 values)
+     \param pMax maximum corner of search box (3 values)
+     \param pResults search results
+     */
+    void query(const float* pMin, const float* pMax, std::vector<SpaceProxyObject*>& pResults);
+
+    /**
+     \brief remove all objects
+     */
+    void clear();
+
+    /**
+     \brief obtain textual aabb tree information
+     \return String containing textual aabb tree information
+     */
+    operator std::string() const;
+
+    /**
+     \brief obtain textual aabb tree information
+     \return String containing textual aabb tree information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual aabb tree information
+     \param pOstream output stream
+     \param pTree aabb tree
+     */
+    friend std::ostream& operator<< (std::ostream & pOstream, const SpaceAABBTree& pTree)
+    {
+        pOstream << std::string(pTree);
+
+        return pOstream;
+    }
+
+protected:
+    /**
+     \brief tree node
+     */
+    class Node
+    {
+    public:
+        float mMin[3]; ///\brief minimum corner of fat box (leaves) or of box enclosing children (internal nodes)
+        float mMax[3]; ///\brief maximum corner of fat box (leaves) or of box enclosing children (internal nodes)
+        float mObjectMin[3]; ///\brief minimum corner of object box (leaves only)
+        float mObjectMax[3]; ///\brief maximum corner of object box (leaves only)
+        SpaceProxyObject* mObject; ///\brief proxy object (leaves only)
+        int mParent; ///\brief parent node, next free node if node is unused (-1: none)
+        int mChild1; ///\brief first child (-1: leaf)
+        int mChild2; ///\brief second child (-1: leaf)
+        int mHeight; ///\brief height of subtree (0: leaf, -1: unused)
+
+        inline bool isLeaf() const
+        {
+            return mChild1 < 0;
+        }
+    };
+
+    /**
+     \brief return unused node, grows node pool if necessary
+     \return node index
+     */
+    int allocateNode();
+
+    /**
+     \brief return node to pool of unused nodes
+     \param pNode node index
+     */
+    void freeNode(int pNode);
+
+    /**
+     \brief insert leaf next to the sibling that least increases the surface area of the tree
+     \param pLeaf leaf node index
+     */
+    void insertLeaf(int pLeaf);
+
+    /**
+     \brief remove leaf and its parent from tree
+     \param pLeaf leaf node index
+     */
+    void removeLeaf(int pLeaf);
+
+    /**
+     \brief refit boxes and heights of ancestors of a node and balance them
+     \param pNode node index
+     */
+    void refitAncestors(int pNode);
+
+    /**
+     \brief rotate node if its subtrees differ in height by more than one
+     \param pNode node index
+     \return index of node that replaces pNode
+     */
+    int balance(int pNode);
+
+    /**
+     \brief update box and height of internal node from its children
+     \param pNode node index
+     */
+    void refit(int pNode);
+
+    /**
+     \brief calculate half surface area of box enclosing two boxes
+     \param pMin1 minimum corner of first box
+     \param pMax1 maximum corner of first box
+     \param pMin2 minimum corner of second box
+     \param pMax2 maximum corner of second box
+     \return half surface area
+     */
+    static float combinedArea(const float* pMin1, const float* pMax1, const float* pMin2, const float* pMax2);
+
+    /**
+     \brief calculate half surface area of box
+     \param pMin minimum corner
+     \param pMax maximum corner
+     \return half surface area
+     */
+    static float area(const float* pMin, const float* pMax);
+
+    float mMargin; ///\brief margin by which boxes are enlarged on each side
+    std::vector<Node> mNodes; ///\brief node pool
+    int mRoot; ///\brief root node (-1: empty tree)
+    int mFreeNode; ///\brief first unused node (-1: none)
+    unsigned int mProxyCount; ///\brief number of objects stored in tree
+    std::vector<int> mQueryStack; ///\brief node stack during queries
+};
+
+};
+
+};
+
+#endif
@@ -2,24 +2,36 @@
 */
 
 #include "dab_space_alg.h"
+#include "dab_space_proxy_object.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 using namespace dab;
 using namespace dab::space;
 
+const double SpaceAlg::sMaxCellCoord = 1.0e15;
+
 SpaceAlg::SpaceAlg()
 : mFixedSize(false)
+, mStoreNeighborPairs(false)
+, mNeighborPairCount(0)
 {}
 
 SpaceAlg::SpaceAlg( unsigned int pDim )
 : mMinPos( pDim )
 , mMaxPos( pDim )
 , mFixedSize(false)
+, mStoreNeighborPairs(false)
+, mNeighborPairCount(0)
 {}
 
 SpaceAlg::SpaceAlg( const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos ) throw (Exception)
 : mMinPos( pMinPos )
 , mMaxPos( pMaxPos )
 , mFixedSize(true)
+, mStoreNeighborPairs(false)
+, mNeighborPairCount(0)
 {
     if(mMinPos.rows() != mMaxPos.rows()) throw Exception("SPACE ERROR: mismatch between minPos dim " + std::to_string(mMinPos.rows()) + " and maxPos dim " + std::to_string(mMaxPos.rows()), __FILE__, __FUNCTION__, __LINE__ );
 }
@@ -70,6 +82,14 @@ SpaceAlg::resize(const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos)
 	}
 }
 
+void
+SpaceAlg::addObject( SpaceProxyObject* ) throw (Exception)
+{}
+
+void
+SpaceAlg::removeObject( SpaceProxyObject* ) throw (Exception)
+{}
+
 void
 SpaceAlg::updateStructure( std::vector<SpaceProxyObject*>& pObjects ) throw (Exception)
 {
@@ -82,6 +102,232 @@ SpaceAlg::updateNeighbors( std::vector<SpaceProxyObject*>& pObjects ) throw (Exc
     //std::cout << "SpaceAlg::updateNeighbors( std::vector<SpaceProxyObject*>& pObjects ) throw (Exception)\n";
 }
 
+bool
+SpaceAlg::symmetricNeighborsSupported() const
+{
+	return true;
+}
+
+bool
+SpaceAlg::storeNeighborPairs() const
+{
+	return mStoreNeighborPairs;
+}
+
+void
+SpaceAlg::setStoreNeighborPairs(bool pStoreNeighborPairs)
+{
+	mStoreNeighborPairs = pStoreNeighborPairs;
+	if( mStoreNeighborPairs == false ) clearNeighborPairs();
+}
+
+unsigned int
+SpaceAlg::neighborPairCount() const
+{
+	return mNeighborPairCount;
+}
+
+const SpaceNeighborPair&
+SpaceAlg::neighborPair(unsigned int pIndex) const throw (Exception)
+{
+	if( pIndex >= mNeighborPairCount ) throw Exception("SPACE ERROR: index " + std::to_string(pIndex) + " exceeds number of neighbor pairs " + std::to_string(mNeighborPairCount), __FILE__, __FUNCTION__, __LINE__);
+	
+	return mNeighborPairs[pIndex];
+}
+
+void
+SpaceAlg::clearNeighborPairs()
+{
+	mNeighborPairCount = 0;
+}
+
+void
+SpaceAlg::updateSymmetricNeighbors( std::vector<SpaceProxyObject*>& pVisibleObjects, std::vector<SpaceProxyObject*>& pNeighborObjects, float pNeighborRadius ) throw (Exception)
+{
+	try
+	{
+		std::vector<SpaceProxyObject*> unpairedObjects;
+		prepareSymmetricNeighbors( pVisibleObjects, pNeighborObjects, unpairedObjects );
+		
+		unsigned int dim = mMinPos.rows();
+		unsigned int visibleCount = pVisibleObjects.size();
+		float squaredNeighborRadius = pNeighborRadius * pNeighborRadius;
+		
+		// number of cells adjacent to a cell (including the cell itself)
+		unsigned int stencilCount = 1;
+		for(unsigned int d=0; d<dim && stencilCount <= visibleCount; ++d) stencilCount *= 3;
+		
+		// cells start at the minimum of the visible positions, the minimum position of the algorithm isn't initialized for spaces without fixed size
+		// a grid whose cell coordinates wouldn't fit into the coordinate type isn't used
+		bool useCells = pNeighborRadius > 0.0 && stencilCount <= visibleCount;
+		
+		if( useCells == true )
+		{
+			mCellOrigin.assign( dim, std::numeric_limits<float>::max() );
+			mCellExtent.assign( dim, std::numeric_limits<float>::lowest() );
+			
+			for(unsigned int i=0; i<visibleCount; ++i)
+			{
+				const Eigen::VectorXf& position = pVisibleObjects[i]->position();
+				
+				for(unsigned int d=0; d<dim; ++d)
+				{
+					mCellOrigin[d] = std::min( mCellOrigin[d], position[d] );
+					mCellExtent[d] = std::max( mCellExtent[d], position[d] );
+				}
+			}
+			
+			for(unsigned int d=0; d<dim && useCells == true; ++d)
+			{
+				double cellCount = ( static_cast<double>( mCellExtent[d] ) - static_cast<double>( mCellOrigin[d] ) ) / pNeighborRadius;
+				
+				if( std::isfinite( cellCount ) == false || cellCount > sMaxCellCoord ) useCells = false;
+			}
+		}
+		
+		if( useCells == false )
+		{
+			// a cell grid doesn't pay off, compare all pairs
+			for(unsigned int i=0; i<visibleCount; ++i)
+			{
+				for(unsigned int j=i+1; j<visibleCount; ++j) evaluateSymmetricPair( pVisibleObjects, i, j, squaredNeighborRadius );
+			}
+		}
+		else
+		{
+			// sort visible objects into cells whose size equals the neighbor radius
+			mCellCoords.resize( visibleCount * dim );
+			mCellEntries.resize( visibleCount );
+			
+			for(unsigned int i=0; i<visibleCount; ++i)
+			{
+				const Eigen::VectorXf& position = pVisibleObjects[i]->position();
+				long long* cellCoord = &( mCellCoords[i * dim] );
+				unsigned long long cellKey = 0;
+				
+				for(unsigned int d=0; d<dim; ++d)
+				{
+					cellCoord[d] = static_cast<long long>( floor( ( position[d] - mCellOrigin[d] ) / pNeighborRadius ) );
+					cellKey = cellKey * 0x9E3779B97F4A7C15ULL + static_cast<unsigned long long>( cellCoord[d] );
+				}
+				
+				mCellEntries[i] = std::make_pair( cellKey, i );
+			}
+			
+			std::sort( mCellEntries.begin(), mCellEntries.end() );
+			
+			// compare each object with the objects of higher index in adjacent cells
+			for(unsigned int i=0; i<visibleCount; ++i)
+			{
+				const long long* cellCoord = &( mCellCoords[i * dim] );
+				
+				for(unsigned int s=0; s<stencilCount; ++s)
+				{
+					unsigned long long cellKey = 0;
+					unsigned int stencilDigits = s;
+					
+					for(unsigned int d=0; d<dim; ++d, stencilDigits /= 3)
+					{
+						cellKey = cellKey * 0x9E3779B97F4A7C15ULL + static_cast<unsigned long long>( cellCoord[d] + static_cast<long long>( stencilDigits % 3 ) - 1 );
+					}
+					
+					std::vector< std::pair<unsigned long long, unsigned int> >::iterator cellIter = std::lower_bound( mCellEntries.begin(), mCellEntries.end(), std::make_pair( cellKey, 0u ) );
+					
+					for(; cellIter != mCellEntries.end() && cellIter->first == cellKey; ++cellIter)
+					{
+						if( cellIter->second > i ) evaluateSymmetricPair( pVisibleObjects, i, cellIter->second, squaredNeighborRadius );
+					}
+				}
+			}
+		}
+		
+		// objects that aren't visible can't be part of a pair
+		unsigned int unpairedCount = unpairedObjects.size();
+		
+		for(unsigned int oI=0; oI<unpairedCount; ++oI)
+		{
+			SpaceProxyObject* proxyObject = unpairedObjects[oI];
+			
+			for(unsigned int vI=0; vI<visibleCount && proxyObject->neighborListFull() == false; ++vI) proxyObject->addNeighbor( pVisibleObjects[vI]->spaceObject() );
+		}
+	}
+	catch(Exception& e)
+	{
+		e += Exception("SPACE ERROR: failed to update symmetric neighbors", __FILE__, __FUNCTION__, __LINE__);
+		throw e;
+	}
+}
+
+void
+SpaceAlg::prepareSymmetricNeighbors( std::vector<SpaceProxyObject*>& pVisibleObjects, std::vector<SpaceProxyObject*>& pNeighborObjects, std::vector<SpaceProxyObject*>& pUnpairedObjects ) throw (Exception)
+{
+	unsigned int visibleCount = pVisibleObjects.size();
+	unsigned int neighborObjectCount = pNeighborObjects.size();
+	
+	for(unsigned int i=0; i<visibleCount; ++i) pVisibleObjects[i]->setIndex(i);
+	
+	mReceivesNeighbors.assign( visibleCount, 0 );
+	mVisitStamps.assign( visibleCount, 0 );
+	mNeighborPairCount = 0;
+	if( mPairDirection.rows() != mMinPos.rows() ) mPairDirection.resize( mMinPos.rows() );
+	
+	for(unsigned int oI=0; oI<neighborObjectCount; ++oI)
+	{
+		SpaceProxyObject* proxyObject = pNeighborObjects[oI];
+		proxyObject->removeNeighbors();
+		
+		unsigned int index = proxyObject->index();
+		
+		if( index < visibleCount && pVisibleObjects[index] == proxyObject ) mReceivesNeighbors[index] = 1;
+		else pUnpairedObjects.push_back( proxyObject );
+	}
+}
+
+void
+SpaceAlg::evaluateSymmetricPair( std::vector<SpaceProxyObject*>& pVisibleObjects, unsigned int pIndex1, unsigned int pIndex2, float pSquaredNeighborRadius ) throw (Exception)
+{
+	// pair has already been evaluated for the first object
+	if( mVisitStamps[pIndex2] == pIndex1 + 1 ) return;
+	mVisitStamps[pIndex2] = pIndex1 + 1;
+	
+	bool receives1 = mReceivesNeighbors[pIndex1] != 0;
+	bool receives2 = mReceivesNeighbors[pIndex2] != 0;
+	
+	if( receives1 == false && receives2 == false && mStoreNeighborPairs == false ) return;
+	
+	SpaceProxyObject* object1 = pVisibleObjects[pIndex1];
+	SpaceProxyObject* object2 = pVisibleObjects[pIndex2];
+	const Eigen::VectorXf& position1 = object1->position();
+	const Eigen::VectorXf& position2 = object2->position();
+	unsigned int dim = mPairDirection.rows();
+	
+	float squaredDistance = 0.0;
+	for(unsigned int d=0; d<dim; ++d)
+	{
+		mPairDirection[d] = position2[d] - position1[d];
+		squaredDistance += mPairDirection[d] * mPairDirection[d];
+	}
+	
+	if( squaredDistance > pSquaredNeighborRadius ) return;
+	
+	float distance = sqrt( squaredDistance );
+	
+	if( receives1 == true && object1->neighborListFull() == false ) object1->addNeighbor( object2->spaceObject(), distance, mPairDirection );
+	if( mStoreNeighborPairs == true ) addNeighborPair( object1->spaceObject(), object2->spaceObject(), distance, mPairDirection );
+	if( receives2 == true && object2->neighborListFull() == false )
+	{
+		mPairDirection *= -1.0;
+		object2->addNeighbor( object1->spaceObject(), distance, mPairDirection );
+	}
+}
+
+void
+SpaceAlg::addNeighborPair( SpaceObject* pObject1, SpaceObject* pObject2, float pDistance, const Eigen::VectorXf& pDirection )
+{
+	if( mNeighborPairCount >= mNeighborPairs.size() ) mNeighborPairs.push_back( SpaceNeighborPair( pDirection.rows() ) );
+	mNeighborPairs[mNeighborPairCount++].set( pObject1, pObject2, pDistance, pDirection );
+}
+
 SpaceAlg::operator std::string() const
 {
     return info();
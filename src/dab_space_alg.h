@@ -8,6 +8,7 @@
 #include <vector>
 #include <Eigen/Dense>
 #include "dab_exception.h"
+#include "dab_space_neighbor_pair.h"
 
 namespace dab
 {
@@ -15,6 +16,7 @@ namespace dab
 namespace space
 {
 
+class SpaceObject;
 class SpaceProxyObject;
 
 class SpaceAlg
@@ -30,9 +32,77 @@ public:
 	const Eigen::VectorXf& maxPos() const;
 	
 	virtual void resize(const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos) throw (Exception);
+	
+	/**
+	 \brief notify the algorithm that an object has been added to the space
+	 \param pObject proxy object of added space object
+	 \exception Exception failed to add object
+	 
+	 algorithms that maintain their structure incrementally override this method, the default does nothing
+	 */
+	virtual void addObject( SpaceProxyObject* pObject ) throw (Exception);
+	
+	/**
+	 \brief notify the algorithm that an object is about to be removed from the space
+	 \param pObject proxy object of removed space object
+	 \exception Exception failed to remove object
+	 
+	 algorithms that maintain their structure incrementally override this method, the default does nothing
+	 */
+	virtual void removeObject( SpaceProxyObject* pObject ) throw (Exception);
 	virtual void updateStructure( std::vector<SpaceProxyObject*>& pObjects ) throw (Exception);
 	virtual void updateNeighbors( std::vector<SpaceProxyObject*>& pObjects ) throw (Exception);
     
+	/**
+	 \brief check whether the algorithm can calculate neighbors in symmetric mode
+	 \return true if symmetric mode is supported, false otherwise
+	 */
+	virtual bool symmetricNeighborsSupported() const;
+	
+	/**
+	 \brief check whether neighbor pairs are stored in symmetric mode
+	 \return true if neighbor pairs are stored, false otherwise
+	 */
+	bool storeNeighborPairs() const;
+	
+	/**
+	 \brief set whether neighbor pairs are stored in symmetric mode
+	 \param pStoreNeighborPairs store neighbor pairs
+	 */
+	void setStoreNeighborPairs(bool pStoreNeighborPairs);
+	
+	/**
+	 \brief return number of neighbor pairs found during the last symmetric neighbor update
+	 \return number of neighbor pairs
+	 */
+	unsigned int neighborPairCount() const;
+	
+	/**
+	 \brief return neighbor pair found during the last symmetric neighbor update
+	 \param pIndex neighbor pair index
+	 \return neighbor pair
+	 \exception Exception index is out of bounds
+	 */
+	const SpaceNeighborPair& neighborPair(unsigned int pIndex) const throw (Exception);
+	
+	/**
+	 \brief remove all neighbor pairs
+	 */
+	void clearNeighborPairs();
+	
+	/**
+	 \brief update neighbors in symmetric mode
+	 \param pVisibleObjects visible objects (as passed to updateStructure)
+	 \param pNeighborObjects objects that can have neighbors
+	 \param pNeighborRadius neighbor radius shared by all objects that can have neighbors
+	 \exception Exception failed to update neighbors
+	 
+	 each unordered pair of visible objects is evaluated only once and the resulting distance and direction are written into the neighbor groups of both objects (with the direction negated for the second object).\n
+	 the default implementation sorts the visible objects into a uniform grid of cells whose size equals the neighbor radius and only compares objects in adjacent cells.\n
+	 objects that can have neighbors but are not visible are handled individually.
+	 */
+	virtual void updateSymmetricNeighbors( std::vector<SpaceProxyObject*>& pVisibleObjects, std::vector<SpaceProxyObject*>& pNeighborObjects, float pNeighborRadius ) throw (Exception);
+    
 	/**
      \brief print space alg information
      */
@@ -57,10 +127,53 @@ public:
 	
 protected:
 	SpaceAlg();
+	
+	/**
+	 \brief prepare symmetric neighbor update
+	 \param pVisibleObjects visible objects
+	 \param pNeighborObjects objects that can have neighbors
+	 \param pUnpairedObjects objects that can have neighbors but are not visible (written)
+	 
+	 assigns indices to visible objects, removes the current neighbors of all objects that can have neighbors and clears the neighbor pairs
+	 */
+	void prepareSymmetricNeighbors( std::vector<SpaceProxyObject*>& pVisibleObjects, std::vector<SpaceProxyObject*>& pNeighborObjects, std::vector<SpaceProxyObject*>& pUnpairedObjects ) throw (Exception);
+	
+	/**
+	 \brief evaluate unordered pair of visible objects
+	 \param pVisibleObjects visible objects
+	 \param pIndex1 index of first visible object
+	 \param pIndex2 index of second visible object
+	 \param pSquaredNeighborRadius squared neighbor radius
+	 
+	 ignores pairs that have already been evaluated for the first object
+	 */
+	void evaluateSymmetricPair( std::vector<SpaceProxyObject*>& pVisibleObjects, unsigned int pIndex1, unsigned int pIndex2, float pSquaredNeighborRadius ) throw (Exception);
+	
+	/**
+	 \brief store neighbor pair
+	 \param pObject1 first space object
+	 \param pObject2 second space object
+	 \param pDistance distance
+	 \param pDirection direction pointing from first to second object
+	 */
+	void addNeighborPair( SpaceObject* pObject1, SpaceObject* pObject2, float pDistance, const Eigen::VectorXf& pDirection );
     
+	static const double sMaxCellCoord; ///\brief largest number of cells along a dimension for which symmetric neighbors are searched in a cell grid
+	
 	bool mFixedSize;
 	Eigen::VectorXf mMinPos;
 	Eigen::VectorXf mMaxPos;
+	
+	bool mStoreNeighborPairs; ///\brief store neighbor pairs in symmetric mode
+	std::vector<SpaceNeighborPair> mNeighborPairs; ///\brief neighbor pairs (reused across updates)
+	unsigned int mNeighborPairCount; ///\brief number of valid neighbor pairs
+	std::vector<unsigned char> mReceivesNeighbors; ///\brief per visible object flag indicating whether the object can have neighbors
+	std::vector<unsigned int> mVisitStamps; ///\brief per visible object index + 1 of the object that evaluated it last
+	Eigen::VectorXf mPairDirection; ///\brief neighbor direction helper variable
+	std::vector<float> mCellOrigin; ///\brief minimum corner of the cell grid, minimum of the visible positions
+	std::vector<float> mCellExtent; ///\brief maximum of the visible positions
+	std::vector<long long> mCellCoords; ///\brief cell coordinates helper variable
+	std::vector< std::pair<unsigned long long, unsigned int> > mCellEntries; ///\brief visible object indices sorted by cell key
 };
     
 };
@@ -0,0 +1,265 @@
+/** \file dab_space_alg_aabbtree.cpp
+ */
+
+#include "dab_space_alg_aabbtree.h"
+#include "dab_space_proxy_object.h"
+#include "dab_space_shape.h"
+#include "dab_space_simd.h"
+#include "dab_geom_cuboid.h"
+
+using namespace dab;
+using namespace dab::space;
+
+AABBTreeAlg::AABBTreeAlg()
+: SpaceAlg(3)
+, mClosestPointType(ClosestPointAABB)
+, mFrame(0)
+, mReinsertCount(0)
+{}
+
+AABBTreeAlg::AABBTreeAlg( const Eigen::Vector3f& pMinPos, const Eigen::Vector3f& pMaxPos, float pMargin ) throw (Exception)
+: SpaceAlg( pMinPos, pMaxPos )
+, mTree( pMargin )
+, mClosestPointType(ClosestPointAABB)
+, mFrame(0)
+, mReinsertCount(0)
+{}
+
+AABBTreeAlg::~AABBTreeAlg()
+{}
+
+ClosestShapePointType
+AABBTreeAlg::closestShapePointType() const
+{
+    return mClosestPointType;
+}
+
+void
+AABBTreeAlg::setClosestPointType(ClosestShapePointType pClosestPointType)
+{
+    mClosestPointType = pClosestPointType;
+}
+
+float
+AABBTreeAlg::margin() const
+{
+    return mTree.margin();
+}
+
+void
+AABBTreeAlg::setMargin(float pMargin) throw (Exception)
+{
+    mTree.setMargin(pMargin);
+}
+
+unsigned int
+AABBTreeAlg::reinsertCount() const
+{
+    return mReinsertCount;
+}
+
+void
+AABBTreeAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != 3) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " is not 3D ", __FILE__, __FUNCTION__, __LINE__);
+
+    mFrame++;
+    mReinsertCount = 0;
+
+    unsigned int objectCount = pObjects.size();
+
+    for(unsigned int i=0; i<objectCount; ++i)
+    {
+        SpaceProxyObject* proxyObject = pObjects[i];
+
+        if(proxyObject->visible() == false) continue;
+
+        SpaceShape* spaceShape = proxyObject->spaceShape();
+
+        if(spaceShape == nullptr) continue;
+
+        const geom::Cuboid& aabb = spaceShape->AABB();
+        const glm::vec3 minPos = aabb.minPos();
+        const glm::vec3 maxPos = aabb.maxPos();
+        float minArray[3] = { minPos.x, minPos.y, minPos.z };
+        float maxArray[3] = { maxPos.x, maxPos.y, maxPos.z };
+
+        auto entryIter = mEntries.find(proxyObject);
+
+        if(entryIter == mEntries.end())
+        {
+            Entry& entry = mEntries[proxyObject];
+            entry.mProxy = mTree.createProxy(minArray, maxArray, proxyObject);
+            entry.mFrame = mFrame;
+            mReinsertCount++;
+        }
+        else
+        {
+            entryIter->second.mFrame = mFrame;
+            if( mTree.moveProxy(entryIter->second.mProxy, minArray, maxArray) == true ) mReinsertCount++;
+        }
+    }
+
+    // remove shapes that have become invisible or have been removed from space
+    for(auto entryIter = mEntries.begin(); entryIter != mEntries.end(); )
+    {
+        if(entryIter->second.mFrame == mFrame)
+        {
+            ++entryIter;
+            continue;
+        }
+
+        mTree.destroyProxy(entryIter->second.mProxy);
+        entryIter = mEntries.erase(entryIter);
+    }
+}
+
+void
+AABBTreeAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != 3) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " is not 3D ", __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        const SpaceSimdTools& simdTools = SpaceSimdTools::get();
+        glm::vec3 closestPoint;
+        glm::vec3 direction;
+        float distance;
+
+        unsigned int objectCount = pObjects.size();
+
+        for(unsigned int i=0; i<objectCount; ++i)
+        {
+            SpaceProxyObject* proxyObject = pObjects[i];
+
+            if(proxyObject->canHaveNeighbors() == false) continue;
+
+            proxyObject->removeNeighbors();
+
+            const Eigen::VectorXf& proxyPos = proxyObject->position();
+            glm::vec3 searchPos(proxyPos[0], proxyPos[1], proxyPos[2]);
+            float minArray[3];
+            float maxArray[3];
+
+            SpaceShape* spaceShape = proxyObject->spaceShape();
+
+            if(spaceShape != nullptr)
+            {
+                const geom::Cuboid& aabb = spaceShape->AABB();
+                const glm::vec3 minPos = aabb.minPos();
+                const glm::vec3 maxPos = aabb.maxPos();
+
+                for(int d=0; d<3; ++d)
+                {
+                    minArray[d] = minPos[d];
+                    maxArray[d] = maxPos[d];
+                }
+            }
+            else
+            {
+                float neighborRadius = proxyObject->neighborRadius();
+
+                for(int d=0; d<3; ++d)
+                {
+                    minArray[d] = proxyPos[d] - neighborRadius;
+                    maxArray[d] = proxyPos[d] + neighborRadius;
+                }
+            }
+
+            mTree.query(minArray, maxArray, mSearchResults);
+
+            unsigned int resultCount = mSearchResults.size();
+
+            if(mClosestPointType == ClosestPointAABB)
+            {
+                // gather boxes of shapes and calculate closest points on all boxes at once
+                float query[3] = { searchPos.x, searchPos.y, searchPos.z };
+                mShapes.clear();
+
+                unsigned int boxStride = SpaceSimdTools::pointStride(resultCount);
+                if(mBoxMins.size() < boxStride * 3)
+                {
+                    mBoxMins.resize(boxStride * 3);
+                    mBoxMaxs.resize(boxStride * 3);
+                    mDirections.resize(boxStride * 3);
+                    mDistances.resize(boxStride);
+                }
+
+                for(unsigned int j=0; j<resultCount; ++j)
+                {
+                    if(mSearchResults[j] == proxyObject) continue;
+
+                    SpaceShape* shape = mSearchResults[j]->spaceShape();
+                    const geom::Cuboid& aabb = shape->AABB();
+                    const glm::vec3 minPos = aabb.minPos();
+                    const glm::vec3 maxPos = aabb.maxPos();
+                    unsigned int shapeIndex = mShapes.size();
+
+                    for(int d=0; d<3; ++d)
+                    {
+                        mBoxMins[d * boxStride + shapeIndex] = minPos[d];
+                        mBoxMaxs[d * boxStride + shapeIndex] = maxPos[d];
+                    }
+
+                    mShapes.push_back(shape);
+                }
+
+                unsigned int shapeCount = mShapes.size();
+
+                simdTools.closestBoxPoints(query, mBoxMins.data(), mBoxMaxs.data(), boxStride, 3, 0, shapeCount, mDirections.data(), mDistances.data());
+
+                for(unsigned int j=0; j<shapeCount; ++j)
+                {
+                    proxyObject->addNeighbor(mShapes[j], mDistances[j], Eigen::Vector3f(mDirections[j], mDirections[boxStride + j], mDirections[2 * boxStride + j]));
+                }
+            }
+            else
+            {
+                for(unsigned int j=0; j<resultCount; ++j)
+                {
+                    if(mSearchResults[j] == proxyObject) continue;
+
+                    SpaceShape* shape = mSearchResults[j]->spaceShape();
+
+                    // calculate closest point from space object to shape
+                    if( shape->featureCaching() == true ) shape->closestPoint(searchPos, closestPoint, proxyObject->closestFeature(shape));
+                    else shape->closestPoint(searchPos, closestPoint);
+
+                    direction = closestPoint - searchPos;
+                    distance = glm::length(direction);
+
+                    proxyObject->addNeighbor(shape, distance, Eigen::Vector3f(direction[0], direction[1], direction[2]));
+                }
+            }
+        }
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update AABBTreeAlg", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+bool
+AABBTreeAlg::symmetricNeighborsSupported() const
+{
+    return false;
+}
+
+AABBTreeAlg::operator std::string() const
+{
+    return info();
+}
+
+std::string
+AABBTreeAlg::info() const
+{
+    std::stringstream stream;
+
+    stream << "AABBTreeAlg\n";
+    stream << "reinsertCount: " << mReinsertCount << "\n";
+    stream << mTree.info();
+    stream << SpaceAlg::info() << "\n";
+
+    return stream.str();
+}
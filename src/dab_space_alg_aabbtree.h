@@ -0,0 +1,130 @@
+/** \file dab_space_alg_aabbtree.h
+ */
+
+#ifndef _dab_space_alg_aabbtree_h_
+#define _dab_space_alg_aabbtree_h_
+
+#include <unordered_map>
+#include "dab_space_types.h"
+#include "dab_space_alg.h"
+#include "dab_space_aabb_tree.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+class SpaceShape;
+
+/**
+ \brief neighbors between objects and shapes based on a dynamic aabb tree
+
+ like RTreeAlg, neighbors are the visible shapes whose axis aligned bounding box overlaps the bounding box of an object (shapes) or a cube whose size is given by the neighbor radius of an object (other objects).\n
+ the tree is kept across structure updates, only shapes whose bounding box leaves its enlarged box in the tree are reinserted. the cost of a structure update therefore scales with the number of shapes that moved by more than the margin.\n
+ a larger margin causes fewer reinsertions but more candidates that have to be rejected during neighbor updates.
+ */
+class AABBTreeAlg : public SpaceAlg
+{
+public:
+    /**
+     \brief create aabb tree alg
+     \param pMinPos minimum position
+     \param pMaxPos maximum position
+     \param pMargin margin by which shape bounding boxes are enlarged in the tree
+     \exception Exception negative margin
+     */
+    AABBTreeAlg(const Eigen::Vector3f& pMinPos, const Eigen::Vector3f& pMaxPos, float pMargin = 0.1) throw (Exception);
+    ~AABBTreeAlg();
+
+    ClosestShapePointType closestShapePointType() const;
+
+    /**
+     \brief set closest point type
+     \param pClosestPointType closest point type
+     */
+    void setClosestPointType(ClosestShapePointType pClosestPointType);
+
+    float margin() const;
+
+    /**
+     \brief set margin by which shape bounding boxes are enlarged in the tree
+     \param pMargin margin
+     \exception Exception negative margin
+
+     only affects shapes that are inserted or reinserted afterwards
+     */
+    void setMargin(float pMargin) throw (Exception);
+
+    /**
+     \brief return number of shapes inserted or reinserted during last structure update
+     \return reinsert count
+     */
+    unsigned int reinsertCount() const;
+
+    void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+    void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+
+    /**
+     \brief symmetric neighbor calculation is not supported
+     \return false
+
+     neighbors are derived from object shapes rather than from object positions
+     */
+    bool symmetricNeighborsSupported() const;
+
+    /**
+     \brief obtain textual aabb tree alg information
+     \return String containing textual aabb tree alg information
+     */
+    operator std::string() const;
+
+    /**
+     \brief obtain textual aabb tree alg information
+     \return String containing textual aabb tree alg information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual aabb tree alg information
+     \param pOstream output stream
+     \param pAlg aabb tree alg
+     */
+    friend std::ostream& operator<< (std::ostream & pOstream, const AABBTreeAlg& pAlg)
+    {
+        pOstream << std::string(pAlg);
+
+        return pOstream;
+    }
+
+protected:
+    /**
+     \brief shape stored in tree
+     */
+    class Entry
+    {
+    public:
+        int mProxy; ///\brief proxy id in tree
+        unsigned long mFrame; ///\brief structure update during which the shape has last been visible
+    };
+
+    AABBTreeAlg();
+
+    SpaceAABBTree mTree; ///\brief dynamic aabb tree of visible shapes
+    ClosestShapePointType mClosestPointType; ///\brief closest point type
+    std::unordered_map<SpaceProxyObject*, Entry> mEntries; ///\brief tree entry of each visible shape
+    unsigned long mFrame; ///\brief number of structure updates
+    unsigned int mReinsertCount; ///\brief number of shapes inserted or reinserted during last structure update
+    std::vector<SpaceProxyObject*> mSearchResults; ///\brief shapes found during neighbor update
+    std::vector<SpaceShape*> mShapes; ///\brief shapes among found objects
+    std::vector<float> mBoxMins; ///\brief packed minimum corners of boxes of shapes
+    std::vector<float> mBoxMaxs; ///\brief packed maximum corners of boxes of shapes
+    std::vector<float> mDirections; ///\brief packed directions from object to closest points on boxes
+    std::vector<float> mDistances; ///\brief distances from object to closest points on boxes
+};
+
+};
+
+};
+
+#endif
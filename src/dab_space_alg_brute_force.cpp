@@ -0,0 +1,251 @@
+/** \file dab_space_alg_brute_force.cpp
+ */
+
+#include "dab_space_alg_brute_force.h"
+#include "dab_space_proxy_object.h"
+#include "dab_space_simd.h"
+#include "dab_space_parallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+
+using namespace dab;
+using namespace dab::space;
+
+BruteForceAlg::BruteForceAlg()
+: SpaceAlg(2)
+, mPositionStride(0)
+, mRowBlockSize(32)
+, mColumnBlockSize(1024)
+{}
+
+BruteForceAlg::BruteForceAlg( unsigned int pDim )
+: SpaceAlg( pDim )
+, mPositionStride(0)
+, mRowBlockSize(32)
+, mColumnBlockSize(1024)
+{}
+
+BruteForceAlg::BruteForceAlg( const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos ) throw (Exception)
+: SpaceAlg( pMinPos, pMaxPos )
+, mPositionStride(0)
+, mRowBlockSize(32)
+, mColumnBlockSize(1024)
+{}
+
+BruteForceAlg::~BruteForceAlg()
+{}
+
+unsigned int
+BruteForceAlg::rowBlockSize() const
+{
+    return mRowBlockSize;
+}
+
+unsigned int
+BruteForceAlg::columnBlockSize() const
+{
+    return mColumnBlockSize;
+}
+
+void
+BruteForceAlg::setBlockSize(unsigned int pRowBlockSize, unsigned int pColumnBlockSize) throw (Exception)
+{
+    if(pRowBlockSize == 0 || pColumnBlockSize == 0) throw Exception("SPACE ERROR: block size must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+
+    mRowBlockSize = pRowBlockSize;
+    mColumnBlockSize = pColumnBlockSize;
+}
+
+void
+BruteForceAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    unsigned int dim = mMinPos.rows();
+    unsigned int objectCount = pObjects.size();
+
+    mObjects = pObjects;
+    mPositionStride = SpaceSimdTools::pointStride(objectCount);
+    mPositions.assign(dim * mPositionStride, 0.0);
+
+    for(unsigned int oI=0; oI<objectCount; ++oI)
+    {
+        const Eigen::VectorXf& position = pObjects[oI]->position();
+        for(unsigned int d=0; d<dim; ++d) mPositions[d * mPositionStride + oI] = position[d];
+
+        pObjects[oI]->setIndex(oI);
+    }
+}
+
+void
+BruteForceAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+        unsigned int dim = mMinPos.rows();
+        unsigned int objectCount = pObjects.size();
+        unsigned int rowBlockCount = ( objectCount + mRowBlockSize - 1 ) / mRowBlockSize;
+        unsigned int threadCount = parallelTools.threadCount();
+
+        if(mThreadBuffers.size() < threadCount) mThreadBuffers.resize(threadCount);
+
+        for(unsigned int tI=0; tI<threadCount; ++tI)
+        {
+            ThreadBuffer& buffer = mThreadBuffers[tI];
+            buffer.mDistances.resize(mRowBlockSize * mColumnBlockSize);
+            buffer.mCandidates.resize(mRowBlockSize);
+            if(buffer.mDirection.rows() != dim) buffer.mDirection.resize(dim);
+        }
+
+        parallelTools.run(rowBlockCount, [this, &pObjects, objectCount](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            unsigned int rowBegin = pTaskIndex * mRowBlockSize;
+            unsigned int rowEnd = std::min(rowBegin + mRowBlockSize, objectCount);
+
+            updateNeighbors(pObjects, rowBegin, rowEnd, mThreadBuffers[pThreadIndex]);
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update neighbors by brute force", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+void
+BruteForceAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects, unsigned int pRowBegin, unsigned int pRowEnd, ThreadBuffer& pBuffer ) throw (Exception)
+{
+    const SpaceSimdTools& simdTools = SpaceSimdTools::get();
+
+    unsigned int dim = mMinPos.rows();
+    unsigned int visibleCount = mObjects.size();
+    float* distances = pBuffer.mDistances.data();
+
+    for(unsigned int rI=pRowBegin; rI<pRowEnd; ++rI)
+    {
+        pObjects[rI]->removeNeighbors();
+        pBuffer.mCandidates[rI - pRowBegin].clear();
+    }
+
+    // process tile by tile so that the column block stays in cache while it's compared with all rows of the block
+    for(unsigned int columnBegin=0; columnBegin<visibleCount; columnBegin += mColumnBlockSize)
+    {
+        unsigned int columnEnd = std::min(columnBegin + mColumnBlockSize, visibleCount);
+        unsigned int columnCount = columnEnd - columnBegin;
+
+        for(unsigned int rI=pRowBegin; rI<pRowEnd; ++rI)
+        {
+            SpaceProxyObject* object = pObjects[rI];
+            int maxNeighborCount = object->maxNeighborCount();
+            if(maxNeighborCount == 0) continue;
+
+            float neighborRadius = object->neighborRadius();
+            float squaredNeighborRadius = neighborRadius >= 0.0 ? neighborRadius * neighborRadius : FLT_MAX;
+
+            // the object itself is skipped if it is visible
+            unsigned int selfIndex = object->index();
+            if(selfIndex >= visibleCount || mObjects[selfIndex] != object) selfIndex = UINT_MAX;
+
+            float* rowDistances = distances + ( rI - pRowBegin ) * mColumnBlockSize;
+            simdTools.squaredDistances(object->position().data(), mPositions.data(), mPositionStride, dim, columnBegin, columnEnd, rowDistances);
+
+            std::vector< std::pair<float, unsigned int> >& candidates = pBuffer.mCandidates[rI - pRowBegin];
+
+            for(unsigned int cI=0; cI<columnCount; ++cI)
+            {
+                if(rowDistances[cI] > squaredNeighborRadius || columnBegin + cI == selfIndex) continue;
+
+                insertCandidate(candidates, rowDistances[cI], columnBegin + cI, maxNeighborCount);
+            }
+        }
+    }
+
+    // add nearest candidates as neighbors
+    for(unsigned int rI=pRowBegin; rI<pRowEnd; ++rI)
+    {
+        SpaceProxyObject* object = pObjects[rI];
+        const Eigen::VectorXf& position = object->position();
+        std::vector< std::pair<float, unsigned int> >& candidates = pBuffer.mCandidates[rI - pRowBegin];
+
+        std::sort(candidates.begin(), candidates.end());
+
+        unsigned int candidateCount = candidates.size();
+        for(unsigned int cI=0; cI<candidateCount; ++cI)
+        {
+            SpaceProxyObject* neighborObject = mObjects[candidates[cI].second];
+            pBuffer.mDirection = neighborObject->position() - position;
+
+            object->addNeighbor(neighborObject->spaceObject(), sqrt(candidates[cI].first), pBuffer.mDirection);
+        }
+    }
+}
+
+void
+BruteForceAlg::insertCandidate( std::vector< std::pair<float, unsigned int> >& pCandidates, float pSquaredDistance, unsigned int pIndex, int pMaxCount )
+{
+    if(pMaxCount < 0 || pCandidates.size() < static_cast<unsigned int>(pMaxCount))
+    {
+        pCandidates.push_back( std::make_pair(pSquaredDistance, pIndex) );
+        if(pMaxCount > 0 && pCandidates.size() == static_cast<unsigned int>(pMaxCount)) std::make_heap(pCandidates.begin(), pCandidates.end());
+    }
+    else if(pSquaredDistance < pCandidates.front().first)
+    {
+        std::pop_heap(pCandidates.begin(), pCandidates.end());
+        pCandidates.back() = std::make_pair(pSquaredDistance, pIndex);
+        std::push_heap(pCandidates.begin(), pCandidates.end());
+    }
+}
+
+void
+BruteForceAlg::searchNeighbors( const Eigen::VectorXf& pPosition, float pNeighborRadius, int pMaxNeighborCount, std::vector< std::pair<float, SpaceProxyObject*> >& pNeighbors ) const throw (Exception)
+{
+    if(pPosition.rows() != mMinPos.rows()) throw Exception("SPACE ERROR: position dimension " + std::to_string(pPosition.rows()) + " doesn't match space dimension " + std::to_string(mMinPos.rows()), __FILE__, __FUNCTION__, __LINE__);
+
+    pNeighbors.clear();
+    if(pMaxNeighborCount == 0) return;
+
+    unsigned int dim = mMinPos.rows();
+    unsigned int visibleCount = mObjects.size();
+    float squaredNeighborRadius = pNeighborRadius >= 0.0 ? pNeighborRadius * pNeighborRadius : FLT_MAX;
+
+    std::vector<float> distances(visibleCount);
+    std::vector< std::pair<float, unsigned int> > candidates;
+
+    SpaceSimdTools::get().squaredDistances(pPosition.data(), mPositions.data(), mPositionStride, dim, 0, visibleCount, distances.data());
+
+    for(unsigned int oI=0; oI<visibleCount; ++oI)
+    {
+        if(distances[oI] <= squaredNeighborRadius) insertCandidate(candidates, distances[oI], oI, pMaxNeighborCount);
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+
+    unsigned int candidateCount = candidates.size();
+    for(unsigned int cI=0; cI<candidateCount; ++cI) pNeighbors.push_back( std::make_pair( sqrt(candidates[cI].first), mObjects[candidates[cI].second] ) );
+}
+
+BruteForceAlg::operator std::string() const
+{
+    return info();
+}
+
+std::string
+BruteForceAlg::info() const
+{
+    std::stringstream stream;
+
+    stream << "BruteForceAlg\n";
+    stream << "rowBlockSize: " << mRowBlockSize << "\n";
+    stream << "columnBlockSize: " << mColumnBlockSize << "\n";
+    stream << "instructionSet: " << SpaceSimdTools::get().instructionSetName( SpaceSimdTools::get().instructionSet() ) << "\n";
+    stream << "threadCount: " << SpaceParallelTools::get().threadCount() << "\n";
+    stream << SpaceAlg::info();
+
+    return stream.str();
+}
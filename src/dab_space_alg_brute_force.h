@@ -0,0 +1,132 @@
+/** \file dab_space_alg_brute_force.h
+ */
+
+#ifndef _dab_space_alg_brute_force_h_
+#define _dab_space_alg_brute_force_h_
+
+#include <Eigen/Dense>
+#include "dab_space_alg.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+/**
+ \brief exhaustive neighbor search
+
+ compares each object with all visible objects by computing blocks of distances with vectorized kernels.\n
+ rows (objects searching for neighbors) are distributed among threads in blocks, columns (visible objects) are processed in blocks that fit into cache.\n
+ suitable for spaces with few objects or high dimension where building a tree doesn't pay off.\n
+ since it is exact, it also serves as reference for approximate space algorithms.
+ */
+class BruteForceAlg : public SpaceAlg
+{
+public:
+    BruteForceAlg(unsigned int pDim);
+    BruteForceAlg(const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos) throw (Exception);
+    ~BruteForceAlg();
+
+    /**
+     \brief return number of objects per row block
+     \return row block size
+     */
+    unsigned int rowBlockSize() const;
+
+    /**
+     \brief return number of visible objects per column block
+     \return column block size
+     */
+    unsigned int columnBlockSize() const;
+
+    /**
+     \brief set block sizes
+     \param pRowBlockSize number of objects per row block
+     \param pColumnBlockSize number of visible objects per column block
+     \exception Exception block size is zero
+     */
+    void setBlockSize(unsigned int pRowBlockSize, unsigned int pColumnBlockSize) throw (Exception);
+
+    void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+    void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+
+    /**
+     \brief search neighbors of a position among the visible objects of the last structure update
+     \param pPosition position
+     \param pNeighborRadius neighbor radius (-1: unlimited)
+     \param pMaxNeighborCount maximum number of neighbors (-1: unlimited)
+     \param pNeighbors resulting distances and objects sorted by ascending distance
+     \exception Exception position dimension doesn't match space dimension
+     */
+    void searchNeighbors( const Eigen::VectorXf& pPosition, float pNeighborRadius, int pMaxNeighborCount, std::vector< std::pair<float, SpaceProxyObject*> >& pNeighbors ) const throw (Exception);
+
+    /**
+     \brief obtain textual brute force alg information
+     \return String containing textual brute force alg information
+     */
+    operator std::string() const;
+
+    /**
+     \brief obtain textual brute force alg information
+     \return String containing textual brute force alg information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual brute force alg information
+     \param pOstream output stream
+     \param pAlg brute force alg
+     */
+    friend std::ostream& operator<< (std::ostream & pOstream, const BruteForceAlg& pAlg)
+    {
+        pOstream << std::string(pAlg);
+
+        return pOstream;
+    }
+
+protected:
+    /**
+     \brief per thread buffers
+     */
+    class ThreadBuffer
+    {
+    public:
+        std::vector<float> mDistances; ///\brief distance tile (row block size * column block size)
+        std::vector< std::vector< std::pair<float, unsigned int> > > mCandidates; ///\brief nearest candidates for each row of the block
+        Eigen::VectorXf mDirection; ///\brief neighbor direction
+    };
+
+    BruteForceAlg();
+
+    /**
+     \brief calculate neighbors for one block of rows
+     \param pObjects objects searching for neighbors
+     \param pRowBegin index of first row
+     \param pRowEnd index after last row
+     \param pBuffer thread buffer
+     */
+    void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects, unsigned int pRowBegin, unsigned int pRowEnd, ThreadBuffer& pBuffer ) throw (Exception);
+
+    /**
+     \brief insert candidate into list of nearest candidates
+     \param pCandidates candidates, kept as max heap once the maximum count has been reached
+     \param pSquaredDistance squared distance
+     \param pIndex visible object index
+     \param pMaxCount maximum number of candidates (-1: unlimited)
+     */
+    static void insertCandidate( std::vector< std::pair<float, unsigned int> >& pCandidates, float pSquaredDistance, unsigned int pIndex, int pMaxCount );
+
+    std::vector<SpaceProxyObject*> mObjects; ///\brief visible objects
+    std::vector<float> mPositions; ///\brief packed positions of visible objects (stored dimension by dimension)
+    unsigned int mPositionStride; ///\brief stride of packed positions
+    unsigned int mRowBlockSize; ///\brief number of objects per row block
+    unsigned int mColumnBlockSize; ///\brief number of visible objects per column block
+    std::vector<ThreadBuffer> mThreadBuffers; ///\brief buffers for each thread
+};
+
+};
+
+};
+
+#endif
@@ -0,0 +1,1063 @@
+/** \file dab_space_alg_delaunay.cpp
+ */
+
+#include "dab_space_alg_delaunay.h"
+#include "dab_space_proxy_object.h"
+#include "dab_space_parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+using namespace dab;
+using namespace dab::space;
+
+const double DelaunayAlg::sSuperSimplexScale = 1000.0;
+const double DelaunayAlg::sPerturbation = 1.0e-7;
+const double DelaunayAlg::sFlipTolerance = 1.0e-9;
+const double DelaunayAlg::sOrientationErrorBound[2] = { ( 3.0 + 16.0 * std::numeric_limits<double>::epsilon() ) * std::numeric_limits<double>::epsilon(), ( 7.0 + 56.0 * std::numeric_limits<double>::epsilon() ) * std::numeric_limits<double>::epsilon() };
+const double DelaunayAlg::sInSphereErrorBound[2] = { ( 10.0 + 96.0 * std::numeric_limits<double>::epsilon() ) * std::numeric_limits<double>::epsilon(), ( 16.0 + 224.0 * std::numeric_limits<double>::epsilon() ) * std::numeric_limits<double>::epsilon() };
+const unsigned int DelaunayAlg::sMaxMoveStepCount = 16;
+
+DelaunayAlg::DelaunayAlg()
+: SpaceAlg(2)
+, mRebuildRequested(true)
+, mRebuildCount(0)
+, mFlipCount(0)
+, mHintSimplex(0)
+{}
+
+DelaunayAlg::DelaunayAlg( unsigned int pDim ) throw (Exception)
+: SpaceAlg( pDim )
+, mRebuildRequested(true)
+, mRebuildCount(0)
+, mFlipCount(0)
+, mHintSimplex(0)
+{
+    if(pDim != 2 && pDim != 3) throw Exception("SPACE ERROR: delaunay alg supports dimension 2 or 3 only, not " + std::to_string(pDim), __FILE__, __FUNCTION__, __LINE__);
+}
+
+DelaunayAlg::DelaunayAlg( const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos ) throw (Exception)
+: SpaceAlg( pMinPos, pMaxPos )
+, mRebuildRequested(true)
+, mRebuildCount(0)
+, mFlipCount(0)
+, mHintSimplex(0)
+{
+    if(pMinPos.rows() != 2 && pMinPos.rows() != 3) throw Exception("SPACE ERROR: delaunay alg supports dimension 2 or 3 only, not " + std::to_string(pMinPos.rows()), __FILE__, __FUNCTION__, __LINE__);
+}
+
+DelaunayAlg::~DelaunayAlg()
+{}
+
+unsigned int
+DelaunayAlg::rebuildCount() const
+{
+    return mRebuildCount;
+}
+
+unsigned int
+DelaunayAlg::flipCount() const
+{
+    return mFlipCount;
+}
+
+unsigned int
+DelaunayAlg::simplexCount() const
+{
+    return mSimplices.size() - mFreeSimplices.size();
+}
+
+void
+DelaunayAlg::rebuild()
+{
+    mRebuildRequested = true;
+}
+
+double
+DelaunayAlg::orientation( const Simplex& pSimplex, int pReplaceIndex, const double* pPoint ) const
+{
+    unsigned int dim = mMinPos.rows();
+    const double* p[4];
+
+    for(unsigned int vI=0; vI<=dim; ++vI) p[vI] = static_cast<int>(vI) == pReplaceIndex ? pPoint : point( pSimplex.mVertices[vI] );
+
+    double determinant;
+    double permanent;
+
+    if(dim == 2)
+    {
+        double left = ( p[1][0] - p[0][0] ) * ( p[2][1] - p[0][1] );
+        double right = ( p[1][1] - p[0][1] ) * ( p[2][0] - p[0][0] );
+
+        determinant = left - right;
+        permanent = std::abs(left) + std::abs(right);
+    }
+    else
+    {
+        double a[3], b[3], c[3];
+        for(unsigned int d=0; d<3; ++d)
+        {
+            a[d] = p[1][d] - p[0][d];
+            b[d] = p[2][d] - p[0][d];
+            c[d] = p[3][d] - p[0][d];
+        }
+
+        determinant = a[0] * ( b[1] * c[2] - b[2] * c[1] ) + a[1] * ( b[2] * c[0] - b[0] * c[2] ) + a[2] * ( b[0] * c[1] - b[1] * c[0] );
+        permanent = std::abs(a[0]) * ( std::abs(b[1] * c[2]) + std::abs(b[2] * c[1]) ) + std::abs(a[1]) * ( std::abs(b[2] * c[0]) + std::abs(b[0] * c[2]) ) + std::abs(a[2]) * ( std::abs(b[0] * c[1]) + std::abs(b[1] * c[0]) );
+    }
+
+    // the sign of determinants within the rounding error bound is unknown
+    if( std::abs(determinant) <= sOrientationErrorBound[dim - 2] * permanent ) return 0.0;
+
+    return determinant;
+}
+
+bool
+DelaunayAlg::inCircumsphere( int pSimplexIndex, const double* pPoint, double pTolerance ) const
+{
+    unsigned int dim = mMinPos.rows();
+    const Simplex& simplex = mSimplices[pSimplexIndex];
+
+    // degenerate simplices are treated as having an infinite circumsphere
+    double simplexOrientation = orientation(simplex, -1, nullptr);
+    if(simplexOrientation == 0.0) return true;
+
+    double determinant;
+    double permanent;
+
+    // lifted vertices relative to position
+    if(dim == 2)
+    {
+        double x[3], y[3], lift[3];
+        for(unsigned int vI=0; vI<3; ++vI)
+        {
+            const double* p = point( simplex.mVertices[vI] );
+            x[vI] = p[0] - pPoint[0];
+            y[vI] = p[1] - pPoint[1];
+            lift[vI] = x[vI] * x[vI] + y[vI] * y[vI];
+        }
+
+        double bc = x[1] * y[2] - x[2] * y[1];
+        double ca = x[2] * y[0] - x[0] * y[2];
+        double ab = x[0] * y[1] - x[1] * y[0];
+
+        determinant = lift[0] * bc + lift[1] * ca + lift[2] * ab;
+        permanent = ( std::abs(x[1] * y[2]) + std::abs(x[2] * y[1]) ) * lift[0] + ( std::abs(x[2] * y[0]) + std::abs(x[0] * y[2]) ) * lift[1] + ( std::abs(x[0] * y[1]) + std::abs(x[1] * y[0]) ) * lift[2];
+    }
+    else
+    {
+        double x[4], y[4], z[4], lift[4];
+        for(unsigned int vI=0; vI<4; ++vI)
+        {
+            const double* p = point( simplex.mVertices[vI] );
+            x[vI] = p[0] - pPoint[0];
+            y[vI] = p[1] - pPoint[1];
+            z[vI] = p[2] - pPoint[2];
+            lift[vI] = x[vI] * x[vI] + y[vI] * y[vI] + z[vI] * z[vI];
+        }
+
+        // 2x2 minors of the x and y columns and their magnitudes
+        double xy[4][4];
+        double xyPermanent[4][4];
+        for(unsigned int i=0; i<4; ++i)
+        {
+            for(unsigned int j=0; j<4; ++j)
+            {
+                xy[i][j] = x[i] * y[j] - x[j] * y[i];
+                xyPermanent[i][j] = std::abs(x[i] * y[j]) + std::abs(x[j] * y[i]);
+            }
+        }
+
+        // 3x3 minors of the x, y and z columns, the vertex opposite of each minor is omitted
+        double minors[4];
+        double minorPermanents[4];
+        for(unsigned int i=0; i<4; ++i)
+        {
+            unsigned int a = (i + 1) % 4, b = (i + 2) % 4, c = (i + 3) % 4;
+
+            minors[i] = z[a] * xy[b][c] - z[b] * xy[a][c] + z[c] * xy[a][b];
+            minorPermanents[i] = std::abs(z[a]) * xyPermanent[b][c] + std::abs(z[b]) * xyPermanent[a][c] + std::abs(z[c]) * xyPermanent[a][b];
+        }
+
+        determinant = lift[0] * minors[0] - lift[1] * minors[1] + lift[2] * minors[2] - lift[3] * minors[3];
+        permanent = lift[0] * minorPermanents[0] + lift[1] * minorPermanents[1] + lift[2] * minorPermanents[2] + lift[3] * minorPermanents[3];
+    }
+
+    // the determinant is positive for positions inside the circumsphere of a positively oriented simplex, positions within the rounding error bound count as inside unless a tolerance is given
+    if(simplexOrientation < 0.0) determinant = -determinant;
+
+    return determinant > ( pTolerance - sInSphereErrorBound[dim - 2] ) * permanent;
+}
+
+int
+DelaunayAlg::locate( const double* pPoint, int pStartSimplex ) const
+{
+    unsigned int dim = mMinPos.rows();
+    int simplexIndex = pStartSimplex;
+    unsigned int maxStepCount = mSimplices.size() + 1;
+
+    // visibility walk, the facet tested first changes with each step to avoid cycles
+    for(unsigned int step=0; step<maxStepCount; ++step)
+    {
+        const Simplex& simplex = mSimplices[simplexIndex];
+        bool inside = true;
+
+        for(unsigned int fI=0; fI<=dim; ++fI)
+        {
+            int vertexIndex = ( fI + step ) % ( dim + 1 );
+
+            if( orientation(simplex, vertexIndex, pPoint) < 0.0 )
+            {
+                if(simplex.mNeighbors[vertexIndex] < 0) return simplexIndex;
+
+                simplexIndex = simplex.mNeighbors[vertexIndex];
+                inside = false;
+                break;
+            }
+        }
+
+        if(inside == true) return simplexIndex;
+    }
+
+    // walk failed due to rounding, search all simplices
+    unsigned int simplexCount = mSimplices.size();
+    for(unsigned int sI=0; sI<simplexCount; ++sI)
+    {
+        const Simplex& simplex = mSimplices[sI];
+        if(simplex.mAlive == false) continue;
+
+        bool inside = true;
+        for(unsigned int vI=0; vI<=dim && inside == true; ++vI) inside = orientation(simplex, vI, pPoint) >= 0.0;
+
+        if(inside == true) return sI;
+    }
+
+    return pStartSimplex;
+}
+
+int
+DelaunayAlg::createSimplex()
+{
+    int simplexIndex;
+
+    if(mFreeSimplices.size() > 0)
+    {
+        simplexIndex = mFreeSimplices.back();
+        mFreeSimplices.pop_back();
+    }
+    else
+    {
+        simplexIndex = mSimplices.size();
+        mSimplices.push_back(Simplex());
+    }
+
+    Simplex& simplex = mSimplices[simplexIndex];
+    simplex.mAlive = true;
+    for(unsigned int vI=0; vI<4; ++vI)
+    {
+        simplex.mVertices[vI] = -1;
+        simplex.mNeighbors[vI] = -1;
+    }
+
+    return simplexIndex;
+}
+
+void
+DelaunayAlg::deleteSimplex( int pSimplexIndex )
+{
+    mSimplices[pSimplexIndex].mAlive = false;
+    mFreeSimplices.push_back(pSimplexIndex);
+}
+
+void
+DelaunayAlg::rebuildTriangulation()
+{
+    unsigned int dim = mMinPos.rows();
+    unsigned int vertexCount = mObjects.size();
+
+    // super simplex enclosing all points
+    Eigen::VectorXd minPos = Eigen::VectorXd::Constant(dim, std::numeric_limits<double>::max());
+    Eigen::VectorXd maxPos = Eigen::VectorXd::Constant(dim, -std::numeric_limits<double>::max());
+
+    for(unsigned int vI=0; vI<vertexCount; ++vI)
+    {
+        for(unsigned int d=0; d<dim; ++d)
+        {
+            minPos[d] = std::min( minPos[d], point(vI)[d] );
+            maxPos[d] = std::max( maxPos[d], point(vI)[d] );
+        }
+    }
+
+    if(vertexCount == 0)
+    {
+        minPos.setConstant(-1.0);
+        maxPos.setConstant(1.0);
+    }
+
+    Eigen::VectorXd center = ( minPos + maxPos ) * 0.5;
+    double extent = std::max( ( maxPos - minPos ).norm() * 0.5, 1.0e-6 );
+    double radius = extent * sSuperSimplexScale;
+
+    mPoints.resize( ( vertexCount + dim + 1 ) * dim );
+    double* superPoints = mPoints.data() + vertexCount * dim;
+
+    if(dim == 2)
+    {
+        const double corners[3][2] = { {0.0, 2.0}, {-sqrt(3.0), -1.0}, {sqrt(3.0), -1.0} };
+        for(unsigned int vI=0; vI<3; ++vI) for(unsigned int d=0; d<2; ++d) superPoints[vI * 2 + d] = center[d] + radius * corners[vI][d];
+    }
+    else
+    {
+        const double corners[4][3] = { {1.0, 1.0, 1.0}, {1.0, -1.0, -1.0}, {-1.0, 1.0, -1.0}, {-1.0, -1.0, 1.0} };
+        for(unsigned int vI=0; vI<4; ++vI) for(unsigned int d=0; d<3; ++d) superPoints[vI * 3 + d] = center[d] + radius * corners[vI][d];
+    }
+
+    mSimplices.clear();
+    mFreeSimplices.clear();
+
+    int superSimplex = createSimplex();
+    for(unsigned int vI=0; vI<=dim; ++vI) mSimplices[superSimplex].mVertices[vI] = vertexCount + vI;
+    if( orientation(mSimplices[superSimplex], -1, nullptr) < 0.0 ) std::swap( mSimplices[superSimplex].mVertices[0], mSimplices[superSimplex].mVertices[1] );
+    mHintSimplex = superSimplex;
+
+    // insert points in z-order so that point location only walks short distances
+    std::vector< std::pair<uint64_t, unsigned int> > order(vertexCount);
+    unsigned int bitCount = dim == 2 ? 16 : 10;
+    double cellCount = static_cast<double>( ( 1u << bitCount ) - 1 );
+
+    for(unsigned int vI=0; vI<vertexCount; ++vI)
+    {
+        uint64_t code = 0;
+
+        for(unsigned int d=0; d<dim; ++d)
+        {
+            double range = maxPos[d] - minPos[d];
+            uint64_t cell = range > 0.0 ? static_cast<uint64_t>( ( point(vI)[d] - minPos[d] ) / range * cellCount ) : 0;
+            for(unsigned int bI=0; bI<bitCount; ++bI) code |= ( ( cell >> bI ) & 1ull ) << ( bI * dim + d );
+        }
+
+        order[vI] = std::make_pair(code, vI);
+    }
+
+    std::sort(order.begin(), order.end());
+
+    mInserted.assign(vertexCount, false);
+    for(unsigned int vI=0; vI<vertexCount; ++vI) mInserted[ order[vI].second ] = insertVertex( order[vI].second );
+
+    mRebuildCount++;
+}
+
+void
+DelaunayAlg::collectCavity( const double* pPoint, int pStartSimplex, SearchBuffer& pBuffer ) const
+{
+    unsigned int dim = mMinPos.rows();
+
+    if(pBuffer.mSimplexStamps.size() < mSimplices.size()) pBuffer.mSimplexStamps.resize(mSimplices.size(), 0);
+
+    pBuffer.mStamp++;
+    pBuffer.mCavity.clear();
+    pBuffer.mCavity.push_back(pStartSimplex);
+    pBuffer.mSimplexStamps[pStartSimplex] = pBuffer.mStamp;
+
+    for(unsigned int cI=0; cI<pBuffer.mCavity.size(); ++cI)
+    {
+        const Simplex& simplex = mSimplices[ pBuffer.mCavity[cI] ];
+
+        for(unsigned int vI=0; vI<=dim; ++vI)
+        {
+            int neighborIndex = simplex.mNeighbors[vI];
+            if(neighborIndex < 0 || pBuffer.mSimplexStamps[neighborIndex] == pBuffer.mStamp) continue;
+            if( inCircumsphere(neighborIndex, pPoint) == false ) continue;
+
+            pBuffer.mSimplexStamps[neighborIndex] = pBuffer.mStamp;
+            pBuffer.mCavity.push_back(neighborIndex);
+        }
+    }
+}
+
+bool
+DelaunayAlg::insertVertex( int pVertex )
+{
+    unsigned int dim = mMinPos.rows();
+    const double* vertexPoint = point(pVertex);
+    SearchBuffer& buffer = mSearchBuffers[0];
+
+    if(mSimplices[mHintSimplex].mAlive == false) mHintSimplex = mSimplices.size() - 1;
+    while(mSimplices[mHintSimplex].mAlive == false) mHintSimplex--;
+
+    int startSimplex = locate(vertexPoint, mHintSimplex);
+    if( inCircumsphere(startSimplex, vertexPoint) == false ) return false;
+
+    collectCavity(vertexPoint, startSimplex, buffer);
+
+    // the cavity must be star shaped with respect to the new vertex, rounding errors are compensated by growing the cavity
+    const unsigned int maxRepairCount = 16;
+    bool starShaped = false;
+
+    for(unsigned int repair=0; repair<maxRepairCount && starShaped == false; ++repair)
+    {
+        starShaped = true;
+        mBoundary.clear();
+
+        unsigned int cavitySize = buffer.mCavity.size();
+        for(unsigned int cI=0; cI<cavitySize; ++cI)
+        {
+            int cavitySimplex = buffer.mCavity[cI];
+            const Simplex& simplex = mSimplices[cavitySimplex];
+
+            for(unsigned int vI=0; vI<=dim; ++vI)
+            {
+                int neighborIndex = simplex.mNeighbors[vI];
+                if(neighborIndex >= 0 && buffer.mSimplexStamps[neighborIndex] == buffer.mStamp) continue;
+
+                if( orientation(simplex, vI, vertexPoint) <= 0.0 )
+                {
+                    if(neighborIndex < 0) return false;
+
+                    buffer.mSimplexStamps[neighborIndex] = buffer.mStamp;
+                    buffer.mCavity.push_back(neighborIndex);
+                    starShaped = false;
+                }
+                else
+                {
+                    mBoundary.push_back(cavitySimplex);
+                    mBoundary.push_back(vI);
+                }
+            }
+        }
+    }
+
+    if(starShaped == false) return false;
+
+    // connect new vertex with each boundary facet
+    unsigned int boundaryCount = mBoundary.size() / 2;
+    mRidges.clear();
+
+    for(unsigned int bI=0; bI<boundaryCount; ++bI)
+    {
+        int cavitySimplex = mBoundary[bI * 2];
+        int vertexIndex = mBoundary[bI * 2 + 1];
+        int newSimplex = createSimplex();
+
+        Simplex& simplex = mSimplices[newSimplex];
+        const Simplex& oldSimplex = mSimplices[cavitySimplex];
+
+        for(unsigned int vI=0; vI<=dim; ++vI) simplex.mVertices[vI] = oldSimplex.mVertices[vI];
+        simplex.mVertices[vertexIndex] = pVertex;
+
+        int outerSimplex = oldSimplex.mNeighbors[vertexIndex];
+        simplex.mNeighbors[vertexIndex] = outerSimplex;
+
+        if(outerSimplex >= 0)
+        {
+            Simplex& outer = mSimplices[outerSimplex];
+            for(unsigned int vI=0; vI<=dim; ++vI) if(outer.mNeighbors[vI] == cavitySimplex) outer.mNeighbors[vI] = newSimplex;
+        }
+
+        // facets containing the new vertex are shared with other new simplices, they are identified by their remaining vertices
+        for(unsigned int vI=0; vI<=dim; ++vI)
+        {
+            if(static_cast<int>(vI) == vertexIndex) continue;
+
+            int ridge[2] = { -1, -1 };
+            unsigned int ridgeCount = 0;
+            for(unsigned int rI=0; rI<=dim; ++rI) if(rI != vI && static_cast<int>(rI) != vertexIndex) ridge[ridgeCount++] = simplex.mVertices[rI];
+            if(ridge[0] > ridge[1]) std::swap(ridge[0], ridge[1]);
+
+            mRidges.push_back( std::make_pair( std::make_pair(ridge[0], ridge[1]), std::make_pair(newSimplex, static_cast<int>(vI)) ) );
+        }
+    }
+
+    std::sort(mRidges.begin(), mRidges.end());
+
+    unsigned int ridgeCount = mRidges.size();
+    for(unsigned int rI=0; rI + 1<ridgeCount; ++rI)
+    {
+        if(mRidges[rI].first != mRidges[rI + 1].first) continue;
+
+        const std::pair<int, int>& facet1 = mRidges[rI].second;
+        const std::pair<int, int>& facet2 = mRidges[rI + 1].second;
+
+        mSimplices[facet1.first].mNeighbors[facet1.second] = facet2.first;
+        mSimplices[facet2.first].mNeighbors[facet2.second] = facet1.first;
+        rI++;
+    }
+
+    unsigned int cavitySize = buffer.mCavity.size();
+    for(unsigned int cI=0; cI<cavitySize; ++cI) deleteSimplex( buffer.mCavity[cI] );
+
+    mHintSimplex = mRidges.size() > 0 ? mRidges.back().second.first : mHintSimplex;
+
+    return true;
+}
+
+bool
+DelaunayAlg::checkOrientations()
+{
+    SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+    unsigned int simplexCount = mSimplices.size();
+    unsigned int threadCount = parallelTools.threadCount();
+    const unsigned int blockSize = 256;
+    unsigned int blockCount = ( simplexCount + blockSize - 1 ) / blockSize;
+
+    for(unsigned int tI=0; tI<threadCount; ++tI) mSearchBuffers[tI].mInvalidCount = 0;
+
+    parallelTools.run(blockCount, [this, simplexCount, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+    {
+        unsigned int simplexEnd = std::min( (pTaskIndex + 1) * blockSize, simplexCount );
+
+        for(unsigned int sI=pTaskIndex * blockSize; sI<simplexEnd; ++sI)
+        {
+            if(mSimplices[sI].mAlive == false) continue;
+
+            if( orientation(mSimplices[sI], -1, nullptr) <= 0.0 ) mSearchBuffers[pThreadIndex].mInvalidCount++;
+        }
+    });
+
+    unsigned int invalidCount = 0;
+    for(unsigned int tI=0; tI<threadCount; ++tI) invalidCount += mSearchBuffers[tI].mInvalidCount;
+
+    return invalidCount == 0;
+}
+
+bool
+DelaunayAlg::movePoints()
+{
+    unsigned int valueCount = mObjects.size() * mMinPos.rows();
+    double reachedFraction = 0.0;
+    double stepFraction = 1.0;
+
+    mTargetPoints.assign( mPoints.begin(), mPoints.begin() + valueCount );
+
+    for(unsigned int step=0; step<sMaxMoveStepCount; ++step)
+    {
+        double fraction = std::min( reachedFraction + stepFraction, 1.0 );
+
+        if(fraction == 1.0) std::copy( mTargetPoints.begin(), mTargetPoints.end(), mPoints.begin() );
+        else for(unsigned int vI=0; vI<valueCount; ++vI) mPoints[vI] = mPreviousPoints[vI] + ( mTargetPoints[vI] - mPreviousPoints[vI] ) * fraction;
+
+        if( checkOrientations() == false )
+        {
+            // repair flips that don't restore a valid triangulation are undone, they could invert triangles at smaller steps
+            mRepairSimplices = mSimplices;
+
+            if( repairInversions() == 0 || checkOrientations() == false )
+            {
+                mSimplices.swap( mRepairSimplices );
+                stepFraction *= 0.5;
+                continue;
+            }
+        }
+
+        if( flipEdges() == false ) break;
+
+        reachedFraction = fraction;
+        if(reachedFraction == 1.0) return true;
+
+        stepFraction = std::min( stepFraction * 2.0, 1.0 );
+    }
+
+    std::copy( mTargetPoints.begin(), mTargetPoints.end(), mPoints.begin() );
+
+    return false;
+}
+
+unsigned int
+DelaunayAlg::repairInversions()
+{
+    unsigned int simplexCount = mSimplices.size();
+    unsigned int repairCount = 0;
+
+    for(unsigned int sI=0; sI<simplexCount; ++sI)
+    {
+        const Simplex& simplex = mSimplices[sI];
+        if(simplex.mAlive == false || orientation(simplex, -1, nullptr) > 0.0) continue;
+
+        // the vertex opposite of the longest edge has most likely crossed that edge, the other edges are tried in order of decreasing length
+        double lengths[3];
+        int edges[3] = { 0, 1, 2 };
+
+        for(unsigned int vI=0; vI<3; ++vI)
+        {
+            const double* p1 = point( simplex.mVertices[ (vI + 1) % 3 ] );
+            const double* p2 = point( simplex.mVertices[ (vI + 2) % 3 ] );
+            lengths[vI] = ( p2[0] - p1[0] ) * ( p2[0] - p1[0] ) + ( p2[1] - p1[1] ) * ( p2[1] - p1[1] );
+        }
+
+        std::sort( edges, edges + 3, [&lengths](int pEdge1, int pEdge2) { return lengths[pEdge1] > lengths[pEdge2]; } );
+
+        int crossingIndex = -1;
+
+        for(unsigned int eI=0; eI<3 && crossingIndex < 0; ++eI)
+        {
+            int neighborIndex = simplex.mNeighbors[ edges[eI] ];
+            if(neighborIndex < 0) continue;
+
+            const Simplex& neighbor = mSimplices[neighborIndex];
+            int d = -1;
+            for(unsigned int vI=0; vI<3; ++vI) if(neighbor.mNeighbors[vI] == static_cast<int>(sI)) d = neighbor.mVertices[vI];
+
+            // flip only if both resulting triangles are positively oriented
+            Simplex flipped1 = simplex;
+            Simplex flipped2 = simplex;
+            flipped1.mVertices[ (edges[eI] + 2) % 3 ] = d;
+            flipped2.mVertices[ (edges[eI] + 1) % 3 ] = d;
+
+            if( orientation(flipped1, -1, nullptr) > 0.0 && orientation(flipped2, -1, nullptr) > 0.0 ) crossingIndex = edges[eI];
+        }
+
+        if(crossingIndex < 0) continue;
+
+        flipEdge(sI, crossingIndex);
+        mFlipCount++;
+        repairCount++;
+    }
+
+    return repairCount;
+}
+
+bool
+DelaunayAlg::flipEdges()
+{
+    unsigned int simplexCount = mSimplices.size();
+    unsigned int maxFlipCount = 4 * simplexCount + 64;
+
+    // find edges that violate the delaunay property in parallel, flips are then carried out sequentially
+    SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+    unsigned int threadCount = parallelTools.threadCount();
+    const unsigned int blockSize = 256;
+    unsigned int blockCount = ( simplexCount + blockSize - 1 ) / blockSize;
+
+    for(unsigned int tI=0; tI<threadCount; ++tI) mSearchBuffers[tI].mFlips.clear();
+
+    parallelTools.run(blockCount, [this, simplexCount, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+    {
+        std::vector<int>& flips = mSearchBuffers[pThreadIndex].mFlips;
+        unsigned int simplexEnd = std::min( (pTaskIndex + 1) * blockSize, simplexCount );
+
+        for(unsigned int sI=pTaskIndex * blockSize; sI<simplexEnd; ++sI)
+        {
+            const Simplex& simplex = mSimplices[sI];
+            if(simplex.mAlive == false) continue;
+
+            for(unsigned int vI=0; vI<3; ++vI)
+            {
+                int neighborIndex = simplex.mNeighbors[vI];
+                if(neighborIndex < 0) continue;
+
+                const Simplex& neighbor = mSimplices[neighborIndex];
+                int oppositeVertex = -1;
+                for(unsigned int nvI=0; nvI<3; ++nvI) if(neighbor.mNeighbors[nvI] == static_cast<int>(sI)) oppositeVertex = neighbor.mVertices[nvI];
+
+                if( inCircumsphere(sI, point(oppositeVertex), sFlipTolerance) == false ) continue;
+
+                flips.push_back(sI);
+                flips.push_back(vI);
+            }
+        }
+    });
+
+    mFlipStack.clear();
+    for(unsigned int tI=0; tI<threadCount; ++tI) mFlipStack.insert( mFlipStack.end(), mSearchBuffers[tI].mFlips.begin(), mSearchBuffers[tI].mFlips.end() );
+
+    while(mFlipStack.size() > 0)
+    {
+        int vertexIndex = mFlipStack.back();
+        mFlipStack.pop_back();
+        int simplexIndex = mFlipStack.back();
+        mFlipStack.pop_back();
+
+        const Simplex& simplex = mSimplices[simplexIndex];
+        int neighborIndex = simplex.mNeighbors[vertexIndex];
+        if(neighborIndex < 0) continue;
+
+        const Simplex& neighbor = mSimplices[neighborIndex];
+        int oppositeVertex = -1;
+        for(unsigned int vI=0; vI<3; ++vI) if(neighbor.mNeighbors[vI] == simplexIndex) oppositeVertex = neighbor.mVertices[vI];
+
+        if( inCircumsphere(simplexIndex, point(oppositeVertex), sFlipTolerance) == false ) continue;
+
+        flipEdge(simplexIndex, vertexIndex);
+        mFlipCount++;
+
+        if(mFlipCount > maxFlipCount) return false;
+        if( orientation(mSimplices[simplexIndex], -1, nullptr) <= 0.0 || orientation(mSimplices[neighborIndex], -1, nullptr) <= 0.0 ) return false;
+
+        for(unsigned int vI=0; vI<3; ++vI)
+        {
+            mFlipStack.push_back(simplexIndex);
+            mFlipStack.push_back(vI);
+            mFlipStack.push_back(neighborIndex);
+            mFlipStack.push_back(vI);
+        }
+    }
+
+    return true;
+}
+
+void
+DelaunayAlg::flipEdge( int pSimplexIndex, int pVertexIndex )
+{
+    Simplex& simplex = mSimplices[pSimplexIndex];
+    int neighborIndex = simplex.mNeighbors[pVertexIndex];
+    Simplex& neighbor = mSimplices[neighborIndex];
+
+    // triangle (a, b, c) and neighbor (d, c, b) become (a, b, d) and (a, d, c)
+    int a = simplex.mVertices[pVertexIndex];
+    int b = simplex.mVertices[ (pVertexIndex + 1) % 3 ];
+    int c = simplex.mVertices[ (pVertexIndex + 2) % 3 ];
+    int neighborCA = simplex.mNeighbors[ (pVertexIndex + 1) % 3 ];
+    int neighborAB = simplex.mNeighbors[ (pVertexIndex + 2) % 3 ];
+
+    int d = -1, neighborBD = -1, neighborDC = -1;
+    for(unsigned int vI=0; vI<3; ++vI)
+    {
+        if(neighbor.mNeighbors[vI] == pSimplexIndex) d = neighbor.mVertices[vI];
+        else if(neighbor.mVertices[vI] == c) neighborBD = neighbor.mNeighbors[vI];
+        else if(neighbor.mVertices[vI] == b) neighborDC = neighbor.mNeighbors[vI];
+    }
+
+    simplex.mVertices[0] = a; simplex.mVertices[1] = b; simplex.mVertices[2] = d;
+    simplex.mNeighbors[0] = neighborBD; simplex.mNeighbors[1] = neighborIndex; simplex.mNeighbors[2] = neighborAB;
+
+    neighbor.mVertices[0] = a; neighbor.mVertices[1] = d; neighbor.mVertices[2] = c;
+    neighbor.mNeighbors[0] = neighborDC; neighbor.mNeighbors[1] = neighborCA; neighbor.mNeighbors[2] = pSimplexIndex;
+
+    if(neighborBD >= 0) for(unsigned int vI=0; vI<3; ++vI) if(mSimplices[neighborBD].mNeighbors[vI] == neighborIndex) mSimplices[neighborBD].mNeighbors[vI] = pSimplexIndex;
+    if(neighborCA >= 0) for(unsigned int vI=0; vI<3; ++vI) if(mSimplices[neighborCA].mNeighbors[vI] == pSimplexIndex) mSimplices[neighborCA].mNeighbors[vI] = neighborIndex;
+}
+
+bool
+DelaunayAlg::checkFacets()
+{
+    SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+    unsigned int simplexCount = mSimplices.size();
+    unsigned int threadCount = parallelTools.threadCount();
+    const unsigned int blockSize = 256;
+    unsigned int blockCount = ( simplexCount + blockSize - 1 ) / blockSize;
+
+    for(unsigned int tI=0; tI<threadCount; ++tI) mSearchBuffers[tI].mInvalidCount = 0;
+
+    parallelTools.run(blockCount, [this, simplexCount, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+    {
+        unsigned int simplexEnd = std::min( (pTaskIndex + 1) * blockSize, simplexCount );
+
+        for(unsigned int sI=pTaskIndex * blockSize; sI<simplexEnd; ++sI)
+        {
+            const Simplex& simplex = mSimplices[sI];
+            if(simplex.mAlive == false) continue;
+
+            for(unsigned int vI=0; vI<4; ++vI)
+            {
+                int neighborIndex = simplex.mNeighbors[vI];
+                if(neighborIndex < static_cast<int>(sI)) continue;
+
+                const Simplex& neighbor = mSimplices[neighborIndex];
+                for(unsigned int nI=0; nI<4; ++nI)
+                {
+                    if(neighbor.mNeighbors[nI] != static_cast<int>(sI)) continue;
+                    if( inCircumsphere(sI, point(neighbor.mVertices[nI]), sFlipTolerance) == true ) mSearchBuffers[pThreadIndex].mInvalidCount++;
+                }
+            }
+        }
+    });
+
+    unsigned int invalidCount = 0;
+    for(unsigned int tI=0; tI<threadCount; ++tI) invalidCount += mSearchBuffers[tI].mInvalidCount;
+
+    return invalidCount == 0;
+}
+
+void
+DelaunayAlg::updateAdjacency()
+{
+    SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+    unsigned int dim = mMinPos.rows();
+    int vertexCount = mObjects.size();
+    unsigned int simplexCount = mSimplices.size();
+    const unsigned int blockSize = 256;
+    unsigned int blockCount = ( vertexCount + blockSize - 1 ) / blockSize;
+
+    // edges of all simplices, counted and distributed per vertex, super simplex vertices are omitted
+    mAdjacencyOffsets.assign(vertexCount + 1, 0);
+
+    for(unsigned int sI=0; sI<simplexCount; ++sI)
+    {
+        const Simplex& simplex = mSimplices[sI];
+        if(simplex.mAlive == false) continue;
+
+        for(unsigned int vI=0; vI<=dim; ++vI)
+        {
+            if(simplex.mVertices[vI] >= vertexCount) continue;
+            for(unsigned int nI=0; nI<=dim; ++nI) if(nI != vI && simplex.mVertices[nI] < vertexCount) mAdjacencyOffsets[ simplex.mVertices[vI] + 1 ]++;
+        }
+    }
+
+    for(int vI=0; vI<vertexCount; ++vI) mAdjacencyOffsets[vI + 1] += mAdjacencyOffsets[vI];
+
+    std::vector<unsigned int> fillOffsets(mAdjacencyOffsets.begin(), mAdjacencyOffsets.end() - 1);
+    mAdjacency.resize( mAdjacencyOffsets[vertexCount] );
+
+    for(unsigned int sI=0; sI<simplexCount; ++sI)
+    {
+        const Simplex& simplex = mSimplices[sI];
+        if(simplex.mAlive == false) continue;
+
+        for(unsigned int vI=0; vI<=dim; ++vI)
+        {
+            if(simplex.mVertices[vI] >= vertexCount) continue;
+            for(unsigned int nI=0; nI<=dim; ++nI) if(nI != vI && simplex.mVertices[nI] < vertexCount) mAdjacency[ fillOffsets[ simplex.mVertices[vI] ]++ ] = simplex.mVertices[nI];
+        }
+    }
+
+    // each edge is shared by several simplices
+    std::vector<unsigned int> uniqueCounts(vertexCount);
+
+    parallelTools.run(blockCount, [this, vertexCount, blockSize, &uniqueCounts](unsigned int pTaskIndex, unsigned int)
+    {
+        int vertexEnd = std::min( static_cast<int>( (pTaskIndex + 1) * blockSize ), vertexCount );
+
+        for(int vI=pTaskIndex * blockSize; vI<vertexEnd; ++vI)
+        {
+            std::vector<int>::iterator begin = mAdjacency.begin() + mAdjacencyOffsets[vI];
+            std::vector<int>::iterator end = mAdjacency.begin() + mAdjacencyOffsets[vI + 1];
+
+            std::sort(begin, end);
+            uniqueCounts[vI] = std::unique(begin, end) - begin;
+        }
+    });
+
+    unsigned int writeOffset = 0;
+    for(int vI=0; vI<vertexCount; ++vI)
+    {
+        unsigned int readOffset = mAdjacencyOffsets[vI];
+        mAdjacencyOffsets[vI] = writeOffset;
+        for(unsigned int nI=0; nI<uniqueCounts[vI]; ++nI) mAdjacency[writeOffset++] = mAdjacency[readOffset + nI];
+    }
+
+    mAdjacencyOffsets[vertexCount] = writeOffset;
+    mAdjacency.resize(writeOffset);
+}
+
+void
+DelaunayAlg::searchNaturalNeighbors( SpaceProxyObject* pObject, SearchBuffer& pBuffer ) const
+{
+    unsigned int dim = mMinPos.rows();
+    int vertexCount = mObjects.size();
+    double position[3];
+
+    for(unsigned int d=0; d<dim; ++d) position[d] = pObject->position()[d];
+
+    pBuffer.mVertices.clear();
+
+    int startSimplex = locate(position, mHintSimplex);
+
+    // the natural neighbors are the vertices of all simplices whose circumsphere contains the position
+    if( inCircumsphere(startSimplex, position) == true ) collectCavity(position, startSimplex, pBuffer);
+    else
+    {
+        pBuffer.mCavity.clear();
+        pBuffer.mCavity.push_back(startSimplex);
+    }
+
+    unsigned int cavitySize = pBuffer.mCavity.size();
+    for(unsigned int cI=0; cI<cavitySize; ++cI)
+    {
+        const Simplex& simplex = mSimplices[ pBuffer.mCavity[cI] ];
+
+        for(unsigned int vI=0; vI<=dim; ++vI)
+        {
+            int vertex = simplex.mVertices[vI];
+            if(vertex < vertexCount && mObjects[vertex] != pObject) pBuffer.mVertices.push_back(vertex);
+        }
+    }
+
+    std::sort(pBuffer.mVertices.begin(), pBuffer.mVertices.end());
+    pBuffer.mVertices.erase( std::unique(pBuffer.mVertices.begin(), pBuffer.mVertices.end()), pBuffer.mVertices.end() );
+}
+
+void
+DelaunayAlg::addNeighbors( SpaceProxyObject* pObject, const int* pVertices, unsigned int pVertexCount, SearchBuffer& pBuffer ) throw (Exception)
+{
+    const Eigen::VectorXf& position = pObject->position();
+    float neighborRadius = pObject->neighborRadius();
+    int maxNeighborCount = pObject->maxNeighborCount();
+
+    std::vector< std::pair<float, unsigned int> >& neighbors = pBuffer.mNeighbors;
+    neighbors.clear();
+
+    for(unsigned int vI=0; vI<pVertexCount; ++vI)
+    {
+        float distance = ( mObjects[ pVertices[vI] ]->position() - position ).norm();
+        if(neighborRadius < 0.0 || distance <= neighborRadius) neighbors.push_back( std::make_pair(distance, pVertices[vI]) );
+    }
+
+    if(maxNeighborCount >= 0 && neighbors.size() > static_cast<unsigned int>(maxNeighborCount))
+    {
+        std::partial_sort(neighbors.begin(), neighbors.begin() + maxNeighborCount, neighbors.end());
+        neighbors.resize(maxNeighborCount);
+    }
+    else
+    {
+        std::sort(neighbors.begin(), neighbors.end());
+    }
+
+    unsigned int neighborCount = neighbors.size();
+    for(unsigned int nI=0; nI<neighborCount; ++nI)
+    {
+        SpaceProxyObject* neighborObject = mObjects[ neighbors[nI].second ];
+        pBuffer.mDirection = neighborObject->position() - position;
+
+        pObject->addNeighbor(neighborObject->spaceObject(), neighbors[nI].first, pBuffer.mDirection);
+    }
+}
+
+void
+DelaunayAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        unsigned int dim = mMinPos.rows();
+        unsigned int vertexCount = pObjects.size();
+        unsigned int threadCount = SpaceParallelTools::get().threadCount();
+
+        // the triangulation can only be repaired if the visible objects haven't changed
+        bool repairable = mRebuildRequested == false && mSimplices.size() > 0 && mObjects == pObjects;
+        for(unsigned int vI=0; vI<vertexCount && repairable == true; ++vI) repairable = mInserted[vI];
+
+        mObjects = pObjects;
+        mPoints.resize( ( vertexCount + dim + 1 ) * dim );
+
+        float extent = 0.0;
+        for(unsigned int vI=0; vI<vertexCount; ++vI) extent = std::max( extent, pObjects[vI]->position().cwiseAbs().maxCoeff() );
+        double perturbation = sPerturbation * std::max( extent, 1.0e-6f );
+
+        for(unsigned int vI=0; vI<vertexCount; ++vI)
+        {
+            SpaceProxyObject* object = pObjects[vI];
+            object->setIndex(vI);
+
+            uint64_t random = reinterpret_cast<uint64_t>( object->spaceObject() ) * 0x9E3779B97F4A7C15ull;
+            const Eigen::VectorXf& position = object->position();
+            double* vertexPoint = mPoints.data() + vI * dim;
+
+            for(unsigned int d=0; d<dim; ++d)
+            {
+                random ^= random << 13;
+                random ^= random >> 7;
+                random ^= random << 17;
+
+                vertexPoint[d] = position[d] + perturbation * ( static_cast<double>(random >> 11) / static_cast<double>(1ull << 53) * 2.0 - 1.0 );
+            }
+        }
+
+        if(mSearchBuffers.size() < threadCount) mSearchBuffers.resize(threadCount);
+        for(unsigned int tI=0; tI<threadCount; ++tI)
+        {
+            SearchBuffer& buffer = mSearchBuffers[tI];
+            if(buffer.mSimplexStamps.size() == 0) buffer.mStamp = 0;
+            if(buffer.mDirection.rows() != dim) buffer.mDirection.resize(dim);
+        }
+
+        mFlipCount = 0;
+
+        if(repairable == true) repairable = dim == 2 ? movePoints() : checkOrientations() && checkFacets();
+        if(repairable == false) rebuildTriangulation();
+
+        mPreviousPoints.assign( mPoints.begin(), mPoints.begin() + vertexCount * dim );
+
+        mRebuildRequested = false;
+
+        updateAdjacency();
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update delaunay triangulation", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+void
+DelaunayAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+        unsigned int objectCount = pObjects.size();
+        unsigned int threadCount = parallelTools.threadCount();
+        const unsigned int blockSize = 16;
+        unsigned int blockCount = ( objectCount + blockSize - 1 ) / blockSize;
+
+        if(mSimplices.size() == 0) return;
+
+        for(unsigned int tI=0; tI<threadCount; ++tI) if(mSearchBuffers[tI].mSimplexStamps.size() < mSimplices.size()) mSearchBuffers[tI].mSimplexStamps.resize(mSimplices.size(), 0);
+
+        parallelTools.run(blockCount, [this, &pObjects, objectCount, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            SearchBuffer& buffer = mSearchBuffers[pThreadIndex];
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+
+            for(unsigned int oI=pTaskIndex * blockSize; oI<objectEnd; ++oI)
+            {
+                SpaceProxyObject* object = pObjects[oI];
+                unsigned int objectIndex = object->index();
+                bool inserted = objectIndex < mObjects.size() && mObjects[objectIndex] == object && mInserted[objectIndex] == true;
+
+                object->removeNeighbors();
+
+                if(object->maxNeighborCount() == 0) continue;
+
+                if(inserted == true)
+                {
+                    addNeighbors(object, mAdjacency.data() + mAdjacencyOffsets[objectIndex], mAdjacencyOffsets[objectIndex + 1] - mAdjacencyOffsets[objectIndex], buffer);
+                }
+                else
+                {
+                    searchNaturalNeighbors(object, buffer);
+                    addNeighbors(object, buffer.mVertices.data(), buffer.mVertices.size(), buffer);
+                }
+            }
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update natural neighbors", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+bool
+DelaunayAlg::symmetricNeighborsSupported() const
+{
+    return false;
+}
+
+DelaunayAlg::operator std::string() const
+{
+    return info();
+}
+
+std::string
+DelaunayAlg::info() const
+{
+    std::stringstream stream;
+
+    stream << "DelaunayAlg\n";
+    stream << "vertexCount: " << mObjects.size() << "\n";
+    stream << "simplexCount: " << simplexCount() << "\n";
+    stream << "rebuildCount: " << mRebuildCount << "\n";
+    stream << "flipCount: " << mFlipCount << "\n";
+    stream << SpaceAlg::info();
+
+    return stream.str();
+}
@@ -0,0 +1,305 @@
+/** \file dab_space_alg_delaunay.h
+ */
+
+#ifndef _dab_space_alg_delaunay_h_
+#define _dab_space_alg_delaunay_h_
+
+#include <Eigen/Dense>
+#include "dab_space_alg.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+/**
+ \brief natural neighbors based on a delaunay triangulation in two or three dimensions
+
+ the neighbors of an object are the objects it shares a delaunay edge with (natural neighbors), which suits topological rather than metric interactions.\n
+ the triangulation of the visible objects is kept across structure updates. in two dimensions, moving objects are handled by edge flips (Lawson flips), objects whose motion would invert triangles are moved in smaller steps with flips in between.\n
+ in three dimensions, the triangulation is only kept as long as it remains a valid delaunay tetrahedralization, there are no flips that repair it.\n
+ the triangulation is rebuilt by incremental insertion (Bowyer-Watson) if it can't be repaired, if the visible objects change, or if an object leaves the enclosing super simplex. in two dimensions, smoothly moving objects therefore cost O(N) per structure update. in three dimensions, moving objects invalidate the tetrahedralization almost every update, so that each update pays for a complete rebuild (O(N log N) for evenly distributed objects).\n
+ invisible objects receive the natural neighbors they would have if they were inserted.\n
+ natural neighbors can be limited by neighbor radius and maximum neighbor count (closest natural neighbors first).\n
+ positions are triangulated with a tiny deterministic perturbation so that coincident objects don't produce degenerate simplices, neighbor distances are calculated from unperturbed positions.\n
+ orientation and in-sphere tests evaluate determinants in double precision with a forward error bound (Shewchuk's filters), results within the bound are treated as degenerate rather than trusted.
+ */
+class DelaunayAlg : public SpaceAlg
+{
+public:
+    /**
+     \brief create delaunay alg
+     \param pDim dimension (2 or 3)
+     \exception Exception dimension is neither 2 nor 3
+     */
+    DelaunayAlg(unsigned int pDim) throw (Exception);
+
+    /**
+     \brief create delaunay alg
+     \param pMinPos minimum position
+     \param pMaxPos maximum position
+     \exception Exception dimension mismatch, dimension is neither 2 nor 3
+     */
+    DelaunayAlg(const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos) throw (Exception);
+
+    ~DelaunayAlg();
+
+    /**
+     \brief return number of rebuilds of the triangulation
+     \return rebuild count
+     */
+    unsigned int rebuildCount() const;
+
+    /**
+     \brief return number of edge flips during last structure update
+     \return flip count
+     */
+    unsigned int flipCount() const;
+
+    /**
+     \brief return number of triangles or tetrahedra, including those connected to the super simplex
+     \return simplex count
+     */
+    unsigned int simplexCount() const;
+
+    /**
+     \brief rebuild triangulation during next structure update
+     */
+    void rebuild();
+
+    void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+    void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+
+    /**
+     \brief symmetric neighbor calculation is not supported
+     \return false
+
+     neighbors are taken from the triangulation rather than evaluated for pairs of objects
+     */
+    bool symmetricNeighborsSupported() const;
+
+    /**
+     \brief obtain textual delaunay alg information
+     \return String containing textual delaunay alg information
+     */
+    operator std::string() const;
+
+    /**
+     \brief obtain textual delaunay alg information
+     \return String containing textual delaunay alg information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual delaunay alg information
+     \param pOstream output stream
+     \param pAlg delaunay alg
+     */
+    friend std::ostream& operator<< (std::ostream & pOstream, const DelaunayAlg& pAlg)
+    {
+        pOstream << std::string(pAlg);
+
+        return pOstream;
+    }
+
+protected:
+    /**
+     \brief triangle or tetrahedron
+     */
+    class Simplex
+    {
+    public:
+        int mVertices[4]; ///\brief vertex indices, positively oriented
+        int mNeighbors[4]; ///\brief index of simplex opposite of each vertex (-1: none)
+        bool mAlive; ///\brief simplex is part of the triangulation
+    };
+
+    /**
+     \brief per thread search buffers
+     */
+    class SearchBuffer
+    {
+    public:
+        std::vector<unsigned int> mSimplexStamps; ///\brief stamp of last visit for each simplex
+        unsigned int mStamp; ///\brief current visit stamp
+        std::vector<int> mCavity; ///\brief simplices whose circumsphere contains the search position
+        std::vector<int> mVertices; ///\brief natural neighbor vertices
+        std::vector<int> mFlips; ///\brief edges that violate the delaunay property (triangle and vertex index pairs)
+        std::vector< std::pair<float, unsigned int> > mNeighbors; ///\brief natural neighbors (distance and visible object index)
+        Eigen::VectorXf mDirection; ///\brief neighbor direction
+        unsigned int mInvalidCount; ///\brief number of invalid simplices or facets found during validation
+    };
+
+    DelaunayAlg();
+
+    /**
+     \brief return position of vertex used for triangulation
+     \param pVertex vertex index
+     \return position (dim values)
+     */
+    inline const double* point( int pVertex ) const;
+
+    /**
+     \brief calculate orientation of simplex whose vertex pReplaceIndex is replaced by a position
+     \param pSimplex simplex
+     \param pReplaceIndex index of replaced vertex (-1: none)
+     \param pPoint replacing position
+     \return signed volume (positive: positively oriented, zero: orientation can't be decided within rounding error)
+     */
+    double orientation( const Simplex& pSimplex, int pReplaceIndex, const double* pPoint ) const;
+
+    /**
+     \brief test if position lies inside circumsphere of simplex
+     \param pSimplexIndex simplex index
+     \param pPoint position
+     \param pTolerance tolerance relative to the magnitude of the in-sphere determinant, positive values exclude positions close to the circumsphere
+     \return true if inside
+
+     without tolerance, positions that can't be distinguished from the circumsphere within rounding error count as inside
+     */
+    bool inCircumsphere( int pSimplexIndex, const double* pPoint, double pTolerance = 0.0 ) const;
+
+    /**
+     \brief find simplex containing position by walking through the triangulation
+     \param pPoint position
+     \param pStartSimplex simplex from which the walk starts
+     \return simplex index
+     */
+    int locate( const double* pPoint, int pStartSimplex ) const;
+
+    /**
+     \brief create simplex, reusing a deleted one if possible
+     \return simplex index
+     */
+    int createSimplex();
+
+    /**
+     \brief delete simplex
+     \param pSimplexIndex simplex index
+     */
+    void deleteSimplex( int pSimplexIndex );
+
+    /**
+     \brief rebuild triangulation of current points
+     */
+    void rebuildTriangulation();
+
+    /**
+     \brief insert vertex into triangulation (Bowyer-Watson)
+     \param pVertex vertex index
+     \return true if vertex has been inserted
+     */
+    bool insertVertex( int pVertex );
+
+    /**
+     \brief collect simplices whose circumsphere contains a position
+     \param pPoint position
+     \param pStartSimplex simplex containing position
+     \param pBuffer search buffer, receives cavity
+     */
+    void collectCavity( const double* pPoint, int pStartSimplex, SearchBuffer& pBuffer ) const;
+
+    /**
+     \brief check orientation of all simplices
+     \return true if all simplices are positively oriented
+     */
+    bool checkOrientations();
+
+    /**
+     \brief move points from their previous to their current position while maintaining the triangulation by edge flips (two dimensions only)
+     \return true if triangulation has been maintained
+
+     triangles that invert are repaired by flips if possible, otherwise the points are moved in smaller steps
+     */
+    bool movePoints();
+
+    /**
+     \brief repair inverted triangles by flipping the edge a vertex has crossed (two dimensions only)
+     \return number of repaired triangles
+     */
+    unsigned int repairInversions();
+
+    /**
+     \brief restore delaunay property by edge flips (two dimensions only)
+     \return true if delaunay property has been restored
+     */
+    bool flipEdges();
+
+    /**
+     \brief flip edge shared by two triangles
+     \param pSimplexIndex triangle
+     \param pVertexIndex index of vertex opposite of shared edge
+     */
+    void flipEdge( int pSimplexIndex, int pVertexIndex );
+
+    /**
+     \brief check delaunay property of all facets (three dimensions only)
+     \return true if triangulation is delaunay
+     */
+    bool checkFacets();
+
+    /**
+     \brief collect natural neighbors of each vertex from triangulation
+     */
+    void updateAdjacency();
+
+    /**
+     \brief search natural neighbors of position that isn't part of triangulation
+     \param pObject proxy object
+     \param pBuffer search buffer, receives vertices
+     */
+    void searchNaturalNeighbors( SpaceProxyObject* pObject, SearchBuffer& pBuffer ) const;
+
+    /**
+     \brief add natural neighbors to object
+     \param pObject proxy object
+     \param pVertices natural neighbor vertices
+     \param pVertexCount number of natural neighbor vertices
+     \param pBuffer search buffer
+     */
+    void addNeighbors( SpaceProxyObject* pObject, const int* pVertices, unsigned int pVertexCount, SearchBuffer& pBuffer ) throw (Exception);
+
+    static const double sSuperSimplexScale; ///\brief size of super simplex relative to the extent of the points
+    static const double sPerturbation; ///\brief perturbation of points relative to the extent of the points
+    static const double sFlipTolerance; ///\brief relative tolerance of circumsphere test for edge flips
+    static const double sOrientationErrorBound[2]; ///\brief relative rounding error bound of orientation determinant (two and three dimensions)
+    static const double sInSphereErrorBound[2]; ///\brief relative rounding error bound of in-sphere determinant (two and three dimensions)
+    static const unsigned int sMaxMoveStepCount; ///\brief maximum number of steps for moving points before the triangulation is rebuilt
+
+    bool mRebuildRequested; ///\brief triangulation is rebuilt during next structure update
+    unsigned int mRebuildCount; ///\brief number of rebuilds
+    unsigned int mFlipCount; ///\brief number of edge flips during last structure update
+
+    std::vector< SpaceProxyObject* > mObjects; ///\brief visible objects, vertex i corresponds to visible object i
+    std::vector<double> mPoints; ///\brief perturbed positions of visible objects followed by super simplex vertices (dim values per vertex)
+    std::vector<bool> mInserted; ///\brief vertex is part of triangulation
+    std::vector<double> mPreviousPoints; ///\brief perturbed positions of visible objects during last structure update
+    std::vector<double> mTargetPoints; ///\brief perturbed positions of visible objects while points are moved
+
+    std::vector<Simplex> mSimplices; ///\brief simplices
+    std::vector<Simplex> mRepairSimplices; ///\brief simplices before inverted triangles are repaired
+    std::vector<int> mFreeSimplices; ///\brief indices of deleted simplices
+    int mHintSimplex; ///\brief simplex from which point location starts
+
+    std::vector<int> mBoundary; ///\brief cavity boundary during insertion (simplex and vertex index pairs)
+    std::vector< std::pair<std::pair<int, int>, std::pair<int, int> > > mRidges; ///\brief ridges of new simplices during insertion (sorted vertex pair, simplex and vertex index)
+    std::vector<int> mFlipStack; ///\brief triangles and vertex indices of edges to be checked during edge flips
+
+    std::vector<unsigned int> mAdjacencyOffsets; ///\brief offset of natural neighbors of each vertex
+    std::vector<int> mAdjacency; ///\brief natural neighbors of all vertices
+
+    std::vector<SearchBuffer> mSearchBuffers; ///\brief search buffers for each thread
+};
+
+inline const double*
+DelaunayAlg::point( int pVertex ) const
+{
+    return mPoints.data() + pVertex * mMinPos.rows();
+}
+
+};
+
+};
+
+#endif
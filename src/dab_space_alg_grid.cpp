@@ -4,13 +4,18 @@
 #include "dab_space_alg_grid.h"
 #include "dab_space_neighbor_relation.h"
 #include "dab_space_proxy_object.h"
+#include "dab_space_parallel.h"
+#include <algorithm>
 
 using namespace dab;
 using namespace dab::space;
 
+const unsigned int GridAlg::sMaxStackRegionDim;
+
 GridAlg::GridAlg()
 : SpaceAlg(1)
 , mGrid(nullptr)
+, mSampleObjectCount(0)
 {
 	mGrid = new SpaceGrid( 1, dab::Array<unsigned int>( {1} ), Eigen::VectorXf(1), Eigen::VectorXf(1) );
     
@@ -31,6 +36,7 @@ GridAlg::GridAlg(unsigned int pValueDim, const dab::Array<unsigned int>& pSubdiv
 , mGrid(nullptr)
 , mNeighborMode(pNeighborMode)
 , mUpdateMode(pUpdateMode)
+, mSampleObjectCount(0)
 {
     try
     {
@@ -48,6 +54,7 @@ GridAlg::GridAlg(SpaceGrid* pSpaceGrid, GridNeighborMode pNeighborMode, GridUpda
 : SpaceAlg(pSpaceGrid->minPos(), pSpaceGrid->maxPos())
 , mNeighborMode(pNeighborMode)
 , mUpdateMode(pUpdateMode)
+, mSampleObjectCount(0)
 {
 	mGrid = pSpaceGrid;
 	mGridOwner = false;
@@ -56,6 +63,9 @@ GridAlg::GridAlg(SpaceGrid* pSpaceGrid, GridNeighborMode pNeighborMode, GridUpda
 GridAlg::~GridAlg()
 {
 	if(mGridOwner == true) delete mGrid;
+    
+    unsigned int sampleObjectCount = mSampleObjects.size();
+    for(unsigned int i=0; i<sampleObjectCount; ++i) delete mSampleObjects[i];
 }
 
 bool
@@ -225,11 +235,29 @@ GridAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Ex
 		unsigned int objectCount = pObjects.size();
 		for(unsigned int i=0; i<objectCount; ++i) if(pObjects[i]->canHaveNeighbors() == true) pObjects[i]->removeNeighbors();
         
-		// remove temporarily created space objects
-		unsigned int tmpSpaceObjectCount = mTmpSpaceObjects.size();
-		for(unsigned int i=0; i<tmpSpaceObjectCount; ++i) delete mTmpSpaceObjects[i];
-		mTmpSpaceObjects.clear();
+		// release grid sample objects, they are reused for the new neighbors
+		mSampleObjectCount = 0;
+        
+		updateGridTransform();
+		
+		mSampledObjects.clear();
+		mSamplePositions.clear();
+		mSampleRadii.clear();
         
+		SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+		unsigned int threadCount = parallelTools.threadCount();
+		unsigned int valueDim = mGrid->valueDim();
+		
+		if(mSampleBuffers.size() < threadCount) mSampleBuffers.resize(threadCount);
+		
+		// buffers keep their size across updates, so that neighbor calculation doesn't allocate
+		SampleBuffer& buffer = mSampleBuffers[0];
+		buffer.mStartIndex.resize(dim);
+		buffer.mEndIndex.resize(dim);
+		buffer.mValue.resize(valueDim);
+		buffer.mDirection.resize(dim);
+		buffer.mPosition.resize(dim);
+		
 		// create new neighbors
 		SpaceProxyObject* proxyObject;
 		SpaceObject* spaceObject;
@@ -237,13 +265,14 @@ GridAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Ex
 		unsigned int gridPosCount = static_cast<unsigned int>( pow( 2.0f, static_cast<float>( dim ) ) );
 		
 		const math::VectorField<float>& vectorField = mGrid->vectorField();
-		const dab::Array<unsigned int>& indexOffset = vectorField.indexOffset();
         const std::vector< Eigen::Matrix<float, Eigen::Dynamic, 1> >& fieldVectors = vectorField.vectors();
-		Eigen::VectorXf value(mGrid->valueDim());
-		Eigen::VectorXf direction(mGrid->gridDim());
+        const unsigned int* indexOffset = mGridTransform.mIndexOffset.data();
+		Eigen::VectorXf& value = buffer.mValue;
+		Eigen::VectorXf& direction = buffer.mDirection;
 		float distance;
 		int maxNeighborCount;
 		float neighborRadius;
+		Eigen::VectorXf& samplePosition = buffer.mPosition;
 		
 		/*
          std::cout << "subdivision count " <<  subdivisionCount << "\n";
@@ -259,13 +288,13 @@ GridAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Ex
 			
 			const Eigen::VectorXf& objectPosition = proxyObject->position();
 			
-			maxNeighborCount = proxyObject->maxNeighborCount();
-			neighborRadius = proxyObject->neighborRadius();
-			
 			//std::cout << "pos " << objectPosition << " minPos " << mMinPos << " maxPos " << mMaxPos << "\n";
             
 			if(proxyObject->canHaveNeighbors() == true)
 			{
+				maxNeighborCount = proxyObject->maxNeighborCount();
+				neighborRadius = proxyObject->neighborRadius();
+				
 				// skip objects outside of this space
 				bool skipObject = false;
 				for(unsigned int j=0; j<dim; ++j)
@@ -278,192 +307,12 @@ GridAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Ex
 				}
 				if(skipObject == true) continue;
 				
-				if(mNeighborMode ==CellLocationMode)
-				{
-                    //					std::cout << "cell loc mode begin\n";
-                    
-					// neighbor relation contains value of cell at position of space object
-					unsigned int gridIndex;
-					Eigen::VectorXf& objectPosition = proxyObject->position();
-					mGrid->position2index( objectPosition, gridIndex );
-					value = mGrid->value( gridIndex );
-					direction.setConstant(0.0);
-					distance = 0.0;
-					
-                    //					std::cout << "pos " << objectPosition << " index " << gridIndex << " value " << value << "\n";
-					
-					spaceObject = new SpaceObject( objectPosition );
-					mTmpSpaceObjects.push_back(spaceObject);
-					proxyObject->addNeighbor(spaceObject, value, direction, distance);
-					
-                    //					std::cout << "cell loc mode end\n";
-				}
-				else if(mNeighborMode == AvgLocationMode)
+				if(mNeighborMode == CellLocationMode || mNeighborMode == AvgLocationMode || mNeighborMode == AvgRegionMode || mNeighborMode == CentroidSearchMode)
 				{
-					// linear interpolation of grid values at grid nodes for space object position
-					// 1 neighbor relation: position at space object position, value is interpolated grid value
-					// example: grid values represent motion vectors from camera
-					// determine motion vector at position of space object (e.g. agent position parameter) -> results in force acting on agent
-                    
-					//std::cout << "AvgLocationMode\n";
-					
-					//spaceObject = new SpaceObject(mGrid->value(proxyObject->position()));
-					spaceObject = new SpaceObject( proxyObject->position() );
-					mGrid->value( proxyObject->position(), value );
-					
-					direction.setConstant(0.0);
-					distance = 0.0;
-					
-					mTmpSpaceObjects.push_back(spaceObject);
-					proxyObject->addNeighbor(spaceObject, value, direction, distance);
-				}
-				else if(mNeighborMode == AvgRegionMode)
-				{
-					// create single neighbor relation whose position is the weighted (by value at grid nodes) position of each grid node within the space object's search radius and whose value is the average of all grid node values within search radius.
-					
-					//std::cout << "AvgRegionMode\n";
-                    
-					std::vector< Eigen::Matrix<float, Eigen::Dynamic, 1> >& fieldVectors = mGrid->vectorField().vectors();
-                    
-					float neighborRadius = proxyObject->neighborRadius();
-                    Eigen::VectorXf neighborRadiusVec(dim);
-                    neighborRadiusVec.setConstant(neighborRadius);
-                    
-					dab::Array<unsigned int> startIndexPos = mGrid->position2index( objectPosition - neighborRadiusVec );
-					dab::Array<unsigned int> endIndexPos = mGrid->position2index( objectPosition + neighborRadiusVec );
-                    Eigen::VectorXf indexPos( mGrid->gridDim() );
-					unsigned int index;
-					unsigned int valueCount = 0;
-					float totalSumValue = 0;
-					float sumValue;
-                    dab::Array<float> totalPosValue( mGrid->gridDim() );
-					unsigned int gridDim = mGrid->gridDim();
-					const dab::Array<unsigned int>& gridElementCount = mGrid->subdivisionCount();
-					
-                    //					std::cout << "objectPos " << objectPosition << " neighborRadius " << neighborRadius << "\n";
-                    //					std::cout << "objectIndexPox " << mGrid->position2index( objectPosition ) << "\n";
-                    //					std::cout << "startIndexPos " << startIndexPos << " endIndexPos " << endIndexPos << "\n";
-                    //					std::cout << "fieldVectorCount " << mGrid->vectorField().vectorCount() << "\n";
-					
-					unsigned int yIndex, zIndex;
-					
-					if(gridElementCount.size() == 3)
-					{
-						for(unsigned int z=startIndexPos[2]; z<=endIndexPos[2]; ++z)
-						{
-							indexPos[2] = static_cast<float>( z );
-							zIndex = z * gridElementCount[0] * gridElementCount[1];
-                            
-							for(unsigned int y=startIndexPos[1]; y<=endIndexPos[1]; ++y)
-							{
-								indexPos[1] = static_cast<float>( y );
-								yIndex = y * gridElementCount[0];
-                                
-								for(unsigned int x=startIndexPos[0]; x<=endIndexPos[0]; ++x, ++valueCount)
-								{
-									indexPos[0] = static_cast<float>( x );
-									
-									index = x + yIndex + zIndex;
-									value += fieldVectors[index];
-									sumValue = fieldVectors[index].sum();
-									totalSumValue += sumValue;
-									
-									for(unsigned int d=0; d<gridDim; ++d)
-									{
-										totalPosValue[d] += indexPos[d] * sumValue;
-									}
-									
-									//totalPosValue += indexPos * value;
-									//std::cout << "x " << x << " y " << y << " z " << z << " indexPos " << indexPos << " index " << index << " value " << value << " totalValue " << totalValue << " totalPosValue " << totalPosValue << "\n";
-								}
-							}
-						}
-						
-						//std::cout << "totalValue " << totalValue << "\n";
-						
-						if(totalSumValue > 0.0)
-						{
-                            for(unsigned int d=0; d<gridDim; ++d) totalPosValue[d] /= totalSumValue;
-							value /= static_cast<float>( valueCount );
-							
-							//std::cout << "totalPosValue " << totalPosValue << "\n";
-							
-							Eigen::VectorXf resultPosition = mGrid->index2position( totalPosValue );
-							
-							//std::cout << "resultPosition " << resultPosition << "\n";
-							
-							spaceObject = new SpaceObject( resultPosition );
-							direction = resultPosition - objectPosition;
-							distance = direction.norm();
-							
-							mTmpSpaceObjects.push_back(spaceObject);
-							proxyObject->addNeighbor(spaceObject, value, direction, distance);
-							
-							//std::cout << "added neighbor to " << i << " : nCount " << proxyObject->neighborGroup()->neighborCount() << "\n";
-						}
-					}
-					else if(gridElementCount.size() == 2)
-					{
-						//std::cout << "agentPos " << objectPosition << " index " << mGrid->position2index(objectPosition)  << " startIndex " << startIndexPos << " endIndex " << endIndexPos << "\n";
-						
-						for(unsigned int y=startIndexPos[1]; y<endIndexPos[1]; ++y)
-						{
-							indexPos[1] = static_cast<float>( y );
-							yIndex = y * gridElementCount[0];
-							
-							for(unsigned int x=startIndexPos[0]; x<endIndexPos[0]; ++x, ++valueCount)
-							{
-								indexPos[0] = static_cast<float>( x );
-								
-								index = x + yIndex;
-								//value += *( fieldVectors[index] );
-								sumValue = fieldVectors[index].sum();
-								totalSumValue += sumValue;
-								
-								for(unsigned int d=0; d<gridDim; ++d)
-								{
-									totalPosValue[d] += indexPos[d] * sumValue;
-								}
-								
-								//std::cout << "indexPos " << indexPos << " index " << index << " checkIndex " << mGrid->vectorField().calcIndex( indexPos ) << " checkIndexPos " << mGrid->vectorField().calcIndex( index ) << "\n";
-								//std::cout << "pos " << mGrid->index2position( indexPos ) << "\n";
-								//std::cout << "pos2 " << mGrid->index2position( math::Vector2<unsigned int>( static_cast<unsigned int>( indexPos.c[0] ), static_cast<unsigned int>( indexPos.c[1] ) ) ) << "\n";
-								
-								//totalPosValue += indexPos * value;
-								//std::cout << "x " << x << " y " << y << " indexPos " << indexPos << " index " << index << " value " << *( fieldVectors[index] ) << " totalSumValue " << totalSumValue << " totalPosValue " << totalPosValue << "\n";
-							}
-						}
-						
-						//std::cout << "totalValue " << totalValue << "\n";
-						
-						if(totalSumValue > 0.0)
-						{
-							for(unsigned int d=0; d<gridDim; ++d) totalPosValue[d] /= totalSumValue;
-							value /= static_cast<float>( valueCount );
-							
-							//std::cout << "totalPosValue " << totalPosValue << "\n";
-							
-							Eigen::VectorXf resultPosition = mGrid->index2position( totalPosValue );
-							
-							//std::cout << "resultPosition " << resultPosition << "\n";
-							
-							spaceObject = new SpaceObject( resultPosition );
-							direction = resultPosition - objectPosition;
-							distance = direction.norm();
-							
-							
-							mTmpSpaceObjects.push_back(spaceObject);
-							proxyObject->addNeighbor(spaceObject, value, direction, distance);
-							
-							//std::cout << "added neighbor to " << i << " : nCount " << proxyObject->neighborGroup()->neighborCount() << "\n";
-						}
-					}
-					else
-					{
-                        throw Exception("SPACE ERROR: grid dimensions other than 2D or 3D not yet supported", __FILE__, __FUNCTION__, __LINE__);
-						// TODO: create a more generic algorithms for dealing with lower or higher dimensional grids
-					}
-                    
+					// the grid is sampled for all these objects at once after all objects have been collected
+					mSampledObjects.push_back(proxyObject);
+					for(unsigned int d=0; d<dim; ++d) mSamplePositions.push_back(objectPosition[d]);
+					mSampleRadii.push_back(neighborRadius);
 				}
 				else if(mNeighborMode == GridLocationMode)
 				{
@@ -473,54 +322,33 @@ GridAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Ex
 					
 					//std::cout << "GridLocationMode\n";
                     
-					Eigen::VectorXf gridWorldPosition(dim);
-                    dab::Array<unsigned int> gridGridPosition(dim);
-                    
-					Eigen::VectorXf objectGridPosition(dim);
-                    
-					Eigen::VectorXf world2gridPosScale(dim);
-					for(unsigned int i=0; i<dim; ++i) world2gridPosScale[i] = static_cast<float>(subdivisionCount[i]) / (mMaxPos[i] - mMinPos[i]);
-                    
-					Eigen::VectorXf grid2worldPosScale(dim);
-					for(unsigned int i=0; i<dim; ++i) grid2worldPosScale[i] = 1.0 / world2gridPosScale[i];
-                    
-					// transform object world position into object grid position
 					const Eigen::VectorXf& objectWorldPosition = objectPosition;
-					objectGridPosition = (objectWorldPosition - mMinPos) * world2gridPosScale;
-					
-					//std::cout << i << " objectWorldPos " << objectWorldPosition << " objectGridPos " << objectGridPosition << "\n";
-                    
-					unsigned int index;
 					unsigned int maskBits;
                     
 					// calculate neighboring grid positions
 					for(unsigned int j=0; j<gridPosCount; ++j)
 					{
 						// calculate index into vector array
+						unsigned int index = 0;
 						maskBits = 1;
 						
-						for(int z=0; z<dim; ++z)
+						for(unsigned int z=0; z<dim; ++z)
 						{
-							gridGridPosition[z] = j & maskBits ? ceil(objectGridPosition[z]) : floor(objectGridPosition[z]);
-							gridWorldPosition[z] = static_cast<float>( gridGridPosition[z] ) * grid2worldPosScale[z] + mMinPos[z];
+							// transform object world position into object grid position, grid positions beyond the last grid point are clamped
+							float objectGridPosition = ( objectWorldPosition[z] - mGridTransform.mMinPos[z] ) * mGridTransform.mCellScale[z];
+							unsigned int gridGridPosition = std::min( static_cast<unsigned int>( std::max( j & maskBits ? std::ceil(objectGridPosition) : std::floor(objectGridPosition), 0.0f ) ), subdivisionCount[z] - 1 );
+							
+							samplePosition[z] = static_cast<float>( gridGridPosition ) * mGridTransform.mCellSize[z] + mGridTransform.mMinPos[z];
+							index += gridGridPosition * indexOffset[z];
 							
 							maskBits = maskBits << 1;
 						}
 						
-						//std::cout << j << " gridGridPosition " << gridGridPosition << " gridWorldPosition " << gridWorldPosition << "\n";
-                        
-						//spaceObject = new SpaceObject(mGrid->gridValue(gridGridPosition));
-                        
-						spaceObject = new SpaceObject(gridWorldPosition);
-						value = mGrid->gridValue(gridGridPosition);
-						direction = gridWorldPosition - objectWorldPosition;
+						spaceObject = sampleObject(samplePosition);
+						value = fieldVectors[index];
+						direction = samplePosition - objectWorldPosition;
 						distance = direction.norm();
 						
-						mTmpSpaceObjects.push_back(spaceObject);
-						
-						//std::cout << "direction " << direction << " distance " << distance << "\n";
-						
-						//proxyObject->addNeighbor(spaceObject, distance, direction);
 						proxyObject->addNeighbor(spaceObject, value, direction, distance);
 					}
 				}
@@ -530,107 +358,47 @@ GridAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Ex
 					// 1 neighbor relation: position is at the grid node with highest value, direction towards this grid node, value : highest value
 					// example: agents are attracted towards high grayscale pixel values from camera
 					
-					dab::Array<unsigned int> objectGridPos(dim);
-					mGrid->position2index( objectPosition, objectGridPos );
-                    
-					//std::cout << "objectPos " << objectPosition << " objectGridPos " << objectGridPos << "\n";
-					
-                    Eigen::VectorXf cellSize(dim);
-					for(unsigned int i=0; i<dim; ++i) cellSize[i] = (mMaxPos[i] - mMinPos[i]) / static_cast<float>(subdivisionCount[i]);
-					
-					//std::cout << "cellSize " << cellSize << " minPos " << mMinPos << " maxPos " << mMaxPos << " subdivisions " << subdivisionCount << "\n";
-					
-					dab::Array<int> cellSearchRange(dim);
-					for(unsigned int i=0; i<dim; ++i) cellSearchRange[i] = ceil( ( neighborRadius - 0.5 * cellSize[i] ) / cellSize[i] );
-					
-					//std::cout << "cellSearchRange " << cellSearchRange << " neighborRadius " << neighborRadius << "\n";
+                    const Eigen::VectorXf& cellSize = mGridTransform.mCellSize;
+					unsigned int* searchStartPos = buffer.mStartIndex.data();
+					unsigned int* searchEndPos = buffer.mEndIndex.data();
+					int searchPosCount = 1;
 					
-					dab::Array<int> searchStartPos(dim);
-					dab::Array<int> searchEndPos(dim);
 					for(unsigned int i=0; i<dim; ++i)
 					{
-						searchStartPos[i] = objectGridPos[i] - cellSearchRange[i];
-						searchEndPos[i] = objectGridPos[i] + cellSearchRange[i];
+						// grid cell containing the object
+						int objectGridPos = std::min( static_cast<int>( std::max( ( objectPosition[i] - mGridTransform.mMinPos[i] ) * mGridTransform.mCellScale[i], 0.0f ) ), static_cast<int>( subdivisionCount[i] ) - 1 );
+						int cellSearchRange = std::max( static_cast<int>( ceil( ( neighborRadius - 0.5 * cellSize[i] ) / cellSize[i] ) ), 0 );
 						
-						if( searchStartPos[i] < 0 ) searchStartPos[i] = 0;
-						if( searchEndPos[i] >= subdivisionCount[i] ) searchEndPos[i] = subdivisionCount[i] - 1;
+						searchStartPos[i] = std::max( objectGridPos - cellSearchRange, 0 );
+						searchEndPos[i] = std::min( objectGridPos + cellSearchRange, static_cast<int>( subdivisionCount[i] ) - 1 );
+						searchPosCount *= searchEndPos[i] - searchStartPos[i] + 1;
 					}
 					
-					//std::cout << "searchStartPos " << searchStartPos << " searchEndPos " << searchEndPos << "\n";
-					
-					int searchPosCount = 1;
-					for(unsigned int i=0; i<dim; ++i) searchPosCount *= searchEndPos[i] - searchStartPos[i];
-					
-					//std::cout << "searchPosCount " << searchPosCount << "\n";
-					
 					int neighborCount = maxNeighborCount;
-					if( neighborCount > searchPosCount ) neighborCount = searchPosCount;
+					if( neighborCount < 0 || neighborCount > searchPosCount ) neighborCount = searchPosCount;
+					if( neighborCount == 0 ) continue;
 					
-                    std::vector< unsigned int > neighborAbsIndices( neighborCount, 0 );
-					std::vector< float > neighborGridValues( neighborCount, 0.0 );
+                    std::vector< unsigned int >& neighborAbsIndices = buffer.mPeakIndices;
+					std::vector< float >& neighborGridValues = buffer.mPeakValues;
+					neighborAbsIndices.assign( neighborCount, 0 );
+					neighborGridValues.assign( neighborCount, 0.0 );
 					int smallestNeighborIndex = 0;
-					int tmpSmallestNeighborIndex;
-					float tmpSmallestGridValue;
                     
 					// go through all grid points from searchStartPos to searchEndPos and look for heighest values
-					int absStartIndex = vectorField.calcIndex( searchStartPos );
-					int absEndIndex = vectorField.calcIndex( searchEndPos );
-					dab::Array<int> curRelIndex( searchStartPos );
-					int absIndex = absStartIndex;
-					//const Eigen::VectorXf* valueVec;
-					
-					while( absIndex < absEndIndex )
+					auto peakVisitor = [&fieldVectors, &neighborAbsIndices, &neighborGridValues, &smallestNeighborIndex](unsigned int pIndex, const unsigned int*)
 					{
-						// first dimension
-						for(curRelIndex[0] = searchStartPos[0]; curRelIndex[0] <= searchEndPos[0]; curRelIndex[0] += 1, absIndex++)
-						{
-							//std::cout << "absIndex " << absIndex << " absStartIndex " << absStartIndex << " absEndIndex " << absEndIndex << " relIndex " << curRelIndex << " searchStartPos " << searchStartPos << " searchEndPos " << searchEndPos << "\n";
-							
-							
-							const Eigen::VectorXf& valueVec = fieldVectors[absIndex];
-							if( valueVec.norm() >= neighborGridValues[smallestNeighborIndex] )
-							{
-								//std::cout << "val " << valueVec->length() << " old curMinVal " << neighborGridValues[smallestNeighborIndex]  << " curMinIndex " << smallestNeighborIndex << "\n";
-								
-								neighborAbsIndices[smallestNeighborIndex] = absIndex;
-								neighborGridValues[smallestNeighborIndex] = valueVec.norm();
-								
-								// find new smallest neighor index
-								tmpSmallestGridValue = FLT_MAX;
-								tmpSmallestNeighborIndex = 0;
-								for(int i=0; i<neighborCount; ++i)
-								{
-									if( tmpSmallestGridValue > neighborGridValues[i] )
-									{
-										tmpSmallestGridValue = neighborGridValues[i];
-										tmpSmallestNeighborIndex = i;
-									}
-								}
-								
-								smallestNeighborIndex = tmpSmallestNeighborIndex;
-								
-								//std::cout << "val " << valueVec->length() << " new curMinVal " << neighborGridValues[smallestNeighborIndex]  << " curMinIndex " << smallestNeighborIndex << "\n";
-							}
-						}
+						float gridValue = fieldVectors[pIndex].norm();
 						
-						if(absIndex >= absEndIndex) break;
+						if( gridValue < neighborGridValues[smallestNeighborIndex] ) return;
 						
-						// successive dimensions
-						for(unsigned int d = 0; d < dim, curRelIndex[d] > searchEndPos[d]; ++d)
-						{
-							curRelIndex[d] = searchStartPos[d];
-							curRelIndex[d + 1] += 1;
-							absIndex -= indexOffset[d] * ( searchEndPos[d] - searchStartPos[d] + 1);
-							absIndex += indexOffset[d + 1];
-						}
-					}
+						neighborAbsIndices[smallestNeighborIndex] = pIndex;
+						neighborGridValues[smallestNeighborIndex] = gridValue;
+						
+						// find new smallest neighor index
+						smallestNeighborIndex = std::min_element( neighborGridValues.begin(), neighborGridValues.end() ) - neighborGridValues.begin();
+					};
 					
-                    //					std::cout << "before sorting\n";
-                    //					for(int i=0; i<neighborCount; ++i)
-                    //					{
-                    //						std::cout << "( " << neighborAbsIndices[i] << " : " << neighborGridValues[i] << ")";
-                    //					}
-                    //					std::cout << "\n";
+					visitRegion( searchStartPos, searchEndPos, peakVisitor );
 					
 					// sort index and value vectors according to values (bubblesort)
 					bool sorted = false;
@@ -658,131 +426,78 @@ GridAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Ex
 						}
 					}
 					
-                    //					std::cout << "after sorting\n";
-                    //					for(int i=0; i<neighborCount; ++i)
-                    //					{
-                    //						std::cout << "( " << neighborAbsIndices[i] << " : " << neighborGridValues[i] << ")";
-                    //					}
-                    //					std::cout << "\n";
-					
-					// transform indices and highest grid values into neighbor relationships
-					dab::Array<unsigned int> cellIndex( dim );
-                    Eigen::VectorXf cellPosition(dim);
+					// transform indices and highest grid values into neighbor relationships, neighbors are located at the center of their cell
 					for(int i=0; i<neighborCount; ++i)
 					{
-                        
-						//std::cout << "i " << i << " neighborAbsIndices " << neighborAbsIndices[i] << "\n";
-						
-						cellIndex = vectorField.calcIndex( neighborAbsIndices[i] );
-						
-						//std::cout << "cellIndex " << cellIndex << "\n";
+						unsigned int absIndex = neighborAbsIndices[i];
 						
-						cellPosition = mGrid->index2position( cellIndex );
-						
-						//std::cout << "cellPosition " << cellPosition << "\n";
-						
-						value = mGrid->gridValue(cellIndex);
-						
-						//std::cout << "value " << value << "\n";
-						
-						direction = cellPosition - objectPosition;
-						
-						//std::cout << "direction " << direction << "\n";
+						for(unsigned int d=0; d<dim; ++d)
+						{
+							unsigned int cellIndex = absIndex / indexOffset[d] % subdivisionCount[d];
+							samplePosition[d] = mGridTransform.mMinPos[d] + ( static_cast<float>( cellIndex ) + 0.5 ) * cellSize[d];
+						}
 						
+						value = fieldVectors[absIndex];
+						direction = samplePosition - objectPosition;
 						distance = direction.norm();
 						
-						//std::cout << "distance " << distance << "\n";
-						
-						spaceObject = new SpaceObject( cellPosition );
-						
-						//std::cout << "1\n";
-						
-						mTmpSpaceObjects.push_back(spaceObject);
-						
-						//std::cout << "2\n";
+						spaceObject = sampleObject( samplePosition );
 						
 						proxyObject->addNeighbor(spaceObject, value, direction, distance);
-						
-						//std::cout << "3\n";
 					}
 				}
-				else if(mNeighborMode == CentroidSearchMode)
+			}
+		}
+		
+		// sample grid for collected objects in parallel, then create their neighbor relations
+		unsigned int sampleCount = mSampledObjects.size();
+		
+		if(sampleCount > 0)
+		{
+			const unsigned int blockSize = 16;
+			unsigned int blockCount = ( sampleCount + blockSize - 1 ) / blockSize;
+			
+			mSampleValues.resize(sampleCount * valueDim);
+			mSampleResultPositions.resize(sampleCount * dim);
+			mSampleValid.resize(sampleCount);
+			
+			parallelTools.run(blockCount, [this, sampleCount, blockSize, dim, valueDim](unsigned int pTaskIndex, unsigned int pThreadIndex)
+			{
+				unsigned int sampleBegin = pTaskIndex * blockSize;
+				unsigned int sampleEnd = std::min( sampleBegin + blockSize, sampleCount );
+				
+				sampleGrid( mSamplePositions.data() + sampleBegin * dim, mSampleRadii.data() + sampleBegin, sampleEnd - sampleBegin, mSampleValues.data() + sampleBegin * valueDim, mSampleResultPositions.data() + sampleBegin * dim, mSampleValid.data() + sampleBegin, mSampleBuffers[pThreadIndex] );
+			});
+			
+			bool regionSamples = mNeighborMode == AvgRegionMode || mNeighborMode == CentroidSearchMode;
+			
+			for(unsigned int sI=0; sI<sampleCount; ++sI)
+			{
+				if(mSampleValid[sI] == 0) continue;
+				
+				proxyObject = mSampledObjects[sI];
+				const Eigen::VectorXf& objectPosition = proxyObject->position();
+				
+				for(unsigned int d=0; d<valueDim; ++d) value[d] = mSampleValues[sI * valueDim + d];
+				
+				if(regionSamples == true)
 				{
-					// create single neighbor relation whose position is the weighted (by value at grid nodes) position of each grid node within the space object's search radius and whose value is the average of all grid node values within search radius.
+					// neighbor is located at the value weighted centroid of the region
+					for(unsigned int d=0; d<dim; ++d) samplePosition[d] = mSampleResultPositions[sI * dim + d];
 					
-					//std::cout << "CentroidSearchMode\n";
-                    
-                    Eigen::VectorXf neighborRadiusVec(dim);
-                    neighborRadiusVec.setConstant(neighborRadius);
-                    
-					dab::Array<unsigned int> searchStartPos = mGrid->position2index( objectPosition - neighborRadiusVec );
-					dab::Array<unsigned int> searchEndPos = mGrid->position2index( objectPosition + neighborRadiusVec );
-					Eigen::VectorXf indexPos( dim );
-					unsigned int index;
-					unsigned int valueCount = 0;
-					float totalSumValue = 0;
-					float sumValue;
-                    dab::Array<float> totalIndexValue( dim );
-					
-					// go through all grid points from searchStartPos to searchEndPos and calculate centroid
-					int absStartIndex = vectorField.calcIndex( searchStartPos );
-					int absEndIndex = vectorField.calcIndex( searchEndPos );
-					dab::Array<int> curRelIndex( searchStartPos );
-					int absIndex = absStartIndex;
-					dab::Array<unsigned int> cellIndex( dim );
-					
-					//std::cout << "searchStartPos " << searchStartPos << " searchEndPos " << searchEndPos << "\n";
-                    
-					while( absIndex < absEndIndex )
-					{
-						// first dimension
-						for(curRelIndex[0] = searchStartPos[0]; curRelIndex[0] <= searchEndPos[0]; curRelIndex[0] += 1, absIndex++)
-						{
-							//std::cout << "absIndex " << absIndex << " absStartIndex " << absStartIndex << " absEndIndex " << absEndIndex << " relIndex " << curRelIndex << " searchStartPos " << searchStartPos << " searchEndPos " << searchEndPos << "\n";
-							
-							const Eigen::Vector3f& valueVec = fieldVectors[absIndex];
-							value += valueVec;
-							sumValue = valueVec.sum();
-							totalSumValue += sumValue;
-							vectorField.calcIndex( absIndex, cellIndex );
-							
-							for(unsigned int d=0; d<dim; ++d)
-							{
-								totalIndexValue[d] += static_cast<float>( cellIndex[d] ) * sumValue;
-							}
-						}
-						
-						if(absIndex >= absEndIndex) break;
-						
-						// successive dimensions
-						for(unsigned int d = 0; d < dim, curRelIndex[d] > searchEndPos[d]; ++d)
-						{
-							curRelIndex[d] = searchStartPos[d];
-							curRelIndex[d + 1] += 1;
-							absIndex -= indexOffset[d] * ( searchEndPos[d] - searchStartPos[d] + 1);
-							absIndex += indexOffset[d + 1];
-						}
-					}
-                    
-					if(totalSumValue > 0.0)
-					{
-						for(unsigned int d=0; d<dim; ++d) totalIndexValue[d] /= totalSumValue;
-						value /= static_cast<float>( valueCount );
-						
-                        Eigen::VectorXf resultPosition = mGrid->index2position( totalIndexValue );
-						
-						//std::cout << "res pos " << resultPosition << " value " << value << "\n";
-                        
-						spaceObject = new SpaceObject( resultPosition );
-						direction = resultPosition - objectPosition;
-						distance = direction.norm();
-						
-						mTmpSpaceObjects.push_back(spaceObject);
-						proxyObject->addNeighbor(spaceObject, value, direction, distance);
-						
-						//std::cout << "added neighbor to " << i << " : nCount " << proxyObject->neighborGroup()->neighborCount() << "\n";
-					}
+					spaceObject = sampleObject( samplePosition );
+					direction = samplePosition - objectPosition;
+					distance = direction.norm();
+				}
+				else
+				{
+					// neighbor is located at the position of the space object
+					spaceObject = sampleObject( objectPosition );
+					direction.setConstant(0.0);
+					distance = 0.0;
 				}
+				
+				proxyObject->addNeighbor(spaceObject, value, direction, distance);
 			}
 		}
 		
@@ -805,6 +520,214 @@ GridAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Ex
 	}
 }
 
+SpaceObject*
+GridAlg::sampleObject( const Eigen::VectorXf& pPosition )
+{
+    if( mSampleObjectCount == mSampleObjects.size() ) mSampleObjects.push_back( new SpaceObject( pPosition ) );
+    else mSampleObjects[mSampleObjectCount]->position() = pPosition;
+    
+    return mSampleObjects[mSampleObjectCount++];
+}
+
+void
+GridAlg::sumRegion( const unsigned int* pStartIndex, const unsigned int* pEndIndex, RegionSum& pSum ) const
+{
+    const std::vector< Eigen::Matrix<float, Eigen::Dynamic, 1> >& fieldVectors = mGrid->vectorField().vectors();
+    unsigned int gridDim = mGridTransform.mSize.size();
+    
+    pSum.mValue.setZero( mGrid->valueDim() );
+    pSum.mWeightedIndex.setZero( gridDim );
+    pSum.mWeight = 0.0;
+    pSum.mCount = 1;
+    
+    for(unsigned int d=0; d<gridDim; ++d) pSum.mCount *= pEndIndex[d] - pStartIndex[d] + 1;
+    
+    Eigen::VectorXf& value = pSum.mValue;
+    float* weightedIndex = pSum.mWeightedIndex.data();
+    float weight = 0.0;
+    
+    auto visitor = [&fieldVectors, &value, weightedIndex, &weight, gridDim](unsigned int pIndex, const unsigned int* pGridIndex)
+    {
+        const Eigen::Matrix<float, Eigen::Dynamic, 1>& fieldVector = fieldVectors[pIndex];
+        float pointWeight = fieldVector.sum();
+        
+        value += fieldVector;
+        weight += pointWeight;
+        
+        for(unsigned int d=0; d<gridDim; ++d) weightedIndex[d] += static_cast<float>( pGridIndex[d] ) * pointWeight;
+    };
+    
+    visitRegion( pStartIndex, pEndIndex, visitor );
+    
+    pSum.mWeight = weight;
+}
+
+void
+GridAlg::updateGridTransform()
+{
+    const Eigen::VectorXf& minPos = mGrid->minPos();
+    const Eigen::VectorXf& maxPos = mGrid->maxPos();
+    const dab::Array<unsigned int>& subdivisionCount = mGrid->subdivisionCount();
+    const dab::Array<unsigned int>& indexOffset = mGrid->vectorField().indexOffset();
+    unsigned int gridDim = mGrid->gridDim();
+    GridTransform& transform = mGridTransform;
+    
+    transform.mMinPos = minPos;
+    transform.mMaxPos = maxPos;
+    transform.mCellScale.resize(gridDim);
+    transform.mCellSize.resize(gridDim);
+    transform.mNodeScale.resize(gridDim);
+    transform.mNodeSize.resize(gridDim);
+    transform.mSize.resize(gridDim);
+    transform.mIndexOffset.resize(gridDim);
+    
+    for(unsigned int d=0; d<gridDim; ++d)
+    {
+        float size = static_cast<float>( subdivisionCount[d] );
+        float range = maxPos[d] - minPos[d];
+        
+        transform.mCellScale[d] = size / range;
+        transform.mCellSize[d] = range / size;
+        transform.mNodeScale[d] = ( size - 1.0 ) / range;
+        transform.mNodeSize[d] = size > 1.0 ? range / ( size - 1.0 ) : 0.0;
+        transform.mSize[d] = subdivisionCount[d];
+        transform.mIndexOffset[d] = indexOffset[d];
+    }
+}
+
+void
+GridAlg::sampleGrid( const float* pPositions, const float* pRadii, unsigned int pCount, float* pValues, float* pResultPositions, unsigned char* pValid, SampleBuffer& pBuffer ) const
+{
+    const std::vector< Eigen::Matrix<float, Eigen::Dynamic, 1> >& fieldVectors = mGrid->vectorField().vectors();
+    const GridTransform& transform = mGridTransform;
+    const float* minPos = transform.mMinPos.data();
+    const float* maxPos = transform.mMaxPos.data();
+    const unsigned int* size = transform.mSize.data();
+    const unsigned int* indexOffset = transform.mIndexOffset.data();
+    unsigned int gridDim = transform.mSize.size();
+    unsigned int valueDim = mGrid->valueDim();
+    
+    pBuffer.mStartIndex.resize(gridDim);
+    pBuffer.mEndIndex.resize(gridDim);
+    pBuffer.mFraction.resize(gridDim);
+    unsigned int* startIndex = pBuffer.mStartIndex.data();
+    unsigned int* endIndex = pBuffer.mEndIndex.data();
+    
+    for(unsigned int sI=0; sI<pCount; ++sI)
+    {
+        const float* position = pPositions + sI * gridDim;
+        Eigen::Map<Eigen::VectorXf> value( pValues + sI * valueDim, valueDim );
+        
+        if(mNeighborMode == CellLocationMode)
+        {
+            // value of the grid point nearest to the position
+            unsigned int index = 0;
+            
+            for(unsigned int d=0; d<gridDim; ++d)
+            {
+                float gridPos = ( position[d] - minPos[d] ) * transform.mNodeScale[d];
+                
+                if(gridPos > 0.0) index += std::min( static_cast<unsigned int>( gridPos ), size[d] - 1 ) * indexOffset[d];
+            }
+            
+            value = fieldVectors[index];
+            pValid[sI] = 1;
+        }
+        else if(mNeighborMode == AvgLocationMode)
+        {
+            // multilinear interpolation of the values at the grid points surrounding the position
+            // startIndex holds the lower grid index, endIndex the offset to the upper grid point (0 at the upper grid border)
+            float* fraction = pBuffer.mFraction.data();
+            unsigned int baseIndex = 0;
+            
+            for(unsigned int d=0; d<gridDim; ++d)
+            {
+                float gridPos = std::max( ( position[d] - minPos[d] ) * transform.mNodeScale[d], 0.0f );
+                unsigned int lowerIndex = static_cast<unsigned int>( gridPos );
+                
+                if(lowerIndex + 1 >= size[d])
+                {
+                    lowerIndex = size[d] - 1;
+                    fraction[d] = 0.0;
+                    endIndex[d] = 0;
+                }
+                else
+                {
+                    fraction[d] = gridPos - static_cast<float>( lowerIndex );
+                    endIndex[d] = indexOffset[d];
+                }
+                
+                baseIndex += lowerIndex * indexOffset[d];
+            }
+            
+            value.setZero();
+            
+            unsigned int cornerCount = 1 << gridDim;
+            
+            for(unsigned int cI=0; cI<cornerCount; ++cI)
+            {
+                unsigned int index = baseIndex;
+                float weight = 1.0;
+                
+                for(unsigned int d=0; d<gridDim; ++d)
+                {
+                    if(cI & (1 << d))
+                    {
+                        index += endIndex[d];
+                        weight *= fraction[d];
+                    }
+                    else weight *= 1.0 - fraction[d];
+                }
+                
+                if(weight > 0.0) value += weight * fieldVectors[index];
+            }
+            
+            pValid[sI] = 1;
+        }
+        else
+        {
+            // average value and value weighted centroid of all grid points within the radius
+            float radius = pRadii[sI];
+            
+            for(unsigned int d=0; d<gridDim; ++d)
+            {
+                float regionMin = position[d] - radius;
+                float regionMax = position[d] + radius;
+                
+                if(regionMin <= minPos[d]) startIndex[d] = 0;
+                else if(regionMin >= maxPos[d]) startIndex[d] = size[d] - 1;
+                else startIndex[d] = std::min( static_cast<unsigned int>( ( regionMin - minPos[d] ) * transform.mNodeScale[d] ), size[d] - 1 );
+                
+                if(regionMax <= minPos[d]) endIndex[d] = 0;
+                else if(regionMax >= maxPos[d]) endIndex[d] = size[d] - 1;
+                else endIndex[d] = std::min( static_cast<unsigned int>( ( regionMax - minPos[d] ) * transform.mNodeScale[d] ), size[d] - 1 );
+            }
+            
+            RegionSum& regionSum = pBuffer.mRegionSum;
+            sumRegion( startIndex, endIndex, regionSum );
+            
+            if(regionSum.mWeight <= 0.0)
+            {
+                pValid[sI] = 0;
+                continue;
+            }
+            
+            value = regionSum.mValue / static_cast<float>( regionSum.mCount );
+            
+            float* resultPosition = pResultPositions + sI * gridDim;
+            for(unsigned int d=0; d<gridDim; ++d) resultPosition[d] = minPos[d] + regionSum.mWeightedIndex[d] / regionSum.mWeight * transform.mNodeSize[d];
+            
+            pValid[sI] = 1;
+        }
+    }
+}
+
+bool
+GridAlg::symmetricNeighborsSupported() const
+{
+    return false;
+}
+
 GridAlg::operator std::string() const
 {
     return info();
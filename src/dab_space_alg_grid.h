@@ -93,6 +93,14 @@ public:
     void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
     void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
     
+    /**
+     \brief symmetric neighbor calculation is not supported
+     \return false
+     
+     neighbors are derived from grid samples rather than from pairs of objects
+     */
+    bool symmetricNeighborsSupported() const;
+    
     /**
      \brief obtain textual ntree information
      \return String containing textual ntree information
@@ -118,15 +126,195 @@ public:
     }
     
 protected:
+    /**
+     \brief grid values accumulated over a region of grid points
+     */
+    class RegionSum
+    {
+    public:
+        Eigen::VectorXf mValue; ///\brief sum of grid values
+        Eigen::VectorXf mWeightedIndex; ///\brief sum of grid indices, each weighted by the component sum of its grid value
+        float mWeight; ///\brief sum of component sums of grid values
+        unsigned int mCount; ///\brief number of grid points
+    };
+    
+    /**
+     \brief transformation between world positions and grid indices
+     
+     calculated once per neighbor update instead of for each object
+     */
+    class GridTransform
+    {
+    public:
+        Eigen::VectorXf mMinPos; ///\brief minimum position of grid
+        Eigen::VectorXf mMaxPos; ///\brief maximum position of grid
+        Eigen::VectorXf mCellScale; ///\brief scale from position relative to minimum position to cell index
+        Eigen::VectorXf mCellSize; ///\brief cell size
+        Eigen::VectorXf mNodeScale; ///\brief scale from position relative to minimum position to continuous grid index, as used for interpolating grid values and sampling regions
+        Eigen::VectorXf mNodeSize; ///\brief distance between neighboring grid points
+        std::vector<unsigned int> mSize; ///\brief number of grid points along each dimension
+        std::vector<unsigned int> mIndexOffset; ///\brief offset in vector field for advancing by one grid point along each dimension
+    };
+    
+    /**
+     \brief buffers used by one thread during grid sampling
+     
+     the neighbor modes that aren't sampled in parallel (GridLocationMode, PeakSearchMode) use the buffer of the first thread
+     */
+    class SampleBuffer
+    {
+    public:
+        std::vector<unsigned int> mStartIndex; ///\brief first grid index of region
+        std::vector<unsigned int> mEndIndex; ///\brief last grid index of region
+        std::vector<float> mFraction; ///\brief interpolation weights of upper grid points
+        RegionSum mRegionSum; ///\brief sums over region
+        std::vector<unsigned int> mPeakIndices; ///\brief positions in vector field of the highest grid values found by a peak search
+        std::vector<float> mPeakValues; ///\brief highest grid values found by a peak search
+        Eigen::VectorXf mValue; ///\brief value of neighbor relation
+        Eigen::VectorXf mDirection; ///\brief direction of neighbor relation
+        Eigen::VectorXf mPosition; ///\brief position of grid sample
+    };
+    
     GridAlg();
     
+    /**
+     \brief visit all grid points within a box of grid indices
+     \param pStartIndex first grid index along each dimension
+     \param pEndIndex last grid index along each dimension (inclusive)
+     \param pVisitor called with the position of each grid point in the vector field and its grid index (one value per grid dimension)
+     
+     the position in the vector field advances by the index offsets of the vector field instead of being recalculated for each grid point. 2D and 3D regions are visited by nested loops, other dimensions by incrementing the grid index like an odometer. regions only allocate memory if the grid has more than sMaxStackRegionDim dimensions
+     */
+    template<class VISITOR>
+    void visitRegion( const unsigned int* pStartIndex, const unsigned int* pEndIndex, VISITOR& pVisitor ) const;
+    
+    static const unsigned int sMaxStackRegionDim = 16; ///\brief highest grid dimension for which visitRegion keeps the grid index on the stack
+    
+    /**
+     \brief return space object representing a grid sample
+     \param pPosition sample position
+     \return grid sample object
+     
+     grid sample objects are kept across updates and only created when more samples are needed than during any previous update
+     */
+    SpaceObject* sampleObject( const Eigen::VectorXf& pPosition );
+    
+    /**
+     \brief accumulate grid values and value weighted grid indices within a box of grid indices
+     \param pStartIndex first grid index along each dimension
+     \param pEndIndex last grid index along each dimension (inclusive)
+     \param pSum resulting sums, previous contents are discarded
+     */
+    void sumRegion( const unsigned int* pStartIndex, const unsigned int* pEndIndex, RegionSum& pSum ) const;
+    
+    /**
+     \brief update transformation between world positions and grid indices from current grid
+     */
+    void updateGridTransform();
+    
+    /**
+     \brief sample grid at packed positions
+     \param pPositions positions (gridDim values per position)
+     \param pRadii region radii (one value per position, only used for region sampling)
+     \param pCount number of positions
+     \param pValues resulting values (valueDim values per position)
+     \param pResultPositions resulting sample positions (gridDim values per position, only set for region sampling)
+     \param pValid whether a sample has been obtained (one value per position)
+     \param pBuffer sample buffer of calling thread
+     
+     depending on the neighbor mode, samples take the value of the nearest cell (CellLocationMode), the multilinearly interpolated value (AvgLocationMode) or the average value and value weighted centroid of a region around the position (AvgRegionMode, CentroidSearchMode). positions must lie within the grid, grid accessors are bypassed and neither check bounds nor allocate.
+     */
+    void sampleGrid( const float* pPositions, const float* pRadii, unsigned int pCount, float* pValues, float* pResultPositions, unsigned char* pValid, SampleBuffer& pBuffer ) const;
+    
     SpaceGrid* mGrid; ///\brief grid	
     bool mGridOwner; ///\brief flag indicating whether we're owner of the grid or not
     GridNeighborMode mNeighborMode; ///\brief mode of grid space neighbor calculation
     GridUpdateMode mUpdateMode; ///\brief mode of grid updating
-    std::vector<SpaceObject*> mTmpSpaceObjects; ///\brief temporarily created space objects
+    std::vector<SpaceObject*> mSampleObjects; ///\brief space objects representing grid samples, reused across updates
+    unsigned int mSampleObjectCount; ///\brief number of grid sample objects in use by current neighbor relations
+    GridTransform mGridTransform; ///\brief transformation between world positions and grid indices
+    std::vector<SampleBuffer> mSampleBuffers; ///\brief sample buffers, one per thread
+    std::vector<SpaceProxyObject*> mSampledObjects; ///\brief objects whose neighbors are derived from batched grid samples
+    std::vector<float> mSamplePositions; ///\brief packed positions of sampled objects
+    std::vector<float> mSampleRadii; ///\brief neighbor radii of sampled objects
+    std::vector<float> mSampleValues; ///\brief packed values of grid samples
+    std::vector<float> mSampleResultPositions; ///\brief packed positions of grid samples
+    std::vector<unsigned char> mSampleValid; ///\brief flags indicating whether a grid sample has been obtained
 };
 
+template<class VISITOR>
+void
+GridAlg::visitRegion( const unsigned int* pStartIndex, const unsigned int* pEndIndex, VISITOR& pVisitor ) const
+{
+    const unsigned int* indexOffset = mGridTransform.mIndexOffset.data();
+    unsigned int dim = mGridTransform.mIndexOffset.size();
+    
+    if(dim == 2)
+    {
+        unsigned int gridIndex[2];
+        
+        for(gridIndex[1] = pStartIndex[1]; gridIndex[1] <= pEndIndex[1]; ++gridIndex[1])
+        {
+            unsigned int index = pStartIndex[0] * indexOffset[0] + gridIndex[1] * indexOffset[1];
+            
+            for(gridIndex[0] = pStartIndex[0]; gridIndex[0] <= pEndIndex[0]; ++gridIndex[0], index += indexOffset[0]) pVisitor(index, gridIndex);
+        }
+    }
+    else if(dim == 3)
+    {
+        unsigned int gridIndex[3];
+        
+        for(gridIndex[2] = pStartIndex[2]; gridIndex[2] <= pEndIndex[2]; ++gridIndex[2])
+        {
+            for(gridIndex[1] = pStartIndex[1]; gridIndex[1] <= pEndIndex[1]; ++gridIndex[1])
+            {
+                unsigned int index = pStartIndex[0] * indexOffset[0] + gridIndex[1] * indexOffset[1] + gridIndex[2] * indexOffset[2];
+                
+                for(gridIndex[0] = pStartIndex[0]; gridIndex[0] <= pEndIndex[0]; ++gridIndex[0], index += indexOffset[0]) pVisitor(index, gridIndex);
+            }
+        }
+    }
+    else
+    {
+        // grid index lives on the stack unless the grid has an unusually high dimension
+        unsigned int stackGridIndex[sMaxStackRegionDim];
+        std::vector<unsigned int> heapGridIndex( dim > sMaxStackRegionDim ? dim : 0 );
+        unsigned int* gridIndex = dim > sMaxStackRegionDim ? heapGridIndex.data() : stackGridIndex;
+        unsigned int index = 0;
+        
+        for(unsigned int d=0; d<dim; ++d)
+        {
+            if(pStartIndex[d] > pEndIndex[d]) return;
+            
+            gridIndex[d] = pStartIndex[d];
+            index += pStartIndex[d] * indexOffset[d];
+        }
+        
+        while(true)
+        {
+            pVisitor(index, gridIndex);
+            
+            // advance the lowest dimension that hasn't reached its end, rewind the dimensions below it
+            unsigned int d = 0;
+            
+            for(; d<dim; ++d)
+            {
+                if(gridIndex[d] < pEndIndex[d])
+                {
+                    gridIndex[d] += 1;
+                    index += indexOffset[d];
+                    break;
+                }
+                
+                index -= ( gridIndex[d] - pStartIndex[d] ) * indexOffset[d];
+                gridIndex[d] = pStartIndex[d];
+            }
+            
+            if(d == dim) break;
+        }
+    }
+}
+
 };
 
 };
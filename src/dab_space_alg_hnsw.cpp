@@ -0,0 +1,799 @@
+/** \file dab_space_alg_hnsw.cpp
+ */
+
+#include "dab_space_alg_hnsw.h"
+#include "dab_space_proxy_object.h"
+#include "dab_space_simd.h"
+#include "dab_space_parallel.h"
+#include <algorithm>
+#include <functional>
+#include <cfloat>
+#include <cmath>
+
+using namespace dab;
+using namespace dab::space;
+
+HNSWAlg::SearchBuffer::SearchBuffer()
+: mVisitStamp(0)
+{}
+
+HNSWAlg::HNSWAlg()
+: SpaceAlg(2)
+, mM(16)
+, mEfConstruction(200)
+, mEfSearch(64)
+, mLevelFactor( 1.0 / log( static_cast<double>(mM) ) )
+, mPurgeRatio(0.05)
+, mEntryNode(-1)
+, mMaxLevel(-1)
+, mRecallSampleCount(0)
+, mRecall(-1.0)
+{}
+
+HNSWAlg::HNSWAlg( unsigned int pDim, unsigned int pM, unsigned int pEfConstruction, unsigned int pEfSearch )
+: SpaceAlg( pDim )
+, mM( std::max(pM, 2u) )
+, mEfConstruction( std::max(pEfConstruction, 1u) )
+, mEfSearch( std::max(pEfSearch, 1u) )
+, mLevelFactor( 1.0 / log( static_cast<double>(mM) ) )
+, mPurgeRatio(0.05)
+, mEntryNode(-1)
+, mMaxLevel(-1)
+, mRecallSampleCount(0)
+, mRecall(-1.0)
+{}
+
+HNSWAlg::HNSWAlg( const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, unsigned int pM, unsigned int pEfConstruction, unsigned int pEfSearch ) throw (Exception)
+: SpaceAlg( pMinPos, pMaxPos )
+, mM( std::max(pM, 2u) )
+, mEfConstruction( std::max(pEfConstruction, 1u) )
+, mEfSearch( std::max(pEfSearch, 1u) )
+, mLevelFactor( 1.0 / log( static_cast<double>(mM) ) )
+, mPurgeRatio(0.05)
+, mEntryNode(-1)
+, mMaxLevel(-1)
+, mRecallSampleCount(0)
+, mRecall(-1.0)
+{}
+
+HNSWAlg::~HNSWAlg()
+{}
+
+unsigned int
+HNSWAlg::M() const
+{
+    return mM;
+}
+
+unsigned int
+HNSWAlg::efConstruction() const
+{
+    return mEfConstruction;
+}
+
+unsigned int
+HNSWAlg::efSearch() const
+{
+    return mEfSearch;
+}
+
+void
+HNSWAlg::setM(unsigned int pM) throw (Exception)
+{
+    if(pM < 2) throw Exception("SPACE ERROR: M must be at least 2", __FILE__, __FUNCTION__, __LINE__);
+    if(pM == mM) return;
+
+    mM = pM;
+    mLevelFactor = 1.0 / log( static_cast<double>(mM) );
+
+    // rebuild graph
+    std::vector< std::pair<SpaceProxyObject*, bool> > objects;
+
+    unsigned int nodeCount = mNodes.size();
+    for(unsigned int nI=0; nI<nodeCount; ++nI)
+    {
+        if(mNodes[nI].mObject != nullptr) objects.push_back( std::make_pair(mNodes[nI].mObject, mNodes[nI].mVisible) );
+    }
+
+    mNodes.clear();
+    mPositions.clear();
+    mFreeNodes.clear();
+    mDeletedNodes.clear();
+    mNodeIndices.clear();
+    mEntryNode = -1;
+    mMaxLevel = -1;
+
+    unsigned int objectCount = objects.size();
+    for(unsigned int oI=0; oI<objectCount; ++oI)
+    {
+        unsigned int node = insertNode(objects[oI].first);
+        mNodes[node].mVisible = objects[oI].second;
+    }
+}
+
+void
+HNSWAlg::setEfConstruction(unsigned int pEfConstruction) throw (Exception)
+{
+    if(pEfConstruction == 0) throw Exception("SPACE ERROR: efConstruction must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+
+    mEfConstruction = pEfConstruction;
+}
+
+void
+HNSWAlg::setEfSearch(unsigned int pEfSearch) throw (Exception)
+{
+    if(pEfSearch == 0) throw Exception("SPACE ERROR: efSearch must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+
+    mEfSearch = pEfSearch;
+}
+
+unsigned int
+HNSWAlg::recallSampleCount() const
+{
+    return mRecallSampleCount;
+}
+
+void
+HNSWAlg::setRecallSampleCount(unsigned int pRecallSampleCount)
+{
+    mRecallSampleCount = pRecallSampleCount;
+    if(mRecallSampleCount == 0) mRecall = -1.0;
+}
+
+float
+HNSWAlg::recall() const
+{
+    return mRecall;
+}
+
+unsigned int
+HNSWAlg::objectCount() const
+{
+    return mNodeIndices.size();
+}
+
+void
+HNSWAlg::addObject( SpaceProxyObject* pObject ) throw (Exception)
+{
+    if(pObject->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObject->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    if(mNodeIndices.find(pObject) == mNodeIndices.end()) insertNode(pObject);
+}
+
+void
+HNSWAlg::removeObject( SpaceProxyObject* pObject ) throw (Exception)
+{
+    std::unordered_map<SpaceProxyObject*, unsigned int>::iterator nodeIter = mNodeIndices.find(pObject);
+    if(nodeIter == mNodeIndices.end()) return;
+
+    unsigned int node = nodeIter->second;
+    mNodeIndices.erase(nodeIter);
+
+    deleteNode(node);
+}
+
+void
+HNSWAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    unsigned int dim = mMinPos.rows();
+    unsigned int nodeCount = mNodes.size();
+    unsigned int objectCount = pObjects.size();
+
+    if( mDeletedNodes.size() > 0 && ( mDeletedNodes.size() >= mNodeIndices.size() || static_cast<float>( mDeletedNodes.size() ) >= mPurgeRatio * static_cast<float>(nodeCount) ) ) purgeDeletedNodes();
+
+    for(unsigned int nI=0; nI<nodeCount; ++nI) mNodes[nI].mVisible = false;
+
+    for(unsigned int oI=0; oI<objectCount; ++oI)
+    {
+        SpaceProxyObject* object = pObjects[oI];
+        std::unordered_map<SpaceProxyObject*, unsigned int>::iterator nodeIter = mNodeIndices.find(object);
+        unsigned int node;
+
+        if(nodeIter == mNodeIndices.end())
+        {
+            node = insertNode(object);
+        }
+        else
+        {
+            node = nodeIter->second;
+
+            // relink node only if it has moved
+            const float* objectPosition = object->position().data();
+            const float* nodePosition = mPositions.data() + node * dim;
+
+            for(unsigned int d=0; d<dim; ++d)
+            {
+                if(objectPosition[d] != nodePosition[d])
+                {
+                    updateNode(node);
+                    break;
+                }
+            }
+        }
+
+        mNodes[node].mVisible = true;
+    }
+}
+
+void
+HNSWAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+        unsigned int dim = mMinPos.rows();
+        unsigned int objectCount = pObjects.size();
+        unsigned int threadCount = parallelTools.threadCount();
+        const unsigned int blockSize = 16;
+        unsigned int blockCount = ( objectCount + blockSize - 1 ) / blockSize;
+
+        if(mSearchBuffers.size() < threadCount) mSearchBuffers.resize(threadCount);
+        for(unsigned int tI=0; tI<threadCount; ++tI) if(mSearchBuffers[tI].mDirection.rows() != dim) mSearchBuffers[tI].mDirection.resize(dim);
+
+        // queries only read the graph and can therefore run in parallel
+        parallelTools.run(blockCount, [this, &pObjects, objectCount, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            SearchBuffer& buffer = mSearchBuffers[pThreadIndex];
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+
+            for(unsigned int oI=pTaskIndex * blockSize; oI<objectEnd; ++oI)
+            {
+                SpaceProxyObject* object = pObjects[oI];
+                object->removeNeighbors();
+
+                int maxNeighborCount = object->maxNeighborCount();
+                if(maxNeighborCount == 0) continue;
+
+                search( object->position().data(), std::max( mEfSearch, static_cast<unsigned int>( std::max(maxNeighborCount, 0) ) ), buffer );
+                addNeighbors(object, buffer);
+            }
+        });
+
+        if(mRecallSampleCount > 0) measureRecall(pObjects);
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update neighbors based on hnsw graph", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+bool
+HNSWAlg::symmetricNeighborsSupported() const
+{
+    return false;
+}
+
+const float*
+HNSWAlg::nodePosition(unsigned int pNode) const
+{
+    return mPositions.data() + pNode * mMinPos.rows();
+}
+
+float
+HNSWAlg::squaredDistance(const float* pPosition, unsigned int pNode) const
+{
+    return SpaceSimdTools::get().squaredDistance(pPosition, mPositions.data() + pNode * mMinPos.rows(), mMinPos.rows());
+}
+
+unsigned int
+HNSWAlg::maxLinkCount(int pLevel) const
+{
+    return pLevel == 0 ? 2 * mM : mM;
+}
+
+int
+HNSWAlg::randomLevel()
+{
+    std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    double value = 1.0 - distribution(mRandomGenerator);
+
+    return static_cast<int>( -log(value) * mLevelFactor );
+}
+
+unsigned int
+HNSWAlg::insertNode( SpaceProxyObject* pObject )
+{
+    unsigned int dim = mMinPos.rows();
+    unsigned int nodeIndex;
+
+    if(mFreeNodes.size() > 0)
+    {
+        nodeIndex = mFreeNodes.back();
+        mFreeNodes.pop_back();
+    }
+    else
+    {
+        nodeIndex = mNodes.size();
+        mNodes.push_back(Node());
+        mPositions.resize(mPositions.size() + dim);
+    }
+
+    Node& node = mNodes[nodeIndex];
+    node.mObject = pObject;
+    node.mLevel = randomLevel();
+    node.mVisible = false;
+    node.mLinks.assign(node.mLevel + 1, std::vector<unsigned int>());
+
+    const Eigen::VectorXf& position = pObject->position();
+    std::copy(position.data(), position.data() + dim, mPositions.begin() + nodeIndex * dim);
+
+    mNodeIndices[pObject] = nodeIndex;
+
+    if(mEntryNode < 0)
+    {
+        mEntryNode = nodeIndex;
+        mMaxLevel = node.mLevel;
+        return nodeIndex;
+    }
+
+    linkNode(nodeIndex);
+
+    if(mNodes[nodeIndex].mLevel > mMaxLevel)
+    {
+        mMaxLevel = mNodes[nodeIndex].mLevel;
+        mEntryNode = nodeIndex;
+    }
+
+    return nodeIndex;
+}
+
+void
+HNSWAlg::updateNode( unsigned int pNode )
+{
+    unsigned int dim = mMinPos.rows();
+    const Eigen::VectorXf& position = mNodes[pNode].mObject->position();
+    std::copy(position.data(), position.data() + dim, mPositions.begin() + pNode * dim);
+
+    if(mNodeIndices.size() <= 1) return;
+
+    // the old links guide the search for new links
+    std::vector< std::vector<unsigned int> > previousLinks = mNodes[pNode].mLinks;
+
+    linkNode(pNode);
+
+    // former neighbors that still point to the node reselect their links
+    int level = mNodes[pNode].mLevel;
+
+    for(int l=0; l<=level; ++l)
+    {
+        const std::vector<unsigned int>& links = previousLinks[l];
+        unsigned int linkCount = links.size();
+
+        for(unsigned int lI=0; lI<linkCount; ++lI)
+        {
+            const std::vector<unsigned int>& neighborLinks = mNodes[links[lI]].mLinks[l];
+            if( std::find(neighborLinks.begin(), neighborLinks.end(), pNode) != neighborLinks.end() ) relinkNode(links[lI], mNodes[pNode].mLinks[l], l);
+        }
+    }
+}
+
+void
+HNSWAlg::deleteNode( unsigned int pNode )
+{
+    mNodes[pNode].mObject = nullptr;
+    mNodes[pNode].mVisible = false;
+
+    mDeletedNodes.push_back(pNode);
+}
+
+void
+HNSWAlg::purgeDeletedNodes()
+{
+    if(mDeletedNodes.size() == 0) return;
+
+    unsigned int nodeCount = mNodes.size();
+    unsigned int deletedCount = mDeletedNodes.size();
+
+    // collect links of deleted nodes that point to remaining nodes, they serve as replacement candidates
+    std::vector<char> deleted(nodeCount, 0);
+    for(unsigned int dI=0; dI<deletedCount; ++dI) deleted[mDeletedNodes[dI]] = 1;
+
+    // remove links pointing to deleted nodes, links aren't necessarily bidirectional so all nodes are checked
+    std::vector<unsigned int> replacementNodes;
+
+    for(unsigned int nI=0; nI<nodeCount; ++nI)
+    {
+        Node& node = mNodes[nI];
+        if(node.mObject == nullptr) continue;
+
+        for(int l=0; l<=node.mLevel; ++l)
+        {
+            std::vector<unsigned int>& links = node.mLinks[l];
+            unsigned int linkCount = links.size();
+            bool linksDeleted = false;
+
+            replacementNodes.clear();
+
+            for(unsigned int lI=0; lI<linkCount; ++lI)
+            {
+                if(deleted[links[lI]] == 0) continue;
+
+                // deleted nodes may point to other deleted nodes, relinkNode skips those
+                const std::vector<unsigned int>& deletedLinks = mNodes[links[lI]].mLinks[l];
+                replacementNodes.insert(replacementNodes.end(), deletedLinks.begin(), deletedLinks.end());
+                linksDeleted = true;
+            }
+
+            if(linksDeleted == false) continue;
+
+            links.erase( std::remove_if(links.begin(), links.end(), [&deleted](unsigned int pLink){ return deleted[pLink] != 0; }), links.end() );
+            relinkNode(nI, replacementNodes, l);
+        }
+    }
+
+    for(unsigned int dI=0; dI<deletedCount; ++dI)
+    {
+        mNodes[mDeletedNodes[dI]].mLinks.clear();
+        mFreeNodes.push_back(mDeletedNodes[dI]);
+    }
+
+    mDeletedNodes.clear();
+
+    // choose new entry node among the remaining nodes of highest level
+    if(mEntryNode >= 0 && deleted[mEntryNode] != 0)
+    {
+        mEntryNode = -1;
+        mMaxLevel = -1;
+
+        for(unsigned int nI=0; nI<nodeCount; ++nI)
+        {
+            if(mNodes[nI].mObject != nullptr && mNodes[nI].mLevel > mMaxLevel)
+            {
+                mMaxLevel = mNodes[nI].mLevel;
+                mEntryNode = nI;
+            }
+        }
+    }
+}
+
+void
+HNSWAlg::linkNode( unsigned int pNode )
+{
+    const float* position = nodePosition(pNode);
+    int level = mNodes[pNode].mLevel;
+
+    unsigned int entryNode = searchGreedy(position, mEntryNode, mMaxLevel, level);
+    std::vector<unsigned int> links;
+
+    for(int l=std::min(level, mMaxLevel); l>=0; --l)
+    {
+        searchLayer(position, entryNode, mEfConstruction, l, mLinkBuffer);
+
+        std::vector<Candidate>& candidates = mLinkBuffer.mResults;
+        for(unsigned int cI=0; cI<candidates.size(); ++cI)
+        {
+            if(candidates[cI].second == pNode)
+            {
+                candidates.erase(candidates.begin() + cI);
+                break;
+            }
+        }
+
+        if(candidates.size() == 0) continue;
+
+        entryNode = candidates[0].second;
+
+        // deleted nodes guide the search but don't receive links
+        candidates.erase( std::remove_if(candidates.begin(), candidates.end(), [this](const Candidate& pCandidate){ return mNodes[pCandidate.second].mObject == nullptr; }), candidates.end() );
+
+        selectLinks(candidates, mM, links);
+        mNodes[pNode].mLinks[l] = links;
+
+        unsigned int linkCount = links.size();
+        for(unsigned int lI=0; lI<linkCount; ++lI) addLink(links[lI], pNode, l);
+    }
+}
+
+unsigned int
+HNSWAlg::searchGreedy( const float* pPosition, unsigned int pEntryNode, int pFromLevel, int pToLevel ) const
+{
+    unsigned int currentNode = pEntryNode;
+    float currentDistance = squaredDistance(pPosition, currentNode);
+
+    for(int l=pFromLevel; l>pToLevel; --l)
+    {
+        bool changed = true;
+
+        while(changed == true)
+        {
+            changed = false;
+
+            const std::vector<unsigned int>& links = mNodes[currentNode].mLinks[l];
+            unsigned int linkCount = links.size();
+
+            for(unsigned int lI=0; lI<linkCount; ++lI)
+            {
+                float distance = squaredDistance(pPosition, links[lI]);
+
+                if(distance < currentDistance)
+                {
+                    currentDistance = distance;
+                    currentNode = links[lI];
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    return currentNode;
+}
+
+void
+HNSWAlg::searchLayer( const float* pPosition, unsigned int pEntryNode, unsigned int pEf, int pLevel, SearchBuffer& pBuffer ) const
+{
+    std::vector<unsigned int>& visitStamps = pBuffer.mVisitStamps;
+    std::vector<Candidate>& candidates = pBuffer.mCandidates;
+    std::vector<Candidate>& results = pBuffer.mResults;
+
+    if(visitStamps.size() < mNodes.size()) visitStamps.resize(mNodes.size(), 0);
+    if(++pBuffer.mVisitStamp == 0)
+    {
+        std::fill(visitStamps.begin(), visitStamps.end(), 0);
+        pBuffer.mVisitStamp = 1;
+    }
+
+    unsigned int visitStamp = pBuffer.mVisitStamp;
+
+    candidates.clear();
+    results.clear();
+
+    float entryDistance = squaredDistance(pPosition, pEntryNode);
+    visitStamps[pEntryNode] = visitStamp;
+    candidates.push_back( Candidate(entryDistance, pEntryNode) );
+    results.push_back( Candidate(entryDistance, pEntryNode) );
+
+    while(candidates.size() > 0)
+    {
+        std::pop_heap(candidates.begin(), candidates.end(), std::greater<Candidate>());
+        Candidate candidate = candidates.back();
+        candidates.pop_back();
+
+        // closest remaining candidate is further away than the furthest result
+        if(candidate.first > results.front().first && results.size() >= pEf) break;
+
+        const std::vector<unsigned int>& links = mNodes[candidate.second].mLinks[pLevel];
+        unsigned int linkCount = links.size();
+
+        for(unsigned int lI=0; lI<linkCount; ++lI)
+        {
+            unsigned int linkedNode = links[lI];
+
+            if(visitStamps[linkedNode] == visitStamp) continue;
+            visitStamps[linkedNode] = visitStamp;
+
+            float distance = squaredDistance(pPosition, linkedNode);
+
+            if(results.size() < pEf || distance < results.front().first)
+            {
+                candidates.push_back( Candidate(distance, linkedNode) );
+                std::push_heap(candidates.begin(), candidates.end(), std::greater<Candidate>());
+
+                results.push_back( Candidate(distance, linkedNode) );
+                std::push_heap(results.begin(), results.end());
+
+                if(results.size() > pEf)
+                {
+                    std::pop_heap(results.begin(), results.end());
+                    results.pop_back();
+                }
+            }
+        }
+    }
+
+    std::sort_heap(results.begin(), results.end());
+}
+
+void
+HNSWAlg::search( const float* pPosition, unsigned int pEf, SearchBuffer& pBuffer ) const
+{
+    if(mEntryNode < 0)
+    {
+        pBuffer.mResults.clear();
+        return;
+    }
+
+    unsigned int entryNode = searchGreedy(pPosition, mEntryNode, mMaxLevel, 0);
+    searchLayer(pPosition, entryNode, pEf, 0, pBuffer);
+}
+
+void
+HNSWAlg::selectLinks( const std::vector<Candidate>& pCandidates, unsigned int pMaxCount, std::vector<unsigned int>& pLinks ) const
+{
+    pLinks.clear();
+
+    std::vector<unsigned int> prunedNodes;
+    unsigned int candidateCount = pCandidates.size();
+
+    for(unsigned int cI=0; cI<candidateCount && pLinks.size() < pMaxCount; ++cI)
+    {
+        const float* candidatePosition = nodePosition(pCandidates[cI].second);
+        bool diverse = true;
+        unsigned int linkCount = pLinks.size();
+
+        for(unsigned int lI=0; lI<linkCount; ++lI)
+        {
+            if(squaredDistance(candidatePosition, pLinks[lI]) < pCandidates[cI].first)
+            {
+                diverse = false;
+                break;
+            }
+        }
+
+        if(diverse == true) pLinks.push_back(pCandidates[cI].second);
+        else prunedNodes.push_back(pCandidates[cI].second);
+    }
+
+    // fill remaining links with the closest pruned candidates to keep the graph well connected
+    unsigned int prunedCount = prunedNodes.size();
+    for(unsigned int pI=0; pI<prunedCount && pLinks.size() < pMaxCount; ++pI) pLinks.push_back(prunedNodes[pI]);
+}
+
+void
+HNSWAlg::addLink( unsigned int pNode, unsigned int pLinkedNode, int pLevel )
+{
+    std::vector<unsigned int>& links = mNodes[pNode].mLinks[pLevel];
+
+    if( std::find(links.begin(), links.end(), pLinkedNode) != links.end() ) return;
+
+    if(links.size() < maxLinkCount(pLevel))
+    {
+        links.push_back(pLinkedNode);
+        return;
+    }
+
+    std::vector<unsigned int> additionalNodes(1, pLinkedNode);
+    relinkNode(pNode, additionalNodes, pLevel);
+}
+
+void
+HNSWAlg::relinkNode( unsigned int pNode, const std::vector<unsigned int>& pAdditionalNodes, int pLevel )
+{
+    std::vector<unsigned int>& links = mNodes[pNode].mLinks[pLevel];
+    const float* position = nodePosition(pNode);
+
+    std::vector<Candidate> candidates;
+    unsigned int linkCount = links.size();
+    unsigned int additionalCount = pAdditionalNodes.size();
+
+    for(unsigned int lI=0; lI<linkCount; ++lI) candidates.push_back( Candidate( squaredDistance(position, links[lI]), links[lI] ) );
+
+    for(unsigned int aI=0; aI<additionalCount; ++aI)
+    {
+        unsigned int additionalNode = pAdditionalNodes[aI];
+        if(additionalNode == pNode || mNodes[additionalNode].mObject == nullptr || std::find(links.begin(), links.end(), additionalNode) != links.end()) continue;
+
+        candidates.push_back( Candidate( squaredDistance(position, additionalNode), additionalNode ) );
+    }
+
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase( std::unique(candidates.begin(), candidates.end()), candidates.end() );
+
+    selectLinks(candidates, maxLinkCount(pLevel), links);
+}
+
+void
+HNSWAlg::addNeighbors( SpaceProxyObject* pObject, SearchBuffer& pBuffer ) const throw (Exception)
+{
+    const Eigen::VectorXf& position = pObject->position();
+    float neighborRadius = pObject->neighborRadius();
+    float squaredNeighborRadius = neighborRadius >= 0.0 ? neighborRadius * neighborRadius : FLT_MAX;
+    int maxNeighborCount = pObject->maxNeighborCount();
+
+    const std::vector<Candidate>& results = pBuffer.mResults;
+    unsigned int resultCount = results.size();
+    int neighborCount = 0;
+
+    for(unsigned int rI=0; rI<resultCount; ++rI)
+    {
+        if(maxNeighborCount >= 0 && neighborCount >= maxNeighborCount) break;
+        if(results[rI].first > squaredNeighborRadius) break;
+
+        const Node& node = mNodes[results[rI].second];
+        if(node.mVisible == false || node.mObject == pObject) continue;
+
+        pBuffer.mDirection = node.mObject->position() - position;
+        pObject->addNeighbor(node.mObject->spaceObject(), sqrt(results[rI].first), pBuffer.mDirection);
+
+        neighborCount++;
+    }
+}
+
+void
+HNSWAlg::measureRecall( std::vector< SpaceProxyObject* >& pObjects )
+{
+    unsigned int objectCount = pObjects.size();
+    unsigned int sampleCount = std::min(mRecallSampleCount, objectCount);
+    if(sampleCount == 0) return;
+
+    SearchBuffer& buffer = mSearchBuffers[0];
+    unsigned int nodeCount = mNodes.size();
+    unsigned int sampleStep = objectCount / sampleCount;
+    unsigned int exactCount = 0;
+    unsigned int foundCount = 0;
+
+    std::vector<Candidate> exactNeighbors;
+    std::vector<unsigned int> approximateNeighbors;
+
+    for(unsigned int sI=0; sI<sampleCount; ++sI)
+    {
+        SpaceProxyObject* object = pObjects[sI * sampleStep];
+        const float* position = object->position().data();
+        float neighborRadius = object->neighborRadius();
+        float squaredNeighborRadius = neighborRadius >= 0.0 ? neighborRadius * neighborRadius : FLT_MAX;
+        int maxNeighborCount = object->maxNeighborCount();
+        if(maxNeighborCount == 0) continue;
+
+        unsigned int ef = std::max( mEfSearch, static_cast<unsigned int>( std::max(maxNeighborCount, 0) ) );
+        unsigned int neighborLimit = maxNeighborCount > 0 ? maxNeighborCount : ef;
+
+        // exact neighbors
+        exactNeighbors.clear();
+
+        for(unsigned int nI=0; nI<nodeCount; ++nI)
+        {
+            const Node& node = mNodes[nI];
+            if(node.mVisible == false || node.mObject == nullptr || node.mObject == object) continue;
+
+            float distance = squaredDistance(position, nI);
+            if(distance <= squaredNeighborRadius) exactNeighbors.push_back( Candidate(distance, nI) );
+        }
+
+        std::sort(exactNeighbors.begin(), exactNeighbors.end());
+        if(exactNeighbors.size() > neighborLimit) exactNeighbors.resize(neighborLimit);
+
+        // approximate neighbors
+        search(position, ef, buffer);
+        approximateNeighbors.clear();
+
+        unsigned int resultCount = buffer.mResults.size();
+        for(unsigned int rI=0; rI<resultCount && approximateNeighbors.size() < neighborLimit; ++rI)
+        {
+            const Candidate& result = buffer.mResults[rI];
+            const Node& node = mNodes[result.second];
+
+            if(result.first > squaredNeighborRadius) break;
+            if(node.mVisible == false || node.mObject == object) continue;
+
+            approximateNeighbors.push_back(result.second);
+        }
+
+        unsigned int exactNeighborCount = exactNeighbors.size();
+        for(unsigned int eI=0; eI<exactNeighborCount; ++eI)
+        {
+            if( std::find(approximateNeighbors.begin(), approximateNeighbors.end(), exactNeighbors[eI].second) != approximateNeighbors.end() ) foundCount++;
+        }
+
+        exactCount += exactNeighborCount;
+    }
+
+    mRecall = exactCount > 0 ? static_cast<float>(foundCount) / static_cast<float>(exactCount) : 1.0;
+}
+
+HNSWAlg::operator std::string() const
+{
+    return info();
+}
+
+std::string
+HNSWAlg::info() const
+{
+    std::stringstream stream;
+
+    stream << "HNSWAlg\n";
+    stream << "M: " << mM << "\n";
+    stream << "efConstruction: " << mEfConstruction << "\n";
+    stream << "efSearch: " << mEfSearch << "\n";
+    stream << "objectCount: " << mNodeIndices.size() << "\n";
+    stream << "deletedNodeCount: " << mDeletedNodes.size() << "\n";
+    stream << "maxLevel: " << mMaxLevel << "\n";
+    if(mRecallSampleCount > 0) stream << "recall: " << mRecall << " (" << mRecallSampleCount << " samples)\n";
+    stream << SpaceAlg::info();
+
+    return stream.str();
+}
@@ -0,0 +1,303 @@
+/** \file dab_space_alg_hnsw.h
+ */
+
+#ifndef _dab_space_alg_hnsw_h_
+#define _dab_space_alg_hnsw_h_
+
+#include <random>
+#include <unordered_map>
+#include <Eigen/Dense>
+#include "dab_space_alg.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+/**
+ \brief approximate neighbor search based on a hierarchical navigable small world graph
+
+ objects are inserted into the graph when they are added to the space and removed from it when they are removed from the space.\n
+ removed objects are only marked as deleted, their nodes are unlinked in batches during structure updates.\n
+ objects whose position has changed are relinked in place during each structure update.\n
+ invisible objects remain in the graph but are not reported as neighbors.\n
+ suitable for spaces of high dimension in which tree based algorithms degrade to linear scans.\n
+ since neighbors are only searched among the efSearch closest candidates, objects with unlimited neighbor count receive at most efSearch neighbors.
+ */
+class HNSWAlg : public SpaceAlg
+{
+public:
+    /**
+     \brief create hnsw alg
+     \param pDim dimension
+     \param pM maximum number of links per node and layer (twice as many on the lowest layer)
+     \param pEfConstruction number of candidates considered when linking a node
+     \param pEfSearch number of candidates considered when searching neighbors
+     */
+    HNSWAlg(unsigned int pDim, unsigned int pM = 16, unsigned int pEfConstruction = 200, unsigned int pEfSearch = 64);
+
+    /**
+     \brief create hnsw alg
+     \param pMinPos minimum position
+     \param pMaxPos maximum position
+     \param pM maximum number of links per node and layer (twice as many on the lowest layer)
+     \param pEfConstruction number of candidates considered when linking a node
+     \param pEfSearch number of candidates considered when searching neighbors
+     \exception Exception dimension mismatch
+     */
+    HNSWAlg(const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, unsigned int pM = 16, unsigned int pEfConstruction = 200, unsigned int pEfSearch = 64) throw (Exception);
+
+    ~HNSWAlg();
+
+    unsigned int M() const;
+    unsigned int efConstruction() const;
+    unsigned int efSearch() const;
+
+    /**
+     \brief set maximum number of links per node and layer
+     \param pM maximum number of links
+     \exception Exception M is smaller than two
+
+     the graph is rebuilt
+     */
+    void setM(unsigned int pM) throw (Exception);
+
+    /**
+     \brief set number of candidates considered when linking a node
+     \param pEfConstruction number of candidates
+     \exception Exception number of candidates is zero
+     */
+    void setEfConstruction(unsigned int pEfConstruction) throw (Exception);
+
+    /**
+     \brief set number of candidates considered when searching neighbors
+     \param pEfSearch number of candidates
+     \exception Exception number of candidates is zero
+     */
+    void setEfSearch(unsigned int pEfSearch) throw (Exception);
+
+    /**
+     \brief return number of objects whose neighbors are compared with an exact search after each neighbor update
+     \return recall sample count
+     */
+    unsigned int recallSampleCount() const;
+
+    /**
+     \brief set number of objects whose neighbors are compared with an exact search after each neighbor update
+     \param pRecallSampleCount recall sample count (0: recall is not measured)
+     */
+    void setRecallSampleCount(unsigned int pRecallSampleCount);
+
+    /**
+     \brief return recall measured during the last neighbor update
+     \return fraction of exact neighbors that have been found (-1: not measured)
+     */
+    float recall() const;
+
+    /**
+     \brief return number of objects in graph
+     \return object count
+     */
+    unsigned int objectCount() const;
+
+    void addObject( SpaceProxyObject* pObject ) throw (Exception);
+    void removeObject( SpaceProxyObject* pObject ) throw (Exception);
+    void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+    void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+
+    /**
+     \brief symmetric neighbor calculation is not supported
+     \return false
+
+     neighbors are searched in a graph rather than evaluated for pairs of objects
+     */
+    bool symmetricNeighborsSupported() const;
+
+    /**
+     \brief obtain textual hnsw alg information
+     \return String containing textual hnsw alg information
+     */
+    operator std::string() const;
+
+    /**
+     \brief obtain textual hnsw alg information
+     \return String containing textual hnsw alg information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual hnsw alg information
+     \param pOstream output stream
+     \param pAlg hnsw alg
+     */
+    friend std::ostream& operator<< (std::ostream & pOstream, const HNSWAlg& pAlg)
+    {
+        pOstream << std::string(pAlg);
+
+        return pOstream;
+    }
+
+protected:
+    typedef std::pair<float, unsigned int> Candidate; ///\brief squared distance and node index
+
+    /**
+     \brief graph node
+     */
+    class Node
+    {
+    public:
+        SpaceProxyObject* mObject; ///\brief proxy object (nullptr if node is unused)
+        int mLevel; ///\brief highest layer of node
+        bool mVisible; ///\brief node is reported as neighbor
+        std::vector< std::vector<unsigned int> > mLinks; ///\brief links for each layer
+    };
+
+    /**
+     \brief per thread search buffers
+     */
+    class SearchBuffer
+    {
+    public:
+        SearchBuffer();
+
+        std::vector<unsigned int> mVisitStamps; ///\brief visit stamp for each node
+        unsigned int mVisitStamp; ///\brief current visit stamp
+        std::vector<Candidate> mCandidates; ///\brief candidates to expand (min heap)
+        std::vector<Candidate> mResults; ///\brief closest candidates (max heap, sorted after search)
+        Eigen::VectorXf mDirection; ///\brief neighbor direction
+    };
+
+    HNSWAlg();
+
+    const float* nodePosition(unsigned int pNode) const;
+    float squaredDistance(const float* pPosition, unsigned int pNode) const;
+    unsigned int maxLinkCount(int pLevel) const;
+    int randomLevel();
+
+    /**
+     \brief insert object into graph
+     \param pObject proxy object
+     \return node index
+     */
+    unsigned int insertNode( SpaceProxyObject* pObject );
+
+    /**
+     \brief relink node after its position has changed
+     \param pNode node index
+     */
+    void updateNode( unsigned int pNode );
+
+    /**
+     \brief mark node as deleted
+     \param pNode node index
+
+     the node remains traversable until deleted nodes are purged
+     */
+    void deleteNode( unsigned int pNode );
+
+    /**
+     \brief remove deleted nodes from graph and repair the links of nodes that pointed to them
+     */
+    void purgeDeletedNodes();
+
+    /**
+     \brief link node on all its layers by searching the graph from the entry point
+     \param pNode node index
+     */
+    void linkNode( unsigned int pNode );
+
+    /**
+     \brief descend greedily through the layers above a layer
+     \param pPosition query position
+     \param pEntryNode entry node
+     \param pFromLevel highest layer
+     \param pToLevel layer at which descending stops
+     \return closest node found
+     */
+    unsigned int searchGreedy( const float* pPosition, unsigned int pEntryNode, int pFromLevel, int pToLevel ) const;
+
+    /**
+     \brief search closest nodes within one layer
+     \param pPosition query position
+     \param pEntryNode entry node
+     \param pEf number of candidates
+     \param pLevel layer
+     \param pBuffer search buffer, results are stored in ascending order of distance in pBuffer.mResults
+     */
+    void searchLayer( const float* pPosition, unsigned int pEntryNode, unsigned int pEf, int pLevel, SearchBuffer& pBuffer ) const;
+
+    /**
+     \brief search closest nodes in graph
+     \param pPosition query position
+     \param pEf number of candidates
+     \param pBuffer search buffer, results are stored in ascending order of distance in pBuffer.mResults
+     */
+    void search( const float* pPosition, unsigned int pEf, SearchBuffer& pBuffer ) const;
+
+    /**
+     \brief select diverse links among candidates
+     \param pCandidates candidates sorted by ascending distance
+     \param pMaxCount maximum number of links
+     \param pLinks selected links
+
+     a candidate is only selected if it's closer to the query than to any previously selected candidate
+     */
+    void selectLinks( const std::vector<Candidate>& pCandidates, unsigned int pMaxCount, std::vector<unsigned int>& pLinks ) const;
+
+    /**
+     \brief add link from one node to another, pruning the links if they exceed the maximum link count
+     \param pNode node from which link starts
+     \param pLinkedNode node to which link points
+     \param pLevel layer
+     */
+    void addLink( unsigned int pNode, unsigned int pLinkedNode, int pLevel );
+
+    /**
+     \brief reselect links of a node among its current links and additional candidates
+     \param pNode node index
+     \param pAdditionalNodes additional candidate nodes
+     \param pLevel layer
+     */
+    void relinkNode( unsigned int pNode, const std::vector<unsigned int>& pAdditionalNodes, int pLevel );
+
+    /**
+     \brief compare neighbors of sample objects with an exact search
+     \param pObjects objects searching for neighbors
+     */
+    void measureRecall( std::vector< SpaceProxyObject* >& pObjects );
+
+    /**
+     \brief add neighbors found in search buffer to object
+     \param pObject proxy object
+     \param pBuffer search buffer
+     */
+    void addNeighbors( SpaceProxyObject* pObject, SearchBuffer& pBuffer ) const throw (Exception);
+
+    unsigned int mM; ///\brief maximum number of links per node and layer
+    unsigned int mEfConstruction; ///\brief number of candidates considered when linking a node
+    unsigned int mEfSearch; ///\brief number of candidates considered when searching neighbors
+    double mLevelFactor; ///\brief normalization factor for random level generation
+    std::mt19937 mRandomGenerator; ///\brief random generator for level generation
+
+    std::vector<Node> mNodes; ///\brief graph nodes
+    std::vector<float> mPositions; ///\brief node positions (dim values per node)
+    std::vector<unsigned int> mFreeNodes; ///\brief indices of unused nodes
+    std::vector<unsigned int> mDeletedNodes; ///\brief indices of deleted nodes that haven't been purged yet
+    float mPurgeRatio; ///\brief ratio of deleted nodes to all nodes at which deleted nodes are purged
+    std::unordered_map<SpaceProxyObject*, unsigned int> mNodeIndices; ///\brief node index for each proxy object
+    int mEntryNode; ///\brief node at which searches start (-1: graph is empty)
+    int mMaxLevel; ///\brief highest layer of graph
+
+    SearchBuffer mLinkBuffer; ///\brief search buffer used for linking nodes
+    std::vector<SearchBuffer> mSearchBuffers; ///\brief search buffers for each thread
+
+    unsigned int mRecallSampleCount; ///\brief number of objects used for measuring recall
+    float mRecall; ///\brief recall measured during last neighbor update
+};
+
+};
+
+};
+
+#endif
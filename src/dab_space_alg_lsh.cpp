@@ -0,0 +1,359 @@
+/** \file dab_space_alg_lsh.cpp
+ */
+
+#include "dab_space_alg_lsh.h"
+#include "dab_space_proxy_object.h"
+#include "dab_space_simd.h"
+#include "dab_space_parallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace dab;
+using namespace dab::space;
+
+LSHAlg::QueryBuffer::QueryBuffer()
+: mVisitStamp(0)
+, mCandidateCount(0)
+{}
+
+LSHAlg::LSHAlg()
+: SpaceAlg(2)
+, mBucketWidth(1.0)
+, mTableCount(8)
+, mHashCount(4)
+, mProjectionStride(0)
+, mAverageCandidateCount(0.0)
+{
+    createProjections();
+}
+
+LSHAlg::LSHAlg( unsigned int pDim, float pBucketWidth, unsigned int pTableCount, unsigned int pHashCount )
+: SpaceAlg( pDim )
+, mBucketWidth( pBucketWidth > 0.0 ? pBucketWidth : 1.0 )
+, mTableCount( std::max(pTableCount, 1u) )
+, mHashCount( std::max(pHashCount, 1u) )
+, mProjectionStride(0)
+, mAverageCandidateCount(0.0)
+{
+    createProjections();
+}
+
+LSHAlg::LSHAlg( const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, float pBucketWidth, unsigned int pTableCount, unsigned int pHashCount ) throw (Exception)
+: SpaceAlg( pMinPos, pMaxPos )
+, mBucketWidth( pBucketWidth > 0.0 ? pBucketWidth : 1.0 )
+, mTableCount( std::max(pTableCount, 1u) )
+, mHashCount( std::max(pHashCount, 1u) )
+, mProjectionStride(0)
+, mAverageCandidateCount(0.0)
+{
+    createProjections();
+}
+
+LSHAlg::~LSHAlg()
+{}
+
+float
+LSHAlg::bucketWidth() const
+{
+    return mBucketWidth;
+}
+
+unsigned int
+LSHAlg::tableCount() const
+{
+    return mTableCount;
+}
+
+unsigned int
+LSHAlg::hashCount() const
+{
+    return mHashCount;
+}
+
+void
+LSHAlg::setBucketWidth(float pBucketWidth) throw (Exception)
+{
+    if(pBucketWidth <= 0.0) throw Exception("SPACE ERROR: bucket width must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+
+    mBucketWidth = pBucketWidth;
+}
+
+void
+LSHAlg::setTableCount(unsigned int pTableCount, unsigned int pHashCount) throw (Exception)
+{
+    if(pTableCount == 0) throw Exception("SPACE ERROR: table count must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+    if(pHashCount == 0) throw Exception("SPACE ERROR: hash count must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+
+    mTableCount = pTableCount;
+    mHashCount = pHashCount;
+
+    createProjections();
+
+    // tables are refilled during the next structure update
+    mObjects.clear();
+    mObjectKeys.clear();
+    mTables.clear();
+}
+
+float
+LSHAlg::averageCandidateCount() const
+{
+    return mAverageCandidateCount;
+}
+
+void
+LSHAlg::createProjections()
+{
+    unsigned int dim = mMinPos.rows();
+    unsigned int projectionCount = mTableCount * mHashCount;
+
+    std::normal_distribution<float> directionDistribution(0.0, 1.0);
+    std::uniform_real_distribution<float> offsetDistribution(0.0, 1.0);
+
+    mProjectionStride = SpaceSimdTools::pointStride(projectionCount);
+    mProjections.assign(dim * mProjectionStride, 0.0);
+    mOffsets.resize(projectionCount);
+
+    for(unsigned int pI=0; pI<projectionCount; ++pI)
+    {
+        for(unsigned int d=0; d<dim; ++d) mProjections[d * mProjectionStride + pI] = directionDistribution(mRandomGenerator);
+        mOffsets[pI] = offsetDistribution(mRandomGenerator);
+    }
+}
+
+void
+LSHAlg::calculateKeys( const float* pPosition, float* pProjections, uint64_t* pKeys ) const
+{
+    // all projections of a position are obtained with a single kernel call by treating the projection directions as packed points
+    SpaceSimdTools::get().dotProducts(pPosition, mProjections.data(), mProjectionStride, mMinPos.rows(), 0, mTableCount * mHashCount, pProjections);
+
+    float inverseBucketWidth = 1.0 / mBucketWidth;
+
+    for(unsigned int tI=0, pI=0; tI<mTableCount; ++tI)
+    {
+        uint64_t key = 0;
+
+        for(unsigned int hI=0; hI<mHashCount; ++hI, ++pI)
+        {
+            int64_t bucket = static_cast<int64_t>( floor( pProjections[pI] * inverseBucketWidth + mOffsets[pI] ) );
+            key = key * 0x9E3779B97F4A7C15ull + static_cast<uint64_t>(bucket);
+        }
+
+        // key collisions between different buckets only produce additional candidates, which are rejected during verification
+        pKeys[tI] = key ^ ( key >> 31 );
+    }
+}
+
+void
+LSHAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+        unsigned int dim = mMinPos.rows();
+        unsigned int objectCount = pObjects.size();
+        unsigned int threadCount = parallelTools.threadCount();
+        const unsigned int blockSize = 64;
+        unsigned int blockCount = ( objectCount + blockSize - 1 ) / blockSize;
+
+        mObjects = pObjects;
+        mPositions.resize(objectCount * dim);
+        mObjectKeys.resize(objectCount * mTableCount);
+        mTables.resize(mTableCount);
+
+        if(mQueryBuffers.size() < threadCount) mQueryBuffers.resize(threadCount);
+        for(unsigned int tI=0; tI<threadCount; ++tI) mQueryBuffers[tI].mProjections.resize(mTableCount * mHashCount);
+
+        // hash visible objects
+        parallelTools.run(blockCount, [this, &pObjects, objectCount, dim, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            QueryBuffer& buffer = mQueryBuffers[pThreadIndex];
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+
+            for(unsigned int oI=pTaskIndex * blockSize; oI<objectEnd; ++oI)
+            {
+                const float* position = pObjects[oI]->position().data();
+
+                std::copy(position, position + dim, mPositions.begin() + oI * dim);
+                calculateKeys(position, buffer.mProjections.data(), mObjectKeys.data() + oI * mTableCount);
+
+                pObjects[oI]->setIndex(oI);
+            }
+        });
+
+        // fill and sort tables
+        parallelTools.run(mTableCount, [this, objectCount](unsigned int pTaskIndex, unsigned int)
+        {
+            std::vector<BucketEntry>& table = mTables[pTaskIndex];
+            table.resize(objectCount);
+
+            for(unsigned int oI=0; oI<objectCount; ++oI) table[oI] = BucketEntry( mObjectKeys[oI * mTableCount + pTaskIndex], oI );
+
+            std::sort(table.begin(), table.end());
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update lsh tables", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+void
+LSHAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+        unsigned int dim = mMinPos.rows();
+        unsigned int objectCount = pObjects.size();
+        unsigned int threadCount = parallelTools.threadCount();
+        const unsigned int blockSize = 16;
+        unsigned int blockCount = ( objectCount + blockSize - 1 ) / blockSize;
+
+        if(mQueryBuffers.size() < threadCount) mQueryBuffers.resize(threadCount);
+
+        for(unsigned int tI=0; tI<threadCount; ++tI)
+        {
+            QueryBuffer& buffer = mQueryBuffers[tI];
+            buffer.mProjections.resize(mTableCount * mHashCount);
+            buffer.mKeys.resize(mTableCount);
+            buffer.mCandidateCount = 0;
+            if(buffer.mDirection.rows() != dim) buffer.mDirection.resize(dim);
+        }
+
+        parallelTools.run(blockCount, [this, &pObjects, objectCount, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            QueryBuffer& buffer = mQueryBuffers[pThreadIndex];
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+
+            for(unsigned int oI=pTaskIndex * blockSize; oI<objectEnd; ++oI) searchNeighbors(pObjects[oI], buffer);
+        });
+
+        unsigned long candidateCount = 0;
+        for(unsigned int tI=0; tI<threadCount; ++tI) candidateCount += mQueryBuffers[tI].mCandidateCount;
+
+        mAverageCandidateCount = objectCount > 0 ? static_cast<float>(candidateCount) / static_cast<float>(objectCount) : 0.0;
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update neighbors based on lsh tables", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+void
+LSHAlg::searchNeighbors( SpaceProxyObject* pObject, QueryBuffer& pBuffer ) const throw (Exception)
+{
+    pObject->removeNeighbors();
+
+    int maxNeighborCount = pObject->maxNeighborCount();
+    if(maxNeighborCount == 0) return;
+
+    const SpaceSimdTools& simdTools = SpaceSimdTools::get();
+
+    unsigned int dim = mMinPos.rows();
+    unsigned int visibleCount = mObjects.size();
+    const Eigen::VectorXf& position = pObject->position();
+    float neighborRadius = pObject->neighborRadius();
+    float squaredNeighborRadius = neighborRadius >= 0.0 ? neighborRadius * neighborRadius : FLT_MAX;
+
+    // visible objects reuse the keys calculated during the structure update
+    unsigned int selfIndex = pObject->index();
+    const uint64_t* keys;
+
+    if(selfIndex < visibleCount && mObjects[selfIndex] == pObject)
+    {
+        keys = mObjectKeys.data() + selfIndex * mTableCount;
+    }
+    else
+    {
+        selfIndex = visibleCount;
+        calculateKeys(position.data(), pBuffer.mProjections.data(), pBuffer.mKeys.data());
+        keys = pBuffer.mKeys.data();
+    }
+
+    if(pBuffer.mVisitStamps.size() < visibleCount) pBuffer.mVisitStamps.resize(visibleCount, 0);
+    if(++pBuffer.mVisitStamp == 0)
+    {
+        std::fill(pBuffer.mVisitStamps.begin(), pBuffer.mVisitStamps.end(), 0);
+        pBuffer.mVisitStamp = 1;
+    }
+
+    std::vector< std::pair<float, unsigned int> >& candidates = pBuffer.mCandidates;
+    candidates.clear();
+
+    // verify candidates of all buckets the object falls into
+    for(unsigned int tI=0; tI<mTableCount; ++tI)
+    {
+        const std::vector<BucketEntry>& table = mTables[tI];
+        std::vector<BucketEntry>::const_iterator entryIter = std::lower_bound( table.begin(), table.end(), BucketEntry(keys[tI], 0) );
+
+        for(; entryIter != table.end() && entryIter->first == keys[tI]; ++entryIter)
+        {
+            unsigned int index = entryIter->second;
+            if(index == selfIndex || pBuffer.mVisitStamps[index] == pBuffer.mVisitStamp) continue;
+
+            pBuffer.mVisitStamps[index] = pBuffer.mVisitStamp;
+            pBuffer.mCandidateCount++;
+
+            float squaredDistance = simdTools.squaredDistance(position.data(), mPositions.data() + index * dim, dim);
+            if(squaredDistance <= squaredNeighborRadius) candidates.push_back( std::make_pair(squaredDistance, index) );
+        }
+    }
+
+    // closest candidates first so that neighbor count limits keep the nearest neighbors
+    unsigned int candidateCount = candidates.size();
+
+    if(maxNeighborCount > 0 && candidateCount > static_cast<unsigned int>(maxNeighborCount))
+    {
+        std::partial_sort(candidates.begin(), candidates.begin() + maxNeighborCount, candidates.end());
+        candidateCount = maxNeighborCount;
+    }
+    else
+    {
+        std::sort(candidates.begin(), candidates.end());
+    }
+
+    for(unsigned int cI=0; cI<candidateCount; ++cI)
+    {
+        SpaceProxyObject* neighborObject = mObjects[candidates[cI].second];
+        pBuffer.mDirection = neighborObject->position() - position;
+
+        pObject->addNeighbor(neighborObject->spaceObject(), sqrt(candidates[cI].first), pBuffer.mDirection);
+    }
+}
+
+bool
+LSHAlg::symmetricNeighborsSupported() const
+{
+    return false;
+}
+
+LSHAlg::operator std::string() const
+{
+    return info();
+}
+
+std::string
+LSHAlg::info() const
+{
+    std::stringstream stream;
+
+    stream << "LSHAlg\n";
+    stream << "bucketWidth: " << mBucketWidth << "\n";
+    stream << "tableCount: " << mTableCount << "\n";
+    stream << "hashCount: " << mHashCount << "\n";
+    stream << "averageCandidateCount: " << mAverageCandidateCount << "\n";
+    stream << "instructionSet: " << SpaceSimdTools::get().instructionSetName( SpaceSimdTools::get().instructionSet() ) << "\n";
+    stream << SpaceAlg::info();
+
+    return stream.str();
+}
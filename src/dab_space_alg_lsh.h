@@ -0,0 +1,178 @@
+/** \file dab_space_alg_lsh.h
+ */
+
+#ifndef _dab_space_alg_lsh_h_
+#define _dab_space_alg_lsh_h_
+
+#include <random>
+#include <cstdint>
+#include <Eigen/Dense>
+#include "dab_space_alg.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+/**
+ \brief approximate radius search based on locality sensitive hashing
+
+ each visible object is hashed into several tables. each table hash combines several random projections onto gaussian (2-stable) directions that are quantized into buckets of equal width.\n
+ objects that share a bucket with the searching object in at least one table are candidates, candidates are verified against their true distance before they are added as neighbors.\n
+ the tables are rebuilt during each structure update, which only requires projecting and sorting the visible objects.\n
+ the bucket width should be a few times the neighbor radius: larger widths increase recall and the number of candidates to verify.\n
+ more tables increase recall, more hashes per table decrease the number of candidates.
+ */
+class LSHAlg : public SpaceAlg
+{
+public:
+    /**
+     \brief create lsh alg
+     \param pDim dimension
+     \param pBucketWidth width of projection buckets
+     \param pTableCount number of hash tables
+     \param pHashCount number of projections per hash table
+     */
+    LSHAlg(unsigned int pDim, float pBucketWidth = 1.0, unsigned int pTableCount = 8, unsigned int pHashCount = 4);
+
+    /**
+     \brief create lsh alg
+     \param pMinPos minimum position
+     \param pMaxPos maximum position
+     \param pBucketWidth width of projection buckets
+     \param pTableCount number of hash tables
+     \param pHashCount number of projections per hash table
+     \exception Exception dimension mismatch
+     */
+    LSHAlg(const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, float pBucketWidth = 1.0, unsigned int pTableCount = 8, unsigned int pHashCount = 4) throw (Exception);
+
+    ~LSHAlg();
+
+    float bucketWidth() const;
+    unsigned int tableCount() const;
+    unsigned int hashCount() const;
+
+    /**
+     \brief set width of projection buckets
+     \param pBucketWidth bucket width
+     \exception Exception bucket width is not positive
+     */
+    void setBucketWidth(float pBucketWidth) throw (Exception);
+
+    /**
+     \brief set number of hash tables and projections per hash table
+     \param pTableCount number of hash tables
+     \param pHashCount number of projections per hash table
+     \exception Exception table count or hash count is zero
+
+     new random projections are created
+     */
+    void setTableCount(unsigned int pTableCount, unsigned int pHashCount) throw (Exception);
+
+    /**
+     \brief return average number of candidates verified per object during the last neighbor update
+     \return average candidate count
+     */
+    float averageCandidateCount() const;
+
+    void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+    void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+
+    /**
+     \brief symmetric neighbor calculation is not supported
+     \return false
+
+     neighbors are searched among hash buckets rather than evaluated for pairs of objects
+     */
+    bool symmetricNeighborsSupported() const;
+
+    /**
+     \brief obtain textual lsh alg information
+     \return String containing textual lsh alg information
+     */
+    operator std::string() const;
+
+    /**
+     \brief obtain textual lsh alg information
+     \return String containing textual lsh alg information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual lsh alg information
+     \param pOstream output stream
+     \param pAlg lsh alg
+     */
+    friend std::ostream& operator<< (std::ostream & pOstream, const LSHAlg& pAlg)
+    {
+        pOstream << std::string(pAlg);
+
+        return pOstream;
+    }
+
+protected:
+    typedef std::pair<uint64_t, unsigned int> BucketEntry; ///\brief bucket key and visible object index
+
+    /**
+     \brief per thread query buffers
+     */
+    class QueryBuffer
+    {
+    public:
+        QueryBuffer();
+
+        std::vector<float> mProjections; ///\brief projections of query position
+        std::vector<uint64_t> mKeys; ///\brief bucket key for each table
+        std::vector<unsigned int> mVisitStamps; ///\brief visit stamp for each visible object
+        unsigned int mVisitStamp; ///\brief current visit stamp
+        std::vector< std::pair<float, unsigned int> > mCandidates; ///\brief verified candidates (squared distance and visible object index)
+        Eigen::VectorXf mDirection; ///\brief neighbor direction
+        unsigned long mCandidateCount; ///\brief number of candidates verified during the current neighbor update
+    };
+
+    LSHAlg();
+
+    /**
+     \brief create random projection directions and offsets
+     */
+    void createProjections();
+
+    /**
+     \brief calculate bucket keys of a position
+     \param pPosition position
+     \param pProjections projection buffer (tableCount * hashCount values)
+     \param pKeys resulting bucket key for each table
+     */
+    void calculateKeys( const float* pPosition, float* pProjections, uint64_t* pKeys ) const;
+
+    /**
+     \brief search neighbors of an object
+     \param pObject proxy object
+     \param pBuffer query buffer
+     */
+    void searchNeighbors( SpaceProxyObject* pObject, QueryBuffer& pBuffer ) const throw (Exception);
+
+    float mBucketWidth; ///\brief width of projection buckets
+    unsigned int mTableCount; ///\brief number of hash tables
+    unsigned int mHashCount; ///\brief number of projections per hash table
+    std::mt19937 mRandomGenerator; ///\brief random generator for projections
+
+    std::vector<float> mProjections; ///\brief projection directions, packed dimension by dimension (see SpaceSimdTools)
+    unsigned int mProjectionStride; ///\brief stride of packed projection directions
+    std::vector<float> mOffsets; ///\brief random offset for each projection (in bucket units)
+
+    std::vector< SpaceProxyObject* > mObjects; ///\brief visible objects
+    std::vector<float> mPositions; ///\brief positions of visible objects (dim values per object)
+    std::vector<uint64_t> mObjectKeys; ///\brief bucket keys of visible objects (tableCount values per object)
+    std::vector< std::vector<BucketEntry> > mTables; ///\brief hash tables, entries sorted by bucket key
+
+    std::vector<QueryBuffer> mQueryBuffers; ///\brief query buffers for each thread
+    float mAverageCandidateCount; ///\brief average number of candidates verified per object during last neighbor update
+};
+
+};
+
+};
+
+#endif
@@ -0,0 +1,588 @@
+/** \file dab_space_alg_nndescent.cpp
+ */
+
+#include "dab_space_alg_nndescent.h"
+#include "dab_space_proxy_object.h"
+#include "dab_space_neighbor_group.h"
+#include "dab_space_neighbor_relation.h"
+#include "dab_space_simd.h"
+#include "dab_space_parallel.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace dab;
+using namespace dab::space;
+
+NNDescentAlg::NNDescentAlg()
+: SpaceAlg(2)
+, mGraphNeighborCount(16)
+, mIterationCount(2)
+, mSampleRate(0.5)
+, mTerminationRate(0.001)
+, mLastIterationCount(0)
+, mLastUpdateRate(0.0)
+, mFrame(0)
+, mNodeCapacity(0)
+, mJoinCapacity(0)
+, mPreviousCapacity(0)
+{}
+
+NNDescentAlg::NNDescentAlg( unsigned int pDim, unsigned int pGraphNeighborCount, unsigned int pIterationCount )
+: SpaceAlg( pDim )
+, mGraphNeighborCount( std::max(pGraphNeighborCount, 1u) )
+, mIterationCount( std::max(pIterationCount, 1u) )
+, mSampleRate(0.5)
+, mTerminationRate(0.001)
+, mLastIterationCount(0)
+, mLastUpdateRate(0.0)
+, mFrame(0)
+, mNodeCapacity(0)
+, mJoinCapacity(0)
+, mPreviousCapacity(0)
+{}
+
+NNDescentAlg::NNDescentAlg( const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, unsigned int pGraphNeighborCount, unsigned int pIterationCount ) throw (Exception)
+: SpaceAlg( pMinPos, pMaxPos )
+, mGraphNeighborCount( std::max(pGraphNeighborCount, 1u) )
+, mIterationCount( std::max(pIterationCount, 1u) )
+, mSampleRate(0.5)
+, mTerminationRate(0.001)
+, mLastIterationCount(0)
+, mLastUpdateRate(0.0)
+, mFrame(0)
+, mNodeCapacity(0)
+, mJoinCapacity(0)
+, mPreviousCapacity(0)
+{}
+
+NNDescentAlg::~NNDescentAlg()
+{}
+
+unsigned int
+NNDescentAlg::graphNeighborCount() const
+{
+    return mGraphNeighborCount;
+}
+
+unsigned int
+NNDescentAlg::iterationCount() const
+{
+    return mIterationCount;
+}
+
+float
+NNDescentAlg::sampleRate() const
+{
+    return mSampleRate;
+}
+
+float
+NNDescentAlg::terminationRate() const
+{
+    return mTerminationRate;
+}
+
+void
+NNDescentAlg::setGraphNeighborCount(unsigned int pGraphNeighborCount) throw (Exception)
+{
+    if(pGraphNeighborCount == 0) throw Exception("SPACE ERROR: graph neighbor count must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+
+    mGraphNeighborCount = pGraphNeighborCount;
+}
+
+void
+NNDescentAlg::setIterationCount(unsigned int pIterationCount) throw (Exception)
+{
+    if(pIterationCount == 0) throw Exception("SPACE ERROR: iteration count must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+
+    mIterationCount = pIterationCount;
+}
+
+void
+NNDescentAlg::setSampleRate(float pSampleRate) throw (Exception)
+{
+    if(pSampleRate <= 0.0 || pSampleRate > 1.0) throw Exception("SPACE ERROR: sample rate " + std::to_string(pSampleRate) + " must be larger than zero and not larger than one", __FILE__, __FUNCTION__, __LINE__);
+
+    mSampleRate = pSampleRate;
+}
+
+void
+NNDescentAlg::setTerminationRate(float pTerminationRate) throw (Exception)
+{
+    if(pTerminationRate < 0.0 || pTerminationRate > 1.0) throw Exception("SPACE ERROR: termination rate " + std::to_string(pTerminationRate) + " must be between zero and one", __FILE__, __FUNCTION__, __LINE__);
+
+    mTerminationRate = pTerminationRate;
+}
+
+unsigned int
+NNDescentAlg::lastIterationCount() const
+{
+    return mLastIterationCount;
+}
+
+float
+NNDescentAlg::lastUpdateRate() const
+{
+    return mLastUpdateRate;
+}
+
+float
+NNDescentAlg::squaredDistance( const float* pPosition, unsigned int pIndex ) const
+{
+    unsigned int dim = mMinPos.rows();
+
+    return SpaceSimdTools::get().squaredDistance(pPosition, mPositions.data() + pIndex * dim, dim);
+}
+
+bool
+NNDescentAlg::insertEntry( Entry* pEntries, unsigned int& pCount, unsigned int pCapacity, float pDistance, unsigned int pIndex ) const
+{
+    if(pCount == pCapacity && pDistance >= pEntries[pCount - 1].mDistance) return false;
+
+    for(unsigned int eI=0; eI<pCount; ++eI) if(pEntries[eI].mIndex == pIndex) return false;
+
+    unsigned int position = std::min(pCount, pCapacity - 1);
+    while(position > 0 && pEntries[position - 1].mDistance > pDistance)
+    {
+        pEntries[position] = pEntries[position - 1];
+        position--;
+    }
+
+    pEntries[position].mDistance = pDistance;
+    pEntries[position].mIndex = pIndex;
+    pEntries[position].mNew = true;
+
+    if(pCount < pCapacity) pCount++;
+
+    return true;
+}
+
+void
+NNDescentAlg::initNode( unsigned int pIndex )
+{
+    unsigned int objectCount = mObjects.size();
+    unsigned int capacity = std::min(mNodeCapacity, objectCount - 1);
+    const float* position = mPositions.data() + pIndex * mMinPos.rows();
+    Entry* entries = mGraph.data() + pIndex * mNodeCapacity;
+    unsigned int& count = mGraphCounts[pIndex];
+    count = 0;
+
+    if(capacity == 0) return;
+
+    // neighbors from previous graph
+    std::unordered_map<SpaceObject*, unsigned int>::const_iterator rowIter = mPreviousNodes.find( mObjects[pIndex]->spaceObject() );
+    if(rowIter != mPreviousNodes.end())
+    {
+        SpaceObject* const* row = mPreviousGraph.data() + rowIter->second * mPreviousCapacity;
+        unsigned int rowCount = mPreviousCounts[rowIter->second];
+
+        for(unsigned int nI=0; nI<rowCount; ++nI)
+        {
+            std::unordered_map<SpaceObject*, unsigned int>::const_iterator indexIter = mIndices.find( row[nI] );
+            if(indexIter == mIndices.end() || indexIter->second == pIndex) continue;
+
+            insertEntry(entries, count, capacity, squaredDistance(position, indexIter->second), indexIter->second);
+        }
+    }
+
+    // neighbors from neighbor group
+    std::vector<SpaceNeighborRelation*>& relations = mObjects[pIndex]->neighborGroup()->neighborRelations();
+    unsigned int relationCount = relations.size();
+
+    for(unsigned int rI=0; rI<relationCount; ++rI)
+    {
+        std::unordered_map<SpaceObject*, unsigned int>::const_iterator indexIter = mIndices.find( relations[rI]->neighbor() );
+        if(indexIter == mIndices.end() || indexIter->second == pIndex) continue;
+
+        insertEntry(entries, count, capacity, squaredDistance(position, indexIter->second), indexIter->second);
+    }
+
+    // random samples
+    uint64_t random = ( static_cast<uint64_t>(pIndex) + 1 ) * 0x9E3779B97F4A7C15ull ^ ( static_cast<uint64_t>(mFrame) << 32 );
+    unsigned int maxAttemptCount = 4 * capacity;
+
+    for(unsigned int aI=0; aI<maxAttemptCount && count < capacity; ++aI)
+    {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+
+        unsigned int sampleIndex = random % objectCount;
+        if(sampleIndex == pIndex) continue;
+
+        insertEntry(entries, count, capacity, squaredDistance(position, sampleIndex), sampleIndex);
+    }
+
+    for(unsigned int eI=0; eI<count; ++eI) entries[eI].mNew = true;
+}
+
+void
+NNDescentAlg::sampleNode( unsigned int pIndex )
+{
+    Entry* entries = mGraph.data() + pIndex * mNodeCapacity;
+    unsigned int count = mGraphCounts[pIndex];
+    unsigned int* newJoint = mNewJoint.data() + pIndex * mJoinCapacity;
+    unsigned int* oldJoint = mOldJoint.data() + pIndex * mJoinCapacity;
+    unsigned int sampleCount = std::max( static_cast<unsigned int>( ceil(mSampleRate * mNodeCapacity) ), 1u );
+    unsigned int newCount = 0;
+    unsigned int oldCount = 0;
+
+    for(unsigned int eI=0; eI<count; ++eI)
+    {
+        Entry& entry = entries[eI];
+
+        if(entry.mNew == false) oldJoint[oldCount++] = entry.mIndex;
+        else if(newCount < sampleCount)
+        {
+            newJoint[newCount++] = entry.mIndex;
+            entry.mNew = false;
+        }
+    }
+
+    mNewJointCounts[pIndex] = newCount;
+    mOldJointCounts[pIndex] = oldCount;
+}
+
+void
+NNDescentAlg::joinNode( unsigned int pIndex, RefineBuffer& pBuffer )
+{
+    unsigned int capacity = std::min(mNodeCapacity, static_cast<unsigned int>(mObjects.size()) - 1);
+    const float* position = mPositions.data() + pIndex * mMinPos.rows();
+    Entry* entries = mGraph.data() + pIndex * mNodeCapacity;
+    unsigned int& count = mGraphCounts[pIndex];
+    const unsigned int* newJoint = mNewJoint.data() + pIndex * mJoinCapacity;
+    const unsigned int* oldJoint = mOldJoint.data() + pIndex * mJoinCapacity;
+    unsigned int newCount = mNewJointCounts[pIndex];
+    unsigned int oldCount = mOldJointCounts[pIndex];
+
+    pBuffer.mVisitStamp++;
+    pBuffer.mVisitStamps[pIndex] = pBuffer.mVisitStamp;
+    for(unsigned int eI=0; eI<count; ++eI) pBuffer.mVisitStamps[ entries[eI].mIndex ] = pBuffer.mVisitStamp;
+
+    // new joint neighbors are compared with all joint neighbors of the object, old joint neighbors only with new ones
+    for(unsigned int jI=0; jI<newCount + oldCount; ++jI)
+    {
+        bool newNeighbor = jI < newCount;
+        unsigned int neighborIndex = newNeighbor ? newJoint[jI] : oldJoint[jI - newCount];
+
+        for(unsigned int listI=0; listI<( newNeighbor ? 2u : 1u ); ++listI)
+        {
+            const unsigned int* candidates = ( listI == 0 ? mNewJoint.data() : mOldJoint.data() ) + neighborIndex * mJoinCapacity;
+            unsigned int candidateCount = listI == 0 ? mNewJointCounts[neighborIndex] : mOldJointCounts[neighborIndex];
+
+            for(unsigned int cI=0; cI<candidateCount; ++cI)
+            {
+                unsigned int candidateIndex = candidates[cI];
+                if(pBuffer.mVisitStamps[candidateIndex] == pBuffer.mVisitStamp) continue;
+                pBuffer.mVisitStamps[candidateIndex] = pBuffer.mVisitStamp;
+
+                if( insertEntry(entries, count, capacity, squaredDistance(position, candidateIndex), candidateIndex) == true ) pBuffer.mUpdateCount++;
+            }
+        }
+    }
+}
+
+void
+NNDescentAlg::searchGraph( SpaceProxyObject* pObject, RefineBuffer& pBuffer )
+{
+    unsigned int objectCount = mObjects.size();
+    unsigned int capacity = std::min(mNodeCapacity, objectCount);
+    const float* position = pObject->position().data();
+
+    pBuffer.mEntries.resize(mNodeCapacity);
+    Entry* entries = pBuffer.mEntries.data();
+    unsigned int count = 0;
+
+    if(capacity == 0)
+    {
+        pBuffer.mEntries.clear();
+        return;
+    }
+
+    pBuffer.mVisitStamp++;
+
+    // start from current neighbors and random samples
+    std::vector<SpaceNeighborRelation*>& relations = pObject->neighborGroup()->neighborRelations();
+    unsigned int relationCount = relations.size();
+
+    for(unsigned int rI=0; rI<relationCount; ++rI)
+    {
+        std::unordered_map<SpaceObject*, unsigned int>::const_iterator indexIter = mIndices.find( relations[rI]->neighbor() );
+        if(indexIter == mIndices.end() || pBuffer.mVisitStamps[indexIter->second] == pBuffer.mVisitStamp) continue;
+        pBuffer.mVisitStamps[indexIter->second] = pBuffer.mVisitStamp;
+
+        insertEntry(entries, count, capacity, squaredDistance(position, indexIter->second), indexIter->second);
+    }
+
+    uint64_t random = reinterpret_cast<uint64_t>(pObject) * 0x9E3779B97F4A7C15ull ^ ( static_cast<uint64_t>(mFrame) << 32 );
+    unsigned int maxAttemptCount = 4 * capacity;
+
+    for(unsigned int aI=0; aI<maxAttemptCount && count < capacity; ++aI)
+    {
+        random ^= random << 13;
+        random ^= random >> 7;
+        random ^= random << 17;
+
+        unsigned int sampleIndex = random % objectCount;
+        if(pBuffer.mVisitStamps[sampleIndex] == pBuffer.mVisitStamp) continue;
+        pBuffer.mVisitStamps[sampleIndex] = pBuffer.mVisitStamp;
+
+        insertEntry(entries, count, capacity, squaredDistance(position, sampleIndex), sampleIndex);
+    }
+
+    // greedy descent: expand closest unexpanded entry (flagged new) until all entries have been expanded
+    while(true)
+    {
+        unsigned int expandIndex = 0;
+        while(expandIndex < count && entries[expandIndex].mNew == false) expandIndex++;
+        if(expandIndex == count) break;
+
+        entries[expandIndex].mNew = false;
+
+        unsigned int nodeIndex = entries[expandIndex].mIndex;
+        const Entry* nodeEntries = mGraph.data() + nodeIndex * mNodeCapacity;
+        unsigned int nodeCount = mGraphCounts[nodeIndex];
+
+        for(unsigned int eI=0; eI<nodeCount; ++eI)
+        {
+            unsigned int candidateIndex = nodeEntries[eI].mIndex;
+            if(pBuffer.mVisitStamps[candidateIndex] == pBuffer.mVisitStamp) continue;
+            pBuffer.mVisitStamps[candidateIndex] = pBuffer.mVisitStamp;
+
+            insertEntry(entries, count, capacity, squaredDistance(position, candidateIndex), candidateIndex);
+        }
+    }
+
+    pBuffer.mEntries.resize(count);
+}
+
+void
+NNDescentAlg::addNeighbors( SpaceProxyObject* pObject, const Entry* pEntries, unsigned int pEntryCount, RefineBuffer& pBuffer ) throw (Exception)
+{
+    const Eigen::VectorXf& position = pObject->position();
+    float neighborRadius = pObject->neighborRadius();
+    int maxNeighborCount = pObject->maxNeighborCount();
+    unsigned int neighborCount = maxNeighborCount >= 0 ? std::min( pEntryCount, static_cast<unsigned int>(maxNeighborCount) ) : pEntryCount;
+
+    for(unsigned int eI=0; eI<neighborCount; ++eI)
+    {
+        const Entry& entry = pEntries[eI];
+        float distance = sqrt(entry.mDistance);
+
+        if(neighborRadius >= 0.0 && distance > neighborRadius) break;
+
+        SpaceProxyObject* neighborObject = mObjects[entry.mIndex];
+        pBuffer.mDirection = neighborObject->position() - position;
+
+        pObject->addNeighbor(neighborObject->spaceObject(), distance, pBuffer.mDirection);
+    }
+}
+
+void
+NNDescentAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    unsigned int dim = mMinPos.rows();
+    unsigned int objectCount = pObjects.size();
+
+    mObjects = pObjects;
+    mPositions.resize(objectCount * dim);
+    mIndices.clear();
+    mIndices.reserve(objectCount);
+
+    for(unsigned int oI=0; oI<objectCount; ++oI)
+    {
+        SpaceProxyObject* object = pObjects[oI];
+        object->setIndex(oI);
+        std::copy(object->position().data(), object->position().data() + dim, mPositions.data() + oI * dim);
+        mIndices[object->spaceObject()] = oI;
+    }
+}
+
+void
+NNDescentAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+        unsigned int dim = mMinPos.rows();
+        unsigned int visibleCount = mObjects.size();
+        unsigned int neighborObjectCount = pObjects.size();
+        unsigned int threadCount = parallelTools.threadCount();
+        const unsigned int nodeBlockSize = 64;
+        const unsigned int queryBlockSize = 16;
+        unsigned int nodeBlockCount = ( visibleCount + nodeBlockSize - 1 ) / nodeBlockSize;
+        unsigned int queryBlockCount = ( neighborObjectCount + queryBlockSize - 1 ) / queryBlockSize;
+
+        mFrame++;
+
+        // graph stores at least as many neighbors as any object requests
+        mNodeCapacity = mGraphNeighborCount;
+        for(unsigned int oI=0; oI<neighborObjectCount; ++oI)
+        {
+            int maxNeighborCount = pObjects[oI]->maxNeighborCount();
+            if(maxNeighborCount > 0) mNodeCapacity = std::max( mNodeCapacity, static_cast<unsigned int>(maxNeighborCount) );
+        }
+
+        unsigned int sampleCount = std::max( static_cast<unsigned int>( ceil(mSampleRate * mNodeCapacity) ), 1u );
+        mJoinCapacity = mNodeCapacity + sampleCount;
+
+        mGraph.resize(visibleCount * mNodeCapacity);
+        mGraphCounts.assign(visibleCount, 0);
+        mNewJoint.resize(visibleCount * mJoinCapacity);
+        mOldJoint.resize(visibleCount * mJoinCapacity);
+        mNewJointCounts.assign(visibleCount, 0);
+        mOldJointCounts.assign(visibleCount, 0);
+
+        if(mRefineBuffers.size() < threadCount) mRefineBuffers.resize(threadCount);
+        for(unsigned int tI=0; tI<threadCount; ++tI)
+        {
+            RefineBuffer& buffer = mRefineBuffers[tI];
+            if(buffer.mVisitStamps.size() != visibleCount)
+            {
+                buffer.mVisitStamps.assign(visibleCount, 0);
+                buffer.mVisitStamp = 0;
+            }
+            if(buffer.mDirection.rows() != dim) buffer.mDirection.resize(dim);
+        }
+
+        mLastIterationCount = 0;
+        mLastUpdateRate = 0.0;
+
+        if(visibleCount > 1)
+        {
+            // warm start
+            parallelTools.run(nodeBlockCount, [this, visibleCount, nodeBlockSize](unsigned int pTaskIndex, unsigned int)
+            {
+                unsigned int nodeEnd = std::min( (pTaskIndex + 1) * nodeBlockSize, visibleCount );
+                for(unsigned int nI=pTaskIndex * nodeBlockSize; nI<nodeEnd; ++nI) initNode(nI);
+            });
+
+            std::vector<unsigned int> newForwardCounts(visibleCount);
+            std::vector<unsigned int> oldForwardCounts(visibleCount);
+
+            for(unsigned int iteration=0; iteration<mIterationCount; ++iteration)
+            {
+                parallelTools.run(nodeBlockCount, [this, visibleCount, nodeBlockSize](unsigned int pTaskIndex, unsigned int)
+                {
+                    unsigned int nodeEnd = std::min( (pTaskIndex + 1) * nodeBlockSize, visibleCount );
+                    for(unsigned int nI=pTaskIndex * nodeBlockSize; nI<nodeEnd; ++nI) sampleNode(nI);
+                });
+
+                // at most sampleCount reverse neighbors are appended to the joint neighbors, the first node visited changes every iteration so that no nodes are favored
+                newForwardCounts = mNewJointCounts;
+                oldForwardCounts = mOldJointCounts;
+
+                unsigned int firstNode = ( mFrame * mIterationCount + iteration ) * 7919 % visibleCount;
+
+                for(unsigned int vI=0; vI<visibleCount; ++vI)
+                {
+                    unsigned int nI = ( firstNode + vI ) % visibleCount;
+                    const unsigned int* newJoint = mNewJoint.data() + nI * mJoinCapacity;
+                    const unsigned int* oldJoint = mOldJoint.data() + nI * mJoinCapacity;
+
+                    for(unsigned int jI=0; jI<newForwardCounts[nI]; ++jI)
+                    {
+                        unsigned int reverseIndex = newJoint[jI];
+                        if(mNewJointCounts[reverseIndex] < newForwardCounts[reverseIndex] + sampleCount) mNewJoint[reverseIndex * mJoinCapacity + mNewJointCounts[reverseIndex]++] = nI;
+                    }
+
+                    for(unsigned int jI=0; jI<oldForwardCounts[nI]; ++jI)
+                    {
+                        unsigned int reverseIndex = oldJoint[jI];
+                        if(mOldJointCounts[reverseIndex] < oldForwardCounts[reverseIndex] + sampleCount) mOldJoint[reverseIndex * mJoinCapacity + mOldJointCounts[reverseIndex]++] = nI;
+                    }
+                }
+
+                for(unsigned int tI=0; tI<threadCount; ++tI) mRefineBuffers[tI].mUpdateCount = 0;
+
+                parallelTools.run(nodeBlockCount, [this, visibleCount, nodeBlockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+                {
+                    unsigned int nodeEnd = std::min( (pTaskIndex + 1) * nodeBlockSize, visibleCount );
+                    for(unsigned int nI=pTaskIndex * nodeBlockSize; nI<nodeEnd; ++nI) joinNode(nI, mRefineBuffers[pThreadIndex]);
+                });
+
+                unsigned long updateCount = 0;
+                for(unsigned int tI=0; tI<threadCount; ++tI) updateCount += mRefineBuffers[tI].mUpdateCount;
+
+                mLastIterationCount = iteration + 1;
+                mLastUpdateRate = static_cast<float>(updateCount) / static_cast<float>( visibleCount * std::min(mNodeCapacity, visibleCount - 1) );
+
+                if(mLastUpdateRate < mTerminationRate) break;
+            }
+        }
+
+        parallelTools.run(queryBlockCount, [this, &pObjects, neighborObjectCount, queryBlockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            RefineBuffer& buffer = mRefineBuffers[pThreadIndex];
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * queryBlockSize, neighborObjectCount );
+
+            for(unsigned int oI=pTaskIndex * queryBlockSize; oI<objectEnd; ++oI)
+            {
+                SpaceProxyObject* object = pObjects[oI];
+                unsigned int objectIndex = object->index();
+                bool visible = objectIndex < mObjects.size() && mObjects[objectIndex] == object;
+
+                if(visible == false) searchGraph(object, buffer);
+
+                object->removeNeighbors();
+
+                if(visible == true) addNeighbors(object, mGraph.data() + objectIndex * mNodeCapacity, mGraphCounts[objectIndex], buffer);
+                else addNeighbors(object, buffer.mEntries.data(), buffer.mEntries.size(), buffer);
+            }
+        });
+
+        // keep graph as starting point for next neighbor update
+        mPreviousCapacity = mNodeCapacity;
+        mPreviousGraph.resize(visibleCount * mPreviousCapacity);
+        mPreviousCounts = mGraphCounts;
+        mPreviousNodes.clear();
+        mPreviousNodes.reserve(visibleCount);
+
+        for(unsigned int nI=0; nI<visibleCount; ++nI)
+        {
+            mPreviousNodes[ mObjects[nI]->spaceObject() ] = nI;
+
+            const Entry* entries = mGraph.data() + nI * mNodeCapacity;
+            SpaceObject** row = mPreviousGraph.data() + nI * mPreviousCapacity;
+            for(unsigned int eI=0; eI<mGraphCounts[nI]; ++eI) row[eI] = mObjects[ entries[eI].mIndex ]->spaceObject();
+        }
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update neighbors based on nndescent graph", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+bool
+NNDescentAlg::symmetricNeighborsSupported() const
+{
+    return false;
+}
+
+NNDescentAlg::operator std::string() const
+{
+    return info();
+}
+
+std::string
+NNDescentAlg::info() const
+{
+    std::stringstream stream;
+
+    stream << "NNDescentAlg\n";
+    stream << "graphNeighborCount: " << mGraphNeighborCount << "\n";
+    stream << "iterationCount: " << mIterationCount << "\n";
+    stream << "sampleRate: " << mSampleRate << "\n";
+    stream << "terminationRate: " << mTerminationRate << "\n";
+    stream << "lastIterationCount: " << mLastIterationCount << "\n";
+    stream << "lastUpdateRate: " << mLastUpdateRate << "\n";
+    stream << SpaceAlg::info();
+
+    return stream.str();
+}
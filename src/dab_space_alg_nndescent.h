@@ -0,0 +1,246 @@
+/** \file dab_space_alg_nndescent.h
+ */
+
+#ifndef _dab_space_alg_nndescent_h_
+#define _dab_space_alg_nndescent_h_
+
+#include <unordered_map>
+#include <Eigen/Dense>
+#include "dab_space_alg.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+class SpaceObject;
+
+/**
+ \brief approximate all k nearest neighbor graph refined by nn-descent
+
+ instead of building an index and querying it for each object, the alg maintains a graph that links each visible object to its closest visible objects found so far.\n
+ the graph is refined by comparing neighbors of neighbors (local join) and converges within a few iterations. each neighbor update only runs a bounded number of iterations.\n
+ the graph of the previous neighbor update and the current neighbor groups serve as starting point, objects that move smoothly therefore keep converging at a fraction of the cost of a rebuild.\n
+ invisible objects search their neighbors by greedy descent through the graph.\n
+ since neighbors are taken from the graph, objects receive at most graphNeighborCount neighbors (or their maximum neighbor count if it is larger), radius limits are applied to these neighbors only.
+ */
+class NNDescentAlg : public SpaceAlg
+{
+public:
+    /**
+     \brief create nndescent alg
+     \param pDim dimension
+     \param pGraphNeighborCount number of neighbors per visible object stored in the graph
+     \param pIterationCount maximum number of refinement iterations per neighbor update
+     */
+    NNDescentAlg(unsigned int pDim, unsigned int pGraphNeighborCount = 16, unsigned int pIterationCount = 2);
+
+    /**
+     \brief create nndescent alg
+     \param pMinPos minimum position
+     \param pMaxPos maximum position
+     \param pGraphNeighborCount number of neighbors per visible object stored in the graph
+     \param pIterationCount maximum number of refinement iterations per neighbor update
+     \exception Exception dimension mismatch
+     */
+    NNDescentAlg(const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, unsigned int pGraphNeighborCount = 16, unsigned int pIterationCount = 2) throw (Exception);
+
+    ~NNDescentAlg();
+
+    unsigned int graphNeighborCount() const;
+    unsigned int iterationCount() const;
+    float sampleRate() const;
+    float terminationRate() const;
+
+    /**
+     \brief set number of neighbors per visible object stored in the graph
+     \param pGraphNeighborCount graph neighbor count
+     \exception Exception graph neighbor count is zero
+     */
+    void setGraphNeighborCount(unsigned int pGraphNeighborCount) throw (Exception);
+
+    /**
+     \brief set maximum number of refinement iterations per neighbor update
+     \param pIterationCount iteration count
+     \exception Exception iteration count is zero
+     */
+    void setIterationCount(unsigned int pIterationCount) throw (Exception);
+
+    /**
+     \brief set fraction of new graph neighbors that take part in a local join
+     \param pSampleRate sample rate
+     \exception Exception sample rate outside of range (0.0, 1.0]
+     */
+    void setSampleRate(float pSampleRate) throw (Exception);
+
+    /**
+     \brief set fraction of changed graph entries below which refinement stops early
+     \param pTerminationRate termination rate
+     \exception Exception termination rate outside of range [0.0, 1.0]
+     */
+    void setTerminationRate(float pTerminationRate) throw (Exception);
+
+    /**
+     \brief return number of refinement iterations run during the last neighbor update
+     \return iteration count
+     */
+    unsigned int lastIterationCount() const;
+
+    /**
+     \brief return fraction of graph entries that changed during the last refinement iteration
+     \return update rate
+     */
+    float lastUpdateRate() const;
+
+    void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+    void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+
+    /**
+     \brief symmetric neighbor calculation is not supported
+     \return false
+
+     neighbors are taken from a graph rather than evaluated for pairs of objects
+     */
+    bool symmetricNeighborsSupported() const;
+
+    /**
+     \brief obtain textual nndescent alg information
+     \return String containing textual nndescent alg information
+     */
+    operator std::string() const;
+
+    /**
+     \brief obtain textual nndescent alg information
+     \return String containing textual nndescent alg information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual nndescent alg information
+     \param pOstream output stream
+     \param pAlg nndescent alg
+     */
+    friend std::ostream& operator<< (std::ostream & pOstream, const NNDescentAlg& pAlg)
+    {
+        pOstream << std::string(pAlg);
+
+        return pOstream;
+    }
+
+protected:
+    /**
+     \brief graph entry
+     */
+    class Entry
+    {
+    public:
+        float mDistance; ///\brief squared distance
+        unsigned int mIndex; ///\brief visible object index
+        bool mNew; ///\brief entry hasn't taken part in a local join yet
+    };
+
+    /**
+     \brief per thread refinement buffers
+     */
+    class RefineBuffer
+    {
+    public:
+        std::vector<unsigned int> mVisitStamps; ///\brief stamp of last visit for each visible object
+        unsigned int mVisitStamp; ///\brief current visit stamp
+        std::vector<Entry> mEntries; ///\brief entries of an invisible object
+        Eigen::VectorXf mDirection; ///\brief neighbor direction
+        unsigned long mUpdateCount; ///\brief number of changed graph entries during current iteration
+    };
+
+    NNDescentAlg();
+
+    /**
+     \brief calculate squared distance between position and visible object
+     \param pPosition position
+     \param pIndex visible object index
+     \return squared distance
+     */
+    float squaredDistance( const float* pPosition, unsigned int pIndex ) const;
+
+    /**
+     \brief insert entry into sorted entry list unless it is farther than all entries or already present
+     \param pEntries entry list (pCapacity entries)
+     \param pCount number of used entries
+     \param pCapacity maximum number of entries
+     \param pDistance squared distance
+     \param pIndex visible object index
+     \return true if entry has been inserted
+     */
+    bool insertEntry( Entry* pEntries, unsigned int& pCount, unsigned int pCapacity, float pDistance, unsigned int pIndex ) const;
+
+    /**
+     \brief initialize graph entries of visible object from previous graph, neighbor group and random samples
+     \param pIndex visible object index
+     */
+    void initNode( unsigned int pIndex );
+
+    /**
+     \brief sample new and old entries of visible object for the next local join
+     \param pIndex visible object index
+     */
+    void sampleNode( unsigned int pIndex );
+
+    /**
+     \brief compare visible object with the joint neighbors of its joint neighbors
+     \param pIndex visible object index
+     \param pBuffer refine buffer
+     */
+    void joinNode( unsigned int pIndex, RefineBuffer& pBuffer );
+
+    /**
+     \brief search graph for neighbors of an invisible object
+     \param pObject proxy object
+     \param pBuffer refine buffer, receives entries
+     */
+    void searchGraph( SpaceProxyObject* pObject, RefineBuffer& pBuffer );
+
+    /**
+     \brief add entries to neighbor group of object
+     \param pObject proxy object
+     \param pEntries entries sorted by distance
+     \param pEntryCount number of entries
+     \param pBuffer refine buffer
+     */
+    void addNeighbors( SpaceProxyObject* pObject, const Entry* pEntries, unsigned int pEntryCount, RefineBuffer& pBuffer ) throw (Exception);
+
+    unsigned int mGraphNeighborCount; ///\brief requested number of neighbors per visible object stored in the graph
+    unsigned int mIterationCount; ///\brief maximum number of refinement iterations per neighbor update
+    float mSampleRate; ///\brief fraction of new graph neighbors that take part in a local join
+    float mTerminationRate; ///\brief fraction of changed graph entries below which refinement stops early
+    unsigned int mLastIterationCount; ///\brief number of refinement iterations run during the last neighbor update
+    float mLastUpdateRate; ///\brief fraction of graph entries changed during the last refinement iteration
+    unsigned long mFrame; ///\brief number of neighbor updates, seeds random samples
+
+    std::vector< SpaceProxyObject* > mObjects; ///\brief visible objects
+    std::vector<float> mPositions; ///\brief positions of visible objects (dim values per object)
+    std::unordered_map<SpaceObject*, unsigned int> mIndices; ///\brief visible object index of each visible space object
+
+    unsigned int mNodeCapacity; ///\brief number of entries per visible object in current graph
+    std::vector<Entry> mGraph; ///\brief graph entries sorted by distance (mNodeCapacity entries per visible object)
+    std::vector<unsigned int> mGraphCounts; ///\brief number of used graph entries of each visible object
+
+    unsigned int mJoinCapacity; ///\brief maximum number of new and old joint neighbors per visible object
+    std::vector<unsigned int> mNewJoint; ///\brief sampled new forward and reverse neighbors (mJoinCapacity per visible object)
+    std::vector<unsigned int> mNewJointCounts; ///\brief number of new joint neighbors of each visible object
+    std::vector<unsigned int> mOldJoint; ///\brief old forward and reverse neighbors (mJoinCapacity per visible object)
+    std::vector<unsigned int> mOldJointCounts; ///\brief number of old joint neighbors of each visible object
+
+    std::unordered_map<SpaceObject*, unsigned int> mPreviousNodes; ///\brief row in previous graph of each space object visible during last neighbor update
+    std::vector<SpaceObject*> mPreviousGraph; ///\brief neighbors in previous graph (mPreviousCapacity per row)
+    std::vector<unsigned int> mPreviousCounts; ///\brief number of neighbors in each row of previous graph
+    unsigned int mPreviousCapacity; ///\brief number of neighbors per row in previous graph
+
+    std::vector<RefineBuffer> mRefineBuffers; ///\brief refine buffers for each thread
+};
+
+};
+
+};
+
+#endif
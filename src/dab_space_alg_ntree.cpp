@@ -63,6 +63,54 @@ NTreeAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (E
     mTreeVisitor.calcNeighbors(mTree, pObjects);
 }
 
+void
+NTreeAlg::updateSymmetricNeighbors( std::vector<SpaceProxyObject*>& pVisibleObjects, std::vector<SpaceProxyObject*>& pNeighborObjects, float pNeighborRadius ) throw (Exception)
+{
+    if(pVisibleObjects.size() > 0 && pVisibleObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pVisibleObjects[0]->dim()) + " doesn't match ntree dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+    
+    try
+    {
+        std::vector<SpaceProxyObject*> unpairedObjects;
+        prepareSymmetricNeighbors( pVisibleObjects, pNeighborObjects, unpairedObjects );
+        
+        unsigned int dim = mMinPos.rows();
+        unsigned int visibleCount = pVisibleObjects.size();
+        float squaredNeighborRadius = pNeighborRadius * pNeighborRadius;
+        
+        if( mSearchMinPos.rows() != dim ) mSearchMinPos.resize(dim);
+        if( mSearchMaxPos.rows() != dim ) mSearchMaxPos.resize(dim);
+        
+        for(unsigned int i=0; i<visibleCount; ++i)
+        {
+            const Eigen::VectorXf& objectPos = pVisibleObjects[i]->position();
+            
+            for(unsigned int d=0; d<dim; ++d)
+            {
+                mSearchMinPos[d] = objectPos[d] - pNeighborRadius;
+                mSearchMaxPos[d] = objectPos[d] + pNeighborRadius;
+            }
+            
+            mSearchObjects.clear();
+            mTreeVisitor.searchObjects(mTree, mSearchMinPos, mSearchMaxPos, mSearchObjects);
+            
+            unsigned int searchCount = mSearchObjects.size();
+            for(unsigned int sI=0; sI<searchCount; ++sI)
+            {
+                unsigned int index = mSearchObjects[sI]->index();
+                if( index > i ) evaluateSymmetricPair( pVisibleObjects, i, index, squaredNeighborRadius );
+            }
+        }
+        
+        // objects that aren't visible can't be part of a pair
+        if( unpairedObjects.size() > 0 ) mTreeVisitor.calcNeighbors(mTree, unpairedObjects);
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update symmetric neighbors", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
 NTreeAlg::operator std::string() const
 {
     return info();
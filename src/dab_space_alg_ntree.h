@@ -30,6 +30,17 @@ public:
     void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
     void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
     
+    /**
+     \brief update neighbors by evaluating each pair of visible objects only once
+     \param pVisibleObjects visible objects (as stored in ntree)
+     \param pNeighborObjects objects that receive neighbors
+     \param pNeighborRadius neighbor radius shared by all neighbor objects
+     \exception Exception failed to update neighbors
+     
+     visible objects query the ntree for objects within their neighbor radius and evaluate only those found objects whose index is higher than their own
+     */
+    void updateSymmetricNeighbors( std::vector<SpaceProxyObject*>& pVisibleObjects, std::vector<SpaceProxyObject*>& pNeighborObjects, float pNeighborRadius ) throw (Exception);
+    
     /**
      \brief obtain textual ntree information
      \return String containing textual ntree information
@@ -66,6 +77,21 @@ protected:
      \brief NTreeVisitor visitor for Ntree
      */
     NTreeVisitor mTreeVisitor;
+    
+    /**
+     \brief objects found during symmetric neighbor search
+     */
+    std::vector<SpaceProxyObject*> mSearchObjects;
+    
+    /**
+     \brief minimum position of symmetric neighbor search box
+     */
+    Eigen::VectorXf mSearchMinPos;
+    
+    /**
+     \brief maximum position of symmetric neighbor search box
+     */
+    Eigen::VectorXf mSearchMaxPos;
 };
 
 };
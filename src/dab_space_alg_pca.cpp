@@ -0,0 +1,634 @@
+/** \file dab_space_alg_pca.cpp
+ */
+
+#include "dab_space_alg_pca.h"
+#include "dab_space.h"
+#include "dab_space_proxy_object.h"
+#include "dab_space_object.h"
+#include "dab_space_neighbor_group.h"
+#include "dab_space_neighbor_group_alg.h"
+#include "dab_space_neighbor_relation.h"
+#include "dab_space_simd.h"
+#include "dab_space_parallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+
+using namespace dab;
+using namespace dab::space;
+
+PCAProjectionAlg::PCAProjectionAlg()
+: SpaceAlg(2)
+, mInnerAlg(nullptr)
+, mShadowSpace(nullptr)
+, mReducedDim(0)
+, mRefreshInterval(30)
+, mBlendFactor(0.5)
+, mSampleCount(10000)
+, mRefreshRequested(true)
+, mFrame(0)
+, mBasisFrame(0)
+, mBasisStride(0)
+, mExplainedVariance(0.0)
+, mCandidateFactor(2.0)
+, mMaxUncertainRate(0.0)
+, mUncertainRate(0.0)
+{}
+
+PCAProjectionAlg::PCAProjectionAlg( unsigned int pDim, SpaceAlg* pInnerAlg, unsigned int pRefreshInterval ) throw (Exception)
+: SpaceAlg( pDim )
+, mInnerAlg( pInnerAlg )
+, mShadowSpace(nullptr)
+, mReducedDim( pInnerAlg != nullptr ? pInnerAlg->dim() : 0 )
+, mRefreshInterval( std::max(pRefreshInterval, 1u) )
+, mBlendFactor(0.5)
+, mSampleCount(10000)
+, mRefreshRequested(true)
+, mFrame(0)
+, mBasisFrame(0)
+, mBasisStride(0)
+, mExplainedVariance(0.0)
+, mCandidateFactor(2.0)
+, mMaxUncertainRate(0.0)
+, mUncertainRate(0.0)
+{
+    if(pInnerAlg == nullptr) throw Exception("SPACE ERROR: inner alg is missing", __FILE__, __FUNCTION__, __LINE__);
+    if(mReducedDim == 0 || mReducedDim > pDim) throw Exception("SPACE ERROR: inner alg dimension " + std::to_string(mReducedDim) + " must be between 1 and space dimension " + std::to_string(pDim), __FILE__, __FUNCTION__, __LINE__);
+
+    mShadowSpace = new Space("PCAProjectionAlg", mInnerAlg);
+
+    // until the principal components have been calculated the first coordinate axes serve as basis
+    mMean = Eigen::VectorXf::Zero(pDim);
+    mCovariance = Eigen::MatrixXf::Zero(pDim, pDim);
+    mBasisStride = SpaceSimdTools::pointStride(mReducedDim);
+    mBasis.assign(pDim * mBasisStride, 0.0);
+    mMeanProjection.assign(mReducedDim, 0.0);
+    for(unsigned int rI=0; rI<mReducedDim; ++rI) mBasis[rI * mBasisStride + rI] = 1.0;
+}
+
+PCAProjectionAlg::PCAProjectionAlg( const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, SpaceAlg* pInnerAlg, unsigned int pRefreshInterval ) throw (Exception)
+: SpaceAlg( pMinPos, pMaxPos )
+, mInnerAlg( pInnerAlg )
+, mShadowSpace(nullptr)
+, mReducedDim( pInnerAlg != nullptr ? pInnerAlg->dim() : 0 )
+, mRefreshInterval( std::max(pRefreshInterval, 1u) )
+, mBlendFactor(0.5)
+, mSampleCount(10000)
+, mRefreshRequested(true)
+, mFrame(0)
+, mBasisFrame(0)
+, mBasisStride(0)
+, mExplainedVariance(0.0)
+, mCandidateFactor(2.0)
+, mMaxUncertainRate(0.0)
+, mUncertainRate(0.0)
+{
+    unsigned int dim = pMinPos.rows();
+
+    if(pInnerAlg == nullptr) throw Exception("SPACE ERROR: inner alg is missing", __FILE__, __FUNCTION__, __LINE__);
+    if(mReducedDim == 0 || mReducedDim > dim) throw Exception("SPACE ERROR: inner alg dimension " + std::to_string(mReducedDim) + " must be between 1 and space dimension " + std::to_string(dim), __FILE__, __FUNCTION__, __LINE__);
+
+    mShadowSpace = new Space("PCAProjectionAlg", mInnerAlg);
+
+    mMean = Eigen::VectorXf::Zero(dim);
+    mCovariance = Eigen::MatrixXf::Zero(dim, dim);
+    mBasisStride = SpaceSimdTools::pointStride(mReducedDim);
+    mBasis.assign(dim * mBasisStride, 0.0);
+    mMeanProjection.assign(mReducedDim, 0.0);
+    for(unsigned int rI=0; rI<mReducedDim; ++rI) mBasis[rI * mBasisStride + rI] = 1.0;
+}
+
+PCAProjectionAlg::~PCAProjectionAlg()
+{
+    for(std::unordered_map<SpaceProxyObject*, Shadow>::iterator shadowIter = mShadows.begin(); shadowIter != mShadows.end(); ++shadowIter)
+    {
+        try
+        {
+            mInnerAlg->removeObject(shadowIter->second.mProxyObject);
+        }
+        catch(Exception& e)
+        {
+            std::cout << e << "\n";
+        }
+
+        deleteShadow(shadowIter->second);
+    }
+
+    // the shadow space deletes the inner alg
+    delete mShadowSpace;
+}
+
+SpaceAlg*
+PCAProjectionAlg::innerAlg()
+{
+    return mInnerAlg;
+}
+
+unsigned int
+PCAProjectionAlg::reducedDim() const
+{
+    return mReducedDim;
+}
+
+unsigned int
+PCAProjectionAlg::refreshInterval() const
+{
+    return mRefreshInterval;
+}
+
+float
+PCAProjectionAlg::blendFactor() const
+{
+    return mBlendFactor;
+}
+
+unsigned int
+PCAProjectionAlg::sampleCount() const
+{
+    return mSampleCount;
+}
+
+float
+PCAProjectionAlg::candidateFactor() const
+{
+    return mCandidateFactor;
+}
+
+float
+PCAProjectionAlg::maxUncertainRate() const
+{
+    return mMaxUncertainRate;
+}
+
+float
+PCAProjectionAlg::explainedVariance() const
+{
+    return mExplainedVariance;
+}
+
+float
+PCAProjectionAlg::uncertainRate() const
+{
+    return mUncertainRate;
+}
+
+void
+PCAProjectionAlg::setRefreshInterval(unsigned int pRefreshInterval) throw (Exception)
+{
+    if(pRefreshInterval == 0) throw Exception("SPACE ERROR: refresh interval must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+
+    mRefreshInterval = pRefreshInterval;
+}
+
+void
+PCAProjectionAlg::setBlendFactor(float pBlendFactor) throw (Exception)
+{
+    if(pBlendFactor <= 0.0 || pBlendFactor > 1.0) throw Exception("SPACE ERROR: blend factor " + std::to_string(pBlendFactor) + " must be larger than zero and not larger than one", __FILE__, __FUNCTION__, __LINE__);
+
+    mBlendFactor = pBlendFactor;
+}
+
+void
+PCAProjectionAlg::setSampleCount(unsigned int pSampleCount) throw (Exception)
+{
+    if(pSampleCount == 0) throw Exception("SPACE ERROR: sample count must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+
+    mSampleCount = pSampleCount;
+}
+
+void
+PCAProjectionAlg::setMaxUncertainRate(float pMaxUncertainRate) throw (Exception)
+{
+    if(pMaxUncertainRate < 0.0 || pMaxUncertainRate > 1.0) throw Exception("SPACE ERROR: uncertain rate " + std::to_string(pMaxUncertainRate) + " must be between zero and one", __FILE__, __FUNCTION__, __LINE__);
+
+    mMaxUncertainRate = pMaxUncertainRate;
+}
+
+void
+PCAProjectionAlg::refresh()
+{
+    mRefreshRequested = true;
+}
+
+void
+PCAProjectionAlg::addObject( SpaceProxyObject* pObject ) throw (Exception)
+{
+    if(pObject->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObject->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        shadow(pObject);
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to add object to pca projection alg", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+void
+PCAProjectionAlg::removeObject( SpaceProxyObject* pObject ) throw (Exception)
+{
+    std::unordered_map<SpaceProxyObject*, Shadow>::iterator shadowIter = mShadows.find(pObject);
+    if(shadowIter == mShadows.end()) return;
+
+    try
+    {
+        mInnerAlg->removeObject(shadowIter->second.mProxyObject);
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to remove object from pca projection alg", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+
+    mShadowOwners.erase(shadowIter->second.mObject);
+    deleteShadow(shadowIter->second);
+    mShadows.erase(shadowIter);
+}
+
+PCAProjectionAlg::Shadow&
+PCAProjectionAlg::shadow( SpaceProxyObject* pObject ) throw (Exception)
+{
+    std::unordered_map<SpaceProxyObject*, Shadow>::iterator shadowIter = mShadows.find(pObject);
+    if(shadowIter != mShadows.end()) return shadowIter->second;
+
+    Shadow shadow;
+    shadow.mObject = new SpaceObject(mReducedDim);
+    shadow.mNeighborGroup = new NeighborGroup(shadow.mObject, mShadowSpace, true, new NeighborGroupAlg(-1.0, -1, true));
+    shadow.mProxyObject = new SpaceProxyObject(shadow.mObject, shadow.mNeighborGroup);
+    shadow.mProjectionFrame = ULONG_MAX;
+
+    try
+    {
+        mInnerAlg->addObject(shadow.mProxyObject);
+    }
+    catch(Exception& e)
+    {
+        deleteShadow(shadow);
+        throw e;
+    }
+
+    mShadowOwners[shadow.mObject] = pObject;
+
+    return mShadows[pObject] = shadow;
+}
+
+void
+PCAProjectionAlg::deleteShadow( Shadow& pShadow )
+{
+    try
+    {
+        pShadow.mNeighborGroup->removeNeighbors();
+    }
+    catch(Exception& e)
+    {
+        std::cout << e << "\n";
+    }
+
+    delete pShadow.mProxyObject;
+    delete pShadow.mNeighborGroup;
+    delete pShadow.mObject;
+}
+
+void
+PCAProjectionAlg::updateBasis( std::vector< SpaceProxyObject* >& pObjects )
+{
+    unsigned int dim = mMinPos.rows();
+    unsigned int objectCount = pObjects.size();
+    unsigned int sampleCount = std::min(objectCount, mSampleCount);
+    double sampleStep = static_cast<double>(objectCount) / static_cast<double>(sampleCount);
+
+    Eigen::MatrixXf samples(dim, sampleCount);
+    for(unsigned int sI=0; sI<sampleCount; ++sI) samples.col(sI) = pObjects[ static_cast<unsigned int>(sI * sampleStep) ]->position();
+
+    Eigen::VectorXf sampleMean = samples.rowwise().mean();
+    samples.colwise() -= sampleMean;
+    Eigen::MatrixXf sampleCovariance = ( samples * samples.transpose() ) / static_cast<float>(sampleCount);
+
+    if(mRefreshRequested == true)
+    {
+        mMean = sampleMean;
+        mCovariance = sampleCovariance;
+    }
+    else
+    {
+        mMean = ( 1.0 - mBlendFactor ) * mMean + mBlendFactor * sampleMean;
+        mCovariance = ( 1.0 - mBlendFactor ) * mCovariance + mBlendFactor * sampleCovariance;
+    }
+
+    // eigenvalues are sorted in increasing order, the principal components are the last eigenvectors
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXf> solver(mCovariance);
+    const Eigen::VectorXf& eigenValues = solver.eigenvalues();
+    const Eigen::MatrixXf& eigenVectors = solver.eigenvectors();
+
+    float totalVariance = 0.0;
+    float explainedVariance = 0.0;
+
+    for(unsigned int d=0; d<dim; ++d) totalVariance += std::max(eigenValues[d], 0.0f);
+
+    for(unsigned int rI=0; rI<mReducedDim; ++rI)
+    {
+        unsigned int component = dim - 1 - rI;
+
+        for(unsigned int d=0; d<dim; ++d) mBasis[d * mBasisStride + rI] = eigenVectors(d, component);
+        mMeanProjection[rI] = eigenVectors.col(component).dot(mMean);
+
+        explainedVariance += std::max(eigenValues[component], 0.0f);
+    }
+
+    mExplainedVariance = totalVariance > 0.0 ? explainedVariance / totalVariance : 1.0;
+}
+
+void
+PCAProjectionAlg::project( SpaceProxyObject* pObject, Shadow& pShadow, RefineBuffer& pBuffer ) const
+{
+    SpaceSimdTools::get().dotProducts(pObject->position().data(), mBasis.data(), mBasisStride, mMinPos.rows(), 0, mReducedDim, pBuffer.mProjection.data());
+
+    Eigen::VectorXf& projectedPosition = pShadow.mObject->position();
+    for(unsigned int rI=0; rI<mReducedDim; ++rI) projectedPosition[rI] = pBuffer.mProjection[rI] - mMeanProjection[rI];
+
+    pShadow.mProjectionFrame = mFrame;
+}
+
+void
+PCAProjectionAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+        unsigned int objectCount = pObjects.size();
+        unsigned int threadCount = parallelTools.threadCount();
+        const unsigned int blockSize = 64;
+        unsigned int blockCount = ( objectCount + blockSize - 1 ) / blockSize;
+
+        mFrame++;
+
+        if( objectCount > 0 && ( mRefreshRequested == true || mFrame - mBasisFrame >= mRefreshInterval ) )
+        {
+            updateBasis(pObjects);
+
+            mBasisFrame = mFrame;
+            mRefreshRequested = false;
+        }
+
+        if(mRefineBuffers.size() < threadCount) mRefineBuffers.resize(threadCount);
+        for(unsigned int tI=0; tI<threadCount; ++tI) mRefineBuffers[tI].mProjection.resize(mReducedDim);
+
+        mObjects = pObjects;
+        mVisibleShadows.resize(objectCount);
+        mShadowObjects.resize(objectCount);
+
+        for(unsigned int oI=0; oI<objectCount; ++oI)
+        {
+            Shadow& objectShadow = shadow(pObjects[oI]);
+
+            mVisibleShadows[oI] = &objectShadow;
+            mShadowObjects[oI] = objectShadow.mProxyObject;
+        }
+
+        parallelTools.run(blockCount, [this, &pObjects, objectCount, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+            for(unsigned int oI=pTaskIndex * blockSize; oI<objectEnd; ++oI) project(pObjects[oI], *mVisibleShadows[oI], mRefineBuffers[pThreadIndex]);
+        });
+
+        mInnerAlg->updateStructure(mShadowObjects);
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update pca projection structure", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+void
+PCAProjectionAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+        unsigned int dim = mMinPos.rows();
+        unsigned int objectCount = pObjects.size();
+        unsigned int threadCount = parallelTools.threadCount();
+        const unsigned int blockSize = 16;
+        unsigned int blockCount = ( objectCount + blockSize - 1 ) / blockSize;
+
+        if(mRefineBuffers.size() < threadCount) mRefineBuffers.resize(threadCount);
+
+        for(unsigned int tI=0; tI<threadCount; ++tI)
+        {
+            RefineBuffer& buffer = mRefineBuffers[tI];
+            buffer.mProjection.resize(mReducedDim);
+            buffer.mLimitedCount = 0;
+            buffer.mUncertainCount = 0;
+            if(buffer.mDirection.rows() != dim) buffer.mDirection.resize(dim);
+        }
+
+        // searches in the subspace use the neighbor radius of the object, searches limited by neighbor count retrieve additional candidates
+        mNeighborShadows.resize(objectCount);
+        mShadowNeighborObjects.resize(objectCount);
+
+        for(unsigned int oI=0; oI<objectCount; ++oI)
+        {
+            SpaceProxyObject* object = pObjects[oI];
+            Shadow& objectShadow = shadow(object);
+            NeighborGroupAlg* neighborGroupAlg = objectShadow.mNeighborGroup->neighborGroupAlg();
+            int maxNeighborCount = object->maxNeighborCount();
+
+            neighborGroupAlg->setNeighborRadius( object->neighborRadius() );
+            neighborGroupAlg->setMaxNeighborCount( maxNeighborCount > 0 ? std::max( maxNeighborCount, static_cast<int>( ceil( maxNeighborCount * mCandidateFactor ) ) ) : maxNeighborCount );
+
+            mNeighborShadows[oI] = &objectShadow;
+            mShadowNeighborObjects[oI] = objectShadow.mProxyObject;
+        }
+
+        parallelTools.run(blockCount, [this, &pObjects, objectCount, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+
+            for(unsigned int oI=pTaskIndex * blockSize; oI<objectEnd; ++oI)
+            {
+                if(mNeighborShadows[oI]->mProjectionFrame != mFrame) project(pObjects[oI], *mNeighborShadows[oI], mRefineBuffers[pThreadIndex]);
+            }
+        });
+
+        mInnerAlg->updateNeighbors(mShadowNeighborObjects);
+
+        parallelTools.run(blockCount, [this, &pObjects, objectCount, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            RefineBuffer& buffer = mRefineBuffers[pThreadIndex];
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+
+            for(unsigned int oI=pTaskIndex * blockSize; oI<objectEnd; ++oI)
+            {
+                SpaceProxyObject* object = pObjects[oI];
+                object->removeNeighbors();
+
+                if(object->maxNeighborCount() == 0) continue;
+
+                if( refine(object, *mNeighborShadows[oI], buffer) == false && mMaxUncertainRate == 0.0 ) searchExhaustive(object, buffer);
+
+                addNeighbors(object, buffer);
+            }
+        });
+
+        // adapt candidate factor to the observed fraction of uncertified searches
+        unsigned int limitedCount = 0;
+        unsigned int uncertainCount = 0;
+
+        for(unsigned int tI=0; tI<threadCount; ++tI)
+        {
+            limitedCount += mRefineBuffers[tI].mLimitedCount;
+            uncertainCount += mRefineBuffers[tI].mUncertainCount;
+        }
+
+        mUncertainRate = limitedCount > 0 ? static_cast<float>(uncertainCount) / static_cast<float>(limitedCount) : 0.0;
+
+        if(mUncertainRate > mMaxUncertainRate) mCandidateFactor = std::min( mCandidateFactor * 1.5f, static_cast<float>( std::max(mObjects.size(), static_cast<size_t>(1)) ) );
+        else if(mUncertainRate <= 0.5 * mMaxUncertainRate) mCandidateFactor = std::max( mCandidateFactor * 0.95f, 1.0f );
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update neighbors based on pca projection", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+bool
+PCAProjectionAlg::refine( SpaceProxyObject* pObject, Shadow& pShadow, RefineBuffer& pBuffer ) const throw (Exception)
+{
+    const SpaceSimdTools& simdTools = SpaceSimdTools::get();
+
+    unsigned int dim = mMinPos.rows();
+    const float* position = pObject->position().data();
+    float neighborRadius = pObject->neighborRadius();
+    float squaredNeighborRadius = neighborRadius >= 0.0 ? neighborRadius * neighborRadius : FLT_MAX;
+    int maxNeighborCount = pObject->maxNeighborCount();
+
+    std::vector<SpaceNeighborRelation*>& relations = pShadow.mNeighborGroup->neighborRelations();
+    unsigned int relationCount = relations.size();
+    float maxProjectedDistance = 0.0;
+
+    std::vector< std::pair<float, SpaceProxyObject*> >& neighbors = pBuffer.mNeighbors;
+    neighbors.clear();
+
+    for(unsigned int rI=0; rI<relationCount; ++rI)
+    {
+        std::unordered_map<SpaceObject*, SpaceProxyObject*>::const_iterator ownerIter = mShadowOwners.find( relations[rI]->neighbor() );
+        if(ownerIter == mShadowOwners.end()) continue;
+
+        maxProjectedDistance = std::max( maxProjectedDistance, relations[rI]->distance() );
+
+        SpaceProxyObject* neighborObject = ownerIter->second;
+        float squaredDistance = simdTools.squaredDistance(position, neighborObject->position().data(), dim);
+
+        if(squaredDistance <= squaredNeighborRadius) neighbors.push_back( std::make_pair(squaredDistance, neighborObject) );
+    }
+
+    std::sort(neighbors.begin(), neighbors.end());
+
+    // radius searches and searches that didn't exhaust the candidate count have found all objects within the radius
+    if(maxNeighborCount < 0) return true;
+
+    pBuffer.mLimitedCount++;
+
+    if(neighbors.size() > static_cast<unsigned int>(maxNeighborCount)) neighbors.resize(maxNeighborCount);
+
+    if(relationCount < static_cast<unsigned int>( pShadow.mNeighborGroup->neighborGroupAlg()->maxNeighborCount() )) return true;
+
+    // objects that haven't been retrieved are at least as far as the farthest candidate, both in the subspace and in full dimension
+    float farthestDistance = neighbors.size() == static_cast<unsigned int>(maxNeighborCount) ? sqrt(neighbors.back().first) : ( neighborRadius >= 0.0 ? neighborRadius : FLT_MAX );
+    if(farthestDistance <= maxProjectedDistance) return true;
+
+    pBuffer.mUncertainCount++;
+
+    return false;
+}
+
+void
+PCAProjectionAlg::searchExhaustive( SpaceProxyObject* pObject, RefineBuffer& pBuffer ) const throw (Exception)
+{
+    const SpaceSimdTools& simdTools = SpaceSimdTools::get();
+
+    unsigned int dim = mMinPos.rows();
+    unsigned int visibleCount = mObjects.size();
+    const float* position = pObject->position().data();
+    float neighborRadius = pObject->neighborRadius();
+    float squaredNeighborRadius = neighborRadius >= 0.0 ? neighborRadius * neighborRadius : FLT_MAX;
+    int maxNeighborCount = pObject->maxNeighborCount();
+
+    std::vector< std::pair<float, SpaceProxyObject*> >& neighbors = pBuffer.mNeighbors;
+    neighbors.clear();
+
+    for(unsigned int oI=0; oI<visibleCount; ++oI)
+    {
+        if(mObjects[oI] == pObject) continue;
+
+        float squaredDistance = simdTools.squaredDistance(position, mObjects[oI]->position().data(), dim);
+        if(squaredDistance <= squaredNeighborRadius) neighbors.push_back( std::make_pair(squaredDistance, mObjects[oI]) );
+    }
+
+    if(maxNeighborCount > 0 && neighbors.size() > static_cast<unsigned int>(maxNeighborCount))
+    {
+        std::partial_sort(neighbors.begin(), neighbors.begin() + maxNeighborCount, neighbors.end());
+        neighbors.resize(maxNeighborCount);
+    }
+    else
+    {
+        std::sort(neighbors.begin(), neighbors.end());
+    }
+}
+
+void
+PCAProjectionAlg::addNeighbors( SpaceProxyObject* pObject, RefineBuffer& pBuffer ) const throw (Exception)
+{
+    const Eigen::VectorXf& position = pObject->position();
+    std::vector< std::pair<float, SpaceProxyObject*> >& neighbors = pBuffer.mNeighbors;
+    unsigned int neighborCount = neighbors.size();
+
+    for(unsigned int nI=0; nI<neighborCount; ++nI)
+    {
+        SpaceProxyObject* neighborObject = neighbors[nI].second;
+        pBuffer.mDirection = neighborObject->position() - position;
+
+        pObject->addNeighbor(neighborObject->spaceObject(), sqrt(neighbors[nI].first), pBuffer.mDirection);
+    }
+}
+
+bool
+PCAProjectionAlg::symmetricNeighborsSupported() const
+{
+    return false;
+}
+
+PCAProjectionAlg::operator std::string() const
+{
+    return info();
+}
+
+std::string
+PCAProjectionAlg::info() const
+{
+    std::stringstream stream;
+
+    stream << "PCAProjectionAlg\n";
+    stream << "reducedDim: " << mReducedDim << "\n";
+    stream << "refreshInterval: " << mRefreshInterval << "\n";
+    stream << "blendFactor: " << mBlendFactor << "\n";
+    stream << "explainedVariance: " << mExplainedVariance << "\n";
+    stream << "candidateFactor: " << mCandidateFactor << "\n";
+    stream << "maxUncertainRate: " << mMaxUncertainRate << "\n";
+    stream << "uncertainRate: " << mUncertainRate << "\n";
+    stream << "innerAlg:\n" << mInnerAlg->info();
+    stream << SpaceAlg::info();
+
+    return stream.str();
+}
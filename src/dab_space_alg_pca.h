@@ -0,0 +1,272 @@
+/** \file dab_space_alg_pca.h
+ */
+
+#ifndef _dab_space_alg_pca_h_
+#define _dab_space_alg_pca_h_
+
+#include <unordered_map>
+#include <Eigen/Dense>
+#include "dab_space_alg.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+class Space;
+class SpaceObject;
+class NeighborGroup;
+
+/**
+ \brief neighbor search in a subspace spanned by principal components
+
+ the positions of all objects are projected onto the principal components of the visible objects and another space algorithm searches candidates among the projected positions.\n
+ the candidates are refined with exact distances in the full dimension, the resulting neighbors therefore never contain false positives.\n
+ since projecting onto an orthonormal basis never increases distances, radius searches in the subspace return all true neighbors.\n
+ searches limited by neighbor count retrieve more candidates than requested (candidate factor). a search is certified exact if its farthest neighbor is closer than the farthest projected candidate.
+ the candidate factor adapts so that the fraction of uncertified searches stays below a bound, with a bound of zero uncertified searches are repeated exhaustively.\n
+ the principal components are recalculated every few structure updates from a sample of visible objects, the covariance is blended with the previous one to avoid jumps of the basis.\n
+ the inner space algorithm operates on proxy objects of the reduced dimension. algorithms that depend on space bounds need bounds of the projected positions, which are centered at the mean of the visible objects.
+ */
+class PCAProjectionAlg : public SpaceAlg
+{
+public:
+    /**
+     \brief create pca projection alg
+     \param pDim dimension
+     \param pInnerAlg space alg searching candidates among projected positions, its dimension determines the number of principal components (the pca projection alg takes ownership)
+     \param pRefreshInterval number of structure updates after which the principal components are recalculated
+     \exception Exception inner alg is missing or its dimension exceeds dimension
+     */
+    PCAProjectionAlg(unsigned int pDim, SpaceAlg* pInnerAlg, unsigned int pRefreshInterval = 30) throw (Exception);
+
+    /**
+     \brief create pca projection alg
+     \param pMinPos minimum position
+     \param pMaxPos maximum position
+     \param pInnerAlg space alg searching candidates among projected positions, its dimension determines the number of principal components (the pca projection alg takes ownership)
+     \param pRefreshInterval number of structure updates after which the principal components are recalculated
+     \exception Exception dimension mismatch, inner alg is missing or its dimension exceeds dimension
+     */
+    PCAProjectionAlg(const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, SpaceAlg* pInnerAlg, unsigned int pRefreshInterval = 30) throw (Exception);
+
+    ~PCAProjectionAlg();
+
+    /**
+     \brief return space alg searching candidates among projected positions
+     \return inner alg
+     */
+    SpaceAlg* innerAlg();
+
+    /**
+     \brief return number of principal components
+     \return reduced dimension
+     */
+    unsigned int reducedDim() const;
+
+    unsigned int refreshInterval() const;
+    float blendFactor() const;
+    unsigned int sampleCount() const;
+    float candidateFactor() const;
+    float maxUncertainRate() const;
+
+    /**
+     \brief return fraction of total variance of the visible objects covered by the principal components
+     \return explained variance
+     */
+    float explainedVariance() const;
+
+    /**
+     \brief return fraction of searches limited by neighbor count that couldn't be certified exact during the last neighbor update
+     \return uncertain rate
+     */
+    float uncertainRate() const;
+
+    /**
+     \brief set number of structure updates after which the principal components are recalculated
+     \param pRefreshInterval refresh interval
+     \exception Exception refresh interval is zero
+     */
+    void setRefreshInterval(unsigned int pRefreshInterval) throw (Exception);
+
+    /**
+     \brief set weight of new covariance when it is blended with the previous one
+     \param pBlendFactor blend factor (1.0: previous covariance is discarded)
+     \exception Exception blend factor outside of range (0.0, 1.0]
+     */
+    void setBlendFactor(float pBlendFactor) throw (Exception);
+
+    /**
+     \brief set maximum number of visible objects used for calculating the principal components
+     \param pSampleCount sample count
+     \exception Exception sample count is zero
+     */
+    void setSampleCount(unsigned int pSampleCount) throw (Exception);
+
+    /**
+     \brief set bound for the fraction of searches limited by neighbor count that can't be certified exact
+     \param pMaxUncertainRate maximum uncertain rate (0.0: uncertified searches are repeated exhaustively)
+     \exception Exception rate outside of range [0.0, 1.0]
+     */
+    void setMaxUncertainRate(float pMaxUncertainRate) throw (Exception);
+
+    /**
+     \brief recalculate principal components from scratch during next structure update
+     */
+    void refresh();
+
+    void addObject( SpaceProxyObject* pObject ) throw (Exception);
+    void removeObject( SpaceProxyObject* pObject ) throw (Exception);
+    void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+    void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+
+    /**
+     \brief symmetric neighbor calculation is not supported
+     \return false
+
+     candidates are searched by the inner alg and refined per object
+     */
+    bool symmetricNeighborsSupported() const;
+
+    /**
+     \brief obtain textual pca projection alg information
+     \return String containing textual pca projection alg information
+     */
+    operator std::string() const;
+
+    /**
+     \brief obtain textual pca projection alg information
+     \return String containing textual pca projection alg information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual pca projection alg information
+     \param pOstream output stream
+     \param pAlg pca projection alg
+     */
+    friend std::ostream& operator<< (std::ostream & pOstream, const PCAProjectionAlg& pAlg)
+    {
+        pOstream << std::string(pAlg);
+
+        return pOstream;
+    }
+
+protected:
+    /**
+     \brief reduced dimension counterpart of an object
+     */
+    class Shadow
+    {
+    public:
+        SpaceObject* mObject; ///\brief space object holding the projected position
+        NeighborGroup* mNeighborGroup; ///\brief neighbor group receiving the candidates
+        SpaceProxyObject* mProxyObject; ///\brief proxy object passed to the inner alg
+        unsigned long mProjectionFrame; ///\brief structure update during which the position was last projected
+    };
+
+    /**
+     \brief per thread refinement buffers
+     */
+    class RefineBuffer
+    {
+    public:
+        std::vector<float> mProjection; ///\brief projected position
+        std::vector< std::pair<float, SpaceProxyObject*> > mNeighbors; ///\brief refined neighbors (squared distance and object)
+        Eigen::VectorXf mDirection; ///\brief neighbor direction
+        unsigned int mLimitedCount; ///\brief number of searches limited by neighbor count during current neighbor update
+        unsigned int mUncertainCount; ///\brief number of uncertified searches during current neighbor update
+    };
+
+    PCAProjectionAlg();
+
+    /**
+     \brief return shadow of object, a shadow is created if the object doesn't have one yet
+     \param pObject proxy object
+     \return shadow
+     \exception Exception shadow could not be added to inner alg
+     */
+    Shadow& shadow( SpaceProxyObject* pObject ) throw (Exception);
+
+    /**
+     \brief delete shadow
+     \param pShadow shadow
+     */
+    void deleteShadow( Shadow& pShadow );
+
+    /**
+     \brief blend covariance of a sample of visible objects into the current covariance and recalculate principal components
+     \param pObjects visible objects
+     */
+    void updateBasis( std::vector< SpaceProxyObject* >& pObjects );
+
+    /**
+     \brief project position of object onto principal components
+     \param pObject proxy object
+     \param pShadow shadow receiving projected position
+     \param pBuffer refine buffer
+     */
+    void project( SpaceProxyObject* pObject, Shadow& pShadow, RefineBuffer& pBuffer ) const;
+
+    /**
+     \brief refine candidates of an object with exact distances
+     \param pObject proxy object
+     \param pShadow shadow holding the candidates
+     \param pBuffer refine buffer
+     \return true if result is certified exact
+     */
+    bool refine( SpaceProxyObject* pObject, Shadow& pShadow, RefineBuffer& pBuffer ) const throw (Exception);
+
+    /**
+     \brief search neighbors of an object exhaustively
+     \param pObject proxy object
+     \param pBuffer refine buffer
+     */
+    void searchExhaustive( SpaceProxyObject* pObject, RefineBuffer& pBuffer ) const throw (Exception);
+
+    /**
+     \brief add refined neighbors to object
+     \param pObject proxy object
+     \param pBuffer refine buffer
+     */
+    void addNeighbors( SpaceProxyObject* pObject, RefineBuffer& pBuffer ) const throw (Exception);
+
+    SpaceAlg* mInnerAlg; ///\brief space alg searching candidates among projected positions
+    Space* mShadowSpace; ///\brief space owning the inner alg, referenced by the neighbor groups of shadows
+    unsigned int mReducedDim; ///\brief number of principal components
+
+    unsigned int mRefreshInterval; ///\brief number of structure updates after which the principal components are recalculated
+    float mBlendFactor; ///\brief weight of new covariance
+    unsigned int mSampleCount; ///\brief maximum number of objects used for calculating the principal components
+    bool mRefreshRequested; ///\brief principal components are recalculated from scratch during next structure update
+    unsigned long mFrame; ///\brief number of structure updates
+    unsigned long mBasisFrame; ///\brief structure update during which the principal components were last calculated
+
+    Eigen::VectorXf mMean; ///\brief mean position of visible objects
+    Eigen::MatrixXf mCovariance; ///\brief covariance of visible objects
+    std::vector<float> mBasis; ///\brief principal components, packed dimension by dimension (see SpaceSimdTools)
+    unsigned int mBasisStride; ///\brief stride of packed principal components
+    std::vector<float> mMeanProjection; ///\brief projection of mean position onto principal components
+    float mExplainedVariance; ///\brief fraction of variance covered by principal components
+
+    float mCandidateFactor; ///\brief ratio between number of candidates and maximum neighbor count
+    float mMaxUncertainRate; ///\brief maximum fraction of uncertified searches
+    float mUncertainRate; ///\brief fraction of uncertified searches during last neighbor update
+
+    std::unordered_map<SpaceProxyObject*, Shadow> mShadows; ///\brief shadow of each object
+    std::unordered_map<SpaceObject*, SpaceProxyObject*> mShadowOwners; ///\brief object of each shadow space object
+    std::vector< SpaceProxyObject* > mObjects; ///\brief visible objects
+    std::vector< Shadow* > mVisibleShadows; ///\brief shadows of visible objects
+    std::vector< SpaceProxyObject* > mShadowObjects; ///\brief shadow proxy objects of visible objects
+    std::vector< SpaceProxyObject* > mShadowNeighborObjects; ///\brief shadow proxy objects of objects searching for neighbors
+    std::vector< Shadow* > mNeighborShadows; ///\brief shadows of objects searching for neighbors
+
+    std::vector<RefineBuffer> mRefineBuffers; ///\brief refine buffers for each thread
+};
+
+};
+
+};
+
+#endif
@@ -73,6 +73,12 @@ PermanentNeighborsAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjec
 }
 
 
+bool
+PermanentNeighborsAlg::symmetricNeighborsSupported() const
+{
+    return false;
+}
+
 PermanentNeighborsAlg::operator std::string() const
 {
     std::stringstream stream;
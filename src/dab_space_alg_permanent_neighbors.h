@@ -27,6 +27,14 @@ public:
     
     void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
     
+    /**
+     \brief symmetric neighbor calculation is not supported
+     \return false
+     
+     neighbors are assigned permanently rather than calculated from pairs of objects
+     */
+    bool symmetricNeighborsSupported() const;
+    
     /**
      \brief obtain textual ntree information
      \return String containing textual ntree information
@@ -0,0 +1,404 @@
+/** \file dab_space_alg_pq.cpp
+ */
+
+#include "dab_space_alg_pq.h"
+#include "dab_space_proxy_object.h"
+#include "dab_space_simd.h"
+#include "dab_space_parallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using namespace dab;
+using namespace dab::space;
+
+const unsigned int PQAlg::sNoObject = std::numeric_limits<unsigned int>::max();
+
+PQAlg::PQAlg()
+: SpaceAlg(2)
+, mQuantizer(2, 1)
+, mRerankCount(64)
+, mTrainingSampleCount(10000)
+, mTrainingRequested(false)
+{}
+
+PQAlg::PQAlg( unsigned int pDim, unsigned int pSubspaceCount, unsigned int pCentroidCount, unsigned int pRerankCount ) throw (Exception)
+: SpaceAlg( pDim )
+, mQuantizer( pDim, pSubspaceCount, pCentroidCount )
+, mRerankCount( std::max(pRerankCount, 1u) )
+, mTrainingSampleCount(10000)
+, mTrainingRequested(false)
+{}
+
+PQAlg::PQAlg( const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, unsigned int pSubspaceCount, unsigned int pCentroidCount, unsigned int pRerankCount ) throw (Exception)
+: SpaceAlg( pMinPos, pMaxPos )
+, mQuantizer( pMinPos.rows(), pSubspaceCount, pCentroidCount )
+, mRerankCount( std::max(pRerankCount, 1u) )
+, mTrainingSampleCount(10000)
+, mTrainingRequested(false)
+{}
+
+PQAlg::~PQAlg()
+{}
+
+const SpaceProductQuantizer&
+PQAlg::quantizer() const
+{
+    return mQuantizer;
+}
+
+unsigned int
+PQAlg::rerankCount() const
+{
+    return mRerankCount;
+}
+
+unsigned int
+PQAlg::trainingSampleCount() const
+{
+    return mTrainingSampleCount;
+}
+
+void
+PQAlg::setRerankCount(unsigned int pRerankCount) throw (Exception)
+{
+    if(pRerankCount == 0) throw Exception("SPACE ERROR: rerank count must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+
+    mRerankCount = pRerankCount;
+}
+
+void
+PQAlg::setTrainingSampleCount(unsigned int pTrainingSampleCount) throw (Exception)
+{
+    if(pTrainingSampleCount == 0) throw Exception("SPACE ERROR: training sample count must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+
+    mTrainingSampleCount = pTrainingSampleCount;
+}
+
+void
+PQAlg::train()
+{
+    mTrainingRequested = true;
+}
+
+unsigned long
+PQAlg::compressedMemorySize() const
+{
+    return static_cast<unsigned long>( mSlotCodes.size() ) * sizeof(SpaceProductQuantizer::Code) + mQuantizer.codebookSize();
+}
+
+unsigned long
+PQAlg::uncompressedMemorySize() const
+{
+    return static_cast<unsigned long>( mSlotIndices.size() ) * mMinPos.rows() * sizeof(float);
+}
+
+unsigned long
+PQAlg::memorySize() const
+{
+    return compressedMemorySize() + uncompressedMemorySize();
+}
+
+void
+PQAlg::addObject( SpaceProxyObject* pObject ) throw (Exception)
+{
+    if(pObject->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObject->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    slotIndex(pObject);
+}
+
+void
+PQAlg::removeObject( SpaceProxyObject* pObject ) throw (Exception)
+{
+    std::unordered_map<SpaceProxyObject*, unsigned int>::iterator slotIter = mSlotIndices.find(pObject);
+    if(slotIter == mSlotIndices.end()) return;
+
+    mSlots[slotIter->second].mEncoded = false;
+    mSlots[slotIter->second].mObjectIndex = sNoObject;
+    mFreeSlots.push_back(slotIter->second);
+    mSlotIndices.erase(slotIter);
+}
+
+unsigned int
+PQAlg::slotIndex( SpaceProxyObject* pObject )
+{
+    std::unordered_map<SpaceProxyObject*, unsigned int>::iterator slotIter = mSlotIndices.find(pObject);
+    if(slotIter != mSlotIndices.end()) return slotIter->second;
+
+    unsigned int slot;
+
+    if(mFreeSlots.size() > 0)
+    {
+        slot = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else
+    {
+        slot = mSlots.size();
+        mSlots.push_back(Slot());
+        mSlotCodes.resize( mSlotCodes.size() + mQuantizer.codeSize() );
+    }
+
+    mSlots[slot].mFingerprint = 0;
+    mSlots[slot].mObjectIndex = sNoObject;
+    mSlots[slot].mEncoded = false;
+    mSlotIndices[pObject] = slot;
+
+    return slot;
+}
+
+uint64_t
+PQAlg::fingerprint( const Eigen::VectorXf& pPosition ) const
+{
+    uint64_t hash = 14695981039346656037ull;
+    unsigned int dim = pPosition.rows();
+
+    for(unsigned int d=0; d<dim; ++d)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, pPosition.data() + d, sizeof(bits));
+
+        hash = ( hash ^ bits ) * 1099511628211ull;
+    }
+
+    return hash;
+}
+
+void
+PQAlg::trainQuantizer( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    unsigned int dim = mMinPos.rows();
+    unsigned int objectCount = pObjects.size();
+    unsigned int sampleCount = std::min(objectCount, mTrainingSampleCount);
+    double sampleStep = static_cast<double>(objectCount) / static_cast<double>(sampleCount);
+
+    std::vector<float> samples(sampleCount * dim);
+
+    for(unsigned int sI=0; sI<sampleCount; ++sI)
+    {
+        const Eigen::VectorXf& position = pObjects[ static_cast<unsigned int>(sI * sampleStep) ]->position();
+        std::copy(position.data(), position.data() + dim, samples.begin() + sI * dim);
+    }
+
+    mQuantizer.train(samples.data(), sampleCount);
+
+    // all codes refer to the previous codebooks
+    unsigned int slotCount = mSlots.size();
+    for(unsigned int sI=0; sI<slotCount; ++sI) mSlots[sI].mEncoded = false;
+
+    mTrainingRequested = false;
+}
+
+void
+PQAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        unsigned int objectCount = pObjects.size();
+        unsigned int codeSize = mQuantizer.codeSize();
+        const unsigned int blockSize = 64;
+        unsigned int blockCount = ( objectCount + blockSize - 1 ) / blockSize;
+
+        mObjects = pObjects;
+        mObjectSlots.resize(objectCount);
+
+        unsigned int slotCount = mSlots.size();
+        for(unsigned int sI=0; sI<slotCount; ++sI) mSlots[sI].mObjectIndex = sNoObject;
+
+        if(objectCount == 0) return;
+
+        if( mQuantizer.trained() == false || mTrainingRequested == true ) trainQuantizer(pObjects);
+
+        for(unsigned int oI=0; oI<objectCount; ++oI)
+        {
+            mObjectSlots[oI] = slotIndex(pObjects[oI]);
+            mSlots[ mObjectSlots[oI] ].mObjectIndex = oI;
+            pObjects[oI]->setIndex(oI);
+        }
+
+        // encode moved objects
+        SpaceParallelTools::get().run(blockCount, [this, &pObjects, objectCount, codeSize, blockSize](unsigned int pTaskIndex, unsigned int)
+        {
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+
+            for(unsigned int oI=pTaskIndex * blockSize; oI<objectEnd; ++oI)
+            {
+                const Eigen::VectorXf& position = pObjects[oI]->position();
+                Slot& slot = mSlots[ mObjectSlots[oI] ];
+                SpaceProductQuantizer::Code* slotCode = mSlotCodes.data() + mObjectSlots[oI] * codeSize;
+                uint64_t positionFingerprint = fingerprint(position);
+
+                if(slot.mEncoded == false || slot.mFingerprint != positionFingerprint)
+                {
+                    mQuantizer.encode(position.data(), slotCode);
+                    slot.mFingerprint = positionFingerprint;
+                    slot.mEncoded = true;
+                }
+            }
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update product quantized positions", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+void
+PQAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+        unsigned int dim = mMinPos.rows();
+        unsigned int objectCount = pObjects.size();
+        unsigned int threadCount = parallelTools.threadCount();
+        const unsigned int blockSize = 16;
+        unsigned int blockCount = ( objectCount + blockSize - 1 ) / blockSize;
+
+        if(mQueryBuffers.size() < threadCount) mQueryBuffers.resize(threadCount);
+
+        for(unsigned int tI=0; tI<threadCount; ++tI)
+        {
+            QueryBuffer& buffer = mQueryBuffers[tI];
+            buffer.mDistanceTable.resize(mQuantizer.subspaceCount() * mQuantizer.centroidCount());
+            buffer.mDistances.resize(1024);
+            if(buffer.mDirection.rows() != dim) buffer.mDirection.resize(dim);
+        }
+
+        parallelTools.run(blockCount, [this, &pObjects, objectCount, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            QueryBuffer& buffer = mQueryBuffers[pThreadIndex];
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+
+            for(unsigned int oI=pTaskIndex * blockSize; oI<objectEnd; ++oI) searchNeighbors(pObjects[oI], buffer);
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update neighbors based on product quantized positions", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+void
+PQAlg::searchNeighbors( SpaceProxyObject* pObject, QueryBuffer& pBuffer ) const throw (Exception)
+{
+    pObject->removeNeighbors();
+
+    int maxNeighborCount = pObject->maxNeighborCount();
+    if(maxNeighborCount == 0 || mObjects.size() == 0) return;
+
+    const SpaceSimdTools& simdTools = SpaceSimdTools::get();
+
+    unsigned int dim = mMinPos.rows();
+    unsigned int visibleCount = mObjects.size();
+    unsigned int slotCount = mSlots.size();
+    unsigned int codeSize = mQuantizer.codeSize();
+    const Eigen::VectorXf& position = pObject->position();
+    float neighborRadius = pObject->neighborRadius();
+    float squaredNeighborRadius = neighborRadius >= 0.0 ? neighborRadius * neighborRadius : FLT_MAX;
+    unsigned int candidateLimit = std::max( mRerankCount, static_cast<unsigned int>( std::max(maxNeighborCount, 0) ) );
+
+    unsigned int selfIndex = pObject->index();
+    if(selfIndex >= visibleCount || mObjects[selfIndex] != pObject) selfIndex = visibleCount;
+
+    // scan compressed positions of all slots with approximate distances
+    mQuantizer.distanceTable(position.data(), pBuffer.mDistanceTable.data());
+
+    const float* distanceTable = pBuffer.mDistanceTable.data();
+    float* distances = pBuffer.mDistances.data();
+    unsigned int blockSize = pBuffer.mDistances.size();
+    std::vector< std::pair<float, unsigned int> >& candidates = pBuffer.mCandidates;
+    candidates.clear();
+
+    for(unsigned int blockBegin=0; blockBegin<slotCount; blockBegin += blockSize)
+    {
+        unsigned int blockEnd = std::min(blockBegin + blockSize, slotCount);
+
+        mQuantizer.asymmetricDistances(distanceTable, mSlotCodes.data() + blockBegin * codeSize, blockEnd - blockBegin, distances);
+
+        for(unsigned int sI=blockBegin; sI<blockEnd; ++sI)
+        {
+            unsigned int oI = mSlots[sI].mObjectIndex;
+            if(oI == sNoObject || oI == selfIndex) continue;
+
+            float distance = distances[sI - blockBegin];
+
+            if(candidates.size() < candidateLimit)
+            {
+                candidates.push_back( std::make_pair(distance, oI) );
+                if(candidates.size() == candidateLimit) std::make_heap(candidates.begin(), candidates.end());
+            }
+            else if(distance < candidates.front().first)
+            {
+                std::pop_heap(candidates.begin(), candidates.end());
+                candidates.back() = std::make_pair(distance, oI);
+                std::push_heap(candidates.begin(), candidates.end());
+            }
+        }
+    }
+
+    // rerank candidates with exact positions
+    std::vector< std::pair<float, unsigned int> >& neighbors = pBuffer.mNeighbors;
+    neighbors.clear();
+
+    unsigned int candidateCount = candidates.size();
+    for(unsigned int cI=0; cI<candidateCount; ++cI)
+    {
+        float squaredDistance = simdTools.squaredDistance(position.data(), mObjects[candidates[cI].second]->position().data(), dim);
+        if(squaredDistance <= squaredNeighborRadius) neighbors.push_back( std::make_pair(squaredDistance, candidates[cI].second) );
+    }
+
+    std::sort(neighbors.begin(), neighbors.end());
+
+    unsigned int neighborCount = neighbors.size();
+    if(maxNeighborCount > 0) neighborCount = std::min( neighborCount, static_cast<unsigned int>(maxNeighborCount) );
+
+    for(unsigned int nI=0; nI<neighborCount; ++nI)
+    {
+        SpaceProxyObject* neighborObject = mObjects[neighbors[nI].second];
+        pBuffer.mDirection = neighborObject->position() - position;
+
+        pObject->addNeighbor(neighborObject->spaceObject(), sqrt(neighbors[nI].first), pBuffer.mDirection);
+    }
+}
+
+bool
+PQAlg::symmetricNeighborsSupported() const
+{
+    return false;
+}
+
+PQAlg::operator std::string() const
+{
+    return info();
+}
+
+std::string
+PQAlg::info() const
+{
+    std::stringstream stream;
+
+    unsigned long compressedSize = compressedMemorySize();
+    unsigned long uncompressedSize = uncompressedMemorySize();
+
+    stream << "PQAlg\n";
+    stream << "rerankCount: " << mRerankCount << "\n";
+    stream << "trainingSampleCount: " << mTrainingSampleCount << "\n";
+    stream << "objectCount: " << mSlotIndices.size() << "\n";
+    stream << "compressedMemorySize: " << compressedSize << " bytes\n";
+    stream << "uncompressedMemorySize: " << uncompressedSize << " bytes (retained for reranking)\n";
+    stream << "memorySize: " << memorySize() << " bytes\n";
+    stream << mQuantizer.info();
+    stream << SpaceAlg::info();
+
+    return stream.str();
+}
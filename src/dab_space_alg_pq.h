@@ -0,0 +1,216 @@
+/** \file dab_space_alg_pq.h
+ */
+
+#ifndef _dab_space_alg_pq_h_
+#define _dab_space_alg_pq_h_
+
+#include <unordered_map>
+#include <Eigen/Dense>
+#include "dab_space_alg.h"
+#include "dab_space_product_quantizer.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+/**
+ \brief approximate neighbor search on product quantized positions
+
+ positions of visible objects are compressed with a product quantizer whose codebooks are trained on a sample of visible objects.\n
+ each object searching for neighbors scans the compressed positions using asymmetric distance computation and reranks the closest candidates with their exact positions.\n
+ positions are only reencoded if they have changed, the compressed positions occupy one byte per subspace instead of four bytes per dimension.\n
+ the exact positions remain stored in the objects for reranking, compression therefore speeds up the scan but doesn't reduce the memory occupied by the space.\n
+ each query still scans the codes of all objects, the cost of a neighbor search grows linearly with the number of objects (O(N) asymmetric distance computations).\n
+ since neighbors are only searched among the reranked candidates, objects with unlimited neighbor count receive at most rerankCount neighbors.
+ */
+class PQAlg : public SpaceAlg
+{
+public:
+    /**
+     \brief create product quantization alg
+     \param pDim dimension
+     \param pSubspaceCount number of subspaces (code size in bytes)
+     \param pCentroidCount number of centroids per subspace
+     \param pRerankCount number of candidates that are reranked with exact positions
+     \exception Exception invalid subspace or centroid count
+     */
+    PQAlg(unsigned int pDim, unsigned int pSubspaceCount, unsigned int pCentroidCount = 256, unsigned int pRerankCount = 64) throw (Exception);
+
+    /**
+     \brief create product quantization alg
+     \param pMinPos minimum position
+     \param pMaxPos maximum position
+     \param pSubspaceCount number of subspaces (code size in bytes)
+     \param pCentroidCount number of centroids per subspace
+     \param pRerankCount number of candidates that are reranked with exact positions
+     \exception Exception dimension mismatch, invalid subspace or centroid count
+     */
+    PQAlg(const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, unsigned int pSubspaceCount, unsigned int pCentroidCount = 256, unsigned int pRerankCount = 64) throw (Exception);
+
+    ~PQAlg();
+
+    /**
+     \brief return product quantizer
+     \return product quantizer
+     */
+    const SpaceProductQuantizer& quantizer() const;
+
+    unsigned int rerankCount() const;
+    unsigned int trainingSampleCount() const;
+
+    /**
+     \brief set number of candidates that are reranked with exact positions
+     \param pRerankCount rerank count
+     \exception Exception rerank count is zero
+
+     at least as many candidates as the maximum neighbor count of an object are reranked
+     */
+    void setRerankCount(unsigned int pRerankCount) throw (Exception);
+
+    /**
+     \brief set maximum number of visible objects used for training the codebooks
+     \param pTrainingSampleCount training sample count
+     \exception Exception training sample count is zero
+     */
+    void setTrainingSampleCount(unsigned int pTrainingSampleCount) throw (Exception);
+
+    /**
+     \brief retrain codebooks and reencode all positions during next structure update
+     */
+    void train();
+
+    /**
+     \brief return number of bytes occupied by compressed positions and codebooks
+     \return compressed memory size
+     */
+    unsigned long compressedMemorySize() const;
+
+    /**
+     \brief return number of bytes occupied by the exact positions that are retained for reranking
+     \return uncompressed memory size
+     */
+    unsigned long uncompressedMemorySize() const;
+
+    /**
+     \brief return number of bytes occupied by compressed and exact positions
+     \return memory size
+     */
+    unsigned long memorySize() const;
+
+    void addObject( SpaceProxyObject* pObject ) throw (Exception);
+    void removeObject( SpaceProxyObject* pObject ) throw (Exception);
+    void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+    void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+
+    /**
+     \brief symmetric neighbor calculation is not supported
+     \return false
+
+     distances are approximated from the perspective of the object searching for neighbors
+     */
+    bool symmetricNeighborsSupported() const;
+
+    /**
+     \brief obtain textual product quantization alg information
+     \return String containing textual product quantization alg information
+     */
+    operator std::string() const;
+
+    /**
+     \brief obtain textual product quantization alg information
+     \return String containing textual product quantization alg information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual product quantization alg information
+     \param pOstream output stream
+     \param pAlg product quantization alg
+     */
+    friend std::ostream& operator<< (std::ostream & pOstream, const PQAlg& pAlg)
+    {
+        pOstream << std::string(pAlg);
+
+        return pOstream;
+    }
+
+protected:
+    /**
+     \brief compressed position of an object
+     */
+    class Slot
+    {
+    public:
+        uint64_t mFingerprint; ///\brief hash of position at time of encoding
+        unsigned int mObjectIndex; ///\brief index of visible object occupying the slot (sNoObject if slot is free or object is invisible)
+        bool mEncoded; ///\brief code is valid
+    };
+
+    /**
+     \brief per thread query buffers
+     */
+    class QueryBuffer
+    {
+    public:
+        std::vector<float> mDistanceTable; ///\brief distances between query and centroids
+        std::vector<float> mDistances; ///\brief approximate distances of a block of visible objects
+        std::vector< std::pair<float, unsigned int> > mCandidates; ///\brief closest candidates (max heap of approximate squared distance and visible object index)
+        std::vector< std::pair<float, unsigned int> > mNeighbors; ///\brief reranked candidates (exact squared distance and visible object index)
+        Eigen::VectorXf mDirection; ///\brief neighbor direction
+    };
+
+    static const unsigned int sNoObject; ///\brief object index of slots without visible object
+
+    PQAlg();
+
+    /**
+     \brief return slot of object, a slot is allocated if the object doesn't have one yet
+     \param pObject proxy object
+     \return slot index
+     */
+    unsigned int slotIndex( SpaceProxyObject* pObject );
+
+    /**
+     \brief calculate hash of position
+     \param pPosition position
+     \return fingerprint
+     */
+    uint64_t fingerprint( const Eigen::VectorXf& pPosition ) const;
+
+    /**
+     \brief train codebooks on a sample of visible objects
+     \param pObjects visible objects
+     \exception Exception training failed
+     */
+    void trainQuantizer( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+
+    /**
+     \brief search neighbors of an object
+     \param pObject proxy object
+     \param pBuffer query buffer
+     */
+    void searchNeighbors( SpaceProxyObject* pObject, QueryBuffer& pBuffer ) const throw (Exception);
+
+    SpaceProductQuantizer mQuantizer; ///\brief product quantizer
+    unsigned int mRerankCount; ///\brief number of candidates reranked with exact positions
+    unsigned int mTrainingSampleCount; ///\brief maximum number of objects used for training
+    bool mTrainingRequested; ///\brief codebooks are retrained during next structure update
+
+    std::unordered_map<SpaceProxyObject*, unsigned int> mSlotIndices; ///\brief slot index for each proxy object
+    std::vector<Slot> mSlots; ///\brief slots of all objects
+    std::vector<SpaceProductQuantizer::Code> mSlotCodes; ///\brief codes of all objects stored contiguously for scanning (codeSize values per slot)
+    std::vector<unsigned int> mFreeSlots; ///\brief indices of unused slots
+
+    std::vector< SpaceProxyObject* > mObjects; ///\brief visible objects
+    std::vector<unsigned int> mObjectSlots; ///\brief slot index of each visible object
+
+    std::vector<QueryBuffer> mQueryBuffers; ///\brief query buffers for each thread
+};
+
+};
+
+};
+
+#endif
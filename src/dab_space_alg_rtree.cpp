@@ -3,23 +3,68 @@
 
 #include "dab_space_alg_rtree.h"
 #include "dab_space_proxy_object.h"
+#include "dab_space_parallel.h"
+#include "dab_space_simd.h"
+#include "dab_space_shape_tools.h"
 #include "dab_geom_cuboid.h"
-#include "dab_geom_cuboid_tools.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 using namespace dab;
 using namespace dab::space;
 
+const float RTreeAlg::sDefaultRebuildFraction = 0.1;
+const float RTreeAlg::sRayHitTolerance = 0.001;
+const unsigned int RTreeAlg::sMaxRayHitSteps = 64;
+
+RTreeAlg::Ray::Ray()
+: mOrigin(0.0, 0.0, 0.0)
+, mDirection(1.0, 0.0, 0.0)
+, mMaxDistance(std::numeric_limits<float>::max())
+, mIgnoredObjects{ nullptr, nullptr }
+{}
+
+RTreeAlg::Ray::Ray(const Eigen::Vector3f& pOrigin, const Eigen::Vector3f& pDirection, float pMaxDistance)
+: mOrigin(pOrigin)
+, mDirection(pDirection.normalized())
+, mMaxDistance(pMaxDistance)
+, mIgnoredObjects{ nullptr, nullptr }
+{}
+
+RTreeAlg::Ray::Ray(const SpaceObject* pStartObject, const SpaceObject* pEndObject)
+: mIgnoredObjects{ pStartObject, pEndObject }
+{
+    const Eigen::VectorXf& startPosition = pStartObject->position();
+    const Eigen::VectorXf& endPosition = pEndObject->position();
+    
+    mOrigin = Eigen::Vector3f(startPosition[0], startPosition[1], startPosition[2]);
+    mDirection = Eigen::Vector3f(endPosition[0], endPosition[1], endPosition[2]) - mOrigin;
+    mMaxDistance = mDirection.norm();
+    mDirection.normalize();
+}
+
 RTreeAlg::RTreeAlg()
 : SpaceAlg(3)
-, mTree( mMinPos.rows() )
 , mClosestPointType(ClosestPointAABB)
+, mRebuildFraction(sDefaultRebuildFraction)
+, mRebuildCount(0)
+, mNearestShapeCount(0)
+, mBoundsType(BoundsAABB)
+, mDistanceFieldResolution(0)
+, mDistanceFieldRefinement(0.0)
 {}
 
 
 RTreeAlg::RTreeAlg( const Eigen::Vector3f& pMinPos, const Eigen::Vector3f& pMaxPos )
 : SpaceAlg( pMinPos, pMaxPos )
-, mTree( mMinPos.rows() )
 , mClosestPointType(ClosestPointAABB)
+, mRebuildFraction(sDefaultRebuildFraction)
+, mRebuildCount(0)
+, mNearestShapeCount(0)
+, mBoundsType(BoundsAABB)
+, mDistanceFieldResolution(0)
+, mDistanceFieldRefinement(0.0)
 {}
 
 RTreeAlg::~RTreeAlg()
@@ -37,6 +82,224 @@ RTreeAlg::setClosestPointType(ClosestShapePointType pClosestPointType)
 	mClosestPointType = pClosestPointType;
 }
 
+unsigned int
+RTreeAlg::distanceFieldResolution() const
+{
+    return mDistanceFieldResolution;
+}
+
+void
+RTreeAlg::setDistanceFieldResolution(unsigned int pResolution) throw (Exception)
+{
+    if(pResolution == 1) throw Exception("SPACE ERROR: distance field resolution must be 0 or at least 2", __FILE__, __FUNCTION__, __LINE__);
+    
+    mDistanceFieldResolution = pResolution;
+}
+
+float
+RTreeAlg::distanceFieldRefinement() const
+{
+    return mDistanceFieldRefinement;
+}
+
+void
+RTreeAlg::setDistanceFieldRefinement(float pDistance) throw (Exception)
+{
+    if(pDistance < 0.0) throw Exception("SPACE ERROR: distance field refinement " + std::to_string(pDistance) + " must not be negative", __FILE__, __FUNCTION__, __LINE__);
+    
+    mDistanceFieldRefinement = pDistance;
+}
+
+float
+RTreeAlg::rebuildFraction() const
+{
+    return mRebuildFraction;
+}
+
+void
+RTreeAlg::setRebuildFraction(float pRebuildFraction) throw (Exception)
+{
+    if(pRebuildFraction < 0.0 || pRebuildFraction > 1.0) throw Exception("SPACE ERROR: rebuild fraction " + std::to_string(pRebuildFraction) + " must be between zero and one", __FILE__, __FUNCTION__, __LINE__);
+    
+    mRebuildFraction = pRebuildFraction;
+}
+
+unsigned int
+RTreeAlg::rebuildCount() const
+{
+    return mRebuildCount;
+}
+
+ShapeBoundsType
+RTreeAlg::boundsType() const
+{
+    return mBoundsType;
+}
+
+void
+RTreeAlg::setBoundsType(ShapeBoundsType pBoundsType)
+{
+    mBoundsType = pBoundsType;
+}
+
+unsigned int
+RTreeAlg::nearestShapeCount() const
+{
+    return mNearestShapeCount;
+}
+
+void
+RTreeAlg::setNearestShapeCount(unsigned int pNearestShapeCount)
+{
+    mNearestShapeCount = pNearestShapeCount;
+}
+
+void
+RTreeAlg::nearestShapes(const Eigen::VectorXf& pPosition, unsigned int pCount, std::vector<SpaceShape*>& pShapes, std::vector<float>& pDistances) const throw (Exception)
+{
+    if(pPosition.rows() != 3) throw Exception("SPACE ERROR: position dimension " + std::to_string(pPosition.rows()) + " is not 3D ", __FILE__, __FUNCTION__, __LINE__);
+    
+    QueryBuffer buffer;
+    float point[3] = { pPosition[0], pPosition[1], pPosition[2] };
+    
+    searchNearestShapes(point, pCount, nullptr, buffer);
+    
+    pShapes.clear();
+    pDistances.clear();
+    
+    for(const std::pair<float, SpaceProxyObject*>& result : buffer.mNearestResults)
+    {
+        pShapes.push_back(result.second->spaceShape());
+        pDistances.push_back(result.first);
+    }
+}
+
+void
+RTreeAlg::castRays(const std::vector<Ray>& pRays, std::vector<RayHit>& pHits, bool pAnyHit) const throw (Exception)
+{
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+        
+        unsigned int rayCount = pRays.size();
+        const unsigned int blockSize = 16;
+        unsigned int blockCount = ( rayCount + blockSize - 1 ) / blockSize;
+        std::vector< std::vector<Tree::NearestEntry> > queues( parallelTools.threadCount() );
+        
+        pHits.resize(rayCount);
+        
+        // shapes update their matrices and bounding volumes lazily when queried, which mustn't happen concurrently
+        if(mClosestPointType != ClosestPointAABB)
+        {
+            unsigned int storedCount = mObjects.size();
+            std::vector<SpaceShape*> shapes;
+            shapes.reserve(storedCount);
+            
+            for(unsigned int i=0; i<storedCount; ++i)
+            {
+                SpaceShape* shape = mObjects[i]->spaceShape();
+                if(shape != nullptr) shapes.push_back(shape);
+            }
+            
+            SpaceShapeTools::get().update(shapes);
+        }
+        
+        parallelTools.run(blockCount, [this, &pRays, &pHits, pAnyHit, rayCount, blockSize, &queues](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            std::vector<Tree::NearestEntry>& queue = queues[pThreadIndex];
+            unsigned int rayEnd = std::min( (pTaskIndex + 1) * blockSize, rayCount );
+            std::pair<float, SpaceProxyObject*> result;
+            
+            for(unsigned int rI=pTaskIndex * blockSize; rI<rayEnd; ++rI)
+            {
+                const Ray& ray = pRays[rI];
+                
+                auto hit = [this, &ray](SpaceProxyObject* const& pObject, float pBoxDistance) -> float
+                {
+                    SpaceShape* shape = pObject->spaceShape();
+                    
+                    if(shape == nullptr || shape == ray.mIgnoredObjects[0] || shape == ray.mIgnoredObjects[1]) return std::numeric_limits<float>::max();
+                    if(mClosestPointType == ClosestPointAABB) return pBoxDistance;
+                    
+                    return shapeHitDistance(shape, ray, pBoxDistance);
+                };
+                
+                if( mTree.RaySearch(ray.mOrigin.data(), ray.mDirection.data(), ray.mMaxDistance, pAnyHit, hit, queue, result) == true )
+                {
+                    pHits[rI].mShape = result.second->spaceShape();
+                    pHits[rI].mDistance = result.first;
+                }
+                else
+                {
+                    pHits[rI].mShape = nullptr;
+                    pHits[rI].mDistance = ray.mMaxDistance;
+                }
+            }
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to cast rays", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+float
+RTreeAlg::shapeHitDistance( SpaceShape* pShape, const Ray& pRay, float pBoxDistance ) const
+{
+    const float missDistance = std::numeric_limits<float>::max();
+    glm::vec3 origin(pRay.mOrigin[0], pRay.mOrigin[1], pRay.mOrigin[2]);
+    glm::vec3 direction(pRay.mDirection[0], pRay.mDirection[1], pRay.mDirection[2]);
+    
+    // the object transform is affine, so the ray keeps its parametrization in object coordinates
+    glm::vec3 objectOrigin = pShape->world2object(origin);
+    glm::vec3 objectDirection = pShape->world2object(origin + direction) - objectOrigin;
+    const geom::Cuboid& objectBox = pShape->ocAABB();
+    const glm::vec3 boxMin = objectBox.minPos();
+    const glm::vec3 boxMax = objectBox.maxPos();
+    float enterDistance = pBoxDistance;
+    float exitDistance = pRay.mMaxDistance;
+    
+    for(int d=0; d<3; ++d)
+    {
+        if(objectDirection[d] == 0.0)
+        {
+            if(objectOrigin[d] < boxMin[d] || objectOrigin[d] > boxMax[d]) return missDistance;
+            continue;
+        }
+        
+        float distance1 = ( boxMin[d] - objectOrigin[d] ) / objectDirection[d];
+        float distance2 = ( boxMax[d] - objectOrigin[d] ) / objectDirection[d];
+        
+        enterDistance = std::max( enterDistance, std::min(distance1, distance2) );
+        exitDistance = std::min( exitDistance, std::max(distance1, distance2) );
+    }
+    
+    if(enterDistance > exitDistance) return missDistance;
+    
+    // march along the ray by the distance to the closest point on the geometry, which can't step across the geometry
+    const geom::Cuboid& worldBox = pShape->AABB();
+    float tolerance = sRayHitTolerance * glm::length( worldBox.maxPos() - worldBox.minPos() );
+    float distance = enterDistance;
+    glm::vec3 point;
+    glm::vec3 closestPoint;
+    int feature = -1;
+    
+    for(unsigned int step=0; step<sMaxRayHitSteps && distance <= exitDistance; ++step)
+    {
+        point = origin + direction * distance;
+        pShape->closestPoint(point, closestPoint, feature);
+        
+        float geometryDistance = glm::length(closestPoint - point);
+        
+        if(geometryDistance <= tolerance) return distance;
+        
+        distance += geometryDistance;
+    }
+    
+    return missDistance;
+}
+
 void
 RTreeAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
 {
@@ -44,51 +307,86 @@ RTreeAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (E
     
 	try
 	{
-		mTree.RemoveAll();
+        updateBoxes(pObjects);
         
-		unsigned int objectCount = pObjects.size();
-		
-        //		std::cout << "objectCount " << objectCount << "\n";
-		
-		for(unsigned int i=0; i<objectCount; ++i)
-		{
-			SpaceProxyObject* proxyObject = pObjects[i];
-			SpaceObject* spaceObject = proxyObject->spaceObject();
-            
-			if(proxyObject->visible() == true)
-			{
-				SpaceShape* spaceShape = dynamic_cast<SpaceShape*>( spaceObject );
-				
-				if(spaceShape != nullptr)
-				{
-					const geom::Cuboid& aabb = spaceShape->AABB();
-					const glm::vec3 minPos = aabb.minPos();
-					const glm::vec3 maxPos = aabb.maxPos();
-					std::array<float, 3>  minArray = { minPos.x, minPos.y, minPos.z };
-					std::array<float, 3>  maxArray = { maxPos.x, maxPos.y, maxPos.z };
-
-					mTree.Insert(minArray.data(), maxArray.data(), proxyObject);
-					
-					// std::cout << "insert shape " << i << " aabb " << aabb << "\n";
-				}
-				else
-				{
-					float neighborRadius = proxyObject->neighborRadius();
-					const Eigen::VectorXf& position = proxyObject->position();
-                    float minPos[3];
-                    float maxPos[3];
-                    for(int d=0; d<3; ++d)
-                    {
-                        minPos[d] = position[0] - neighborRadius;
-                        maxPos[d] = position[0] + neighborRadius;
-                    }
-                    
-					mTree.Insert(minPos, maxPos, proxyObject);
-					
-					// std::cout << "insert agent " << i << " aabb " << aabb << "\n";
-				}
-			}
-		}
+		unsigned int objectCount = mUpdateObjects.size();
+        unsigned int storedCount = mObjects.size();
+        
+        // find objects whose box is unchanged since they have been stored in the tree
+        std::vector<int> storedIndices(objectCount, -1);
+        std::vector<bool> unchanged(storedCount, false);
+        unsigned int changedCount = storedCount;
+        
+        for(unsigned int i=0; i<objectCount; ++i)
+        {
+            auto indexIter = mIndices.find( mUpdateObjects[i] );
+            
+            if(indexIter == mIndices.end())
+            {
+                changedCount++;
+                continue;
+            }
+            
+            unsigned int storedIndex = indexIter->second;
+            storedIndices[i] = storedIndex;
+            
+            if( std::equal( mUpdateMins.begin() + i * 3, mUpdateMins.begin() + i * 3 + 3, mMins.begin() + storedIndex * 3 ) && std::equal( mUpdateMaxs.begin() + i * 3, mUpdateMaxs.begin() + i * 3 + 3, mMaxs.begin() + storedIndex * 3 ) )
+            {
+                unchanged[storedIndex] = true;
+                changedCount--;
+            }
+        }
+        
+        if( storedCount == 0 || static_cast<float>(changedCount) > mRebuildFraction * static_cast<float>(objectCount) )
+        {
+            mTree.BulkLoad( mUpdateMins.data(), mUpdateMaxs.data(), mUpdateObjects.data(), objectCount );
+            mRebuildCount++;
+        }
+        else
+        {
+            for(unsigned int i=0; i<storedCount; ++i)
+            {
+                if(unchanged[i] == false) mTree.Remove( mMins.data() + i * 3, mMaxs.data() + i * 3, mObjects[i] );
+            }
+            
+            for(unsigned int i=0; i<objectCount; ++i)
+            {
+                if(storedIndices[i] < 0 || unchanged[ storedIndices[i] ] == false) mTree.Insert( mUpdateMins.data() + i * 3, mUpdateMaxs.data() + i * 3, mUpdateObjects[i] );
+            }
+        }
+        
+        mObjects.swap(mUpdateObjects);
+        mMins.swap(mUpdateMins);
+        mMaxs.swap(mUpdateMaxs);
+        
+        mIndices.clear();
+        for(unsigned int i=0; i<objectCount; ++i)
+        {
+            mIndices[ mObjects[i] ] = i;
+            mObjects[i]->setIndex(i);
+        }
+        
+        // distance fields are looked up here, since neighbor searches run in parallel and only read them
+        // the previous fields are kept alive until the lookup is done, the registry only holds weak references and would otherwise rebuild every field
+        std::vector< std::shared_ptr<SpaceDistanceField> > distanceFields;
+        
+        if(mDistanceFieldResolution > 0 && mClosestPointType == ClosestPointShape)
+        {
+            distanceFields.resize(objectCount);
+            
+            for(unsigned int i=0; i<objectCount; ++i)
+            {
+                SpaceShape* shape = mObjects[i]->spaceShape();
+                
+                if(shape == nullptr) continue;
+                
+                std::shared_ptr<SpaceTriangleMesh> triangleMesh = shape->triangleMesh();
+                
+                if(triangleMesh != nullptr) distanceFields[i] = SpaceDistanceField::create(triangleMesh, mDistanceFieldResolution);
+            }
+        }
+        
+        mDistanceFields.swap(distanceFields);
 	}
 	catch(Exception& e)
 	{
@@ -98,6 +396,48 @@ RTreeAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (E
     //	std::cout << "RTreeAlg::updateStructure( QVector< SpaceProxyObject* >& pObjects ) end\n";
 }
 
+void
+RTreeAlg::updateBoxes( std::vector< SpaceProxyObject* >& pObjects )
+{
+    mUpdateObjects.clear();
+    mUpdateMins.clear();
+    mUpdateMaxs.clear();
+    
+    unsigned int objectCount = pObjects.size();
+    
+    for(unsigned int i=0; i<objectCount; ++i)
+    {
+        SpaceProxyObject* proxyObject = pObjects[i];
+        
+        if(proxyObject->visible() == false) continue;
+        
+        SpaceShape* spaceShape = proxyObject->spaceShape();
+        
+        mUpdateObjects.push_back(proxyObject);
+        
+        if(spaceShape != nullptr)
+        {
+            const geom::Cuboid& aabb = spaceShape->AABB();
+            const glm::vec3 minPos = aabb.minPos();
+            const glm::vec3 maxPos = aabb.maxPos();
+            
+            mUpdateMins.insert( mUpdateMins.end(), { minPos.x, minPos.y, minPos.z } );
+            mUpdateMaxs.insert( mUpdateMaxs.end(), { maxPos.x, maxPos.y, maxPos.z } );
+        }
+        else
+        {
+            float neighborRadius = proxyObject->neighborRadius();
+            const Eigen::VectorXf& position = proxyObject->position();
+            
+            for(int d=0; d<3; ++d)
+            {
+                mUpdateMins.push_back( position[d] - neighborRadius );
+                mUpdateMaxs.push_back( position[d] + neighborRadius );
+            }
+        }
+    }
+}
+
 void
 RTreeAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
 {
@@ -105,112 +445,296 @@ RTreeAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (E
     
 	try
 	{
-		unsigned int dim = 3;
-        
-		geom::Cuboid cuboid;
-        glm::vec3 closestPoint;
-		glm::vec3 direction;
-		float distance;
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
         
 		unsigned int objectCount = pObjects.size();
-		
-        //		std::cout << "objectCount " << objectCount << "\n";
-		
-		for(unsigned int i=0; i<objectCount; ++i)
-		{
-			SpaceProxyObject* proxyObject = pObjects[i];
-			SpaceObject* spaceObject = proxyObject->spaceObject();
-            
-			if(proxyObject->canHaveNeighbors() == true)
-			{
-				proxyObject->removeNeighbors();
-                
-                geom::Cuboid searchAABB;
-                std::vector<SpaceProxyObject*> searchResults;
-				
-				SpaceShape* spaceShape = dynamic_cast<SpaceShape*>( spaceObject );
-				
-				if(spaceShape != nullptr)
-				{
-					searchAABB = spaceShape->AABB();
-				}
-				else
-				{
-					float neighborRadius = proxyObject->neighborRadius();
-					//if(neighborRadius == 0.0) neighborRadius = 0.00001;
-					const Eigen::VectorXf& position = proxyObject->position();
-                    
-					searchAABB = geom::Cuboid( glm::vec3( position[0] - neighborRadius, position[1] - neighborRadius, position[2] - neighborRadius ), glm::vec3( position[0] + neighborRadius, position[1] + neighborRadius, position[2] + neighborRadius ) );
-				}
-				
-				// std::cout << "search neighbors " << searchAABB << ": ";
-				
-				//mTree.Search(baabb.minPos().values(), baabb.maxPos().values(), searchResults);
-				const glm::vec3 minPos = searchAABB.minPos();
-				const glm::vec3 maxPos = searchAABB.maxPos();
-				std::array<float, 3>  minArray = { minPos.x, minPos.y, minPos.z };
-				std::array<float, 3>  maxArray = { maxPos.x, maxPos.y, maxPos.z };
-
-				mTree.Search(minArray.data(), maxArray.data(), searchResults);
-				
-				unsigned int resultCount = searchResults.size();
-				
-				// std::cout << "resultCount " << resultCount << "\n";
+        unsigned int threadCount = parallelTools.threadCount();
+        const unsigned int blockSize = 16;
+        unsigned int blockCount = ( objectCount + blockSize - 1 ) / blockSize;
+        
+        if(mQueryBuffers.size() < threadCount) mQueryBuffers.resize(threadCount);
+        
+        // the structure update has brought the transforms and bounding boxes of all visible shapes up to date, searching them doesn't modify them
+        parallelTools.run(blockCount, [this, &pObjects, objectCount, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            QueryBuffer& buffer = mQueryBuffers[pThreadIndex];
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+            
+            for(unsigned int oI=pTaskIndex * blockSize; oI<objectEnd; ++oI)
+            {
+                if(pObjects[oI]->canHaveNeighbors() == false) continue;
                 
-				if(mClosestPointType == ClosestPointAABB)
-				{
-					for(unsigned int j=0; j<resultCount; ++j)
-					{
-						SpaceShape* shape = dynamic_cast<SpaceShape*>( searchResults[j]->spaceObject() );
-						
-						if( shape == nullptr ) continue;
-						
-						//SpaceShape* shape = static_cast<SpaceShape*>( searchResults[j]->spaceObject() );
-						
-						// create temporary cuboid geometry for closest point calculation
-						cuboid = shape->AABB();
-                        
-						// calculate closest point from space obejct to cuboid surface
-                        const Eigen::VectorXf& proxyPos = proxyObject->position();
-						glm::vec3 searchPos(proxyPos[0], proxyPos[1], proxyPos[2]);
-						geom::CuboidTools::get().closestPoint( searchPos, closestPoint, cuboid);
-						
-						direction = closestPoint - searchPos;
-						distance = glm::length(direction);
-						
-						bool createNeighborResult = proxyObject->addNeighbor(shape, distance, Eigen::Vector3f(direction[0], direction[1], direction[2]));
-					}
-				}
-				else if(mClosestPointType == ClosestPointShape)
-				{
-					for(unsigned int j=0; j<resultCount; ++j)
-					{
-						SpaceShape* shape = dynamic_cast<SpaceShape*>( searchResults[j]->spaceObject() );
-                        
-						if( shape == nullptr ) continue;
-						
-						//SpaceShape* shape = static_cast<SpaceShape*>( searchResults[j]->spaceObject() );
-                        
-						// calculate closest point from space obejct to shape
-                        const Eigen::VectorXf& proxyPos = proxyObject->position();
-						glm::vec3 searchPos(proxyPos[0], proxyPos[1], proxyPos[2]);
-                        
-						shape->closestPoint(searchPos, closestPoint);
-						direction = closestPoint - searchPos;
-						distance = glm::length(direction);
-						bool createNeighborResult = proxyObject->addNeighbor(shape, distance, Eigen::Vector3f(direction[0], direction[1], direction[2]));
-					}
-				}
-			}
-		}
+                searchNeighbors(pObjects[oI], buffer);
+            }
+        });
 	}
 	catch(Exception& e)
 	{
         e += Exception("SPACE ERROR: failed to update RTreeAlg", __FILE__, __FUNCTION__, __LINE__);
-		throw;
+		throw e;
 	}
-	
-    //	std::cout << "RTreeAlg::updateNeighbors( QVector< SpaceProxyObject* >& pObjects ) end\n";
+}
+
+void
+RTreeAlg::searchNeighbors( SpaceProxyObject* pObject, QueryBuffer& pBuffer ) const throw (Exception)
+{
+    pObject->removeNeighbors();
+    
+    unsigned int storedCount = mObjects.size();
+    unsigned int selfIndex = pObject->index();
+    const Eigen::VectorXf& position = pObject->position();
+    
+    if(mNearestShapeCount > 0)
+    {
+        float point[3] = { position[0], position[1], position[2] };
+        searchNearestShapes(point, mNearestShapeCount, pObject, pBuffer);
+        
+        glm::vec3 searchPos(position[0], position[1], position[2]);
+        glm::vec3 closestPoint;
+        glm::vec3 direction;
+        
+        for(const std::pair<float, SpaceProxyObject*>& result : pBuffer.mNearestResults)
+        {
+            closestShapePoint(searchPos, result.second, closestPoint);
+            direction = closestPoint - searchPos;
+            
+            pObject->addNeighbor(result.second->spaceShape(), result.first, Eigen::Vector3f(direction[0], direction[1], direction[2]));
+        }
+        
+        return;
+    }
+    float searchMin[3];
+    float searchMax[3];
+    
+    if(selfIndex < storedCount && mObjects[selfIndex] == pObject)
+    {
+        std::copy( mMins.begin() + selfIndex * 3, mMins.begin() + selfIndex * 3 + 3, searchMin );
+        std::copy( mMaxs.begin() + selfIndex * 3, mMaxs.begin() + selfIndex * 3 + 3, searchMax );
+    }
+    else if(pObject->spaceShape() != nullptr)
+    {
+        const geom::Cuboid& aabb = pObject->spaceShape()->AABB();
+        const glm::vec3 minPos = aabb.minPos();
+        const glm::vec3 maxPos = aabb.maxPos();
+        
+        for(int d=0; d<3; ++d)
+        {
+            searchMin[d] = minPos[d];
+            searchMax[d] = maxPos[d];
+        }
+    }
+    else
+    {
+        float neighborRadius = pObject->neighborRadius();
+        
+        for(int d=0; d<3; ++d)
+        {
+            searchMin[d] = position[d] - neighborRadius;
+            searchMax[d] = position[d] + neighborRadius;
+        }
+    }
+    
+    std::vector<SpaceProxyObject*>& searchResults = pBuffer.mSearchResults;
+    mTree.Search(searchMin, searchMax, searchResults);
+    
+    if(mBoundsType != BoundsAABB) filterByDOP(pObject, searchMin, searchMax, searchResults);
+    
+    unsigned int resultCount = searchResults.size();
+    
+    if(mClosestPointType == ClosestPointAABB)
+    {
+        // gather stored boxes of shapes and calculate closest points on all boxes at once
+        float query[3] = { position[0], position[1], position[2] };
+        std::vector<SpaceShape*>& shapes = pBuffer.mShapes;
+        shapes.clear();
+        
+        unsigned int boxStride = SpaceSimdTools::pointStride(resultCount);
+        if(pBuffer.mBoxMins.size() < boxStride * 3)
+        {
+            pBuffer.mBoxMins.resize(boxStride * 3);
+            pBuffer.mBoxMaxs.resize(boxStride * 3);
+            pBuffer.mDirections.resize(boxStride * 3);
+            pBuffer.mDistances.resize(boxStride);
+        }
+        
+        float* boxMins = pBuffer.mBoxMins.data();
+        float* boxMaxs = pBuffer.mBoxMaxs.data();
+        
+        for(unsigned int j=0; j<resultCount; ++j)
+        {
+            SpaceProxyObject* resultObject = searchResults[j];
+            SpaceShape* shape = resultObject->spaceShape();
+            
+            if( shape == nullptr ) continue;
+            
+            unsigned int boxIndex = shapes.size();
+            unsigned int resultIndex = resultObject->index();
+            
+            for(int d=0; d<3; ++d)
+            {
+                boxMins[d * boxStride + boxIndex] = mMins[resultIndex * 3 + d];
+                boxMaxs[d * boxStride + boxIndex] = mMaxs[resultIndex * 3 + d];
+            }
+            
+            shapes.push_back(shape);
+        }
+        
+        unsigned int shapeCount = shapes.size();
+        const float* directions = pBuffer.mDirections.data();
+        const float* distances = pBuffer.mDistances.data();
+        
+        SpaceSimdTools::get().closestBoxPoints(query, boxMins, boxMaxs, boxStride, 3, 0, shapeCount, pBuffer.mDirections.data(), pBuffer.mDistances.data());
+        
+        for(unsigned int j=0; j<shapeCount; ++j)
+        {
+            pObject->addNeighbor(shapes[j], distances[j], Eigen::Vector3f(directions[j], directions[boxStride + j], directions[2 * boxStride + j]));
+        }
+    }
+    else
+    {
+        glm::vec3 searchPos(position[0], position[1], position[2]);
+        glm::vec3 closestPoint;
+        glm::vec3 direction;
+        float distance;
+        
+        for(unsigned int j=0; j<resultCount; ++j)
+        {
+            SpaceShape* shape = searchResults[j]->spaceShape();
+            
+            if( shape == nullptr ) continue;
+            
+            // calculate closest point from space object to shape
+            if( fieldClosestPoint(searchPos, searchResults[j], closestPoint) == false )
+            {
+                if( shape->featureCaching() == true ) shape->closestPoint(searchPos, closestPoint, pObject->closestFeature(shape));
+                else shape->closestPoint(searchPos, closestPoint);
+            }
+            
+            direction = closestPoint - searchPos;
+            distance = glm::length(direction);
+            
+            pObject->addNeighbor(shape, distance, Eigen::Vector3f(direction[0], direction[1], direction[2]));
+        }
+    }
+}
+
+void
+RTreeAlg::filterByDOP( SpaceProxyObject* pObject, const float* pSearchMin, const float* pSearchMax, std::vector<SpaceProxyObject*>& pSearchResults ) const
+{
+    // the axis directions of the polytopes have already been tested by the tree search
+    unsigned int directionBegin = mBoundsType == BoundsDOP14 ? 0 : 4;
+    unsigned int directionEnd = mBoundsType == BoundsDOP14 ? 4 : SpaceShape::sDOPDirectionCount;
+    float queryMins[SpaceShape::sDOPDirectionCount];
+    float queryMaxs[SpaceShape::sDOPDirectionCount];
+    const SpaceShape* queryShape = pObject->spaceShape();
+    
+    if(queryShape != nullptr)
+    {
+        std::copy(queryShape->DOPMins(), queryShape->DOPMins() + SpaceShape::sDOPDirectionCount, queryMins);
+        std::copy(queryShape->DOPMaxs(), queryShape->DOPMaxs() + SpaceShape::sDOPDirectionCount, queryMaxs);
+    }
+    else
+    {
+        // project search box onto directions
+        glm::vec3 center( ( pSearchMin[0] + pSearchMax[0] ) * 0.5, ( pSearchMin[1] + pSearchMax[1] ) * 0.5, ( pSearchMin[2] + pSearchMax[2] ) * 0.5 );
+        glm::vec3 halfSize( ( pSearchMax[0] - pSearchMin[0] ) * 0.5, ( pSearchMax[1] - pSearchMin[1] ) * 0.5, ( pSearchMax[2] - pSearchMin[2] ) * 0.5 );
+        
+        for(unsigned int d=directionBegin; d<directionEnd; ++d)
+        {
+            const glm::vec3& direction = SpaceShape::sDOPDirections[d];
+            float centerExtent = glm::dot(direction, center);
+            float halfExtent = glm::dot(glm::abs(direction), halfSize);
+            
+            queryMins[d] = centerExtent - halfExtent;
+            queryMaxs[d] = centerExtent + halfExtent;
+        }
+    }
+    
+    unsigned int resultCount = pSearchResults.size();
+    unsigned int keptCount = 0;
+    
+    for(unsigned int rI=0; rI<resultCount; ++rI)
+    {
+        const SpaceShape* shape = pSearchResults[rI]->spaceShape();
+        
+        if(shape == nullptr) continue;
+        
+        const float* shapeMins = shape->DOPMins();
+        const float* shapeMaxs = shape->DOPMaxs();
+        bool overlap = true;
+        
+        for(unsigned int d=directionBegin; d<directionEnd && overlap == true; ++d)
+        {
+            overlap = shapeMins[d] <= queryMaxs[d] && queryMins[d] <= shapeMaxs[d];
+        }
+        
+        if(overlap == true) pSearchResults[keptCount++] = pSearchResults[rI];
+    }
+    
+    pSearchResults.resize(keptCount);
+}
+
+void
+RTreeAlg::searchNearestShapes( const float* pPoint, unsigned int pCount, const SpaceProxyObject* pExclude, QueryBuffer& pBuffer ) const
+{
+    glm::vec3 point(pPoint[0], pPoint[1], pPoint[2]);
+    
+    // the closest point on a shape lies within its bounding box, so the distance to the box bounds the distance to the shape
+    auto distance = [this, &point, pExclude](SpaceProxyObject* const& pObject, const float* pMin, const float* pMax) -> float
+    {
+        if(pObject == pExclude || pObject->spaceShape() == nullptr) return std::numeric_limits<float>::max();
+        
+        glm::vec3 closestPoint;
+        
+        if(mClosestPointType == ClosestPointAABB) closestPoint = glm::clamp(point, glm::vec3(pMin[0], pMin[1], pMin[2]), glm::vec3(pMax[0], pMax[1], pMax[2]));
+        else if( fieldClosestPoint(point, pObject, closestPoint) == false ) pObject->spaceShape()->closestPoint(point, closestPoint);
+        
+        return glm::length(closestPoint - point);
+    };
+    
+    mTree.NearestSearch(pPoint, pCount, distance, pBuffer.mNearestQueue, pBuffer.mNearestResults);
+}
+
+void
+RTreeAlg::closestShapePoint( const glm::vec3& pPoint, SpaceProxyObject* pObject, glm::vec3& pClosestPoint ) const
+{
+    if(mClosestPointType == ClosestPointAABB)
+    {
+        unsigned int index = pObject->index();
+        
+        pClosestPoint = glm::clamp(pPoint, glm::vec3(mMins[index * 3], mMins[index * 3 + 1], mMins[index * 3 + 2]), glm::vec3(mMaxs[index * 3], mMaxs[index * 3 + 1], mMaxs[index * 3 + 2]));
+    }
+    else if( fieldClosestPoint(pPoint, pObject, pClosestPoint) == false )
+    {
+        pObject->spaceShape()->closestPoint(pPoint, pClosestPoint);
+    }
+}
+
+bool
+RTreeAlg::fieldClosestPoint( const glm::vec3& pPoint, const SpaceProxyObject* pObject, glm::vec3& pClosestPoint ) const
+{
+    if(mDistanceFields.empty() == true) return false;
+    
+    const SpaceDistanceField* distanceField = mDistanceFields[ pObject->index() ].get();
+    
+    if(distanceField == nullptr) return false;
+    
+    const SpaceShape* shape = pObject->spaceShape();
+    glm::vec3 objectPoint = shape->world2object(pPoint);
+    glm::vec3 objectClosestPoint;
+    float distance;
+    
+    if( distanceField->closestPoint(objectPoint, objectClosestPoint, distance) == false || std::abs(distance) < mDistanceFieldRefinement ) return false;
+    
+    shape->object2world(objectClosestPoint, pClosestPoint);
+    
+    return true;
+}
+
+bool
+RTreeAlg::symmetricNeighborsSupported() const
+{
+    return false;
 }
 
 RTreeAlg::operator std::string() const
@@ -224,6 +748,12 @@ RTreeAlg::info() const
     std::stringstream stream;
     
     stream << "RTreeAlg\n";
+    stream << "rebuildFraction: " << mRebuildFraction << "\n";
+    stream << "rebuildCount: " << mRebuildCount << "\n";
+    stream << "nearestShapeCount: " << mNearestShapeCount << "\n";
+    stream << "boundsType: " << ( mBoundsType == BoundsAABB ? "AABB" : ( mBoundsType == BoundsDOP14 ? "14-DOP" : "18-DOP" ) ) << "\n";
+    stream << "distanceFieldResolution: " << mDistanceFieldResolution << "\n";
+    stream << "distanceFieldRefinement: " << mDistanceFieldRefinement << "\n";
     stream << SpaceAlg::info() << "\n";
     
 	return stream.str();
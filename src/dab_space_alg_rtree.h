@@ -4,9 +4,12 @@
 #ifndef _dab_space_alg_rtree_h_
 #define _dab_space_alg_rtree_h_
 
+#include <unordered_map>
+#include <limits>
 #include "dab_space_types.h"
 #include "dab_space_alg.h"
 #include "dab_space_rtree.h"
+#include "dab_space_distance_field.h"
 
 // TODO: untested
 
@@ -19,6 +22,47 @@ namespace space
 class RTreeAlg : public SpaceAlg
 {
 public:
+    /**
+     \brief ray or segment tested against the shapes in the tree
+     */
+    class Ray
+    {
+    public:
+        Ray();
+        
+        /**
+         \brief create ray
+         \param pOrigin origin
+         \param pDirection direction, is normalized
+         \param pMaxDistance maximum distance along the ray
+         */
+        Ray(const Eigen::Vector3f& pOrigin, const Eigen::Vector3f& pDirection, float pMaxDistance = std::numeric_limits<float>::max());
+        
+        /**
+         \brief create segment between two space objects
+         \param pStartObject object at start of segment
+         \param pEndObject object at end of segment
+         
+         the shapes of both objects are ignored, which turns the segment into a line of sight test between an object and its neighbor
+         */
+        Ray(const SpaceObject* pStartObject, const SpaceObject* pEndObject);
+        
+        Eigen::Vector3f mOrigin; ///\brief origin
+        Eigen::Vector3f mDirection; ///\brief direction of unit length
+        float mMaxDistance; ///\brief maximum distance along the ray
+        const SpaceObject* mIgnoredObjects[2]; ///\brief shapes that can't be hit
+    };
+    
+    /**
+     \brief shape hit by a ray
+     */
+    class RayHit
+    {
+    public:
+        SpaceShape* mShape; ///\brief shape hit by ray (nullptr: ray hits no shape)
+        float mDistance; ///\brief distance from origin of ray to hit
+    };
+    
     RTreeAlg(const Eigen::Vector3f& pMinPos, const Eigen::Vector3f& pMaxPos);
     ~RTreeAlg();
     
@@ -31,9 +75,119 @@ public:
      */
     void setClosestPointType(ClosestShapePointType pClosestPointType);
     
+    /**
+     \brief return bounding volume that shapes found by the tree search are tested against
+     \return bounds type
+     */
+    ShapeBoundsType boundsType() const;
+    
+    /**
+     \brief set bounding volume that shapes found by the tree search are tested against
+     \param pBoundsType bounds type
+     
+     14-DOPs and 18-DOPs reject shapes whose bounding boxes overlap the search box but whose discrete oriented polytopes don't, which avoids closest point calculations for rotated and elongated shapes
+     */
+    void setBoundsType(ShapeBoundsType pBoundsType);
+    
+    /**
+     \brief return number of grid points along each axis of the distance fields of mesh shapes
+     \return distance field resolution (0: no distance fields)
+     */
+    unsigned int distanceFieldResolution() const;
+    
+    /**
+     \brief set number of grid points along each axis of the distance fields of mesh shapes
+     \param pResolution distance field resolution (0: no distance fields)
+     \exception Exception resolution is 1
+     
+     with closest point type ClosestPointShape, closest points on mesh shapes are approximated by a lookup in a distance field instead of searching the mesh. shapes sharing a geometry share the distance field, which is built during the first structure update that finds one of them visible. queries outside the grid of a distance field fall back to searching the mesh
+     */
+    void setDistanceFieldResolution(unsigned int pResolution) throw (Exception);
+    
+    /**
+     \brief return distance to a mesh below which closest points are searched on the mesh even if a distance field is available
+     \return refinement distance (in object coordinates)
+     */
+    float distanceFieldRefinement() const;
+    
+    /**
+     \brief set distance to a mesh below which closest points are searched on the mesh even if a distance field is available
+     \param pDistance refinement distance (in object coordinates, 0: distance fields are always used)
+     \exception Exception distance is negative
+     
+     close to the mesh, the gradient of the distance field changes direction within a grid cell and the approximated closest points become inaccurate
+     */
+    void setDistanceFieldRefinement(float pDistance) throw (Exception);
+    
+    /**
+     \brief return fraction of moved, added or removed objects above which the tree is rebuilt by bulk loading
+     \return rebuild fraction
+     */
+    float rebuildFraction() const;
+    
+    /**
+     \brief set fraction of moved, added or removed objects above which the tree is rebuilt by bulk loading
+     \param pRebuildFraction rebuild fraction
+     \exception Exception rebuild fraction outside of range [0.0, 1.0]
+     
+     below this fraction, the entries of changed objects are removed from and reinserted into the tree
+     */
+    void setRebuildFraction(float pRebuildFraction) throw (Exception);
+    
+    /**
+     \brief return number of bulk loaded rebuilds of the tree
+     \return rebuild count
+     */
+    unsigned int rebuildCount() const;
+    
+    /**
+     \brief return number of nearest shapes each object receives as neighbors
+     \return nearest shape count (0: neighbors are the shapes whose bounding box overlaps the search box of an object)
+     */
+    unsigned int nearestShapeCount() const;
+    
+    /**
+     \brief set number of nearest shapes each object receives as neighbors
+     \param pNearestShapeCount nearest shape count (0: neighbors are the shapes whose bounding box overlaps the search box of an object)
+     
+     above zero, neighbors are found by a best first search of the tree instead of a range search and the neighbor radius of objects is ignored
+     */
+    void setNearestShapeCount(unsigned int pNearestShapeCount);
+    
+    /**
+     \brief find the visible shapes nearest to a position
+     \param pPosition position
+     \param pCount maximum number of shapes
+     \param pShapes resulting shapes, ordered by increasing distance
+     \param pDistances resulting distances
+     \exception Exception position is not 3D
+     
+     distances are calculated according to the closest point type. the search covers the shapes stored during the last structure update
+     */
+    void nearestShapes(const Eigen::VectorXf& pPosition, unsigned int pCount, std::vector<SpaceShape*>& pShapes, std::vector<float>& pDistances) const throw (Exception);
+    
+    /**
+     \brief find the shape hit first by each of a batch of rays
+     \param pRays rays
+     \param pHits resulting hits, one per ray
+     \param pAnyHit return any shape hit by a ray instead of the first one, which suffices for visibility tests and ends the search of a ray early
+     \exception Exception failed to cast rays
+     
+     with closest point type ClosestPointAABB, rays hit the bounding boxes of shapes. otherwise they are intersected with the oriented bounding boxes of shapes and then marched towards the geometry in steps of the distance to its closest point. the search covers the shapes stored during the last structure update, rays are processed in parallel after all changed shapes have been brought up to date
+     */
+    void castRays(const std::vector<Ray>& pRays, std::vector<RayHit>& pHits, bool pAnyHit = false) const throw (Exception);
+    
     void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
     void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
     
+    /**
+     \brief symmetric neighbor calculation is not supported
+     \return false
+     
+     neighbors are derived from object shapes rather than from object positions
+     */
+    bool symmetricNeighborsSupported() const;
+    
     /**
      \brief obtain textual ntree information
      \return String containing textual ntree information
@@ -59,14 +213,120 @@ public:
     }
     
 protected:
+    typedef RTree<SpaceProxyObject*, float, 3> Tree;
+    
+    /**
+     \brief buffers used by one thread during neighbor update
+     */
+    class QueryBuffer
+    {
+    public:
+        std::vector<SpaceProxyObject*> mSearchResults; ///\brief objects found by tree search
+        std::vector<SpaceShape*> mShapes; ///\brief shapes among found objects
+        std::vector<float> mBoxMins; ///\brief packed minimum corners of stored boxes of shapes
+        std::vector<float> mBoxMaxs; ///\brief packed maximum corners of stored boxes of shapes
+        std::vector<float> mDirections; ///\brief packed directions from object to closest points on boxes
+        std::vector<float> mDistances; ///\brief distances from object to closest points on boxes
+        std::vector<Tree::NearestEntry> mNearestQueue; ///\brief priority queue of nearest shape search
+        std::vector< std::pair<float, SpaceProxyObject*> > mNearestResults; ///\brief nearest shapes and their distances
+    };
+    
     RTreeAlg();
     
+    /**
+     \brief calculate axis aligned bounding box of visible objects
+     \param pObjects proxy objects
+     
+     shapes use their AABB, other objects a cube whose size is given by their neighbor radius
+     */
+    void updateBoxes( std::vector< SpaceProxyObject* >& pObjects );
+    
+    /**
+     \brief replace neighbors of object with shapes whose bounding box overlaps the search box of the object
+     \param pObject proxy object
+     \param pBuffer query buffer of calling thread
+     \exception Exception failed to add neighbor
+     
+     visible objects search with the box they are stored with in the tree, other objects calculate their search box
+     */
+    void searchNeighbors( SpaceProxyObject* pObject, QueryBuffer& pBuffer ) const throw (Exception);
+    
+    /**
+     \brief remove shapes from search results whose discrete oriented polytope doesn't overlap that of the searching object
+     \param pObject searching object
+     \param pSearchMin minimum corner of search box
+     \param pSearchMax maximum corner of search box
+     \param pSearchResults search results
+     
+     objects other than shapes use the polytope of their search box
+     */
+    void filterByDOP( SpaceProxyObject* pObject, const float* pSearchMin, const float* pSearchMax, std::vector<SpaceProxyObject*>& pSearchResults ) const;
+    
+    /**
+     \brief find the shapes nearest to a point by best first search of the tree
+     \param pPoint point (3 values)
+     \param pCount maximum number of shapes
+     \param pExclude object that is skipped
+     \param pBuffer query buffer of calling thread, receives the shapes ordered by increasing distance in mNearestResults
+     */
+    void searchNearestShapes( const float* pPoint, unsigned int pCount, const SpaceProxyObject* pExclude, QueryBuffer& pBuffer ) const;
+    
+    /**
+     \brief calculate closest point on shape according to the closest point type
+     \param pPoint point
+     \param pObject shape object stored in the tree
+     \param pClosestPoint resulting closest point
+     */
+    void closestShapePoint( const glm::vec3& pPoint, SpaceProxyObject* pObject, glm::vec3& pClosestPoint ) const;
+    
+    /**
+     \brief approximate closest point on shape by a lookup in its distance field
+     \param pPoint point
+     \param pObject shape object stored in the tree
+     \param pClosestPoint resulting closest point
+     \return false if the shape has no distance field, the point lies outside of it or closer to the shape than the refinement distance
+     */
+    bool fieldClosestPoint( const glm::vec3& pPoint, const SpaceProxyObject* pObject, glm::vec3& pClosestPoint ) const;
+    
+    /**
+     \brief calculate distance along a ray at which it hits the geometry of a shape
+     \param pShape shape
+     \param pRay ray
+     \param pBoxDistance distance at which the ray enters the bounding box of the shape
+     \return hit distance (std::numeric_limits<float>::max(): ray misses shape)
+     */
+    float shapeHitDistance( SpaceShape* pShape, const Ray& pRay, float pBoxDistance ) const;
+    
+    static const float sDefaultRebuildFraction; ///\brief default fraction of changed objects above which the tree is rebuilt
+    static const float sRayHitTolerance; ///\brief distance to geometry at which a ray hits a shape, relative to the size of the shape
+    static const unsigned int sMaxRayHitSteps; ///\brief maximum number of steps a ray is marched towards the geometry of a shape
+    
     /**
      \brief RTree space partitioning instance
      */
-    RTree<SpaceProxyObject*, float, float> mTree;
+    Tree mTree;
+    
+    ClosestShapePointType mClosestPointType;
+    
+    float mRebuildFraction; ///\brief fraction of changed objects above which the tree is rebuilt by bulk loading
+    unsigned int mRebuildCount; ///\brief number of bulk loaded rebuilds
+    unsigned int mNearestShapeCount; ///\brief number of nearest shapes each object receives as neighbors (0: range search)
+    ShapeBoundsType mBoundsType; ///\brief bounding volume that shapes found by the tree search are tested against
+    
+    unsigned int mDistanceFieldResolution; ///\brief number of grid points along each axis of distance fields (0: no distance fields)
+    float mDistanceFieldRefinement; ///\brief distance to a mesh below which closest points are searched on the mesh
+    std::vector< std::shared_ptr<SpaceDistanceField> > mDistanceFields; ///\brief distance field of each stored object, indexed like mObjects (empty: no distance fields), the only strong references that keep shared fields alive across structure updates
+    
+    std::vector< SpaceProxyObject* > mObjects; ///\brief objects stored in tree, the index of each object refers to its position
+    std::vector<float> mMins; ///\brief minimum corners of stored boxes (3 values per object)
+    std::vector<float> mMaxs; ///\brief maximum corners of stored boxes (3 values per object)
+    std::unordered_map<SpaceProxyObject*, unsigned int> mIndices; ///\brief index of each stored object
+    
+    std::vector< SpaceProxyObject* > mUpdateObjects; ///\brief visible objects during structure update
+    std::vector<float> mUpdateMins; ///\brief minimum corners of boxes during structure update (3 values per object)
+    std::vector<float> mUpdateMaxs; ///\brief maximum corners of boxes during structure update (3 values per object)
     
-    ClosestShapePointType mClosestPointType;	
+    std::vector<QueryBuffer> mQueryBuffers; ///\brief query buffers, one per thread
 };
 
 };
@@ -0,0 +1,579 @@
+/** \file dab_space_alg_sweep_and_prune.cpp
+ */
+
+#include "dab_space_alg_sweep_and_prune.h"
+#include "dab_space_proxy_object.h"
+#include "dab_space_shape.h"
+#include "dab_space_parallel.h"
+#include "dab_space_simd.h"
+#include "dab_geom_cuboid.h"
+#include <algorithm>
+
+using namespace dab;
+using namespace dab::space;
+
+SweepAndPruneAlg::SweepAndPruneAlg()
+: SpaceAlg(3)
+, mClosestPointType(ClosestPointAABB)
+, mFrame(0)
+{}
+
+SweepAndPruneAlg::SweepAndPruneAlg( const Eigen::Vector3f& pMinPos, const Eigen::Vector3f& pMaxPos )
+: SpaceAlg( pMinPos, pMaxPos )
+, mClosestPointType(ClosestPointAABB)
+, mFrame(0)
+{}
+
+SweepAndPruneAlg::~SweepAndPruneAlg()
+{}
+
+ClosestShapePointType
+SweepAndPruneAlg::closestShapePointType() const
+{
+    return mClosestPointType;
+}
+
+void
+SweepAndPruneAlg::setClosestPointType(ClosestShapePointType pClosestPointType)
+{
+    mClosestPointType = pClosestPointType;
+}
+
+unsigned int
+SweepAndPruneAlg::pairCount() const
+{
+    return mPairs.size();
+}
+
+const std::vector< std::pair<SpaceObject*, SpaceObject*> >&
+SweepAndPruneAlg::addedPairs() const
+{
+    return mAddedPairs;
+}
+
+const std::vector< std::pair<SpaceObject*, SpaceObject*> >&
+SweepAndPruneAlg::removedPairs() const
+{
+    return mRemovedPairs;
+}
+
+void
+SweepAndPruneAlg::removeObject( SpaceProxyObject* pObject ) throw (Exception)
+{
+    auto boxIter = mBoxIndices.find(pObject);
+
+    if(boxIter == mBoxIndices.end()) return;
+
+    // the proxy is deleted after this call, a new proxy might reuse its address before the next structure update
+    mBoxes[boxIter->second].mProxy = nullptr;
+    mBoxIndices.erase(boxIter);
+}
+
+void
+SweepAndPruneAlg::calculateBox( SpaceProxyObject* pObject, float* pMin, float* pMax ) const
+{
+    SpaceShape* spaceShape = pObject->spaceShape();
+
+    if(spaceShape != nullptr)
+    {
+        const geom::Cuboid& aabb = spaceShape->AABB();
+        const glm::vec3 minPos = aabb.minPos();
+        const glm::vec3 maxPos = aabb.maxPos();
+
+        for(int d=0; d<3; ++d)
+        {
+            pMin[d] = minPos[d];
+            pMax[d] = maxPos[d];
+        }
+    }
+    else
+    {
+        float neighborRadius = pObject->neighborRadius();
+        const Eigen::VectorXf& position = pObject->position();
+
+        for(int d=0; d<3; ++d)
+        {
+            pMin[d] = position[d] - neighborRadius;
+            pMax[d] = position[d] + neighborRadius;
+        }
+    }
+}
+
+void
+SweepAndPruneAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != 3) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " is not 3D ", __FILE__, __FUNCTION__, __LINE__);
+
+    mFrame++;
+    mAddedPairs.clear();
+    mRemovedPairs.clear();
+
+    unsigned int objectCount = pObjects.size();
+    std::vector<SpaceProxyObject*> newObjects;
+
+    // update boxes of visible objects
+    for(unsigned int i=0; i<objectCount; ++i)
+    {
+        SpaceProxyObject* proxyObject = pObjects[i];
+
+        if(proxyObject->visible() == false) continue;
+
+        auto boxIter = mBoxIndices.find(proxyObject);
+
+        if(boxIter == mBoxIndices.end())
+        {
+            newObjects.push_back(proxyObject);
+            continue;
+        }
+
+        Box& box = mBoxes[boxIter->second];
+        box.mFrame = mFrame;
+        calculateBox(proxyObject, box.mMin, box.mMax);
+        proxyObject->setIndex(boxIter->second);
+    }
+
+    // remove boxes of objects that have become invisible or have been removed from space
+    unsigned int boxCount = mBoxes.size();
+    std::vector<bool> removedBoxes(boxCount, false);
+    bool boxesRemoved = false;
+
+    for(unsigned int bI=0; bI<boxCount; ++bI)
+    {
+        Box& box = mBoxes[bI];
+
+        if(box.mUsed == false || box.mFrame == mFrame) continue;
+
+        if(box.mProxy != nullptr) mBoxIndices.erase(box.mProxy);
+
+        box.mUsed = false;
+        box.mProxy = nullptr;
+        removedBoxes[bI] = true;
+        boxesRemoved = true;
+        mFreeBoxes.push_back(bI);
+    }
+
+    if(boxesRemoved == true)
+    {
+        for(unsigned int pI=0; pI<mPairs.size(); )
+        {
+            const std::pair<unsigned int, unsigned int>& pair = mPairs[pI];
+
+            if(removedBoxes[pair.first] == true || removedBoxes[pair.second] == true) removePair(pair.first, pair.second);
+            else ++pI;
+        }
+
+        for(int d=0; d<3; ++d)
+        {
+            std::vector<EndPoint>& endPoints = mEndPoints[d];
+            endPoints.erase( std::remove_if( endPoints.begin(), endPoints.end(), [&removedBoxes](const EndPoint& pEndPoint){ return removedBoxes[pEndPoint.box()]; } ), endPoints.end() );
+        }
+    }
+
+    // add boxes of newly visible objects, their end points are appended and sorted into place with all others
+    unsigned int newCount = newObjects.size();
+
+    for(unsigned int i=0; i<newCount; ++i)
+    {
+        SpaceProxyObject* proxyObject = newObjects[i];
+        unsigned int boxIndex;
+
+        if(mFreeBoxes.empty() == false)
+        {
+            boxIndex = mFreeBoxes.back();
+            mFreeBoxes.pop_back();
+        }
+        else
+        {
+            boxIndex = mBoxes.size();
+            mBoxes.push_back(Box());
+        }
+
+        Box& box = mBoxes[boxIndex];
+        box.mProxy = proxyObject;
+        box.mObject = proxyObject->spaceObject();
+        box.mShape = proxyObject->spaceShape();
+        box.mFrame = mFrame;
+        box.mUsed = true;
+        calculateBox(proxyObject, box.mMin, box.mMax);
+
+        mBoxIndices[proxyObject] = boxIndex;
+        proxyObject->setIndex(boxIndex);
+
+        for(int d=0; d<3; ++d)
+        {
+            mEndPoints[d].push_back( { box.mMin[d], boxIndex << 1 } );
+            mEndPoints[d].push_back( { box.mMax[d], ( boxIndex << 1 ) | 1 } );
+        }
+    }
+
+    // insertion sort moves each appended end point across all others, many new boxes are cheaper to handle by sorting from scratch
+    if( newCount > mBoxIndices.size() / 4 )
+    {
+        rebuildPairs();
+    }
+    else
+    {
+        for(unsigned int d=0; d<3; ++d) sortAxis(d);
+    }
+
+    // group overlapping boxes by box for neighbor update
+    boxCount = mBoxes.size();
+    unsigned int pairCount = mPairs.size();
+
+    mPartnerOffsets.assign(boxCount + 1, 0);
+    mPartners.resize(pairCount * 2);
+
+    for(unsigned int pI=0; pI<pairCount; ++pI)
+    {
+        mPartnerOffsets[ mPairs[pI].first + 1 ]++;
+        mPartnerOffsets[ mPairs[pI].second + 1 ]++;
+    }
+
+    for(unsigned int bI=0; bI<boxCount; ++bI) mPartnerOffsets[bI + 1] += mPartnerOffsets[bI];
+
+    std::vector<unsigned int> partnerPositions(mPartnerOffsets.begin(), mPartnerOffsets.end() - 1);
+
+    for(unsigned int pI=0; pI<pairCount; ++pI)
+    {
+        unsigned int box1 = mPairs[pI].first;
+        unsigned int box2 = mPairs[pI].second;
+
+        mPartners[ partnerPositions[box1]++ ] = box2;
+        mPartners[ partnerPositions[box2]++ ] = box1;
+    }
+}
+
+void
+SweepAndPruneAlg::sortAxis( unsigned int pAxis )
+{
+    std::vector<EndPoint>& endPoints = mEndPoints[pAxis];
+    unsigned int endPointCount = endPoints.size();
+
+    // refresh coordinates from the current boxes, the order is mostly preserved from the last structure update
+    for(unsigned int eI=0; eI<endPointCount; ++eI)
+    {
+        EndPoint& endPoint = endPoints[eI];
+        const Box& box = mBoxes[endPoint.box()];
+
+        endPoint.mValue = endPoint.isMax() ? box.mMax[pAxis] : box.mMin[pAxis];
+    }
+
+    for(unsigned int eI=1; eI<endPointCount; ++eI)
+    {
+        EndPoint endPoint = endPoints[eI];
+        unsigned int eJ = eI;
+
+        while(eJ > 0 && endPoint < endPoints[eJ - 1])
+        {
+            const EndPoint& otherEndPoint = endPoints[eJ - 1];
+
+            if(endPoint.isMax() == false && otherEndPoint.isMax() == true) addPair( endPoint.box(), otherEndPoint.box() );
+            else if(endPoint.isMax() == true && otherEndPoint.isMax() == false) removePair( endPoint.box(), otherEndPoint.box() );
+
+            endPoints[eJ] = otherEndPoint;
+            eJ--;
+        }
+
+        endPoints[eJ] = endPoint;
+    }
+}
+
+void
+SweepAndPruneAlg::rebuildPairs()
+{
+    for(unsigned int d=0; d<3; ++d)
+    {
+        std::vector<EndPoint>& endPoints = mEndPoints[d];
+        unsigned int endPointCount = endPoints.size();
+
+        for(unsigned int eI=0; eI<endPointCount; ++eI)
+        {
+            EndPoint& endPoint = endPoints[eI];
+            const Box& box = mBoxes[endPoint.box()];
+
+            endPoint.mValue = endPoint.isMax() ? box.mMax[d] : box.mMin[d];
+        }
+
+        std::sort(endPoints.begin(), endPoints.end());
+    }
+
+    // sweep along the first axis, each box is tested against all boxes whose interval is open when it starts
+    std::vector< std::pair<unsigned int, unsigned int> > oldPairs;
+    std::unordered_map<unsigned long long, unsigned int> oldPairIndices;
+    oldPairs.swap(mPairs);
+    oldPairIndices.swap(mPairIndices);
+
+    std::vector<unsigned int> openBoxes;
+    const std::vector<EndPoint>& endPoints = mEndPoints[0];
+    unsigned int endPointCount = endPoints.size();
+
+    for(unsigned int eI=0; eI<endPointCount; ++eI)
+    {
+        unsigned int boxIndex = endPoints[eI].box();
+
+        if(endPoints[eI].isMax() == true)
+        {
+            openBoxes.erase( std::find( openBoxes.begin(), openBoxes.end(), boxIndex ) );
+            continue;
+        }
+
+        const Box& box = mBoxes[boxIndex];
+
+        for(unsigned int openBox : openBoxes)
+        {
+            const Box& otherBox = mBoxes[openBox];
+
+            if(box.mShape == nullptr && otherBox.mShape == nullptr) continue;
+            if(box.mMin[1] > otherBox.mMax[1] || otherBox.mMin[1] > box.mMax[1]) continue;
+            if(box.mMin[2] > otherBox.mMax[2] || otherBox.mMin[2] > box.mMax[2]) continue;
+
+            unsigned long long key = pairKey(boxIndex, openBox);
+
+            mPairIndices[key] = mPairs.size();
+            mPairs.push_back( std::make_pair( std::min(boxIndex, openBox), std::max(boxIndex, openBox) ) );
+
+            if(oldPairIndices.find(key) == oldPairIndices.end()) mAddedPairs.push_back( std::make_pair( box.mObject, otherBox.mObject ) );
+        }
+
+        openBoxes.push_back(boxIndex);
+    }
+
+    for(const std::pair<unsigned int, unsigned int>& pair : oldPairs)
+    {
+        if(mPairIndices.find( pairKey(pair.first, pair.second) ) == mPairIndices.end()) mRemovedPairs.push_back( std::make_pair( mBoxes[pair.first].mObject, mBoxes[pair.second].mObject ) );
+    }
+}
+
+void
+SweepAndPruneAlg::addPair( unsigned int pBox1, unsigned int pBox2 )
+{
+    const Box& box1 = mBoxes[pBox1];
+    const Box& box2 = mBoxes[pBox2];
+
+    if(box1.mShape == nullptr && box2.mShape == nullptr) return;
+
+    for(int d=0; d<3; ++d)
+    {
+        if(box1.mMin[d] > box2.mMax[d] || box2.mMin[d] > box1.mMax[d]) return;
+    }
+
+    unsigned long long key = pairKey(pBox1, pBox2);
+
+    if(mPairIndices.find(key) != mPairIndices.end()) return;
+
+    mPairIndices[key] = mPairs.size();
+    mPairs.push_back( std::make_pair( std::min(pBox1, pBox2), std::max(pBox1, pBox2) ) );
+    mAddedPairs.push_back( std::make_pair( box1.mObject, box2.mObject ) );
+}
+
+void
+SweepAndPruneAlg::removePair( unsigned int pBox1, unsigned int pBox2 )
+{
+    auto pairIter = mPairIndices.find( pairKey(pBox1, pBox2) );
+
+    if(pairIter == mPairIndices.end()) return;
+
+    unsigned int pairIndex = pairIter->second;
+    unsigned int lastIndex = mPairs.size() - 1;
+
+    mRemovedPairs.push_back( std::make_pair( mBoxes[pBox1].mObject, mBoxes[pBox2].mObject ) );
+    mPairIndices.erase(pairIter);
+
+    if(pairIndex != lastIndex)
+    {
+        mPairs[pairIndex] = mPairs[lastIndex];
+        mPairIndices[ pairKey( mPairs[pairIndex].first, mPairs[pairIndex].second ) ] = pairIndex;
+    }
+
+    mPairs.pop_back();
+}
+
+void
+SweepAndPruneAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != 3) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " is not 3D ", __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+        unsigned int objectCount = pObjects.size();
+        unsigned int threadCount = parallelTools.threadCount();
+        const unsigned int blockSize = 16;
+        unsigned int blockCount = ( objectCount + blockSize - 1 ) / blockSize;
+
+        if(mQueryBuffers.size() < threadCount) mQueryBuffers.resize(threadCount);
+
+        // the structure update has brought the transforms and bounding boxes of all visible shapes up to date, searching them doesn't modify them
+        parallelTools.run(blockCount, [this, &pObjects, objectCount, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            QueryBuffer& buffer = mQueryBuffers[pThreadIndex];
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+
+            for(unsigned int oI=pTaskIndex * blockSize; oI<objectEnd; ++oI)
+            {
+                if(pObjects[oI]->canHaveNeighbors() == false) continue;
+
+                searchNeighbors(pObjects[oI], buffer);
+            }
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update SweepAndPruneAlg", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+void
+SweepAndPruneAlg::searchNeighbors( SpaceProxyObject* pObject, QueryBuffer& pBuffer ) const throw (Exception)
+{
+    pObject->removeNeighbors();
+
+    unsigned int boxCount = mBoxes.size();
+    unsigned int selfIndex = pObject->index();
+    const Eigen::VectorXf& position = pObject->position();
+
+    std::vector<unsigned int>& candidates = pBuffer.mCandidates;
+    const unsigned int* candidateBegin;
+    const unsigned int* candidateEnd;
+
+    if(selfIndex < boxCount && mBoxes[selfIndex].mProxy == pObject)
+    {
+        // visible objects overlap the boxes they are paired with
+        candidateBegin = mPartners.data() + mPartnerOffsets[selfIndex];
+        candidateEnd = mPartners.data() + mPartnerOffsets[selfIndex + 1];
+    }
+    else
+    {
+        // invisible objects test all boxes that start before their search box ends along the first axis
+        float searchMin[3];
+        float searchMax[3];
+        calculateBox(pObject, searchMin, searchMax);
+
+        const std::vector<EndPoint>& endPoints = mEndPoints[0];
+        EndPoint searchEnd = { searchMax[0], 1 };
+        auto endPointEnd = std::upper_bound( endPoints.begin(), endPoints.end(), searchEnd );
+
+        candidates.clear();
+
+        for(auto endPointIter = endPoints.begin(); endPointIter != endPointEnd; ++endPointIter)
+        {
+            if(endPointIter->isMax() == true) continue;
+
+            const Box& box = mBoxes[endPointIter->box()];
+
+            if(box.mShape == nullptr) continue;
+
+            bool overlap = true;
+
+            for(int d=0; d<3 && overlap == true; ++d)
+            {
+                overlap = box.mMin[d] <= searchMax[d] && searchMin[d] <= box.mMax[d];
+            }
+
+            if(overlap == true) candidates.push_back(endPointIter->box());
+        }
+
+        candidateBegin = candidates.data();
+        candidateEnd = candidates.data() + candidates.size();
+    }
+
+    unsigned int candidateCount = candidateEnd - candidateBegin;
+
+    if(mClosestPointType == ClosestPointAABB)
+    {
+        // gather boxes of shapes and calculate closest points on all boxes at once
+        float query[3] = { position[0], position[1], position[2] };
+        std::vector<SpaceShape*>& shapes = pBuffer.mShapes;
+        shapes.clear();
+
+        unsigned int boxStride = SpaceSimdTools::pointStride(candidateCount);
+        if(pBuffer.mBoxMins.size() < boxStride * 3)
+        {
+            pBuffer.mBoxMins.resize(boxStride * 3);
+            pBuffer.mBoxMaxs.resize(boxStride * 3);
+            pBuffer.mDirections.resize(boxStride * 3);
+            pBuffer.mDistances.resize(boxStride);
+        }
+
+        float* boxMins = pBuffer.mBoxMins.data();
+        float* boxMaxs = pBuffer.mBoxMaxs.data();
+
+        for(const unsigned int* candidateIter = candidateBegin; candidateIter != candidateEnd; ++candidateIter)
+        {
+            const Box& box = mBoxes[*candidateIter];
+
+            if( box.mShape == nullptr ) continue;
+
+            unsigned int shapeIndex = shapes.size();
+
+            for(int d=0; d<3; ++d)
+            {
+                boxMins[d * boxStride + shapeIndex] = box.mMin[d];
+                boxMaxs[d * boxStride + shapeIndex] = box.mMax[d];
+            }
+
+            shapes.push_back(box.mShape);
+        }
+
+        unsigned int shapeCount = shapes.size();
+        const float* directions = pBuffer.mDirections.data();
+        const float* distances = pBuffer.mDistances.data();
+
+        SpaceSimdTools::get().closestBoxPoints(query, boxMins, boxMaxs, boxStride, 3, 0, shapeCount, pBuffer.mDirections.data(), pBuffer.mDistances.data());
+
+        for(unsigned int j=0; j<shapeCount; ++j)
+        {
+            pObject->addNeighbor(shapes[j], distances[j], Eigen::Vector3f(directions[j], directions[boxStride + j], directions[2 * boxStride + j]));
+        }
+    }
+    else
+    {
+        glm::vec3 searchPos(position[0], position[1], position[2]);
+        glm::vec3 closestPoint;
+        glm::vec3 direction;
+        float distance;
+
+        for(const unsigned int* candidateIter = candidateBegin; candidateIter != candidateEnd; ++candidateIter)
+        {
+            SpaceShape* shape = mBoxes[*candidateIter].mShape;
+
+            if( shape == nullptr ) continue;
+
+            // calculate closest point from space object to shape
+            if( shape->featureCaching() == true ) shape->closestPoint(searchPos, closestPoint, pObject->closestFeature(shape));
+            else shape->closestPoint(searchPos, closestPoint);
+            direction = closestPoint - searchPos;
+            distance = glm::length(direction);
+
+            pObject->addNeighbor(shape, distance, Eigen::Vector3f(direction[0], direction[1], direction[2]));
+        }
+    }
+}
+
+bool
+SweepAndPruneAlg::symmetricNeighborsSupported() const
+{
+    return false;
+}
+
+SweepAndPruneAlg::operator std::string() const
+{
+    return info();
+}
+
+std::string
+SweepAndPruneAlg::info() const
+{
+    std::stringstream stream;
+
+    stream << "SweepAndPruneAlg\n";
+    stream << "boxCount: " << mBoxIndices.size() << "\n";
+    stream << "pairCount: " << mPairs.size() << "\n";
+    stream << "addedPairCount: " << mAddedPairs.size() << "\n";
+    stream << "removedPairCount: " << mRemovedPairs.size() << "\n";
+    stream << SpaceAlg::info() << "\n";
+
+    return stream.str();
+}
@@ -0,0 +1,248 @@
+/** \file dab_space_alg_sweep_and_prune.h
+ */
+
+#ifndef _dab_space_alg_sweep_and_prune_h_
+#define _dab_space_alg_sweep_and_prune_h_
+
+#include <unordered_map>
+#include "dab_space_types.h"
+#include "dab_space_alg.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+class SpaceShape;
+
+/**
+ \brief neighbors between objects and shapes based on incremental sweep and prune
+
+ like RTreeAlg, neighbors are the visible shapes whose axis aligned bounding box overlaps the bounding box of an object (shapes) or a cube whose size is given by the neighbor radius of an object (other objects). an object is never its own neighbor.\n
+ the start and end points of all boxes are kept sorted along each axis across structure updates. each structure update re-sorts them by insertion sort, which takes close to linear time when objects move only a little between updates. when many objects have become visible, the end points are sorted from scratch instead.\n
+ while sorting, a start point that moves past an end point may begin an overlap and an end point that moves past a start point ends one. the set of overlapping box pairs is therefore maintained incrementally, pairs that started or stopped overlapping during the last structure update are available as events.\n
+ only pairs that involve at least one shape are maintained.
+ */
+class SweepAndPruneAlg : public SpaceAlg
+{
+public:
+    /**
+     \brief create sweep and prune alg
+     \param pMinPos minimum position
+     \param pMaxPos maximum position
+     */
+    SweepAndPruneAlg(const Eigen::Vector3f& pMinPos, const Eigen::Vector3f& pMaxPos);
+    ~SweepAndPruneAlg();
+
+    ClosestShapePointType closestShapePointType() const;
+
+    /**
+     \brief set closest point type
+     \param pClosestPointType closest point type
+     */
+    void setClosestPointType(ClosestShapePointType pClosestPointType);
+
+    /**
+     \brief return number of overlapping box pairs
+     \return pair count
+     */
+    unsigned int pairCount() const;
+
+    /**
+     \brief return pairs of objects whose boxes started overlapping during last structure update
+     \return added pairs
+     */
+    const std::vector< std::pair<SpaceObject*, SpaceObject*> >& addedPairs() const;
+
+    /**
+     \brief return pairs of objects whose boxes stopped overlapping during last structure update
+     \return removed pairs
+
+     includes pairs of objects that have become invisible or have been removed from space, the latter must not be accessed anymore
+     */
+    const std::vector< std::pair<SpaceObject*, SpaceObject*> >& removedPairs() const;
+
+    /**
+     \brief forget object that is about to be removed from space
+     \param pObject proxy object of removed space object
+
+     the box of the object and its pairs are removed during the next structure update
+     */
+    void removeObject( SpaceProxyObject* pObject ) throw (Exception);
+
+    void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+    void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+
+    /**
+     \brief symmetric neighbor calculation is not supported
+     \return false
+
+     neighbors are derived from object shapes rather than from object positions
+     */
+    bool symmetricNeighborsSupported() const;
+
+    /**
+     \brief obtain textual sweep and prune alg information
+     \return String containing textual sweep and prune alg information
+     */
+    operator std::string() const;
+
+    /**
+     \brief obtain textual sweep and prune alg information
+     \return String containing textual sweep and prune alg information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual sweep and prune alg information
+     \param pOstream output stream
+     \param pAlg sweep and prune alg
+     */
+    friend std::ostream& operator<< (std::ostream & pOstream, const SweepAndPruneAlg& pAlg)
+    {
+        pOstream << std::string(pAlg);
+
+        return pOstream;
+    }
+
+protected:
+    /**
+     \brief box of visible object
+     */
+    class Box
+    {
+    public:
+        SpaceProxyObject* mProxy; ///\brief proxy object (nullptr: object has been removed from space)
+        SpaceObject* mObject; ///\brief space object
+        SpaceShape* mShape; ///\brief space object as shape (nullptr: object isn't a shape)
+        float mMin[3]; ///\brief minimum corner
+        float mMax[3]; ///\brief maximum corner
+        unsigned long mFrame; ///\brief structure update during which the object has last been visible
+        bool mUsed; ///\brief box belongs to an object
+    };
+
+    /**
+     \brief start or end point of a box along an axis
+     */
+    class EndPoint
+    {
+    public:
+        float mValue; ///\brief coordinate
+        unsigned int mData; ///\brief box index times two, plus one for end points
+
+        inline unsigned int box() const
+        {
+            return mData >> 1;
+        }
+
+        inline bool isMax() const
+        {
+            return ( mData & 1 ) != 0;
+        }
+
+        /**
+         \brief sort order of end points, start points precede end points at equal coordinates so that touching boxes overlap
+         */
+        inline bool operator<(const EndPoint& pEndPoint) const
+        {
+            return mValue < pEndPoint.mValue || ( mValue == pEndPoint.mValue && isMax() == false && pEndPoint.isMax() == true );
+        }
+    };
+
+    /**
+     \brief buffers used by one thread during neighbor update
+     */
+    class QueryBuffer
+    {
+    public:
+        std::vector<unsigned int> mCandidates; ///\brief boxes overlapping search box of invisible objects
+        std::vector<SpaceShape*> mShapes; ///\brief shapes among overlapping boxes
+        std::vector<float> mBoxMins; ///\brief packed minimum corners of boxes of shapes
+        std::vector<float> mBoxMaxs; ///\brief packed maximum corners of boxes of shapes
+        std::vector<float> mDirections; ///\brief packed directions from object to closest points on boxes
+        std::vector<float> mDistances; ///\brief distances from object to closest points on boxes
+    };
+
+    SweepAndPruneAlg();
+
+    /**
+     \brief calculate box of object
+     \param pObject proxy object
+     \param pMin resulting minimum corner (3 values)
+     \param pMax resulting maximum corner (3 values)
+
+     shapes use their AABB, other objects a cube whose size is given by their neighbor radius
+     */
+    void calculateBox( SpaceProxyObject* pObject, float* pMin, float* pMax ) const;
+
+    /**
+     \brief sort end points along an axis by insertion sort and update pairs of boxes whose end points swapped
+     \param pAxis axis
+     */
+    void sortAxis( unsigned int pAxis );
+
+    /**
+     \brief sort end points along all axes from scratch and recompute pairs by sweeping along the first axis
+
+     used instead of insertion sort when many boxes have been added
+     */
+    void rebuildPairs();
+
+    /**
+     \brief store pair if boxes overlap along all axes
+     \param pBox1 first box index
+     \param pBox2 second box index
+     */
+    void addPair( unsigned int pBox1, unsigned int pBox2 );
+
+    /**
+     \brief remove pair if it is stored
+     \param pBox1 first box index
+     \param pBox2 second box index
+     */
+    void removePair( unsigned int pBox1, unsigned int pBox2 );
+
+    /**
+     \brief return key of box pair independent of box order
+     \param pBox1 first box index
+     \param pBox2 second box index
+     \return pair key
+     */
+    static inline unsigned long long pairKey( unsigned int pBox1, unsigned int pBox2 )
+    {
+        return pBox1 < pBox2 ? ( static_cast<unsigned long long>(pBox1) << 32 ) | pBox2 : ( static_cast<unsigned long long>(pBox2) << 32 ) | pBox1;
+    }
+
+    /**
+     \brief replace neighbors of object with shapes whose box overlaps the box of the object
+     \param pObject proxy object
+     \param pBuffer query buffer of calling thread
+     \exception Exception failed to add neighbor
+     */
+    void searchNeighbors( SpaceProxyObject* pObject, QueryBuffer& pBuffer ) const throw (Exception);
+
+    ClosestShapePointType mClosestPointType; ///\brief closest point type
+    unsigned long mFrame; ///\brief number of structure updates
+
+    std::vector<Box> mBoxes; ///\brief boxes, the index of each visible proxy object refers to its box
+    std::vector<unsigned int> mFreeBoxes; ///\brief indices of unused boxes
+    std::unordered_map<SpaceProxyObject*, unsigned int> mBoxIndices; ///\brief box index of each visible object
+    std::vector<EndPoint> mEndPoints[3]; ///\brief end points of boxes sorted along each axis
+
+    std::vector< std::pair<unsigned int, unsigned int> > mPairs; ///\brief overlapping box pairs
+    std::unordered_map<unsigned long long, unsigned int> mPairIndices; ///\brief index of each overlapping pair in mPairs
+    std::vector< std::pair<SpaceObject*, SpaceObject*> > mAddedPairs; ///\brief pairs that started overlapping during last structure update
+    std::vector< std::pair<SpaceObject*, SpaceObject*> > mRemovedPairs; ///\brief pairs that stopped overlapping during last structure update
+
+    std::vector<unsigned int> mPartnerOffsets; ///\brief offset of the overlapping boxes of each box in mPartners
+    std::vector<unsigned int> mPartners; ///\brief overlapping boxes, grouped by box
+
+    std::vector<QueryBuffer> mQueryBuffers; ///\brief query buffers, one per thread
+};
+
+};
+
+};
+
+#endif
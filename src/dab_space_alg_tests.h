@@ -0,0 +1,168 @@
+/** \file dab_space_alg_tests.h
+*/
+
+#ifndef _dab_space_alg_tests_h_
+#define _dab_space_alg_tests_h_
+
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "ofNode.h"
+#include "dab_exception.h"
+#include "dab_singleton.h"
+#include "dab_space_object.h"
+
+namespace dab
+{
+
+namespace geom
+{
+class Mesh;
+};
+
+namespace space
+{
+
+class SpaceAlg;
+class SpaceGrid;
+class SpaceShape;
+
+/**
+ \brief compares the neighbors found by space algs with a brute force search on small random sets of objects
+
+ each test prints its result and returns true if it has passed
+ */
+class SpaceAlgTests : public dab::Singleton<SpaceAlgTests>
+{
+public:
+    void runTests();
+
+    bool testBruteForce() throw (dab::Exception);
+    bool testHNSW() throw (dab::Exception);
+    bool testLSH() throw (dab::Exception);
+    bool testPQ() throw (dab::Exception);
+    bool testVPTree() throw (dab::Exception);
+    bool testPCAProjection() throw (dab::Exception);
+    bool testNNDescent() throw (dab::Exception);
+    bool testDelaunay() throw (dab::Exception);
+    bool testRTree() throw (dab::Exception);
+    bool testAABBTree() throw (dab::Exception);
+    bool testRTreePool() throw (dab::Exception);
+    bool testRTreeMixed() throw (dab::Exception);
+    bool testBoxKernel() throw (dab::Exception);
+    bool testNearestShapes() throw (dab::Exception);
+    bool testSweepAndPrune() throw (dab::Exception);
+    bool testRays() throw (dab::Exception);
+    bool testDOPBounds() throw (dab::Exception);
+    bool testShapeRays() throw (dab::Exception);
+    bool testFeatureCache() throw (dab::Exception);
+    bool testTriangleBVH() throw (dab::Exception);
+    bool testDistanceField() throw (dab::Exception);
+    bool testShapeTransforms() throw (dab::Exception);
+    bool testGridRegions() throw (dab::Exception);
+    bool testGridSamples() throw (dab::Exception);
+
+protected:
+    /**
+     \brief create objects at random positions within [-1, 1]
+     \param pDim dimension
+     \param pObjectCount number of objects
+     \param pSeed random seed
+     \param pObjects resulting objects
+     */
+    void createObjects( unsigned int pDim, unsigned int pObjectCount, unsigned int pSeed, std::vector<SpaceObject*>& pObjects );
+
+    /**
+     \brief create cube shapes of random size at random positions within [-1, 1]
+     \param pShapeCount number of shapes
+     \param pSeed random seed
+     \param pShapes resulting shapes
+     */
+    void createShapes( unsigned int pShapeCount, unsigned int pSeed, std::vector<SpaceShape*>& pShapes );
+
+    /**
+     \brief fill all grid points with random values between 0 and 1
+     \param pSeed random seed
+     \param pGrid grid
+     */
+    void fillGrid( unsigned int pSeed, SpaceGrid& pGrid );
+
+    /**
+     \brief create a mesh of two parallel square sheets within [-1, 1] at z = 0 and z = 1
+     \param pResolution number of quads along each side of a sheet
+     \return mesh
+     */
+    std::shared_ptr<geom::Mesh> createSheets( unsigned int pResolution );
+
+    /**
+     \brief find the closest point on a mesh shape by testing all triangles
+     \param pShape mesh shape
+     \param pPoint reference point (in world coordinates)
+     \return distance between reference point and closest point
+     */
+    float bruteForceMeshDistance( const SpaceShape* pShape, const glm::vec3& pPoint );
+
+    /**
+     \brief find the closest objects within a radius by brute force
+     \param pObjects objects
+     \param pNeighborRadius neighbor radius
+     \param pMaxNeighborCount maximum number of neighbors
+     \param pNeighbors resulting neighbors of each object, ordered by increasing distance
+     */
+    void bruteForceNeighbors( const std::vector<SpaceObject*>& pObjects, float pNeighborRadius, unsigned int pMaxNeighborCount, std::vector< std::vector<SpaceObject*> >& pNeighbors );
+
+    /**
+     \brief find the shapes whose bounding box lies within the neighbor radius of each object by brute force
+     \param pObjects objects
+     \param pShapes shapes
+     \param pNeighborRadius neighbor radius
+     \param pNeighbors resulting neighbors of each object
+     \param pDistances resulting distances from each object to the closest point on the bounding box of each neighbor
+     */
+    void bruteForceBoxNeighbors( const std::vector<SpaceObject*>& pObjects, const std::vector<SpaceShape*>& pShapes, float pNeighborRadius, std::vector< std::vector<SpaceObject*> >& pNeighbors, std::vector< std::vector<float> >& pDistances );
+
+    /**
+     \brief compare neighbors found in a space with reference neighbors
+     \param pObjects objects
+     \param pSpaceName space name
+     \param pReferenceNeighbors reference neighbors of each object
+     \param pExtraCount resulting number of neighbors that aren't reference neighbors
+     \param pDistanceError resulting largest deviation of a neighbor distance from the distance between the object positions
+     \return fraction of reference neighbors that have been found
+     */
+    float neighborRecall( const std::vector<SpaceObject*>& pObjects, const std::string& pSpaceName, const std::vector< std::vector<SpaceObject*> >& pReferenceNeighbors, unsigned int& pExtraCount, float& pDistanceError ) throw (dab::Exception);
+
+    /**
+     \brief compare the closest neighbors found by a space alg with a brute force search over several frames during which objects move or are removed and added again
+     \param pSpaceName space name
+     \param pSpaceAlg space alg, is deleted by the test
+     \param pDim dimension
+     \param pMinRecall minimum fraction of brute force neighbors the alg has to find
+     \return true if test has passed
+     */
+    bool testNeighbors( const std::string& pSpaceName, SpaceAlg* pSpaceAlg, unsigned int pDim, float pMinRecall ) throw (dab::Exception);
+
+    /**
+     \brief compare the shapes found by a shape space alg with a brute force search over several frames during which objects and shapes move
+     \param pSpaceName space name
+     \param pSpaceAlg space alg, is deleted by the test
+     \param pVisibleObjects objects are visible as well, the alg has to tell them apart from shapes
+     \return true if test has passed
+     */
+    bool testBoxNeighbors( const std::string& pSpaceName, SpaceAlg* pSpaceAlg, bool pVisibleObjects = false ) throw (dab::Exception);
+
+    /**
+     \brief print test result
+     \param pTestName test name
+     \param pPassed test has passed
+     \param pDetails measured values
+     \return pPassed
+     */
+    bool report( const std::string& pTestName, bool pPassed, const std::string& pDetails );
+};
+
+};
+
+};
+
+#endif
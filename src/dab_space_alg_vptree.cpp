@@ -0,0 +1,380 @@
+/** \file dab_space_alg_vptree.cpp
+ */
+
+#include "dab_space_alg_vptree.h"
+#include "dab_space_proxy_object.h"
+#include "dab_space_simd.h"
+#include "dab_space_parallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace dab;
+using namespace dab::space;
+
+VPTreeAlg::VPTreeAlg()
+: SpaceAlg(2)
+, mMetric(EuclideanMetric)
+, mLeafSize(8)
+, mTreeLeafSize(8)
+{}
+
+VPTreeAlg::VPTreeAlg( unsigned int pDim, Metric pMetric ) throw (Exception)
+: SpaceAlg( pDim )
+, mMetric(EuclideanMetric)
+, mLeafSize(8)
+, mTreeLeafSize(8)
+{
+    setMetric(pMetric);
+}
+
+VPTreeAlg::VPTreeAlg( const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, Metric pMetric ) throw (Exception)
+: SpaceAlg( pMinPos, pMaxPos )
+, mMetric(EuclideanMetric)
+, mLeafSize(8)
+, mTreeLeafSize(8)
+{
+    setMetric(pMetric);
+}
+
+VPTreeAlg::~VPTreeAlg()
+{}
+
+VPTreeAlg::Metric
+VPTreeAlg::metric() const
+{
+    return mMetric;
+}
+
+unsigned int
+VPTreeAlg::leafSize() const
+{
+    return mLeafSize;
+}
+
+void
+VPTreeAlg::setMetric(Metric pMetric) throw (Exception)
+{
+    if(pMetric == CustomMetric && !mMetricFunction) throw Exception("SPACE ERROR: custom metric requires a metric function", __FILE__, __FUNCTION__, __LINE__);
+
+    mMetric = pMetric;
+}
+
+void
+VPTreeAlg::setMetric(const MetricFunction& pMetricFunction)
+{
+    mMetricFunction = pMetricFunction;
+    mMetric = CustomMetric;
+}
+
+void
+VPTreeAlg::setLeafSize(unsigned int pLeafSize) throw (Exception)
+{
+    if(pLeafSize == 0) throw Exception("SPACE ERROR: leaf size must be larger than zero", __FILE__, __FUNCTION__, __LINE__);
+
+    mLeafSize = pLeafSize;
+}
+
+float
+VPTreeAlg::distance(const float* pPosition1, const float* pPosition2) const
+{
+    unsigned int dim = mMinPos.rows();
+
+    switch(mMetric)
+    {
+        case EuclideanMetric:
+            return sqrt( SpaceSimdTools::get().squaredDistance(pPosition1, pPosition2, dim) );
+
+        case ManhattanMetric:
+        {
+            float distance = 0.0;
+            for(unsigned int d=0; d<dim; ++d) distance += fabs( pPosition1[d] - pPosition2[d] );
+            return distance;
+        }
+
+        case ChebyshevMetric:
+        {
+            float distance = 0.0;
+            for(unsigned int d=0; d<dim; ++d) distance = std::max( distance, static_cast<float>( fabs( pPosition1[d] - pPosition2[d] ) ) );
+            return distance;
+        }
+
+        default:
+            return mMetricFunction(pPosition1, pPosition2, dim);
+    }
+}
+
+void
+VPTreeAlg::updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+        unsigned int dim = mMinPos.rows();
+        unsigned int objectCount = pObjects.size();
+        unsigned int threadCount = parallelTools.threadCount();
+        const unsigned int blockSize = 256;
+        unsigned int blockCount = ( objectCount + blockSize - 1 ) / blockSize;
+
+        mObjects = pObjects;
+        mTreeLeafSize = mLeafSize;
+        mPositions.resize(objectCount * dim);
+        mTreePositions.resize(objectCount * dim);
+        mItems.resize(objectCount);
+
+        for(unsigned int oI=0; oI<objectCount; ++oI)
+        {
+            const float* position = pObjects[oI]->position().data();
+            std::copy(position, position + dim, mPositions.begin() + oI * dim);
+
+            mItems[oI] = Item(0.0, oI);
+            pObjects[oI]->setIndex(oI);
+        }
+
+        // upper levels are built sequentially until there are enough subtrees to keep all threads busy
+        unsigned int splitDepth = 0;
+        while( threadCount > 1 && ( 1u << splitDepth ) < 4 * threadCount ) splitDepth++;
+
+        std::vector< std::pair<unsigned int, unsigned int> > subtrees;
+        buildNode(0, objectCount, splitDepth, &subtrees);
+
+        parallelTools.run(subtrees.size(), [this, &subtrees](unsigned int pTaskIndex, unsigned int)
+        {
+            buildNode(subtrees[pTaskIndex].first, subtrees[pTaskIndex].second, 0, nullptr);
+        });
+
+        // store positions in tree order
+        parallelTools.run(blockCount, [this, objectCount, dim, blockSize](unsigned int pTaskIndex, unsigned int)
+        {
+            unsigned int itemEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+
+            for(unsigned int iI=pTaskIndex * blockSize; iI<itemEnd; ++iI)
+            {
+                const float* position = mPositions.data() + mItems[iI].second * dim;
+                std::copy(position, position + dim, mTreePositions.begin() + iI * dim);
+            }
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to build vptree", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+void
+VPTreeAlg::buildNode( unsigned int pBegin, unsigned int pEnd, unsigned int pSplitDepth, std::vector< std::pair<unsigned int, unsigned int> >* pSubtrees )
+{
+    unsigned int dim = mMinPos.rows();
+    unsigned int itemCount = pEnd - pBegin;
+
+    if(itemCount <= mTreeLeafSize) return;
+
+    if(pSubtrees != nullptr && pSplitDepth == 0)
+    {
+        pSubtrees->push_back( std::make_pair(pBegin, pEnd) );
+        return;
+    }
+
+    // pseudo random vantage point, the visible objects are often ordered spatially
+    unsigned int vantageItem = pBegin + static_cast<unsigned int>( ( static_cast<unsigned long>(pBegin) * 2654435761ul + itemCount ) % itemCount );
+    std::swap(mItems[pBegin], mItems[vantageItem]);
+
+    const float* vantagePosition = mPositions.data() + mItems[pBegin].second * dim;
+    for(unsigned int iI=pBegin + 1; iI<pEnd; ++iI) mItems[iI].first = distance( vantagePosition, mPositions.data() + mItems[iI].second * dim );
+
+    // items closer than the median distance form the inner half, the others the outer half
+    unsigned int middle = pBegin + 1 + ( itemCount - 1 ) / 2;
+    std::nth_element( mItems.begin() + pBegin + 1, mItems.begin() + middle, mItems.begin() + pEnd, [](const Item& pItem1, const Item& pItem2){ return pItem1.first < pItem2.first; } );
+
+    mItems[pBegin].first = mItems[middle].first;
+
+    unsigned int splitDepth = pSplitDepth > 0 ? pSplitDepth - 1 : 0;
+    buildNode(pBegin + 1, middle, splitDepth, pSubtrees);
+    buildNode(middle, pEnd, splitDepth, pSubtrees);
+}
+
+void
+VPTreeAlg::updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception)
+{
+    if(pObjects.size() > 0 && pObjects[0]->dim() != dim()) throw Exception("SPACE ERROR: object dimension " + std::to_string(pObjects[0]->dim()) + " doesn't match space dimension " + std::to_string(dim()), __FILE__, __FUNCTION__, __LINE__);
+
+    try
+    {
+        SpaceParallelTools& parallelTools = SpaceParallelTools::get();
+
+        unsigned int dim = mMinPos.rows();
+        unsigned int objectCount = pObjects.size();
+        unsigned int threadCount = parallelTools.threadCount();
+        const unsigned int blockSize = 16;
+        unsigned int blockCount = ( objectCount + blockSize - 1 ) / blockSize;
+
+        if(mSearchBuffers.size() < threadCount) mSearchBuffers.resize(threadCount);
+        for(unsigned int tI=0; tI<threadCount; ++tI) if(mSearchBuffers[tI].mDirection.rows() != dim) mSearchBuffers[tI].mDirection.resize(dim);
+
+        parallelTools.run(blockCount, [this, &pObjects, objectCount, dim, blockSize](unsigned int pTaskIndex, unsigned int pThreadIndex)
+        {
+            SearchBuffer& buffer = mSearchBuffers[pThreadIndex];
+            std::vector<Item>& candidates = buffer.mCandidates;
+            unsigned int visibleCount = mObjects.size();
+            unsigned int objectEnd = std::min( (pTaskIndex + 1) * blockSize, objectCount );
+
+            for(unsigned int oI=pTaskIndex * blockSize; oI<objectEnd; ++oI)
+            {
+                SpaceProxyObject* object = pObjects[oI];
+                object->removeNeighbors();
+
+                int maxNeighborCount = object->maxNeighborCount();
+                if(maxNeighborCount == 0) continue;
+
+                const Eigen::VectorXf& position = object->position();
+                float radius = object->neighborRadius() >= 0.0 ? object->neighborRadius() : FLT_MAX;
+
+                unsigned int selfIndex = object->index();
+                if(selfIndex >= visibleCount || mObjects[selfIndex] != object) selfIndex = visibleCount;
+
+                candidates.clear();
+                searchNode(position.data(), 0, visibleCount, selfIndex, maxNeighborCount, radius, candidates);
+                std::sort(candidates.begin(), candidates.end());
+
+                unsigned int candidateCount = candidates.size();
+                for(unsigned int cI=0; cI<candidateCount; ++cI)
+                {
+                    unsigned int treeIndex = candidates[cI].second;
+                    SpaceProxyObject* neighborObject = mObjects[ mItems[treeIndex].second ];
+
+                    for(unsigned int d=0; d<dim; ++d) buffer.mDirection[d] = mTreePositions[treeIndex * dim + d] - position[d];
+
+                    object->addNeighbor(neighborObject->spaceObject(), candidates[cI].first, buffer.mDirection);
+                }
+            }
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update neighbors based on vptree", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+void
+VPTreeAlg::searchNode( const float* pPosition, unsigned int pBegin, unsigned int pEnd, unsigned int pSelfIndex, int pMaxCount, float& pRadius, std::vector<Item>& pCandidates ) const
+{
+    unsigned int dim = mMinPos.rows();
+    unsigned int itemCount = pEnd - pBegin;
+
+    if(itemCount == 0) return;
+
+    if(itemCount <= mTreeLeafSize)
+    {
+        for(unsigned int iI=pBegin; iI<pEnd; ++iI)
+        {
+            if(mItems[iI].second == pSelfIndex) continue;
+
+            float itemDistance = distance( pPosition, mTreePositions.data() + iI * dim );
+            if(itemDistance <= pRadius) insertCandidate(itemDistance, iI, pMaxCount, pRadius, pCandidates);
+        }
+
+        return;
+    }
+
+    float vantageDistance = distance( pPosition, mTreePositions.data() + pBegin * dim );
+    if(mItems[pBegin].second != pSelfIndex && vantageDistance <= pRadius) insertCandidate(vantageDistance, pBegin, pMaxCount, pRadius, pCandidates);
+
+    float medianDistance = mItems[pBegin].first;
+    unsigned int middle = pBegin + 1 + ( itemCount - 1 ) / 2;
+
+    // the half containing the query is searched first since it likely shrinks the search radius, the triangle inequality prunes the other half
+    if(vantageDistance < medianDistance)
+    {
+        if(vantageDistance - pRadius <= medianDistance) searchNode(pPosition, pBegin + 1, middle, pSelfIndex, pMaxCount, pRadius, pCandidates);
+        if(vantageDistance + pRadius >= medianDistance) searchNode(pPosition, middle, pEnd, pSelfIndex, pMaxCount, pRadius, pCandidates);
+    }
+    else
+    {
+        if(vantageDistance + pRadius >= medianDistance) searchNode(pPosition, middle, pEnd, pSelfIndex, pMaxCount, pRadius, pCandidates);
+        if(vantageDistance - pRadius <= medianDistance) searchNode(pPosition, pBegin + 1, middle, pSelfIndex, pMaxCount, pRadius, pCandidates);
+    }
+}
+
+void
+VPTreeAlg::insertCandidate( float pDistance, unsigned int pTreeIndex, int pMaxCount, float& pRadius, std::vector<Item>& pCandidates ) const
+{
+    if(pMaxCount < 0)
+    {
+        pCandidates.push_back( Item(pDistance, pTreeIndex) );
+    }
+    else if(pCandidates.size() < static_cast<unsigned int>(pMaxCount))
+    {
+        pCandidates.push_back( Item(pDistance, pTreeIndex) );
+
+        if(pCandidates.size() == static_cast<unsigned int>(pMaxCount))
+        {
+            std::make_heap(pCandidates.begin(), pCandidates.end());
+            pRadius = std::min(pRadius, pCandidates.front().first);
+        }
+    }
+    else if(pDistance < pCandidates.front().first)
+    {
+        std::pop_heap(pCandidates.begin(), pCandidates.end());
+        pCandidates.back() = Item(pDistance, pTreeIndex);
+        std::push_heap(pCandidates.begin(), pCandidates.end());
+
+        pRadius = std::min(pRadius, pCandidates.front().first);
+    }
+}
+
+void
+VPTreeAlg::searchNeighbors( const Eigen::VectorXf& pPosition, float pNeighborRadius, int pMaxNeighborCount, std::vector< std::pair<float, SpaceProxyObject*> >& pNeighbors ) const throw (Exception)
+{
+    if(pPosition.rows() != mMinPos.rows()) throw Exception("SPACE ERROR: position dimension " + std::to_string(pPosition.rows()) + " doesn't match space dimension " + std::to_string(mMinPos.rows()), __FILE__, __FUNCTION__, __LINE__);
+
+    pNeighbors.clear();
+    if(pMaxNeighborCount == 0) return;
+
+    unsigned int visibleCount = mObjects.size();
+    float radius = pNeighborRadius >= 0.0 ? pNeighborRadius : FLT_MAX;
+    std::vector<Item> candidates;
+
+    searchNode(pPosition.data(), 0, visibleCount, visibleCount, pMaxNeighborCount, radius, candidates);
+    std::sort(candidates.begin(), candidates.end());
+
+    unsigned int candidateCount = candidates.size();
+    for(unsigned int cI=0; cI<candidateCount; ++cI) pNeighbors.push_back( std::make_pair( candidates[cI].first, mObjects[ mItems[ candidates[cI].second ].second ] ) );
+}
+
+bool
+VPTreeAlg::symmetricNeighborsSupported() const
+{
+    return false;
+}
+
+VPTreeAlg::operator std::string() const
+{
+    return info();
+}
+
+std::string
+VPTreeAlg::info() const
+{
+    std::stringstream stream;
+
+    stream << "VPTreeAlg\n";
+
+    switch(mMetric)
+    {
+        case EuclideanMetric: stream << "metric: euclidean\n"; break;
+        case ManhattanMetric: stream << "metric: manhattan\n"; break;
+        case ChebyshevMetric: stream << "metric: chebyshev\n"; break;
+        default: stream << "metric: custom\n"; break;
+    }
+
+    stream << "leafSize: " << mLeafSize << "\n";
+    stream << "objectCount: " << mObjects.size() << "\n";
+    stream << SpaceAlg::info();
+
+    return stream.str();
+}
@@ -0,0 +1,198 @@
+/** \file dab_space_alg_vptree.h
+ */
+
+#ifndef _dab_space_alg_vptree_h_
+#define _dab_space_alg_vptree_h_
+
+#include <functional>
+#include <Eigen/Dense>
+#include "dab_space_alg.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+/**
+ \brief exact neighbor search based on a vantage point tree
+
+ the tree splits the visible objects by their distance to a vantage point rather than along coordinate axes and therefore doesn't degrade as quickly with increasing dimension as kd-trees or ntrees.\n
+ the tree is bulk built during each structure update. it is stored implicitly: each node occupies a range of an item array whose first item is the vantage point, followed by the inner and outer half.\n
+ positions are stored in tree order so that searches access memory mostly sequentially.\n
+ any metric that satisfies the triangle inequality can be used, the neighbor distances are measured with this metric.
+ */
+class VPTreeAlg : public SpaceAlg
+{
+public:
+    enum Metric
+    {
+        EuclideanMetric,
+        ManhattanMetric,
+        ChebyshevMetric,
+        CustomMetric
+    };
+
+    typedef std::function<float(const float* pPosition1, const float* pPosition2, unsigned int pDim)> MetricFunction;
+
+    /**
+     \brief create vptree alg
+     \param pDim dimension
+     \param pMetric metric
+     \exception Exception custom metric can only be set by function
+     */
+    VPTreeAlg(unsigned int pDim, Metric pMetric = EuclideanMetric) throw (Exception);
+
+    /**
+     \brief create vptree alg
+     \param pMinPos minimum position
+     \param pMaxPos maximum position
+     \param pMetric metric
+     \exception Exception dimension mismatch, custom metric can only be set by function
+     */
+    VPTreeAlg(const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, Metric pMetric = EuclideanMetric) throw (Exception);
+
+    ~VPTreeAlg();
+
+    Metric metric() const;
+    unsigned int leafSize() const;
+
+    /**
+     \brief set metric
+     \param pMetric metric
+     \exception Exception custom metric can only be set by function
+     */
+    void setMetric(Metric pMetric) throw (Exception);
+
+    /**
+     \brief set custom metric
+     \param pMetricFunction function returning the distance between two positions
+
+     the function must satisfy the triangle inequality and be safe to call from several threads at once
+     */
+    void setMetric(const MetricFunction& pMetricFunction);
+
+    /**
+     \brief set maximum number of items in leaf nodes
+     \param pLeafSize leaf size
+     \exception Exception leaf size is zero
+     */
+    void setLeafSize(unsigned int pLeafSize) throw (Exception);
+
+    void updateStructure( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+    void updateNeighbors( std::vector< SpaceProxyObject* >& pObjects ) throw (Exception);
+
+    /**
+     \brief search neighbors of a position
+     \param pPosition position
+     \param pNeighborRadius neighbor radius (-1: unlimited)
+     \param pMaxNeighborCount maximum number of neighbors (-1: unlimited)
+     \param pNeighbors resulting neighbors (distance and object), sorted by ascending distance
+     \exception Exception dimension mismatch
+     */
+    void searchNeighbors( const Eigen::VectorXf& pPosition, float pNeighborRadius, int pMaxNeighborCount, std::vector< std::pair<float, SpaceProxyObject*> >& pNeighbors ) const throw (Exception);
+
+    /**
+     \brief symmetric neighbor calculation is not supported
+     \return false
+
+     neighbors are searched in a tree rather than evaluated for pairs of objects
+     */
+    bool symmetricNeighborsSupported() const;
+
+    /**
+     \brief obtain textual vptree alg information
+     \return String containing textual vptree alg information
+     */
+    operator std::string() const;
+
+    /**
+     \brief obtain textual vptree alg information
+     \return String containing textual vptree alg information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual vptree alg information
+     \param pOstream output stream
+     \param pAlg vptree alg
+     */
+    friend std::ostream& operator<< (std::ostream & pOstream, const VPTreeAlg& pAlg)
+    {
+        pOstream << std::string(pAlg);
+
+        return pOstream;
+    }
+
+protected:
+    typedef std::pair<float, unsigned int> Item; ///\brief distance and visible object index
+
+    /**
+     \brief per thread search buffers
+     */
+    class SearchBuffer
+    {
+    public:
+        std::vector<Item> mCandidates; ///\brief closest items found so far (max heap of distance and tree position)
+        Eigen::VectorXf mDirection; ///\brief neighbor direction
+    };
+
+    VPTreeAlg();
+
+    /**
+     \brief calculate distance between two positions with current metric
+     \param pPosition1 first position
+     \param pPosition2 second position
+     \return distance
+     */
+    float distance(const float* pPosition1, const float* pPosition2) const;
+
+    /**
+     \brief build subtree occupying a range of the item array
+     \param pBegin first item of subtree
+     \param pEnd item after last item of subtree
+     \param pSplitDepth number of levels that are built before remaining subtrees are collected instead
+     \param pSubtrees collected subtrees (begin and end), or nullptr if subtree is built completely
+     */
+    void buildNode( unsigned int pBegin, unsigned int pEnd, unsigned int pSplitDepth, std::vector< std::pair<unsigned int, unsigned int> >* pSubtrees );
+
+    /**
+     \brief search subtree for neighbors
+     \param pPosition query position
+     \param pBegin first item of subtree
+     \param pEnd item after last item of subtree
+     \param pSelfIndex visible object index of query object (excluded from result)
+     \param pMaxCount maximum number of neighbors (-1: unlimited)
+     \param pRadius current search radius, shrinks once pMaxCount neighbors have been found
+     \param pCandidates candidates (max heap of distance and tree position)
+     */
+    void searchNode( const float* pPosition, unsigned int pBegin, unsigned int pEnd, unsigned int pSelfIndex, int pMaxCount, float& pRadius, std::vector<Item>& pCandidates ) const;
+
+    /**
+     \brief consider item as candidate
+     \param pDistance distance of item
+     \param pTreeIndex tree position of item
+     \param pMaxCount maximum number of neighbors (-1: unlimited)
+     \param pRadius current search radius
+     \param pCandidates candidates
+     */
+    void insertCandidate( float pDistance, unsigned int pTreeIndex, int pMaxCount, float& pRadius, std::vector<Item>& pCandidates ) const;
+
+    Metric mMetric; ///\brief metric
+    MetricFunction mMetricFunction; ///\brief custom metric
+    unsigned int mLeafSize; ///\brief maximum number of items in leaf nodes
+    unsigned int mTreeLeafSize; ///\brief maximum number of items in leaf nodes of current tree
+
+    std::vector< SpaceProxyObject* > mObjects; ///\brief visible objects
+    std::vector<float> mPositions; ///\brief positions of visible objects in order of visible objects (dim values per object)
+    std::vector<Item> mItems; ///\brief tree items, for inner nodes the first item holds the median distance to the vantage point and its index
+    std::vector<float> mTreePositions; ///\brief positions of visible objects in tree order (dim values per item)
+
+    std::vector<SearchBuffer> mSearchBuffers; ///\brief search buffers for each thread
+};
+
+};
+
+};
+
+#endif
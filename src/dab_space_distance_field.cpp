@@ -0,0 +1,181 @@
+/** \file dab_space_distance_field.cpp
+ */
+
+#include "dab_space_distance_field.h"
+#include "dab_space_triangle_mesh.h"
+#include "dab_space_parallel.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace dab;
+using namespace dab::space;
+
+const float SpaceDistanceField::sMargin = 0.1;
+std::mutex SpaceDistanceField::sMutex;
+std::map< std::pair<const SpaceTriangleMesh*, unsigned int>, SpaceDistanceField::Entry > SpaceDistanceField::sEntries;
+
+std::shared_ptr<SpaceDistanceField>
+SpaceDistanceField::create(const std::shared_ptr<SpaceTriangleMesh>& pTriangleMesh, unsigned int pResolution) throw (Exception)
+{
+    if(pResolution < 2) throw Exception("SPACE ERROR: distance field resolution " + std::to_string(pResolution) + " must be at least 2", __FILE__, __FUNCTION__, __LINE__);
+
+    std::lock_guard<std::mutex> lock(sMutex);
+
+    std::pair<const SpaceTriangleMesh*, unsigned int> key( pTriangleMesh.get(), pResolution );
+    auto entryIter = sEntries.find(key);
+
+    if(entryIter != sEntries.end() && entryIter->second.mTriangleMesh.lock() == pTriangleMesh)
+    {
+        std::shared_ptr<SpaceDistanceField> distanceField = entryIter->second.mDistanceField.lock();
+
+        if(distanceField != nullptr) return distanceField;
+    }
+
+    try
+    {
+        std::shared_ptr<SpaceDistanceField> distanceField( new SpaceDistanceField( *pTriangleMesh, pResolution ) );
+
+        // forget distance fields nobody holds anymore
+        for(auto iter = sEntries.begin(); iter != sEntries.end(); )
+        {
+            if(iter->second.mTriangleMesh.expired() == true || iter->second.mDistanceField.expired() == true) iter = sEntries.erase(iter);
+            else ++iter;
+        }
+
+        sEntries[key] = { pTriangleMesh, distanceField };
+
+        return distanceField;
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to create distance field", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+SpaceDistanceField::SpaceDistanceField()
+: mResolution(0)
+{}
+
+SpaceDistanceField::SpaceDistanceField(const SpaceTriangleMesh& pTriangleMesh, unsigned int pResolution) throw (Exception)
+: mResolution(pResolution)
+{
+    glm::vec3 meshMinPos = pTriangleMesh.minPos();
+    glm::vec3 meshMaxPos = pTriangleMesh.maxPos();
+    glm::vec3 meshExtent = meshMaxPos - meshMinPos;
+    float margin = std::max( sMargin * std::max( meshExtent.x, std::max( meshExtent.y, meshExtent.z ) ), 1.0e-6f );
+
+    mMinPos = meshMinPos - glm::vec3(margin);
+    mMaxPos = meshMaxPos + glm::vec3(margin);
+
+    glm::vec3 cellSize = ( mMaxPos - mMinPos ) / static_cast<float>(mResolution - 1);
+    mInvCellSize = glm::vec3(1.0) / cellSize;
+
+    mValues.resize(mResolution * mResolution * mResolution * 4);
+
+    try
+    {
+        // one task per row of grid points
+        SpaceParallelTools::get().run(mResolution * mResolution, [this, &pTriangleMesh, &cellSize](unsigned int pTaskIndex, unsigned int)
+        {
+            unsigned int y = pTaskIndex % mResolution;
+            unsigned int z = pTaskIndex / mResolution;
+            float* values = mValues.data() + pTaskIndex * mResolution * 4;
+            glm::vec3 point( mMinPos.x, mMinPos.y + cellSize.y * static_cast<float>(y), mMinPos.z + cellSize.z * static_cast<float>(z) );
+            glm::vec3 closestPoint;
+
+            for(unsigned int x=0; x<mResolution; ++x, values += 4)
+            {
+                point.x = mMinPos.x + cellSize.x * static_cast<float>(x);
+
+                unsigned int triangle = pTriangleMesh.closestPoint(point, closestPoint);
+                glm::vec3 normal = pTriangleMesh.triangleNormal(triangle);
+                glm::vec3 offset = point - closestPoint;
+                float distance = glm::length(offset);
+                glm::vec3 gradient;
+
+                if(distance > 0.0)
+                {
+                    gradient = offset / distance;
+                    if( glm::dot(offset, normal) < 0.0 ) distance = -distance;
+                    if( distance < 0.0 ) gradient = -gradient;
+                }
+                else
+                {
+                    // point lies on the mesh
+                    float normalLength = glm::length(normal);
+                    gradient = normalLength > 0.0 ? normal / normalLength : glm::vec3(0.0);
+                }
+
+                values[0] = distance;
+                values[1] = gradient.x;
+                values[2] = gradient.y;
+                values[3] = gradient.z;
+            }
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to sample distance field", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+unsigned int
+SpaceDistanceField::resolution() const
+{
+    return mResolution;
+}
+
+const glm::vec3&
+SpaceDistanceField::minPos() const
+{
+    return mMinPos;
+}
+
+const glm::vec3&
+SpaceDistanceField::maxPos() const
+{
+    return mMaxPos;
+}
+
+bool
+SpaceDistanceField::closestPoint(const glm::vec3& pPoint, glm::vec3& pClosestPoint, float& pDistance) const
+{
+    glm::vec3 gridPoint = ( pPoint - mMinPos ) * mInvCellSize;
+    float maxIndex = static_cast<float>(mResolution - 1);
+    unsigned int cell[3];
+    float weights[3];
+
+    for(int d=0; d<3; ++d)
+    {
+        if( gridPoint[d] < 0.0 || gridPoint[d] > maxIndex ) return false;
+
+        cell[d] = std::min( static_cast<unsigned int>(gridPoint[d]), mResolution - 2 );
+        weights[d] = gridPoint[d] - static_cast<float>(cell[d]);
+    }
+
+    // trilinear interpolation of distance and gradient
+    float values[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+    for(unsigned int corner=0; corner<8; ++corner)
+    {
+        unsigned int dx = corner & 1;
+        unsigned int dy = ( corner >> 1 ) & 1;
+        unsigned int dz = corner >> 2;
+        float weight = ( dx == 1 ? weights[0] : 1.0f - weights[0] ) * ( dy == 1 ? weights[1] : 1.0f - weights[1] ) * ( dz == 1 ? weights[2] : 1.0f - weights[2] );
+        const float* cornerValues = mValues.data() + ( ( ( cell[2] + dz ) * mResolution + cell[1] + dy ) * mResolution + cell[0] + dx ) * 4;
+
+        for(int v=0; v<4; ++v) values[v] += weight * cornerValues[v];
+    }
+
+    glm::vec3 gradient(values[1], values[2], values[3]);
+    float gradientLength = glm::length(gradient);
+
+    if(gradientLength < 1.0e-6) return false;
+
+    pDistance = values[0];
+    pClosestPoint = pPoint - gradient * ( values[0] / gradientLength );
+
+    return true;
+}
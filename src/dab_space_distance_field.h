@@ -0,0 +1,107 @@
+/** \file dab_space_distance_field.h
+ */
+
+#ifndef _dab_space_distance_field_h_
+#define _dab_space_distance_field_h_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ofNode.h"
+#include "dab_exception.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+class SpaceTriangleMesh;
+
+/**
+ \brief sampled signed distance and gradient of a triangle mesh
+
+ the grid covers the bounding box of the mesh, enlarged by a margin, with the same number of points along each axis. each grid point stores the signed distance to the mesh and the gradient of the distance, the distance is positive on the side the triangle normals face.\n
+ closest points are approximated by moving a point against the interpolated gradient by the interpolated distance, which costs the same for every mesh size. the approximation is exact at grid points and degrades within cells in which the closest point jumps between parts of the mesh, for instance around sharp edges or midway between opposite sides of a thin mesh.\n
+ one distance field is built per triangle mesh and resolution and shared by all shapes using the mesh. coordinates are object coordinates of these shapes.
+ */
+class SpaceDistanceField
+{
+public:
+    /**
+     \brief return distance field of triangle mesh
+     \param pTriangleMesh triangle mesh
+     \param pResolution number of grid points along each axis
+     \return distance field
+     \exception Exception resolution is smaller than 2
+
+     the distance field is built on first request and reused as long as any caller holds it. the grid points are sampled in parallel.
+     */
+    static std::shared_ptr<SpaceDistanceField> create(const std::shared_ptr<SpaceTriangleMesh>& pTriangleMesh, unsigned int pResolution) throw (Exception);
+
+    /**
+     \brief return number of grid points along each axis
+     \return resolution
+     */
+    unsigned int resolution() const;
+
+    /**
+     \brief return minimum corner of grid
+     \return minimum position
+     */
+    const glm::vec3& minPos() const;
+
+    /**
+     \brief return maximum corner of grid
+     \return maximum position
+     */
+    const glm::vec3& maxPos() const;
+
+    /**
+     \brief approximate closest point on mesh by trilinear interpolation of distance and gradient
+     \param pPoint reference point
+     \param pClosestPoint resulting closest point
+     \param pDistance resulting signed distance
+     \return false if reference point lies outside the grid or the gradient vanishes
+     */
+    bool closestPoint(const glm::vec3& pPoint, glm::vec3& pClosestPoint, float& pDistance) const;
+
+    static const float sMargin; ///\brief margin by which the grid exceeds the bounding box of the mesh, relative to the largest extent of the box
+
+protected:
+    /**
+     \brief registered distance field of a triangle mesh
+     */
+    class Entry
+    {
+    public:
+        std::weak_ptr<SpaceTriangleMesh> mTriangleMesh; ///\brief triangle mesh, guards against a new mesh at the address of a destroyed one
+        std::weak_ptr<SpaceDistanceField> mDistanceField; ///\brief distance field
+    };
+
+    SpaceDistanceField();
+
+    /**
+     \brief sample distance field of triangle mesh
+     \param pTriangleMesh triangle mesh
+     \param pResolution number of grid points along each axis
+     \exception Exception failed to sample grid points
+     */
+    SpaceDistanceField(const SpaceTriangleMesh& pTriangleMesh, unsigned int pResolution) throw (Exception);
+
+    unsigned int mResolution; ///\brief number of grid points along each axis
+    glm::vec3 mMinPos; ///\brief minimum corner of grid
+    glm::vec3 mMaxPos; ///\brief maximum corner of grid
+    glm::vec3 mInvCellSize; ///\brief reciprocal distance between grid points along each axis
+    std::vector<float> mValues; ///\brief signed distance followed by gradient at each grid point (4 values per point, x varies fastest)
+
+    static std::mutex sMutex; ///\brief guards the registry of distance fields
+    static std::map< std::pair<const SpaceTriangleMesh*, unsigned int>, Entry > sEntries; ///\brief registered distance field of each triangle mesh and resolution
+};
+
+};
+
+};
+
+#endif
@@ -3,19 +3,32 @@
 
 #include "dab_space_types.h"
 #include "dab_space.h"
+#include "dab_space_aabb_tree.h"
 #include "dab_space_alg.h"
+#include "dab_space_alg_aabbtree.h"
 #include "dab_space_alg_ann.h"
+#include "dab_space_alg_brute_force.h"
+#include "dab_space_alg_delaunay.h"
 #include "dab_space_alg_grid.h"
+#include "dab_space_alg_hnsw.h"
 #include "dab_space_alg_kdtree.h"
+#include "dab_space_alg_lsh.h"
+#include "dab_space_alg_nndescent.h"
 #include "dab_space_alg_ntree.h"
+#include "dab_space_alg_pca.h"
 #include "dab_space_alg_permanent_neighbors.h"
+#include "dab_space_alg_pq.h"
 #include "dab_space_alg_rtree.h"
+#include "dab_space_alg_sweep_and_prune.h"
+#include "dab_space_alg_vptree.h"
 #include "dab_space_cluster_analyzer.h"
+#include "dab_space_distance_field.h"
 #include "dab_space_grid.h"
 #include "dab_space_grid_tools.h"
 #include "dab_space_manager.h"
 #include "dab_space_neighbor_group.h"
 #include "dab_space_neighbor_group_alg.h"
+#include "dab_space_neighbor_pair.h"
 #include "dab_space_neighbor_relation.h"
 #include "dab_space_neighbors.h"
 #include "dab_space_ntree.h"
@@ -26,9 +39,14 @@
 #include "dab_space_object.h"
 #include "dab_space_objects_analyze_manager.h"
 #include "dab_space_objects_analyzer.h"
+#include "dab_space_parallel.h"
+#include "dab_space_product_quantizer.h"
 #include "dab_space_proxy_object.h"
 #include "dab_space_rtree.h"
 #include "dab_space_shape.h"
+#include "dab_space_shape_tools.h"
+#include "dab_space_simd.h"
+#include "dab_space_triangle_mesh.h"
 #include "dab_space_types.h"
 
 #endif
\ No newline at end of file
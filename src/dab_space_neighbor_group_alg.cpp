@@ -37,7 +37,10 @@ NeighborGroupAlg::NeighborGroupAlg(NeighborGroupAlg& pNeighborGroupAlg)
 {}
 
 NeighborGroupAlg::~NeighborGroupAlg()
-{}
+{
+    unsigned int spareRelationCount = mSpareRelations.size();
+    for(unsigned int i=0; i<spareRelationCount; ++i) delete mSpareRelations[i];
+}
 
 void
 NeighborGroupAlg::setNeighborGroup(NeighborGroup* pNeighborGroup)
@@ -119,7 +122,7 @@ NeighborGroupAlg::createNeighbor(SpaceObject* pObject1, SpaceObject* pObject2)
 	if( mMaxNeighborCount <= neighborCount && mReplaceNeighborMode == true && neighborRelations.back()->distance() < neighborDistance ) return false;
     
 	// create new neighbor relation
-	SpaceNeighborRelation* neighborRelation = new SpaceNeighborRelation(pObject1, pObject2, neighborDistance, mNeighborDirection );
+	SpaceNeighborRelation* neighborRelation = acquireRelation(pObject1, pObject2, mNeighborDirection, mNeighborDirection, neighborDistance);
 	
 	//std::cout << "insert neighborRelation " << *neighborRelation << "\n";
 	//std::cout << "neighborRelation list before insertion " << *mNeighborList << "\n";
@@ -165,13 +168,13 @@ NeighborGroupAlg::createNeighbor(SpaceObject* pObject1, SpaceObject* pObject2)
 		
 		if(lastRelation == neighborRelation)
 		{
-			delete lastRelation;
+			releaseRelation(lastRelation);
 			neighborRelations.pop_back();
 			
 			return false;
 		}
 		
-		delete lastRelation;
+		releaseRelation(lastRelation);
 		neighborRelations.pop_back();
 		
 		//std::cout << "remove last neighbor\n";
@@ -191,12 +194,12 @@ NeighborGroupAlg::createNeighbor(SpaceObject* pObject1, SpaceObject* pObject2, f
     
     std::vector<SpaceNeighborRelation*>& neighborRelations = mNeighborGroup->mNeighborRelations;
     
-	SpaceNeighborRelation* neighborRelation = new SpaceNeighborRelation(pObject1, pObject2, pDistance, pDirection);
+	SpaceNeighborRelation* neighborRelation = acquireRelation(pObject1, pObject2, pDirection, pDirection, pDistance);
 	
 	// neighbor outside visibility radius
 	if(mNeighborRadius >= 0.0 && mNeighborRadius < pDistance)
 	{
-		delete neighborRelation;
+		releaseRelation(neighborRelation);
 		return false;
 	}
 	
@@ -206,7 +209,7 @@ NeighborGroupAlg::createNeighbor(SpaceObject* pObject1, SpaceObject* pObject2, f
 		// neighborlist non replacing
 		if(mReplaceNeighborMode == false)
 		{
-			delete neighborRelation;
+			releaseRelation(neighborRelation);
 			return false;
 		}
 		else
@@ -214,7 +217,7 @@ NeighborGroupAlg::createNeighbor(SpaceObject* pObject1, SpaceObject* pObject2, f
 			// new neighbor is further away than all other neighbors
 			if(neighborRelations.back()->distance() < pDistance)
 			{
-				delete neighborRelation;
+				releaseRelation(neighborRelation);
 				return false;
 			}
 		}
@@ -257,13 +260,13 @@ NeighborGroupAlg::createNeighbor(SpaceObject* pObject1, SpaceObject* pObject2, f
 		
 		if(lastRelation == neighborRelation)
 		{
-			delete lastRelation;
+			releaseRelation(lastRelation);
 			neighborRelations.pop_back();
 			
 			return false;
 		}
 		
-		delete lastRelation;
+		releaseRelation(lastRelation);
 		neighborRelations.pop_back();
 	}
 	
@@ -281,12 +284,12 @@ NeighborGroupAlg::createNeighbor(SpaceObject* pObject1, SpaceObject* pObject2, c
     
     std::vector<SpaceNeighborRelation*>& neighborRelations = mNeighborGroup->mNeighborRelations;
     
-	SpaceNeighborRelation* neighborRelation = new SpaceNeighborRelation(pObject1, pObject2, pValue, pDirection, pDistance);
+	SpaceNeighborRelation* neighborRelation = acquireRelation(pObject1, pObject2, pValue, pDirection, pDistance);
 	
 	// neighbor outside visibility radius
 	if(mNeighborRadius >= 0.0 && mNeighborRadius < pDistance)
 	{
-		delete neighborRelation;
+		releaseRelation(neighborRelation);
 		return false;
 	}
 	
@@ -296,7 +299,7 @@ NeighborGroupAlg::createNeighbor(SpaceObject* pObject1, SpaceObject* pObject2, c
 		// neighborlist non replacing
 		if(mReplaceNeighborMode == false)
 		{
-			delete neighborRelation;
+			releaseRelation(neighborRelation);
 			return false;
 		}
 		else
@@ -304,7 +307,7 @@ NeighborGroupAlg::createNeighbor(SpaceObject* pObject1, SpaceObject* pObject2, c
 			// new neighbor is further away than all other neighbors
 			if(neighborRelations.back()->distance() < pDistance)
 			{
-				delete neighborRelation;
+				releaseRelation(neighborRelation);
 				return false;
 			}
 		}
@@ -347,13 +350,13 @@ NeighborGroupAlg::createNeighbor(SpaceObject* pObject1, SpaceObject* pObject2, c
 		
 		if(lastRelation == neighborRelation)
 		{
-			delete lastRelation;
+			releaseRelation(lastRelation);
 			neighborRelations.pop_back();
 			
 			return false;
 		}
 		
-		delete lastRelation;
+		releaseRelation(lastRelation);
 		neighborRelations.pop_back();
 	}
 	
@@ -375,7 +378,7 @@ NeighborGroupAlg::removeNeighbor(SpaceObject* pNeighborObject)
 		if( neighborRelation->neighbor() == pNeighborObject )
 		{
 			neighborRelations.erase(neighborRelations.begin() + i);
-			delete neighborRelation;
+			releaseRelation(neighborRelation);
 		}
 	}
 }
@@ -390,7 +393,7 @@ NeighborGroupAlg::removeNeighbor(unsigned int pNeighborIndex)
 	{
 		SpaceNeighborRelation* neighborRelation = neighborRelations[pNeighborIndex];
 		neighborRelations.erase(neighborRelations.begin() + pNeighborIndex);
-		delete neighborRelation;
+		releaseRelation(neighborRelation);
 	}
 }
 
@@ -400,10 +403,28 @@ NeighborGroupAlg::removeNeighbors()
     std::vector< SpaceNeighborRelation* >& neighborRelations = mNeighborGroup->mNeighborRelations;
 	unsigned int neighborCount = neighborRelations.size();
 	
-	for(unsigned int i=0; i<neighborCount; ++i) delete neighborRelations[i];
+	for(unsigned int i=0; i<neighborCount; ++i) releaseRelation(neighborRelations[i]);
 	neighborRelations.clear();
 }
 
+SpaceNeighborRelation*
+NeighborGroupAlg::acquireRelation(SpaceObject* pObject1, SpaceObject* pObject2, const Eigen::VectorXf& pValue, const Eigen::VectorXf& pDirection, float pDistance) throw (Exception)
+{
+    if(mSpareRelations.size() == 0) return new SpaceNeighborRelation(pObject1, pObject2, pValue, pDirection, pDistance);
+    
+    SpaceNeighborRelation* neighborRelation = mSpareRelations.back();
+    neighborRelation->set(pObject1, pObject2, pValue, pDirection, pDistance);
+    mSpareRelations.pop_back();
+    
+    return neighborRelation;
+}
+
+void
+NeighborGroupAlg::releaseRelation(SpaceNeighborRelation* pNeighborRelation)
+{
+    mSpareRelations.push_back(pNeighborRelation);
+}
+
 NeighborGroupAlg::operator std::string() const
 {
     std::stringstream stream;
@@ -157,6 +157,24 @@ public:
     };
     
 protected:
+    /**
+     \brief obtain neighbor relation, reusing a previously removed one if available
+     \param pObject1 the space object a neighbor will be added to
+     \param pObject2 the neighbor space object
+     \param pValue value
+     \param pDirection direction
+     \param pDistance distance
+     \return neighbor relation
+     \exception Exception either the two objects are identical are if they differ in their respective dimensions
+     */
+    SpaceNeighborRelation* acquireRelation(SpaceObject* pObject1, SpaceObject* pObject2, const Eigen::VectorXf& pValue, const Eigen::VectorXf& pDirection, float pDistance) throw (Exception);
+    
+    /**
+     \brief keep removed neighbor relation for reuse
+     \param pNeighborRelation neighbor relation
+     */
+    void releaseRelation(SpaceNeighborRelation* pNeighborRelation);
+    
     /**
      \brief default search radius for finding neighbors
      */
@@ -193,6 +211,7 @@ protected:
     NeighborGroup* mNeighborGroup;
     
     Eigen::VectorXf mNeighborDirection; ///\brief neighbor direction helper variable
+    std::vector<SpaceNeighborRelation*> mSpareRelations; ///\brief removed neighbor relations kept for reuse, avoids allocating new relations each time neighbors are updated
 };
 
 };
@@ -0,0 +1,88 @@
+/** \file dab_space_neighbor_pair.cpp
+*/
+
+#include "dab_space_neighbor_pair.h"
+#include "dab_space_object.h"
+
+using namespace dab;
+using namespace dab::space;
+
+SpaceNeighborPair::SpaceNeighborPair()
+: mObject1(nullptr)
+, mObject2(nullptr)
+, mDirection(1)
+, mDistance(0.0)
+{}
+
+SpaceNeighborPair::SpaceNeighborPair(unsigned int pDim)
+: mObject1(nullptr)
+, mObject2(nullptr)
+, mDirection(pDim)
+, mDistance(0.0)
+{}
+
+SpaceNeighborPair::SpaceNeighborPair(const SpaceNeighborPair& pNeighborPair)
+: mObject1(pNeighborPair.mObject1)
+, mObject2(pNeighborPair.mObject2)
+, mDirection(pNeighborPair.mDirection)
+, mDistance(pNeighborPair.mDistance)
+{}
+
+SpaceNeighborPair::~SpaceNeighborPair()
+{}
+
+const SpaceNeighborPair&
+SpaceNeighborPair::operator=(const SpaceNeighborPair& pNeighborPair)
+{
+	mObject1 = pNeighborPair.mObject1;
+	mObject2 = pNeighborPair.mObject2;
+	mDirection = pNeighborPair.mDirection;
+	mDistance = pNeighborPair.mDistance;
+
+	return *this;
+}
+
+SpaceObject*
+SpaceNeighborPair::object1() const
+{
+	return mObject1;
+}
+
+SpaceObject*
+SpaceNeighborPair::object2() const
+{
+	return mObject2;
+}
+
+const Eigen::VectorXf&
+SpaceNeighborPair::direction() const
+{
+	return mDirection;
+}
+
+float
+SpaceNeighborPair::distance() const
+{
+	return mDistance;
+}
+
+void
+SpaceNeighborPair::set(SpaceObject* pObject1, SpaceObject* pObject2, float pDistance, const Eigen::VectorXf& pDirection)
+{
+	mObject1 = pObject1;
+	mObject2 = pObject2;
+	mDistance = pDistance;
+	mDirection = pDirection;
+}
+
+SpaceNeighborPair::operator std::string() const
+{
+    std::stringstream stream;
+
+    stream << "object1: " << *mObject1 << "\n";
+    stream << "object2: " << *mObject2 << "\n";
+    stream << "direction: " << mDirection.transpose() << "\n";
+    stream << "distance: " << mDistance << "\n";
+
+	return stream.str();
+}
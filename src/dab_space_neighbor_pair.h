@@ -0,0 +1,120 @@
+/** \file dab_space_neighbor_pair.h
+*/
+
+#ifndef _dab_space_neighbor_pair_h_
+#define _dab_space_neighbor_pair_h_
+
+#include <iostream>
+#include <Eigen/Dense>
+#include "dab_exception.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+class SpaceObject;
+
+/**
+ \brief unordered pair of neighboring space objects
+
+ produced by spaces that calculate neighbors in symmetric mode.\n
+ each pair of objects within neighbor radius of each other is stored only once.\n
+ the direction points from the first to the second object.
+ */
+class SpaceNeighborPair
+{
+public:
+    /**
+     \brief create neighbor pair
+     \param pDim dimension of space
+     */
+    SpaceNeighborPair(unsigned int pDim);
+
+    /**
+     \brief copy constructor
+     \param pNeighborPair neighbor pair to copy
+     */
+    SpaceNeighborPair(const SpaceNeighborPair& pNeighborPair);
+
+    /**
+     \brief destructor
+     */
+    ~SpaceNeighborPair();
+
+    /**
+     \brief assignment operator
+     \param pNeighborPair neighbor pair to copy
+     */
+    const SpaceNeighborPair& operator=(const SpaceNeighborPair& pNeighborPair);
+
+    /**
+     \brief return first space object
+     \return first space object
+     */
+    SpaceObject* object1() const;
+
+    /**
+     \brief return second space object
+     \return second space object
+     */
+    SpaceObject* object2() const;
+
+    /**
+     \brief return direction pointing from first to second object
+     \return direction
+     */
+    const Eigen::VectorXf& direction() const;
+
+    /**
+     \brief return distance between objects
+     \return distance
+     */
+    float distance() const;
+
+    /**
+     \brief set neighbor pair
+     \param pObject1 first space object
+     \param pObject2 second space object
+     \param pDistance distance
+     \param pDirection direction pointing from first to second object
+
+     the direction is copied without reallocation as long as its dimension doesn't change
+     */
+    void set(SpaceObject* pObject1, SpaceObject* pObject2, float pDistance, const Eigen::VectorXf& pDirection);
+
+    /**
+     \brief print neighbor pair information
+     */
+    operator std::string() const;
+
+    /**
+     \brief retrieve textual neighbor pair info
+     \param pOstream output text stream
+     \param pNeighborPair neighbor pair
+     */
+    friend std::ostream& operator << ( std::ostream& pOstream, const SpaceNeighborPair& pNeighborPair )
+    {
+        pOstream << std::string(pNeighborPair);
+
+        return pOstream;
+    };
+
+protected:
+    /**
+     \brief default constructor
+     */
+    SpaceNeighborPair();
+
+    SpaceObject* mObject1; ///\brief first space object
+    SpaceObject* mObject2; ///\brief second space object
+    Eigen::VectorXf mDirection; ///\brief direction pointing from first to second object
+    float mDistance; ///\brief distance between objects
+};
+
+};
+
+};
+
+#endif
@@ -131,6 +131,20 @@ SpaceNeighborRelation::set(SpaceObject* pObject, SpaceObject* pNeighborObject) t
 	mDistance = mDirection.norm();
 }
 
+void
+SpaceNeighborRelation::set(SpaceObject* pObject, SpaceObject* pNeighborObject, const Eigen::VectorXf& pValue, const Eigen::VectorXf& pDirection, float pDistance) throw (Exception)
+{
+    if(pObject == pNeighborObject) throw Exception("SPACE ERROR: space object and neighbor can't refer to one and the same object", __FILE__, __FUNCTION__, __LINE__);
+    if(pObject->dim() != pNeighborObject->dim()) throw Exception("SPACE ERROR: space object and neighbor must have identical dimension", __FILE__, __FUNCTION__, __LINE__);
+    if(pDirection.rows() != pNeighborObject->dim()) throw Exception("SPACE ERROR: direction and neighbor must have identical dimension", __FILE__, __FUNCTION__, __LINE__);
+    
+	mObject = pObject;
+	mNeighborObject = pNeighborObject;
+	mValue = pValue;
+	mDirection = pDirection;
+	mDistance = pDistance;
+}
+
 std::string
 SpaceNeighborRelation::info(int pPropagationLevel) const
 {
@@ -57,7 +57,7 @@ public:
     /**
      \brief destructor
      */
-    ~SpaceNeighborRelation();
+    virtual ~SpaceNeighborRelation();
     
     /**
      \brief return neighbor
@@ -117,6 +117,19 @@ public:
      */
     void set(SpaceObject* pObject, SpaceObject* pNeighborObject) throw (Exception);
     
+    /**
+     \brief set new space object, neighbor object, value, direction and distance
+     \param pObject space object
+     \param pNeighborObject neighboring space object
+     \param pValue value
+     \param pDirection direction
+     \param pDistance distance
+     \exception Exception either the two objects are identical are if they differ in their respective dimensions
+     
+     allows a neighbor relation to be reused for a different pair of objects
+     */
+    void set(SpaceObject* pObject, SpaceObject* pNeighborObject, const Eigen::VectorXf& pValue, const Eigen::VectorXf& pDirection, float pDistance) throw (Exception);
+    
     /**
      \brief print neighbor information
      */
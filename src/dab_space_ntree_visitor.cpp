@@ -408,6 +408,47 @@ NTreeVisitor::calcNeighbors( NTreeNode* pNode, SpaceProxyObject* pObject)
 	}
 }
 
+void
+NTreeVisitor::searchObjects(NTree& pTree, const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, std::vector<SpaceProxyObject*>& pObjects)
+{
+    if(pTree.mRootNode != nullptr) searchObjects(pTree.mRootNode, pMinPos, pMaxPos, pObjects);
+}
+
+void
+NTreeVisitor::searchObjects(NTreeNode* pNode, const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, std::vector<SpaceProxyObject*>& pObjects)
+{
+	// check whether this node overlaps the search box
+	for(unsigned int i=0; i<mDim; ++i) if(pMaxPos[i] < pNode->mMinPos[i] || pMinPos[i] > pNode->mMaxPos[i]) return;
+	
+	// progress into child nodes
+	if(pNode->mChildren[0] != nullptr)
+	{
+		unsigned int childrenCount = pNode->childrenCount();
+		for(unsigned int i=0; i<childrenCount; ++i) searchObjects(pNode->mChildren[i], pMinPos, pMaxPos, pObjects);
+		return;
+	}
+	
+	// collect objects of leaf node that lie within search box
+	unsigned int objectCount = pNode->mObjects.size();
+	
+	for(unsigned int i=0; i<objectCount; ++i)
+	{
+		const Eigen::VectorXf& objectPos = pNode->mObjects[i]->position();
+		bool insideBox = true;
+		
+		for(unsigned int d=0; d<mDim; ++d)
+		{
+			if(objectPos[d] < pMinPos[d] || objectPos[d] > pMaxPos[d])
+			{
+				insideBox = false;
+				break;
+			}
+		}
+		
+		if(insideBox == true) pObjects.push_back(pNode->mObjects[i]);
+	}
+}
+
 void
 NTreeVisitor::clearTree(NTree& pTree)
 {
@@ -34,6 +34,17 @@ public:
     void calcNeighbors(NTreeNode*, std::vector<SpaceProxyObject*>& pObjects);
     
     void calcNeighbors(NTreeNode* pNode, SpaceProxyObject* pObject);
+    
+    /**
+     \brief collect all objects whose position lies within a box
+     \param pTree ntree
+     \param pMinPos minimum position of box
+     \param pMaxPos maximum position of box
+     \param pObjects objects found within box (appended)
+     */
+    void searchObjects(NTree& pTree, const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, std::vector<SpaceProxyObject*>& pObjects);
+    void searchObjects(NTreeNode* pNode, const Eigen::VectorXf& pMinPos, const Eigen::VectorXf& pMaxPos, std::vector<SpaceProxyObject*>& pObjects);
+    
     void clearTree(NTree& pTree);
     void clearTree(NTreeNode* pNode);
     
@@ -0,0 +1,181 @@
+/** \file dab_space_parallel.cpp
+ */
+
+#include "dab_space_parallel.h"
+
+using namespace dab;
+using namespace dab::space;
+
+thread_local bool SpaceParallelTools::sInsideTask = false;
+
+SpaceParallelTools::SpaceParallelTools()
+: mTask(nullptr)
+, mTaskCount(0)
+, mNextTask(0)
+, mActiveWorkerCount(0)
+, mGeneration(0)
+, mStop(false)
+{
+    setThreadCount(0);
+}
+
+SpaceParallelTools::~SpaceParallelTools()
+{
+    stopThreads();
+}
+
+unsigned int
+SpaceParallelTools::threadCount() const
+{
+    return mThreads.size() + 1;
+}
+
+void
+SpaceParallelTools::setThreadCount(unsigned int pThreadCount)
+{
+    if(pThreadCount == 0) pThreadCount = std::thread::hardware_concurrency();
+    if(pThreadCount == 0) pThreadCount = 1;
+
+    std::lock_guard<std::mutex> runLock(mRunMutex);
+
+    stopThreads();
+    startThreads(pThreadCount - 1);
+}
+
+void
+SpaceParallelTools::run(unsigned int pTaskCount, const Task& pTask) throw (Exception)
+{
+    if(pTaskCount == 0) return;
+
+    // process sequentially
+    if(mThreads.size() == 0 || pTaskCount == 1 || sInsideTask == true)
+    {
+        for(unsigned int tI=0; tI<pTaskCount; ++tI) pTask(tI, 0);
+        return;
+    }
+
+    std::lock_guard<std::mutex> runLock(mRunMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        mTask = &pTask;
+        mTaskCount = pTaskCount;
+        mNextTask = 0;
+        mException = nullptr;
+        mActiveWorkerCount = mThreads.size();
+        mGeneration++;
+    }
+
+    mStartCondition.notify_all();
+
+    // calling thread takes part in processing
+    processTasks(0);
+
+    std::exception_ptr exception;
+
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        mFinishCondition.wait(lock, [this]{ return mActiveWorkerCount == 0; });
+        mTask = nullptr;
+        exception = mException;
+        mException = nullptr;
+    }
+
+    if(exception != nullptr) std::rethrow_exception(exception);
+}
+
+void
+SpaceParallelTools::startThreads(unsigned int pWorkerCount)
+{
+    mStop = false;
+
+    for(unsigned int tI=0; tI<pWorkerCount; ++tI) mThreads.push_back( std::thread(&SpaceParallelTools::processWorker, this, tI + 1) );
+}
+
+void
+SpaceParallelTools::stopThreads()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+
+    mStartCondition.notify_all();
+
+    unsigned int threadCount = mThreads.size();
+    for(unsigned int tI=0; tI<threadCount; ++tI) mThreads[tI].join();
+
+    mThreads.clear();
+}
+
+void
+SpaceParallelTools::processWorker(unsigned int pThreadIndex)
+{
+    unsigned long long generation = 0;
+
+    while(true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+
+            mStartCondition.wait(lock, [this, generation]{ return mStop == true || mGeneration != generation; });
+            if(mStop == true) return;
+            generation = mGeneration;
+        }
+
+        processTasks(pThreadIndex);
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if(--mActiveWorkerCount == 0) mFinishCondition.notify_one();
+        }
+    }
+}
+
+void
+SpaceParallelTools::processTasks(unsigned int pThreadIndex)
+{
+    sInsideTask = true;
+
+    while(true)
+    {
+        unsigned int taskIndex = mNextTask.fetch_add(1);
+        if(taskIndex >= mTaskCount) break;
+
+        try
+        {
+            (*mTask)(taskIndex, pThreadIndex);
+        }
+        catch(Exception& e)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if(mException == nullptr) mException = std::current_exception();
+            mNextTask = mTaskCount;
+        }
+        catch(std::exception& e)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if(mException == nullptr) mException = std::make_exception_ptr( Exception(std::string("SPACE ERROR: task failed: ") + e.what(), __FILE__, __FUNCTION__, __LINE__) );
+            mNextTask = mTaskCount;
+        }
+    }
+
+    sInsideTask = false;
+}
+
+SpaceParallelTools::operator std::string() const
+{
+    return info();
+}
+
+std::string
+SpaceParallelTools::info() const
+{
+    std::stringstream stream;
+
+    stream << "threadCount: " << threadCount() << "\n";
+
+    return stream.str();
+}
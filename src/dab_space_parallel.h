@@ -0,0 +1,108 @@
+/** \file dab_space_parallel.h
+ */
+
+#ifndef _dab_space_parallel_h_
+#define _dab_space_parallel_h_
+
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <condition_variable>
+#include "dab_exception.h"
+#include "dab_singleton.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+/**
+ \brief pool of worker threads shared by space algorithms
+
+ tasks are distributed dynamically among the worker threads and the calling thread.\n
+ tasks that are started from within a running task are processed sequentially by the calling thread.
+ */
+class SpaceParallelTools : public Singleton<SpaceParallelTools>
+{
+friend class Singleton<SpaceParallelTools>;
+
+public:
+    typedef std::function<void(unsigned int pTaskIndex, unsigned int pThreadIndex)> Task;
+
+    /**
+     \brief return number of threads that process tasks (including the calling thread)
+     \return thread count
+     */
+    unsigned int threadCount() const;
+
+    /**
+     \brief set number of threads that process tasks (including the calling thread)
+     \param pThreadCount thread count (0: number of hardware threads)
+     */
+    void setThreadCount(unsigned int pThreadCount);
+
+    /**
+     \brief process tasks in parallel
+     \param pTaskCount number of tasks
+     \param pTask task function, called with task index and thread index (0 <= thread index < threadCount())
+     \exception Exception a task failed, remaining tasks are skipped
+     */
+    void run(unsigned int pTaskCount, const Task& pTask) throw (Exception);
+
+    /**
+     \brief print parallel information
+     */
+    operator std::string() const;
+
+    /**
+     \brief print parallel information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual parallel info
+     \param pOstream output text stream
+     \param pTools parallel tools
+     */
+    friend std::ostream& operator << ( std::ostream& pOstream, const SpaceParallelTools& pTools )
+    {
+        pOstream << pTools.info();
+
+        return pOstream;
+    };
+
+protected:
+    SpaceParallelTools();
+    ~SpaceParallelTools();
+
+    void startThreads(unsigned int pWorkerCount);
+    void stopThreads();
+    void processWorker(unsigned int pThreadIndex);
+    void processTasks(unsigned int pThreadIndex);
+
+    static thread_local bool sInsideTask; ///\brief flag indicating that the current thread is processing a task
+
+    std::vector<std::thread> mThreads; ///\brief worker threads
+    std::mutex mRunMutex; ///\brief serializes calls to run
+    std::mutex mMutex; ///\brief protects task state
+    std::condition_variable mStartCondition; ///\brief signals workers that tasks are available
+    std::condition_variable mFinishCondition; ///\brief signals caller that all workers are done
+    const Task* mTask; ///\brief current task function
+    unsigned int mTaskCount; ///\brief number of current tasks
+    std::atomic<unsigned int> mNextTask; ///\brief index of next task to process
+    unsigned int mActiveWorkerCount; ///\brief number of workers still processing current tasks
+    unsigned long long mGeneration; ///\brief incremented each time tasks are started
+    bool mStop; ///\brief flag telling workers to terminate
+    std::exception_ptr mException; ///\brief first exception thrown by a task
+};
+
+};
+
+};
+
+#endif
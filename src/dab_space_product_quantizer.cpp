@@ -0,0 +1,288 @@
+/** \file dab_space_product_quantizer.cpp
+ */
+
+#include "dab_space_product_quantizer.h"
+#include "dab_space_parallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <sstream>
+
+using namespace dab;
+using namespace dab::space;
+
+const unsigned int SpaceProductQuantizer::sMaxCentroidCount = 256;
+
+SpaceProductQuantizer::SpaceProductQuantizer()
+: mDim(0)
+, mSubspaceCount(0)
+, mCentroidCount(0)
+, mTrained(false)
+{}
+
+SpaceProductQuantizer::SpaceProductQuantizer(unsigned int pDim, unsigned int pSubspaceCount, unsigned int pCentroidCount) throw (Exception)
+: mDim(pDim)
+, mSubspaceCount(pSubspaceCount)
+, mCentroidCount(pCentroidCount)
+, mTrained(false)
+{
+    if(pSubspaceCount == 0 || pSubspaceCount > pDim) throw Exception("SPACE ERROR: subspace count " + std::to_string(pSubspaceCount) + " must be between 1 and dimension " + std::to_string(pDim), __FILE__, __FUNCTION__, __LINE__);
+    if(pCentroidCount == 0 || pCentroidCount > sMaxCentroidCount) throw Exception("SPACE ERROR: centroid count " + std::to_string(pCentroidCount) + " must be between 1 and " + std::to_string(sMaxCentroidCount), __FILE__, __FUNCTION__, __LINE__);
+
+    // distribute dimensions as evenly as possible among subspaces
+    mSubspaceOffsets.resize(mSubspaceCount + 1);
+    for(unsigned int sI=0; sI<=mSubspaceCount; ++sI) mSubspaceOffsets[sI] = sI * mDim / mSubspaceCount;
+
+    mCentroids.assign(mCentroidCount * mDim, 0.0);
+}
+
+SpaceProductQuantizer::~SpaceProductQuantizer()
+{}
+
+unsigned int
+SpaceProductQuantizer::dim() const
+{
+    return mDim;
+}
+
+unsigned int
+SpaceProductQuantizer::subspaceCount() const
+{
+    return mSubspaceCount;
+}
+
+unsigned int
+SpaceProductQuantizer::centroidCount() const
+{
+    return mCentroidCount;
+}
+
+bool
+SpaceProductQuantizer::trained() const
+{
+    return mTrained;
+}
+
+unsigned int
+SpaceProductQuantizer::codeSize() const
+{
+    return mSubspaceCount * sizeof(Code);
+}
+
+unsigned int
+SpaceProductQuantizer::codebookSize() const
+{
+    return mCentroids.size() * sizeof(float);
+}
+
+void
+SpaceProductQuantizer::train(const float* pVectors, unsigned int pVectorCount, unsigned int pIterationCount) throw (Exception)
+{
+    if(pVectorCount == 0) throw Exception("SPACE ERROR: no training vectors", __FILE__, __FUNCTION__, __LINE__);
+
+    // random generators are seeded beforehand so that subspaces can be trained in parallel
+    std::vector<unsigned int> seeds(mSubspaceCount);
+    for(unsigned int sI=0; sI<mSubspaceCount; ++sI) seeds[sI] = mRandomGenerator();
+
+    try
+    {
+        SpaceParallelTools::get().run(mSubspaceCount, [this, pVectors, pVectorCount, pIterationCount, &seeds](unsigned int pTaskIndex, unsigned int)
+        {
+            unsigned int subspace = pTaskIndex;
+            unsigned int subOffset = mSubspaceOffsets[subspace];
+            unsigned int subDim = mSubspaceOffsets[subspace + 1] - subOffset;
+            float* centroids = mCentroids.data() + mCentroidCount * subOffset;
+
+            std::mt19937 randomGenerator(seeds[subspace]);
+            std::uniform_int_distribution<unsigned int> vectorDistribution(0, pVectorCount - 1);
+
+            // initialize centroids with distinct training vectors where possible
+            std::vector<unsigned int> vectorIndices(pVectorCount);
+            for(unsigned int vI=0; vI<pVectorCount; ++vI) vectorIndices[vI] = vI;
+            std::shuffle(vectorIndices.begin(), vectorIndices.end(), randomGenerator);
+
+            for(unsigned int cI=0; cI<mCentroidCount; ++cI)
+            {
+                const float* subvector = pVectors + vectorIndices[cI % pVectorCount] * mDim + subOffset;
+                std::copy(subvector, subvector + subDim, centroids + cI * subDim);
+            }
+
+            std::vector<unsigned int> assignments(pVectorCount, 0);
+            std::vector<float> sums(mCentroidCount * subDim);
+            std::vector<unsigned int> counts(mCentroidCount);
+
+            for(unsigned int iteration=0; iteration<pIterationCount; ++iteration)
+            {
+                bool assignmentsChanged = false;
+
+                for(unsigned int vI=0; vI<pVectorCount; ++vI)
+                {
+                    unsigned int centroid = closestCentroid(subspace, pVectors + vI * mDim + subOffset);
+                    if(centroid != assignments[vI] || iteration == 0) assignmentsChanged = true;
+                    assignments[vI] = centroid;
+                }
+
+                if(assignmentsChanged == false) break;
+
+                std::fill(sums.begin(), sums.end(), 0.0);
+                std::fill(counts.begin(), counts.end(), 0);
+
+                for(unsigned int vI=0; vI<pVectorCount; ++vI)
+                {
+                    const float* subvector = pVectors + vI * mDim + subOffset;
+                    float* sum = sums.data() + assignments[vI] * subDim;
+
+                    for(unsigned int d=0; d<subDim; ++d) sum[d] += subvector[d];
+                    counts[assignments[vI]]++;
+                }
+
+                for(unsigned int cI=0; cI<mCentroidCount; ++cI)
+                {
+                    float* centroid = centroids + cI * subDim;
+
+                    if(counts[cI] == 0)
+                    {
+                        // empty clusters are reinitialized with a random training vector
+                        const float* subvector = pVectors + vectorDistribution(randomGenerator) * mDim + subOffset;
+                        std::copy(subvector, subvector + subDim, centroid);
+                    }
+                    else
+                    {
+                        for(unsigned int d=0; d<subDim; ++d) centroid[d] = sums[cI * subDim + d] / static_cast<float>(counts[cI]);
+                    }
+                }
+            }
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to train product quantizer", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+
+    mTrained = true;
+}
+
+unsigned int
+SpaceProductQuantizer::closestCentroid(unsigned int pSubspace, const float* pSubvector) const
+{
+    unsigned int subOffset = mSubspaceOffsets[pSubspace];
+    unsigned int subDim = mSubspaceOffsets[pSubspace + 1] - subOffset;
+    const float* centroid = mCentroids.data() + mCentroidCount * subOffset;
+
+    unsigned int closestCentroid = 0;
+    float closestDistance = FLT_MAX;
+
+    for(unsigned int cI=0; cI<mCentroidCount; ++cI, centroid += subDim)
+    {
+        float distance = 0.0;
+        for(unsigned int d=0; d<subDim; ++d) distance += ( pSubvector[d] - centroid[d] ) * ( pSubvector[d] - centroid[d] );
+
+        if(distance < closestDistance)
+        {
+            closestDistance = distance;
+            closestCentroid = cI;
+        }
+    }
+
+    return closestCentroid;
+}
+
+void
+SpaceProductQuantizer::encode(const float* pVector, Code* pCode) const
+{
+    for(unsigned int sI=0; sI<mSubspaceCount; ++sI) pCode[sI] = static_cast<Code>( closestCentroid(sI, pVector + mSubspaceOffsets[sI]) );
+}
+
+void
+SpaceProductQuantizer::decode(const Code* pCode, float* pVector) const
+{
+    for(unsigned int sI=0; sI<mSubspaceCount; ++sI)
+    {
+        unsigned int subOffset = mSubspaceOffsets[sI];
+        unsigned int subDim = mSubspaceOffsets[sI + 1] - subOffset;
+        const float* centroid = mCentroids.data() + mCentroidCount * subOffset + pCode[sI] * subDim;
+
+        std::copy(centroid, centroid + subDim, pVector + subOffset);
+    }
+}
+
+void
+SpaceProductQuantizer::distanceTable(const float* pQuery, float* pTable) const
+{
+    for(unsigned int sI=0; sI<mSubspaceCount; ++sI)
+    {
+        unsigned int subOffset = mSubspaceOffsets[sI];
+        unsigned int subDim = mSubspaceOffsets[sI + 1] - subOffset;
+        const float* subvector = pQuery + subOffset;
+        const float* centroid = mCentroids.data() + mCentroidCount * subOffset;
+        float* table = pTable + sI * mCentroidCount;
+
+        for(unsigned int cI=0; cI<mCentroidCount; ++cI, centroid += subDim)
+        {
+            float distance = 0.0;
+            for(unsigned int d=0; d<subDim; ++d) distance += ( subvector[d] - centroid[d] ) * ( subvector[d] - centroid[d] );
+
+            table[cI] = distance;
+        }
+    }
+}
+
+float
+SpaceProductQuantizer::asymmetricDistance(const float* pTable, const Code* pCode) const
+{
+    float distance = 0.0;
+
+    for(unsigned int sI=0; sI<mSubspaceCount; ++sI, pTable += mCentroidCount) distance += pTable[ pCode[sI] ];
+
+    return distance;
+}
+
+void
+SpaceProductQuantizer::asymmetricDistances(const float* pTable, const Code* pCodes, unsigned int pCodeCount, float* pDistances) const
+{
+    unsigned int codeSize = mSubspaceCount;
+    unsigned int cI = 0;
+
+    // four codes are processed at once so that the table lookups of independent codes can overlap
+    for(; cI + 4 <= pCodeCount; cI += 4, pCodes += 4 * codeSize)
+    {
+        float distance0 = 0.0, distance1 = 0.0, distance2 = 0.0, distance3 = 0.0;
+        const float* table = pTable;
+
+        for(unsigned int sI=0; sI<codeSize; ++sI, table += mCentroidCount)
+        {
+            distance0 += table[ pCodes[sI] ];
+            distance1 += table[ pCodes[codeSize + sI] ];
+            distance2 += table[ pCodes[2 * codeSize + sI] ];
+            distance3 += table[ pCodes[3 * codeSize + sI] ];
+        }
+
+        pDistances[cI] = distance0;
+        pDistances[cI + 1] = distance1;
+        pDistances[cI + 2] = distance2;
+        pDistances[cI + 3] = distance3;
+    }
+
+    for(; cI<pCodeCount; ++cI, pCodes += codeSize) pDistances[cI] = asymmetricDistance(pTable, pCodes);
+}
+
+SpaceProductQuantizer::operator std::string() const
+{
+    return info();
+}
+
+std::string
+SpaceProductQuantizer::info() const
+{
+    std::stringstream stream;
+
+    stream << "SpaceProductQuantizer\n";
+    stream << "dim: " << mDim << "\n";
+    stream << "subspaceCount: " << mSubspaceCount << "\n";
+    stream << "centroidCount: " << mCentroidCount << "\n";
+    stream << "codeSize: " << codeSize() << " bytes (uncompressed: " << mDim * sizeof(float) << " bytes)\n";
+    stream << "codebookSize: " << codebookSize() << " bytes\n";
+    stream << "trained: " << mTrained << "\n";
+
+    return stream.str();
+}
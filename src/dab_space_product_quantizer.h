@@ -0,0 +1,160 @@
+/** \file dab_space_product_quantizer.h
+ */
+
+#ifndef _dab_space_product_quantizer_h_
+#define _dab_space_product_quantizer_h_
+
+#include <iostream>
+#include <random>
+#include <cstdint>
+#include <vector>
+#include "dab_exception.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+/**
+ \brief compressed representation of high dimensional vectors by product quantization
+
+ a vector is split into subvectors of consecutive dimensions, each subvector is replaced by the index of the closest centroid of a codebook trained for its subspace.\n
+ a code therefore occupies one byte per subspace instead of four bytes per dimension.\n
+ squared distances between an uncompressed query and encoded vectors are approximated by summing entries of a distance table that is calculated once per query (asymmetric distance computation).
+ */
+class SpaceProductQuantizer
+{
+public:
+    typedef uint8_t Code; ///\brief centroid index within one subspace
+
+    static const unsigned int sMaxCentroidCount; ///\brief maximum number of centroids per subspace
+
+    /**
+     \brief create product quantizer
+     \param pDim dimension of vectors
+     \param pSubspaceCount number of subspaces (code size in bytes)
+     \param pCentroidCount number of centroids per subspace
+     \exception Exception subspace count is zero or exceeds dimension, centroid count is zero or exceeds maximum centroid count
+     */
+    SpaceProductQuantizer(unsigned int pDim, unsigned int pSubspaceCount, unsigned int pCentroidCount = 256) throw (Exception);
+    ~SpaceProductQuantizer();
+
+    unsigned int dim() const;
+    unsigned int subspaceCount() const;
+    unsigned int centroidCount() const;
+
+    /**
+     \brief return whether codebooks have been trained
+     \return true if codebooks have been trained
+     */
+    bool trained() const;
+
+    /**
+     \brief return number of bytes per code
+     \return code size
+     */
+    unsigned int codeSize() const;
+
+    /**
+     \brief return number of bytes occupied by codebooks
+     \return codebook size
+     */
+    unsigned int codebookSize() const;
+
+    /**
+     \brief train codebooks by k-means clustering of each subspace
+     \param pVectors training vectors (pDim values per vector)
+     \param pVectorCount number of training vectors
+     \param pIterationCount number of k-means iterations
+     \exception Exception no training vectors
+     */
+    void train(const float* pVectors, unsigned int pVectorCount, unsigned int pIterationCount = 16) throw (Exception);
+
+    /**
+     \brief encode vector
+     \param pVector vector (pDim values)
+     \param pCode resulting code (codeSize values)
+     */
+    void encode(const float* pVector, Code* pCode) const;
+
+    /**
+     \brief decode code into approximate vector
+     \param pCode code (codeSize values)
+     \param pVector resulting vector (pDim values)
+     */
+    void decode(const Code* pCode, float* pVector) const;
+
+    /**
+     \brief calculate squared distances between query and all centroids
+     \param pQuery query vector (pDim values)
+     \param pTable resulting distance table (subspaceCount * centroidCount values)
+     */
+    void distanceTable(const float* pQuery, float* pTable) const;
+
+    /**
+     \brief approximate squared distance between query and encoded vector
+     \param pTable distance table of query
+     \param pCode code (codeSize values)
+     \return approximate squared distance
+     */
+    float asymmetricDistance(const float* pTable, const Code* pCode) const;
+
+    /**
+     \brief approximate squared distances between query and consecutive encoded vectors
+     \param pTable distance table of query
+     \param pCodes codes (codeSize values per vector)
+     \param pCodeCount number of codes
+     \param pDistances resulting approximate squared distances (pCodeCount values)
+     */
+    void asymmetricDistances(const float* pTable, const Code* pCodes, unsigned int pCodeCount, float* pDistances) const;
+
+    /**
+     \brief obtain textual product quantizer information
+     \return String containing textual product quantizer information
+     */
+    operator std::string() const;
+
+    /**
+     \brief obtain textual product quantizer information
+     \return String containing textual product quantizer information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual product quantizer information
+     \param pOstream output stream
+     \param pQuantizer product quantizer
+     */
+    friend std::ostream& operator<< (std::ostream & pOstream, const SpaceProductQuantizer& pQuantizer)
+    {
+        pOstream << std::string(pQuantizer);
+
+        return pOstream;
+    }
+
+protected:
+    SpaceProductQuantizer();
+
+    /**
+     \brief return index of centroid closest to subvector
+     \param pSubspace subspace index
+     \param pSubvector subvector (subspace dimension values)
+     \return centroid index
+     */
+    unsigned int closestCentroid(unsigned int pSubspace, const float* pSubvector) const;
+
+    unsigned int mDim; ///\brief dimension of vectors
+    unsigned int mSubspaceCount; ///\brief number of subspaces
+    unsigned int mCentroidCount; ///\brief number of centroids per subspace
+    std::vector<unsigned int> mSubspaceOffsets; ///\brief first dimension of each subspace (subspaceCount + 1 values)
+    std::vector<float> mCentroids; ///\brief centroids, subspace s occupies centroidCount * subspace dimension values starting at centroidCount * mSubspaceOffsets[s]
+    bool mTrained; ///\brief codebooks have been trained
+    std::mt19937 mRandomGenerator; ///\brief random generator for centroid initialization
+};
+
+};
+
+};
+
+#endif
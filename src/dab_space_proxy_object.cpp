@@ -2,18 +2,23 @@
 */
 
 #include "dab_space_proxy_object.h"
+#include "dab_space_shape.h"
 
 using namespace dab;
 using namespace dab::space;
 
 SpaceProxyObject::SpaceProxyObject()
 : mSpaceObject(nullptr)
+, mSpaceShape(nullptr)
 , mNeighborGroup(nullptr)
+, mIndex(0)
 {}
 
 SpaceProxyObject::SpaceProxyObject(SpaceObject* pSpaceObject, NeighborGroup* pNeighborGroup)
 : mSpaceObject(pSpaceObject)
+, mSpaceShape(dynamic_cast<SpaceShape*>(pSpaceObject))
 , mNeighborGroup(pNeighborGroup)
+, mIndex(0)
 {}
 
 SpaceProxyObject::~SpaceProxyObject()
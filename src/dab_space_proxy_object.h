@@ -4,7 +4,10 @@
 #ifndef _dab_space_proxy_object_h_
 #define _dab_space_proxy_object_h_
 
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <vector>
 #include <Eigen/Dense>
 #include "dab_exception.h"
 #include "dab_space_object.h"
@@ -18,21 +21,66 @@ namespace space
 {
 
 class NeighborGroup;
+class SpaceShape;
 
 class SpaceProxyObject
 {
 public:
     SpaceProxyObject(SpaceObject* pSpaceObject, NeighborGroup* pNeighborGroup);
-    ~SpaceProxyObject();
+    virtual ~SpaceProxyObject();
     
     inline SpaceObject* spaceObject();
     
     inline const SpaceObject* spaceObject() const;
     
+    /**
+     \brief return space object as shape
+     \return space shape (nullptr: space object isn't a shape)
+     
+     whether the space object is a shape is determined once when the proxy object is created
+     */
+    inline SpaceShape* spaceShape();
+    
+    /**
+     \brief return space object as shape
+     \return space shape (nullptr: space object isn't a shape)
+     */
+    inline const SpaceShape* spaceShape() const;
+    
     inline NeighborGroup* neighborGroup();
     
     inline const NeighborGroup* neighborGroup() const;
     
+    /**
+     \brief return index of proxy object
+     \return index
+     
+     the index is assigned by space algorithms and refers to the position of the proxy object within the objects the algorithm currently operates on
+     */
+    inline unsigned int index() const;
+    
+    /**
+     \brief set index of proxy object
+     \param pIndex index
+     */
+    inline void setIndex(unsigned int pIndex);
+    
+    /**
+     \brief return closest feature of a shape found by the last closest point query of this object
+     \param pShape shape
+     \return closest feature, can be passed to and is updated by SpaceShape::closestPoint (-1: none)
+     
+     each proxy object is updated by a single thread during neighbor updates, so the features can be updated without synchronization.\n
+     the features of all shapes queried by this object are kept, ordered by shape, and are only forgotten when a shape is removed from the space. memory is only allocated the first time a shape is queried. the returned reference is valid until the next call. should only be called for shapes with feature caching.
+     */
+    inline int& closestFeature(const SpaceShape* pShape);
+    
+    /**
+     \brief forget closest feature of a shape
+     \param pShape shape
+     */
+    inline void removeClosestFeature(const SpaceShape* pShape);
+    
     /**
      \brief return space object dimension
      \return space object dimension
@@ -143,8 +191,10 @@ protected:
     SpaceProxyObject();
     
     SpaceObject* mSpaceObject;
+    SpaceShape* mSpaceShape; ///\brief space object as shape (nullptr: space object isn't a shape)
     NeighborGroup* mNeighborGroup;
-    
+    unsigned int mIndex;
+    std::vector< std::pair<const SpaceShape*, int> > mClosestFeatures; ///\brief closest feature of each queried shape found by the last closest point query, ordered by shape
 };
 
 SpaceObject*
@@ -159,6 +209,18 @@ SpaceProxyObject::spaceObject() const
     return mSpaceObject;
 }
 
+SpaceShape*
+SpaceProxyObject::spaceShape()
+{
+    return mSpaceShape;
+}
+
+const SpaceShape*
+SpaceProxyObject::spaceShape() const
+{
+    return mSpaceShape;
+}
+
 NeighborGroup*
 SpaceProxyObject::neighborGroup()
 {
@@ -171,6 +233,36 @@ SpaceProxyObject::neighborGroup() const
     return mNeighborGroup;
 }
 
+unsigned int
+SpaceProxyObject::index() const
+{
+    return mIndex;
+}
+
+int&
+SpaceProxyObject::closestFeature(const SpaceShape* pShape)
+{
+    auto featureIter = std::lower_bound( mClosestFeatures.begin(), mClosestFeatures.end(), pShape, [](const std::pair<const SpaceShape*, int>& pFeature, const SpaceShape* pShape) { return std::less<const SpaceShape*>()(pFeature.first, pShape); } );
+    
+    if( featureIter == mClosestFeatures.end() || featureIter->first != pShape ) featureIter = mClosestFeatures.insert( featureIter, std::make_pair(pShape, -1) );
+    
+    return featureIter->second;
+}
+
+void
+SpaceProxyObject::removeClosestFeature(const SpaceShape* pShape)
+{
+    auto featureIter = std::lower_bound( mClosestFeatures.begin(), mClosestFeatures.end(), pShape, [](const std::pair<const SpaceShape*, int>& pFeature, const SpaceShape* pShape) { return std::less<const SpaceShape*>()(pFeature.first, pShape); } );
+    
+    if( featureIter != mClosestFeatures.end() && featureIter->first == pShape ) mClosestFeatures.erase(featureIter);
+}
+
+void
+SpaceProxyObject::setIndex(unsigned int pIndex)
+{
+    mIndex = pIndex;
+}
+
 unsigned int
 SpaceProxyObject::dim() const
 {
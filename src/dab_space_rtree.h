@@ -6,6 +6,8 @@
 
 #include "dab_space_shape.h"
 #include <vector>
+#include <algorithm>
+#include <limits>
 #include <stdio.h>
 #include <math.h>
 #include <assert.h>
@@ -17,7 +19,6 @@ namespace dab
 namespace space
 {
 
-#define RTREE_DONT_USE_MEMPOOLS // This version does not contain a fixed memory allocator, fill in lines with EXAMPLE to implement one.
 #define RTREE_USE_SPHERICAL_VOLUME // Better split classification, may be slower on some systems
 
 // Fwd decl
@@ -32,122 +33,184 @@ class RTFileStream;  // File I/O helper class, look below for implementation and
 ///
 /// DATATYPE Referenced data, should be int, void*, obj* etc. no larger than sizeof<void*> and simple type
 /// ELEMTYPE Type of element such as int or float
+/// NUMDIMS Number of dimensions such as 2 or 3
 /// ELEMTYPEREAL Type of element that allows fractional and large values such as float or double, for use in volume calcs
 ///
 /// NOTES: Inserting and removing data requires the knowledge of its constant Minimal Bounding Rectangle.
-///        This version uses new/delete for nodes, I recommend using a fixed size allocator for efficiency.
+///        Nodes store the rects of their branches as one contiguous array per axis and dimension, so that
+///        a search tests all branches of a node in a single pass over a few cache lines.
+///        Nodes are taken from a pool that allocates them in blocks. Freed nodes are kept for reuse,
+///        the pool only returns its memory when the tree is destroyed.
 ///        Instead of using a callback function for returned results, I recommend and efficient pre-sized, grow-only memory
 ///        array similar to MFC CArray or STL Vector for returning search query result.
 ///
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL = ELEMTYPE, int TMAXNODES = 8, int TMINNODES = TMAXNODES / 2>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL = ELEMTYPE, int TMAXNODES = 8, int TMINNODES = TMAXNODES / 2>
 
 class RTree
 {
 protected:
-    
+
     class Node;  // Fwd decl.  Used by other internal structs and iterator
-    unsigned int mDim;
-    
+
 public:
-    
+
     // These constant must be declared after Branch and before Node struct
     // Stuck up here for MSVC 6 compiler.  NSVC .NET 2003 is much happier.
     enum
     {
         MAXNODES = TMAXNODES,                         ///< Max elements in node
         MINNODES = TMINNODES,                         ///< Min elements in node
+        NODEBLOCKSIZE = 64,                           ///< Nodes allocated at once by the node pool
+        MAXSTACK = 32 * TMAXNODES,                    ///< Max nodes pending during a search. Allows trees up to 32 levels deep
     };
-    
-    
+
+
 public:
-    
-    RTree(unsigned int pDim);
+
+    RTree();
     virtual ~RTree();
-    
+
     /// Insert entry
     /// \param a_min Min of bounding rect
     /// \param a_max Max of bounding rect
     /// \param a_dataId Positive Id of data.  Maybe zero, but negative numbers not allowed.
     void Insert(const ELEMTYPE* a_min, const ELEMTYPE* a_max, const DATATYPE& a_dataId);
-    
+
+    /// Remove all entries and build a packed tree from a list of entries (Sort-Tile-Recursive bulk loading).
+    /// Much faster than inserting the entries one by one, and the resulting nodes are full and overlap less.
+    /// \param a_mins Min of bounding rects (NUMDIMS values per entry)
+    /// \param a_maxs Max of bounding rects (NUMDIMS values per entry)
+    /// \param a_dataIds Ids of data
+    /// \param a_count Number of entries
+    void BulkLoad(const ELEMTYPE* a_mins, const ELEMTYPE* a_maxs, const DATATYPE* a_dataIds, int a_count);
+
     /// Remove entry
     /// \param a_min Min of bounding rect
     /// \param a_max Max of bounding rect
     /// \param a_dataId Positive Id of data.  Maybe zero, but negative numbers not allowed.
     void Remove(const ELEMTYPE* a_min, const ELEMTYPE* a_max, const DATATYPE& a_dataId);
-    
+
     /// Find all within search rectangle
+    /// Doesn't modify the tree, several threads may search the same tree concurrently.
     /// \param a_min Min of search bounding rect
     /// \param a_max Max of search bounding rect
     /// \param pSearchResults Search result array.
-    void Search(const ELEMTYPE* a_min, const ELEMTYPE* a_max, std::vector<DATATYPE>& pSearchResults);
-    
+    void Search(const ELEMTYPE* a_min, const ELEMTYPE* a_max, std::vector<DATATYPE>& pSearchResults) const;
+
+    /// Entry of the priority queue of a nearest neighbor search
+    class NearestEntry
+    {
+    public:
+        ELEMTYPEREAL mDistance;                      ///< Lower bound or exact distance to the query point
+        const Node* mNode;                           ///< Node to visit, or leaf node holding the entry
+        int mIndex;                                  ///< Index of entry in leaf node, -1 for nodes to visit
+        bool mExact;                                 ///< mDistance is the exact distance of the entry
+
+        /// Heap order: smallest distance on top, exact distances before bounds of equal value
+        bool operator<(const NearestEntry& a_other) const
+        {
+            return mDistance > a_other.mDistance || (mDistance == a_other.mDistance && mExact == false && a_other.mExact == true);
+        }
+    };
+
+    /// Find the k entries nearest to a point by best first branch and bound search
+    /// Nodes are visited in order of the distance from the point to their rect. Entries are first queued with the distance
+    /// to their rect and, once dequeued, requeued with their exact distance. The search stops when k exact distances have been
+    /// dequeued, since all remaining bounds are larger.
+    /// Doesn't modify the tree, several threads may search the same tree concurrently.
+    /// \param a_point Query point
+    /// \param a_k Number of entries to find
+    /// \param a_distance Functor ELEMTYPEREAL(const DATATYPE& a_data, const ELEMTYPE* a_min, const ELEMTYPE* a_max) that returns the
+    ///        exact distance of an entry, which must not be smaller than the distance to its rect.
+    ///        Entries for which it returns std::numeric_limits<ELEMTYPEREAL>::max() are skipped.
+    /// \param a_queue Priority queue, passed in so that its memory can be reused across searches
+    /// \param a_results Found entries with their exact distances, ordered by increasing distance
+    template<class DISTANCE>
+    void NearestSearch(const ELEMTYPE* a_point, int a_k, DISTANCE& a_distance, std::vector<NearestEntry>& a_queue, std::vector< std::pair<ELEMTYPEREAL, DATATYPE> >& a_results) const;
+
+    /// Find the entry hit first by a ray by best first search with slab tests
+    /// Nodes are visited in order of the distance along the ray at which it enters their rect. Entries are first queued
+    /// with the entry distance of their rect and, once dequeued, requeued with their exact hit distance.
+    /// Doesn't modify the tree, several threads may search the same tree concurrently.
+    /// \param a_origin Ray origin
+    /// \param a_direction Ray direction, distances are measured in multiples of its length
+    /// \param a_maxDistance Maximum distance along the ray
+    /// \param a_anyHit Stop at the first entry that is hit, which is not necessarily the closest one
+    /// \param a_hit Functor ELEMTYPEREAL(const DATATYPE& a_data, ELEMTYPEREAL a_rectDistance) that returns the exact hit distance
+    ///        of an entry, which must not be smaller than the entry distance of its rect. Entries for which it returns
+    ///        std::numeric_limits<ELEMTYPEREAL>::max() are not hit.
+    /// \param a_queue Priority queue, passed in so that its memory can be reused across searches
+    /// \param a_result Entry that has been hit and its hit distance
+    /// \return Whether an entry has been hit
+    template<class HIT>
+    bool RaySearch(const ELEMTYPE* a_origin, const ELEMTYPE* a_direction, ELEMTYPEREAL a_maxDistance, bool a_anyHit, HIT& a_hit, std::vector<NearestEntry>& a_queue, std::pair<ELEMTYPEREAL, DATATYPE>& a_result) const;
+
     /// Remove all entries from tree
     void RemoveAll();
-    
+
     /// Count the data elements in this container.  This is slow as no internal counter is maintained.
     int Count();
-    
+
     /// Load tree contents from file
     bool Load(const char* a_fileName);
     /// Load tree contents from stream
     bool Load(RTFileStream& a_stream);
-    
-    
+
+
     /// Save tree contents to file
     bool Save(const char* a_fileName);
     /// Save tree contents to stream
     bool Save(RTFileStream& a_stream);
-    
+
     /// Iterator is not remove safe.
     class Iterator
     {
     private:
-        
+
         enum { MAX_STACK = 32 }; //  Max stack size. Allows almost n^32 where n is number of branches in node
-        
+
         struct StackElement
         {
             Node* m_node;
             int m_branchIndex;
         };
-        
+
     public:
-        
+
         Iterator()                                    { Init(); }
-        
+
         ~Iterator()                                   { }
-        
+
         /// Is iterator invalid
         bool IsNull()                                 { return (m_tos <= 0); }
-        
+
         /// Is iterator pointing to valid data
         bool IsNotNull()                              { return (m_tos > 0); }
-        
+
         /// Access the current data element. Caller must be sure iterator is not NULL first.
         DATATYPE& operator*()
         {
             assert(IsNotNull());
             StackElement& curTos = m_stack[m_tos - 1];
-            return curTos.m_node->m_branch[curTos.m_branchIndex].m_data;
+            return curTos.m_node->mData[curTos.m_branchIndex];
         }
-        
+
         /// Access the current data element. Caller must be sure iterator is not NULL first.
         const DATATYPE& operator*() const
         {
             assert(IsNotNull());
-            StackElement& curTos = m_stack[m_tos - 1];
-            return curTos.m_node->m_branch[curTos.m_branchIndex].m_data;
+            const StackElement& curTos = m_stack[m_tos - 1];
+            return curTos.m_node->mData[curTos.m_branchIndex];
         }
-        
+
         /// Find the next data element
         bool operator++()                             { return FindNextData(); }
-        
+
     private:
-        
+
         /// Reset iterator
         void Init()                                   { m_tos = 0; }
-        
+
         /// Find the next data element in the tree (For internal use only)
         bool FindNextData()
         {
@@ -158,11 +221,11 @@ public:
                     return false;
                 }
                 StackElement curTos = Pop(); // Copy stack top cause it may change as we use it
-                
+
                 if(curTos.m_node->IsLeaf())
                 {
                     // Keep walking through data while we can
-                    if(curTos.m_branchIndex+1 < curTos.m_node->m_count)
+                    if(curTos.m_branchIndex+1 < curTos.m_node->mCount)
                     {
                         // There is more data, just point to the next one
                         Push(curTos.m_node, curTos.m_branchIndex + 1);
@@ -172,16 +235,16 @@ public:
                 }
                 else
                 {
-                    if(curTos.m_branchIndex+1 < curTos.m_node->m_count)
+                    if(curTos.m_branchIndex+1 < curTos.m_node->mCount)
                     {
                         // Push sibling on for future tree walk
                         // This is the 'fall back' node when we finish with the current level
                         Push(curTos.m_node, curTos.m_branchIndex + 1);
                     }
                     // Since cur node is not a leaf, push first of next level to get deeper into the tree
-                    Node* nextLevelnode = curTos.m_node->m_branch[curTos.m_branchIndex].m_child;
+                    Node* nextLevelnode = curTos.m_node->mChild[curTos.m_branchIndex];
                     Push(nextLevelnode, 0);
-                    
+
                     // If we pushed on a new leaf, exit as the data is ready at TOS
                     if(nextLevelnode->IsLeaf())
                     {
@@ -190,7 +253,7 @@ public:
                 }
             }
         }
-        
+
         /// Push node and branch onto iteration stack (For internal use only)
         void Push(Node* a_node, int a_branchIndex)
         {
@@ -199,7 +262,7 @@ public:
             ++m_tos;
             assert(m_tos <= MAX_STACK);
         }
-        
+
         /// Pop element off iteration stack (For internal use only)
         StackElement& Pop()
         {
@@ -207,93 +270,47 @@ public:
             --m_tos;
             return m_stack[m_tos];
         }
-        
+
         StackElement m_stack[MAX_STACK];              ///< Stack as we are doing iteration instead of recursion
         int m_tos;                                    ///< Top Of Stack index
-        
+
         friend class RTree; // Allow hiding of non-public functions while allowing manipulation by logical owner
     };
-    
+
     /// Get 'first' for iteration
     void GetFirst(Iterator& a_it)
     {
         a_it.Init();
-        if(m_root && (m_root->m_count > 0))
+        if(m_root && (m_root->mCount > 0))
         {
             a_it.Push(m_root, 0);
             a_it.FindNextData();
         }
     }
-    
+
     /// Get Next for iteration
     void GetNext(Iterator& a_it)                    { ++a_it; }
-    
+
     /// Is iterator NULL, or at end?
     bool IsNull(Iterator& a_it)                     { return a_it.IsNull(); }
-    
+
     /// Get object at iterator position
     DATATYPE& GetAt(Iterator& a_it)                 { return *a_it; }
-    
+
 protected:
-    
+
+    /// Minimal bounding rectangle (n-dimensional)
     class Rect
     {
-    protected:
-        Rect()
-        {
-            assert("illegal constructor");
-        }
-        
     public:
-        unsigned int mDim;
-        ELEMTYPE* mMin;                      ///< Min dimensions of bounding box
-        ELEMTYPE* mMax;                      ///< Max dimensions of bounding box
-        
-        Rect(unsigned int pDim)
-        : mDim(pDim)
-        {
-            mMin = new ELEMTYPE[mDim];
-            mMax = new ELEMTYPE[mDim];
-        }
-        
-        Rect(const Rect& pRect)
-        : mDim(pRect.mDim)
-        {
-            mMin = new ELEMTYPE[mDim];
-            mMax = new ELEMTYPE[mDim];
-            
-            for(unsigned int i=0; i<mDim; ++i)
-            {
-                mMin[i] = pRect.mMin[i];
-                mMax[i] = pRect.mMax[i];
-            }
-        }
-        
-        ~Rect()
-        {
-            delete [] mMin;
-            delete [] mMax;
-        }
-        
-        const Rect&
-        operator=( const Rect& pRect )
-        {
-            assert(mDim == pRect.mDim);
-            
-            for(unsigned int i=0; i<mDim; ++i)
-            {
-                mMin[i] = pRect.mMin[i];
-                mMax[i] = pRect.mMax[i];
-            }
-            
-            return pRect;
-        }
-        
+        ELEMTYPE mMin[NUMDIMS];                      ///< Min dimensions of bounding box
+        ELEMTYPE mMax[NUMDIMS];                      ///< Max dimensions of bounding box
     };
-    
+
     /// May be data or may be another subtree
     /// The parents level determines this.
     /// If the parents level is 0, then this is data
+    /// Only used for branches that are being moved between nodes, nodes store their branches in Node::mMin, Node::mMax and Node::mChild or Node::mData
     class Branch
     {
     public:
@@ -303,340 +320,139 @@ protected:
             Node* mChild;                              ///< Child node
             DATATYPE mData;                            ///< Data Id or Ptr
         };
-        
-    protected:
-        Branch()
-        : mRect(0)
-        {
-            assert("illegal constructor");
-        }
-        
-    public:
-        
-        Branch(unsigned int pDim)
-        : mRect(pDim)
-        {}
-        
-        ~Branch()
-        {}
-        
-        inline
-        Rect&
-        rect()
-        {
-            return mRect;
-        }
-        
-        inline
-        Node*
-        child()
-        {
-            return mChild;
-        }
-        
-        inline
-        DATATYPE&
-        data()
-        {
-            return mData;
-        }
-        
-        inline
-        void
-        setRect(Rect& pRect)
-        {
-            mRect = pRect;
-        }
-        
-        inline
-        void
-        setChild(Node* pChild)
-        {
-            mChild = pChild;
-        }
-        
-        inline
-        void
-        setData(DATATYPE& pData)
-        {
-            mData = pData;
-        }
-        
     };
-    
+
     /// Node for each branch level
+    /// Branch rects are stored as one array of mins and maxs per axis (structure of arrays).
+    /// Slots beyond mCount hold stale but valid values, searches may test them and ignore the result.
     class Node
     {
     public:
+        ELEMTYPE mMin[NUMDIMS][MAXNODES];            ///< Min of branch rects, per axis
+        ELEMTYPE mMax[NUMDIMS][MAXNODES];            ///< Max of branch rects, per axis
+        union
+        {
+            Node* mChild[MAXNODES];                    ///< Child nodes (internal node)
+            DATATYPE mData[MAXNODES];                  ///< Data Ids or Ptrs (leaf)
+        };
         int mCount;                                  ///< Count
         int mLevel;                                  ///< Leaf is zero, others positive
-        Branch** mBranch;							 ///< Branch
-        
-    protected:
-        Node()
-        {
-            assert("illegal constructor");
-        }
-        
-    public:
-        Node(unsigned int pDim)
-        : mCount(0)
-        , mLevel(0)
-        {
-            mBranch = new Branch*[MAXNODES];
-            for(unsigned int i=0; i<MAXNODES; ++i) mBranch[i] = new Branch(pDim);
-        }
-        
-        Node(int pDim, int pCount, int pLevel)
-        : mCount(pCount)
-        , mLevel(pLevel)
-        {
-            mBranch = new Branch*[MAXNODES];
-            for(unsigned int i=0; i<MAXNODES; ++i) mBranch[i] = new Branch(pDim);
-        }
-        
-        ~Node()
-        {
-            for(unsigned int i=0; i<MAXNODES; ++i) delete mBranch[i];
-            delete [] mBranch;
-        }
-        
+
         inline
         bool
-        IsInternalNode()
+        IsInternalNode() const
         {
             return (mLevel > 0);
         } // Not a leaf, but a internal node
-        
+
         inline
         bool
-        IsLeaf()
+        IsLeaf() const
         {
             return (mLevel == 0);
         } // A leaf, contains data
-        
-        inline
-        int
-        level()
-        {
-            return mLevel;
-        }
-        
-        inline
-        int
-        count()
-        {
-            return mCount;
-        }
-        
-        inline
-        Branch&
-        branch(unsigned int pIndex)
-        {
-            assert(pIndex < MAXNODES);
-            
-            return *(mBranch[pIndex]);
-        }
-        
-        inline
-        void
-        setLevel(int pLevel)
-        {
-            mLevel = pLevel;
-        }
-        
+
         inline
         void
-        setCount(int pCount)
+        GetRect(int a_index, Rect& a_rect) const
         {
-            mCount = pCount;
+            assert(a_index >= 0 && a_index < MAXNODES);
+
+            for(int axis=0; axis<NUMDIMS; ++axis)
+            {
+                a_rect.mMin[axis] = mMin[axis][a_index];
+                a_rect.mMax[axis] = mMax[axis][a_index];
+            }
         }
-        
+
         inline
         void
-        setBranch(Branch* pBranch, unsigned int pIndex)
-        {
-            assert(pIndex < MAXNODES);
-            
-            mBranch[pIndex] = pBranch;
-        }
-    };
-    
-    /// A link list of nodes for reinsertion after a delete operation
-    class ListNode
-    {
-    public:
-        ListNode* mNext;                             ///< Next in list
-        Node* mNode;                                 ///< Node
-        
-    protected:
-        ListNode()
-        {
-            assert("illegal constructor");
-        }
-        
-    public:
-        ListNode(ListNode* pNext, Node* pNode)
-        : mNext(pNext)
-        , mNode(pNode)
-        {}
-        
-        inline
-        ListNode*
-        next()
-        {
-            return mNext;
-        }
-        
-        inline
-        Node*
-        node()
+        SetRect(int a_index, const Rect& a_rect)
         {
-            return mNode;
+            assert(a_index >= 0 && a_index < MAXNODES);
+
+            for(int axis=0; axis<NUMDIMS; ++axis)
+            {
+                mMin[axis][a_index] = a_rect.mMin[axis];
+                mMax[axis][a_index] = a_rect.mMax[axis];
+            }
         }
-        
+
         inline
         void
-        setNext(ListNode* pNext)
+        GetBranch(int a_index, Branch& a_branch) const
         {
-            mNext = pNext;
+            GetRect(a_index, a_branch.mRect);
+
+            if(IsLeaf()) a_branch.mData = mData[a_index];
+            else a_branch.mChild = mChild[a_index];
         }
-        
+
         inline
         void
-        setNode(Node* pNode)
+        SetBranch(int a_index, const Branch& a_branch)
         {
-            mNode = pNode;
+            SetRect(a_index, a_branch.mRect);
+
+            if(IsLeaf()) mData[a_index] = a_branch.mData;
+            else mChild[a_index] = a_branch.mChild;
         }
     };
-    
+
     /// Variables for finding a split partition
     class PartitionVars
     {
-        friend class RTree;
-        
     public:
         int mPartition[MAXNODES+1];
         int mTotal;
         int mMinFill;
         int mTaken[MAXNODES+1];
         int mCount[2];
-        Rect** mCover;
+        Rect mCover[2];
         ELEMTYPEREAL mArea[2];
-        
-        Branch** mBranchBuf;
+
+        Branch mBranchBuf[MAXNODES+1];
         int mBranchCount;
         Rect mCoverSplit;
         ELEMTYPEREAL mCoverSplitArea;
-        
-    protected:
-        PartitionVars()
-        : mCoverSplit(0)
-        {
-            assert("illegal contructor");
-        }
-        
-    public:
-        
-        PartitionVars(unsigned int pDim)
-        : mCoverSplit(pDim)
-        {
-            mCover = new Rect*[2];
-            mCover[0] = new Rect(pDim);
-            mCover[1] = new Rect(pDim);
-            
-            mBranchBuf = new Branch*[MAXNODES+1];
-            for(unsigned int i=0; i<MAXNODES+1; ++i) mBranchBuf[i] = new Branch(pDim);
-        }
-        
-        ~PartitionVars()
-        {
-            delete mCover[0];
-            delete mCover[1];
-            delete [] mCover;
-            
-            for(unsigned int i=0; i<MAXNODES+1; ++i) delete mBranchBuf[i];
-            delete [] mBranchBuf;
-        }
-        
-        inline
-        Branch&
-        branch(unsigned int pIndex)
-        {
-            assert(pIndex < MAXNODES+1);
-            
-            return *(mBranchBuf[pIndex]);
-        }
-        
-        inline
-        Rect&
-        cover(unsigned int pIndex)
-        {
-            assert(pIndex < 2);
-            
-            return *(mCover[pIndex]);
-        }
-        
-        inline
-        void
-        setBranch(Branch& pBranch, unsigned int pIndex)
-        {
-            assert(pIndex < MAXNODES+1);
-            
-            Branch* branch = mBranchBuf[pIndex];
-            
-            branch->setRect( pBranch.rect() );
-            branch->setChild( pBranch.child() );
-            branch->setData( pBranch.data() );
-        }
-        
-        inline
-        void
-        setCover(Rect& pRect, unsigned int pIndex)
-        {
-            assert(pIndex < 2);
-            
-            *(mCover[pIndex]) = pRect;
-        }
     };
-    
+
     Node* AllocNode();
     void FreeNode(Node* a_node);
     void InitNode(Node* a_node);
     void InitRect(Rect* a_rect);
-    bool InsertRectRec(Rect* a_rect, const DATATYPE& a_id, Node* a_node, Node** a_newNode, int a_level);
-    bool InsertRect(Rect* a_rect, const DATATYPE& a_id, Node** a_root, int a_level);
+    bool InsertRectRec(const Branch& a_branch, Node* a_node, Node** a_newNode, int a_level);
+    bool InsertRect(const Branch& a_branch, Node** a_root, int a_level);
+    void TileEntries(int* a_order, int a_count, int a_axis, const ELEMTYPE* a_mins, const ELEMTYPE* a_maxs);
     Rect NodeCover(Node* a_node);
-    bool AddBranch(Branch* a_branch, Node* a_node, Node** a_newNode);
+    bool AddBranch(const Branch* a_branch, Node* a_node, Node** a_newNode);
     void DisconnectBranch(Node* a_node, int a_index);
-    int PickBranch(Rect* a_rect, Node* a_node);
-    Rect CombineRect(Rect* a_rectA, Rect* a_rectB);
-    void SplitNode(Node* a_node, Branch* a_branch, Node** a_newNode);
-    ELEMTYPEREAL RectSphericalVolume(Rect* a_rect);
-    ELEMTYPEREAL RectVolume(Rect* a_rect);
-    ELEMTYPEREAL CalcRectVolume(Rect* a_rect);
-    void GetBranches(Node* a_node, Branch* a_branch, PartitionVars* a_parVars);
+    int PickBranch(const Rect* a_rect, Node* a_node);
+    Rect CombineRect(const Rect* a_rectA, const Rect* a_rectB);
+    void SplitNode(Node* a_node, const Branch* a_branch, Node** a_newNode);
+    ELEMTYPEREAL RectSphericalVolume(const Rect* a_rect);
+    ELEMTYPEREAL RectVolume(const Rect* a_rect);
+    ELEMTYPEREAL CalcRectVolume(const Rect* a_rect);
+    void GetBranches(Node* a_node, const Branch* a_branch, PartitionVars* a_parVars);
     void ChoosePartition(PartitionVars* a_parVars, int a_minFill);
     void LoadNodes(Node* a_nodeA, Node* a_nodeB, PartitionVars* a_parVars);
     void InitParVars(PartitionVars* a_parVars, int a_maxRects, int a_minFill);
     void PickSeeds(PartitionVars* a_parVars);
     void Classify(int a_index, int a_group, PartitionVars* a_parVars);
     bool RemoveRect(Rect* a_rect, const DATATYPE& a_id, Node** a_root);
-    bool RemoveRectRec(Rect* a_rect, const DATATYPE& a_id, Node* a_node, ListNode** a_listNode);
-    ListNode* AllocListNode();
-    void FreeListNode(ListNode* a_listNode);
-    bool Overlap(Rect* a_rectA, Rect* a_rectB);
-    void ReInsert(Node* a_node, ListNode** a_listNode);
-    bool Search(Node* a_node, Rect* a_rect, std::vector<DATATYPE>& pSearchResults);
-    void RemoveAllRec(Node* a_node);
+    bool RemoveRectRec(Rect* a_rect, const DATATYPE& a_id, Node* a_node, std::vector<Node*>& a_reInsertList);
+    bool Overlap(const Rect* a_rectA, const Rect* a_rectB);
+    void ReInsert(Node* a_node, std::vector<Node*>& a_reInsertList);
     void Reset();
     void CountRec(Node* a_node, int& a_count);
-    
+
     bool SaveRec(Node* a_node, RTFileStream& a_stream);
     bool LoadRec(Node* a_node, RTFileStream& a_stream);
-    
+
     Node* m_root;                                    ///< Root of tree
     ELEMTYPEREAL m_unitSphereVolume;                 ///< Unit sphere constant for required number of dimensions
+    std::vector<Node*> m_nodeBlocks;                 ///< Blocks of NODEBLOCKSIZE nodes allocated by the node pool
+    std::vector<Node*> m_freeNodes;                  ///< Unused nodes of the node pool
 };
 
 
@@ -645,20 +461,20 @@ protected:
 class RTFileStream
 {
     FILE* m_file;
-    
+
 public:
-    
-    
+
+
     RTFileStream()
     {
         m_file = NULL;
     }
-    
+
     ~RTFileStream()
     {
         Close();
     }
-    
+
     bool OpenRead(const char* a_fileName)
     {
         m_file = fopen(a_fileName, "rb");
@@ -668,7 +484,7 @@ public:
         }
         return true;
     }
-    
+
     bool OpenWrite(const char* a_fileName)
     {
         m_file = fopen(a_fileName, "wb");
@@ -678,7 +494,7 @@ public:
         }
         return true;
     }
-    
+
     void Close()
     {
         if(m_file)
@@ -687,28 +503,28 @@ public:
             m_file = NULL;
         }
     }
-    
+
     template< typename TYPE >
     size_t Write(const TYPE& a_value)
     {
         assert(m_file);
         return fwrite((void*)&a_value, sizeof(a_value), 1, m_file);
     }
-    
+
     template< typename TYPE >
     size_t WriteArray(const TYPE* a_array, int a_count)
     {
         assert(m_file);
         return fwrite((void*)a_array, sizeof(TYPE) * a_count, 1, m_file);
     }
-    
+
     template< typename TYPE >
     size_t Read(TYPE& a_value)
     {
         assert(m_file);
         return fread((void*)&a_value, sizeof(a_value), 1, m_file);
     }
-    
+
     template< typename TYPE >
     size_t ReadArray(TYPE* a_array, int a_count)
     {
@@ -718,18 +534,18 @@ public:
 };
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RTree(unsigned int pDim)
-: mDim(pDim)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RTree()
 {
     assert(MAXNODES > MINNODES);
     assert(MINNODES > 0);
-    
-    
+    assert(NUMDIMS > 0 && NUMDIMS <= 20);
+
+
     // We only support machine word size simple data type eg. integer index or object pointer.
     // Since we are storing as union with non data branch
     assert(sizeof(DATATYPE) == sizeof(void*) || sizeof(DATATYPE) == sizeof(int));
-    
+
     // Precomputed volumes of the unit spheres for the first few dimensions
     const float UNIT_SPHERE_VOLUMES[] = {
         0.000000f, 2.000000f, 3.141593f, // Dimension  0,1,2
@@ -740,155 +556,501 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RTree(unsigned in
         0.381443f, 0.235331f, 0.140981f, // Dimension  15,16,17
         0.082146f, 0.046622f, 0.025807f, // Dimension  18,19,20
     };
-    
+
     m_root = AllocNode();
     m_root->mLevel = 0;
-    m_unitSphereVolume = (ELEMTYPEREAL)UNIT_SPHERE_VOLUMES[mDim];
+    m_unitSphereVolume = (ELEMTYPEREAL)UNIT_SPHERE_VOLUMES[NUMDIMS];
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::~RTree()
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::~RTree()
 {
-    Reset(); // Free, or reset node memory
+    // Release the memory of the node pool
+    for(unsigned int block=0; block<m_nodeBlocks.size(); ++block)
+    {
+        delete [] m_nodeBlocks[block];
+    }
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 void
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Insert(const ELEMTYPE* a_min, const ELEMTYPE* a_max, const DATATYPE& a_dataId)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Insert(const ELEMTYPE* a_min, const ELEMTYPE* a_max, const DATATYPE& a_dataId)
 {
 #ifdef _DEBUG
-    for(int index=0; index<mDim; ++index)
+    for(int index=0; index<NUMDIMS; ++index)
     {
         assert(a_min[index] <= a_max[index]);
     }
 #endif //_DEBUG
-    
-    Rect rect(mDim);
-    
-    for(int axis=0; axis<rect.mDim; ++axis)
+
+    Branch branch;
+    branch.mData = a_dataId;
+
+    for(int axis=0; axis<NUMDIMS; ++axis)
     {
-        rect.mMin[axis] = a_min[axis];
-        rect.mMax[axis] = a_max[axis];
+        branch.mRect.mMin[axis] = a_min[axis];
+        branch.mRect.mMax[axis] = a_max[axis];
+    }
+
+    InsertRect(branch, &m_root, 0);
+}
+
+
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+void
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::BulkLoad(const ELEMTYPE* a_mins, const ELEMTYPE* a_maxs, const DATATYPE* a_dataIds, int a_count)
+{
+    Reset();
+
+    if(a_count <= 0)
+    {
+        m_root = AllocNode();
+        m_root->mLevel = 0;
+        return;
+    }
+
+    // bounding rects and child nodes of the current level, starting with the data entries
+    std::vector<ELEMTYPE> levelMins(a_mins, a_mins + a_count * NUMDIMS);
+    std::vector<ELEMTYPE> levelMaxs(a_maxs, a_maxs + a_count * NUMDIMS);
+    std::vector<Node*> levelNodes;
+    std::vector<int> order;
+    int entryCount = a_count;
+
+    for(int level=0; ; ++level)
+    {
+        order.resize(entryCount);
+        for(int index=0; index<entryCount; ++index) order[index] = index;
+
+        // sort entries so that consecutive runs of MAXNODES entries form compact tiles
+        TileEntries(order.data(), entryCount, 0, levelMins.data(), levelMaxs.data());
+
+        int nodeCount = (entryCount + MAXNODES - 1) / MAXNODES;
+        std::vector<ELEMTYPE> nodeMins(nodeCount * NUMDIMS);
+        std::vector<ELEMTYPE> nodeMaxs(nodeCount * NUMDIMS);
+        std::vector<Node*> nodes(nodeCount);
+
+        for(int nodeIndex=0; nodeIndex<nodeCount; ++nodeIndex)
+        {
+            Node* node = AllocNode();
+            node->mLevel = level;
+            node->mCount = std::min<int>(MAXNODES, entryCount - nodeIndex * MAXNODES);
+
+            ELEMTYPE* coverMin = nodeMins.data() + nodeIndex * NUMDIMS;
+            ELEMTYPE* coverMax = nodeMaxs.data() + nodeIndex * NUMDIMS;
+
+            for(int index=0; index<node->mCount; ++index)
+            {
+                int entry = order[nodeIndex * MAXNODES + index];
+                const ELEMTYPE* entryMin = levelMins.data() + entry * NUMDIMS;
+                const ELEMTYPE* entryMax = levelMaxs.data() + entry * NUMDIMS;
+
+                for(int axis=0; axis<NUMDIMS; ++axis)
+                {
+                    node->mMin[axis][index] = entryMin[axis];
+                    node->mMax[axis][index] = entryMax[axis];
+                    coverMin[axis] = (index == 0) ? entryMin[axis] : std::min(coverMin[axis], entryMin[axis]);
+                    coverMax[axis] = (index == 0) ? entryMax[axis] : std::max(coverMax[axis], entryMax[axis]);
+                }
+
+                if(level == 0) node->mData[index] = a_dataIds[entry];
+                else node->mChild[index] = levelNodes[entry];
+            }
+
+            nodes[nodeIndex] = node;
+        }
+
+        if(nodeCount == 1)
+        {
+            m_root = nodes[0];
+            return;
+        }
+
+        levelMins.swap(nodeMins);
+        levelMaxs.swap(nodeMaxs);
+        levelNodes.swap(nodes);
+        entryCount = nodeCount;
+    }
+}
+
+
+// Sort entries by the center of their rects along an axis, cut them into slabs
+// and recursively sort each slab along the next axis (Sort-Tile-Recursive).
+// Slabs hold a multiple of MAXNODES entries so that nodes don't straddle slabs.
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+void
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::TileEntries(int* a_order, int a_count, int a_axis, const ELEMTYPE* a_mins, const ELEMTYPE* a_maxs)
+{
+    std::sort(a_order, a_order + a_count, [a_mins, a_maxs, a_axis](int a_entryA, int a_entryB)
+    {
+        return a_mins[a_entryA * NUMDIMS + a_axis] + a_maxs[a_entryA * NUMDIMS + a_axis] < a_mins[a_entryB * NUMDIMS + a_axis] + a_maxs[a_entryB * NUMDIMS + a_axis];
+    });
+
+    int remainingAxes = NUMDIMS - a_axis;
+    if(remainingAxes <= 1) return;
+
+    // smallest slab count whose power of the remaining axes covers all nodes
+    int nodeCount = (a_count + MAXNODES - 1) / MAXNODES;
+    int slabCount = 1;
+
+    for(;;)
+    {
+        long long tileCount = 1;
+        for(int axis=0; axis<remainingAxes && tileCount < nodeCount; ++axis) tileCount *= slabCount;
+        if(tileCount >= nodeCount) break;
+        ++slabCount;
+    }
+
+    int slabSize = MAXNODES * ((nodeCount + slabCount - 1) / slabCount);
+
+    for(int slabStart=0; slabStart<a_count; slabStart+=slabSize)
+    {
+        TileEntries(a_order + slabStart, std::min<int>(slabSize, a_count - slabStart), a_axis + 1, a_mins, a_maxs);
     }
-    
-    InsertRect(&rect, a_dataId, &m_root, 0);
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 void
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Remove(const ELEMTYPE* a_min, const ELEMTYPE* a_max, const DATATYPE& a_dataId)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Remove(const ELEMTYPE* a_min, const ELEMTYPE* a_max, const DATATYPE& a_dataId)
 {
 #ifdef _DEBUG
-    for(int index=0; index<mDim; ++index)
+    for(int index=0; index<NUMDIMS; ++index)
     {
         assert(a_min[index] <= a_max[index]);
     }
 #endif //_DEBUG
-    
-    Rect rect(mDim);
-    
-    for(int axis=0; axis<rect.mDim; ++axis)
+
+    Rect rect;
+
+    for(int axis=0; axis<NUMDIMS; ++axis)
     {
         rect.mMin[axis] = a_min[axis];
         rect.mMax[axis] = a_max[axis];
     }
-    
+
     RemoveRect(&rect, a_dataId, &m_root);
 }
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+
+// Iterative depth first search with a fixed size stack of pending nodes.
+// The branches of a node are tested axis by axis over the per axis arrays of the node,
+// which the compiler turns into a few vector compares. All MAXNODES slots are tested
+// so that the loops have a constant trip count, slots beyond the node count are ignored afterwards.
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 void
-    RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Search(const ELEMTYPE* a_min, const ELEMTYPE* a_max, std::vector<DATATYPE>& pSearchResults)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Search(const ELEMTYPE* a_min, const ELEMTYPE* a_max, std::vector<DATATYPE>& pSearchResults) const
 {
 #ifdef _DEBUG
-    for(int index=0; index<mDim; ++index)
+    for(int index=0; index<NUMDIMS; ++index)
     {
         assert(a_min[index] <= a_max[index]);
     }
 #endif //_DEBUG
-    
+
     pSearchResults.clear();
-    
-    Rect rect(mDim);
-    
-    for(int axis=0; axis<rect.mDim; ++axis)
+
+    // NOTE: May want to return search result another way, perhaps returning the number of found elements here.
+
+    const Node* stack[MAXSTACK];
+    int stackSize = 0;
+    unsigned char overlap[MAXNODES];
+
+    stack[stackSize++] = m_root;
+
+    while(stackSize > 0)
     {
-        rect.mMin[axis] = a_min[axis];
-        rect.mMax[axis] = a_max[axis];
+        const Node* node = stack[--stackSize];
+
+        assert(node->mLevel >= 0);
+
+        for(int index=0; index<MAXNODES; ++index) overlap[index] = 1;
+
+        for(int axis=0; axis<NUMDIMS; ++axis)
+        {
+            const ELEMTYPE searchMin = a_min[axis];
+            const ELEMTYPE searchMax = a_max[axis];
+            const ELEMTYPE* mins = node->mMin[axis];
+            const ELEMTYPE* maxs = node->mMax[axis];
+
+            for(int index=0; index<MAXNODES; ++index)
+            {
+                overlap[index] &= (unsigned char)( (mins[index] <= searchMax) & (maxs[index] >= searchMin) );
+            }
+        }
+
+        int count = node->mCount;
+
+        if(node->IsInternalNode()) // This is an internal node in the tree
+        {
+            // push in reverse order so that branches are visited in order
+            for(int index=count-1; index >= 0; --index)
+            {
+                if(overlap[index] == 0) continue;
+
+                assert(stackSize < MAXSTACK);
+                stack[stackSize++] = node->mChild[index];
+            }
+        }
+        else // This is a leaf node
+        {
+            for(int index=0; index < count; ++index)
+            {
+                if(overlap[index] == 0) continue;
+
+                pSearchResults.push_back(node->mData[index]);
+            }
+        }
     }
-    
-    // NOTE: May want to return search result another way, perhaps returning the number of found elements here.
-    
-    Search(m_root, &rect, pSearchResults);
 }
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+// The distances from the query point to all branch rects of a node are accumulated axis by axis
+// over the per axis arrays of the node, like the overlap tests of Search.
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DISTANCE>
+void
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::NearestSearch(const ELEMTYPE* a_point, int a_k, DISTANCE& a_distance, std::vector<NearestEntry>& a_queue, std::vector< std::pair<ELEMTYPEREAL, DATATYPE> >& a_results) const
+{
+    a_results.clear();
+    a_queue.clear();
+
+    if(a_k <= 0) return;
+
+    const ELEMTYPEREAL skipDistance = std::numeric_limits<ELEMTYPEREAL>::max();
+    ELEMTYPEREAL squaredDistances[MAXNODES];
+    ELEMTYPE rectMin[NUMDIMS];
+    ELEMTYPE rectMax[NUMDIMS];
+
+    NearestEntry entry = { 0, m_root, -1, false };
+    a_queue.push_back(entry);
+
+    while(a_queue.empty() == false)
+    {
+        std::pop_heap(a_queue.begin(), a_queue.end());
+        entry = a_queue.back();
+        a_queue.pop_back();
+
+        const Node* node = entry.mNode;
+
+        if(entry.mExact == true) // No remaining entry can be closer
+        {
+            a_results.push_back( std::make_pair(entry.mDistance, node->mData[entry.mIndex]) );
+
+            if((int)a_results.size() == a_k) break;
+        }
+        else if(entry.mIndex >= 0) // Replace bound of entry by its exact distance
+        {
+            for(int axis=0; axis<NUMDIMS; ++axis)
+            {
+                rectMin[axis] = node->mMin[axis][entry.mIndex];
+                rectMax[axis] = node->mMax[axis][entry.mIndex];
+            }
+
+            entry.mDistance = a_distance(node->mData[entry.mIndex], rectMin, rectMax);
+
+            if(entry.mDistance == skipDistance) continue;
+
+            entry.mExact = true;
+            a_queue.push_back(entry);
+            std::push_heap(a_queue.begin(), a_queue.end());
+        }
+        else // Queue branches of node with the distance to their rects
+        {
+            for(int index=0; index<MAXNODES; ++index) squaredDistances[index] = 0;
+
+            for(int axis=0; axis<NUMDIMS; ++axis)
+            {
+                const ELEMTYPE point = a_point[axis];
+                const ELEMTYPE* mins = node->mMin[axis];
+                const ELEMTYPE* maxs = node->mMax[axis];
+
+                for(int index=0; index<MAXNODES; ++index)
+                {
+                    ELEMTYPEREAL delta = (ELEMTYPEREAL)( std::max<ELEMTYPE>(mins[index] - point, 0) + std::max<ELEMTYPE>(point - maxs[index], 0) );
+                    squaredDistances[index] += delta * delta;
+                }
+            }
+
+            bool leaf = node->IsLeaf();
+            int count = node->mCount;
+
+            for(int index=0; index<count; ++index)
+            {
+                NearestEntry branchEntry = { (ELEMTYPEREAL)sqrt(squaredDistances[index]), leaf ? node : node->mChild[index], leaf ? index : -1, false };
+                a_queue.push_back(branchEntry);
+                std::push_heap(a_queue.begin(), a_queue.end());
+            }
+        }
+    }
+}
+
+// Slab test of all branch rects of a node, axis by axis over the per axis arrays of the node.
+// Axes the ray runs parallel to are tested by the position of the origin, since their slab distances are infinite.
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class HIT>
+bool
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RaySearch(const ELEMTYPE* a_origin, const ELEMTYPE* a_direction, ELEMTYPEREAL a_maxDistance, bool a_anyHit, HIT& a_hit, std::vector<NearestEntry>& a_queue, std::pair<ELEMTYPEREAL, DATATYPE>& a_result) const
+{
+    a_queue.clear();
+
+    const ELEMTYPEREAL missDistance = std::numeric_limits<ELEMTYPEREAL>::max();
+    ELEMTYPEREAL inverseDirection[NUMDIMS];
+    ELEMTYPEREAL nearDistances[MAXNODES];
+    ELEMTYPEREAL farDistances[MAXNODES];
+
+    for(int axis=0; axis<NUMDIMS; ++axis) inverseDirection[axis] = a_direction[axis] != 0 ? (ELEMTYPEREAL)1 / (ELEMTYPEREAL)a_direction[axis] : 0;
+
+    NearestEntry entry = { 0, m_root, -1, false };
+    a_queue.push_back(entry);
+
+    while(a_queue.empty() == false)
+    {
+        std::pop_heap(a_queue.begin(), a_queue.end());
+        entry = a_queue.back();
+        a_queue.pop_back();
+
+        const Node* node = entry.mNode;
+
+        if(entry.mExact == true) // No remaining entry can be hit earlier
+        {
+            a_result = std::make_pair(entry.mDistance, node->mData[entry.mIndex]);
+
+            return true;
+        }
+        else if(entry.mIndex >= 0) // Replace entry distance of rect by exact hit distance
+        {
+            entry.mDistance = a_hit(node->mData[entry.mIndex], entry.mDistance);
+
+            if(entry.mDistance == missDistance || entry.mDistance > a_maxDistance) continue;
+
+            if(a_anyHit == true)
+            {
+                a_result = std::make_pair(entry.mDistance, node->mData[entry.mIndex]);
+
+                return true;
+            }
+
+            entry.mExact = true;
+            a_queue.push_back(entry);
+            std::push_heap(a_queue.begin(), a_queue.end());
+        }
+        else // Queue branches of node that are hit with their entry distances
+        {
+            for(int index=0; index<MAXNODES; ++index)
+            {
+                nearDistances[index] = 0;
+                farDistances[index] = a_maxDistance;
+            }
+
+            for(int axis=0; axis<NUMDIMS; ++axis)
+            {
+                const ELEMTYPEREAL origin = a_origin[axis];
+                const ELEMTYPEREAL inverse = inverseDirection[axis];
+                const ELEMTYPE* mins = node->mMin[axis];
+                const ELEMTYPE* maxs = node->mMax[axis];
+
+                if(a_direction[axis] == 0)
+                {
+                    for(int index=0; index<MAXNODES; ++index)
+                    {
+                        if(origin < (ELEMTYPEREAL)mins[index] || origin > (ELEMTYPEREAL)maxs[index]) farDistances[index] = -1;
+                    }
+
+                    continue;
+                }
+
+                for(int index=0; index<MAXNODES; ++index)
+                {
+                    ELEMTYPEREAL distance1 = ((ELEMTYPEREAL)mins[index] - origin) * inverse;
+                    ELEMTYPEREAL distance2 = ((ELEMTYPEREAL)maxs[index] - origin) * inverse;
+
+                    nearDistances[index] = std::max(nearDistances[index], std::min(distance1, distance2));
+                    farDistances[index] = std::min(farDistances[index], std::max(distance1, distance2));
+                }
+            }
+
+            bool leaf = node->IsLeaf();
+            int count = node->mCount;
+
+            for(int index=0; index<count; ++index)
+            {
+                if(nearDistances[index] > farDistances[index]) continue;
+
+                NearestEntry branchEntry = { nearDistances[index], leaf ? node : node->mChild[index], leaf ? index : -1, false };
+                a_queue.push_back(branchEntry);
+                std::push_heap(a_queue.begin(), a_queue.end());
+            }
+        }
+    }
+
+    return false;
+}
+
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 int
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Count()
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Count()
 {
     int count = 0;
     CountRec(m_root, count);
-    
+
     return count;
 }
 
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 void
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::CountRec(Node* a_node, int& a_count)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::CountRec(Node* a_node, int& a_count)
 {
     if(a_node->IsInternalNode())  // not a leaf node
     {
-        for(int index = 0; index < a_node->m_count; ++index)
+        for(int index = 0; index < a_node->mCount; ++index)
         {
-            CountRec(a_node->m_branch[index].m_child, a_count);
+            CountRec(a_node->mChild[index], a_count);
         }
     }
     else // A leaf node
     {
-        a_count += a_node->m_count;
+        a_count += a_node->mCount;
     }
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 bool
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Load(const char* a_fileName)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Load(const char* a_fileName)
 {
     RemoveAll(); // Clear existing tree
-    
+
     RTFileStream stream;
     if(!stream.OpenRead(a_fileName))
     {
         return false;
     }
-    
+
     bool result = Load(stream);
-    
+
     stream.Close();
-    
+
     return result;
 };
 
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 bool
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Load(RTFileStream& a_stream)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Load(RTFileStream& a_stream)
 {
     // Write some kind of header
     int _dataFileId = ('R'<<0)|('T'<<8)|('R'<<16)|('E'<<24);
     int _dataSize = sizeof(DATATYPE);
-    int _dataNumDims = mDim;
+    int _dataNumDims = NUMDIMS;
     int _dataElemSize = sizeof(ELEMTYPE);
     int _dataElemRealSize = sizeof(ELEMTYPEREAL);
     int _dataMaxNodes = TMAXNODES;
     int _dataMinNodes = TMINNODES;
-    
+
     int dataFileId = 0;
     int dataSize = 0;
     int dataNumDims = 0;
@@ -896,7 +1058,7 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Load(RTFileStream
     int dataElemRealSize = 0;
     int dataMaxNodes = 0;
     int dataMinNodes = 0;
-    
+
     a_stream.Read(dataFileId);
     a_stream.Read(dataSize);
     a_stream.Read(dataNumDims);
@@ -904,9 +1066,9 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Load(RTFileStream
     a_stream.Read(dataElemRealSize);
     a_stream.Read(dataMaxNodes);
     a_stream.Read(dataMinNodes);
-    
+
     bool result = false;
-    
+
     // Test if header was valid and compatible
     if(    (dataFileId == _dataFileId)
        && (dataSize == _dataSize)
@@ -920,79 +1082,72 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Load(RTFileStream
         // Recursively load tree
         result = LoadRec(m_root, a_stream);
     }
-    
+
     return result;
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 bool
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::LoadRec(Node* a_node, RTFileStream& a_stream)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::LoadRec(Node* a_node, RTFileStream& a_stream)
 {
-    a_stream.Read(a_node->m_level);
-    a_stream.Read(a_node->m_count);
-    
-    if(a_node->IsInternalNode())  // not a leaf node
+    a_stream.Read(a_node->mLevel);
+    a_stream.Read(a_node->mCount);
+
+    Rect rect;
+
+    for(int index = 0; index < a_node->mCount; ++index)
     {
-        for(int index = 0; index < a_node->m_count; ++index)
+        a_stream.ReadArray(rect.mMin, NUMDIMS);
+        a_stream.ReadArray(rect.mMax, NUMDIMS);
+        a_node->SetRect(index, rect);
+
+        if(a_node->IsInternalNode())  // not a leaf node
         {
-            Branch* curBranch = &a_node->m_branch[index];
-            
-            a_stream.ReadArray(curBranch->m_rect.mMin, mDim);
-            a_stream.ReadArray(curBranch->m_rect.mMax, mDim);
-            
-            curBranch->m_child = AllocNode();
-            LoadRec(curBranch->m_child, a_stream);
+            a_node->mChild[index] = AllocNode();
+            LoadRec(a_node->mChild[index], a_stream);
         }
-    }
-    else // A leaf node
-    {
-        for(int index = 0; index < a_node->m_count; ++index)
+        else // A leaf node
         {
-            Branch* curBranch = &a_node->m_branch[index];
-            
-            a_stream.ReadArray(curBranch->m_rect.mMin, mDim);
-            a_stream.ReadArray(curBranch->m_rect.mMax, mDim);
-            
-            a_stream.Read(curBranch->m_data);
+            a_stream.Read(a_node->mData[index]);
         }
     }
-    
+
     return true; // Should do more error checking on I/O operations
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 bool
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Save(const char* a_fileName)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Save(const char* a_fileName)
 {
     RTFileStream stream;
     if(!stream.OpenWrite(a_fileName))
     {
         return false;
     }
-    
+
     bool result = Save(stream);
-    
+
     stream.Close();
-    
+
     return result;
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 bool
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Save(RTFileStream& a_stream)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Save(RTFileStream& a_stream)
 {
     // Write some kind of header
     int dataFileId = ('R'<<0)|('T'<<8)|('R'<<16)|('E'<<24);
     int dataSize = sizeof(DATATYPE);
-    int dataNumDims = mDim;
+    int dataNumDims = NUMDIMS;
     int dataElemSize = sizeof(ELEMTYPE);
     int dataElemRealSize = sizeof(ELEMTYPEREAL);
     int dataMaxNodes = TMAXNODES;
     int dataMinNodes = TMINNODES;
-    
+
     a_stream.Write(dataFileId);
     a_stream.Write(dataSize);
     a_stream.Write(dataNumDims);
@@ -1000,163 +1155,123 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Save(RTFileStream
     a_stream.Write(dataElemRealSize);
     a_stream.Write(dataMaxNodes);
     a_stream.Write(dataMinNodes);
-    
+
     // Recursively save tree
     bool result = SaveRec(m_root, a_stream);
-    
+
     return result;
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 bool
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::SaveRec(Node* a_node, RTFileStream& a_stream)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::SaveRec(Node* a_node, RTFileStream& a_stream)
 {
-    a_stream.Write(a_node->m_level);
-    a_stream.Write(a_node->m_count);
-    
-    if(a_node->IsInternalNode())  // not a leaf node
+    a_stream.Write(a_node->mLevel);
+    a_stream.Write(a_node->mCount);
+
+    Rect rect;
+
+    for(int index = 0; index < a_node->mCount; ++index)
     {
-        for(int index = 0; index < a_node->m_count; ++index)
+        a_node->GetRect(index, rect);
+        a_stream.WriteArray(rect.mMin, NUMDIMS);
+        a_stream.WriteArray(rect.mMax, NUMDIMS);
+
+        if(a_node->IsInternalNode())  // not a leaf node
         {
-            Branch* curBranch = &a_node->m_branch[index];
-            
-            a_stream.WriteArray(curBranch->m_rect.mMin, mDim);
-            a_stream.WriteArray(curBranch->m_rect.mMax, mDim);
-            
-            SaveRec(curBranch->m_child, a_stream);
+            SaveRec(a_node->mChild[index], a_stream);
         }
-    }
-    else // A leaf node
-    {
-        for(int index = 0; index < a_node->m_count; ++index)
+        else // A leaf node
         {
-            Branch* curBranch = &a_node->m_branch[index];
-            
-            a_stream.WriteArray(curBranch->m_rect.mMin, mDim);
-            a_stream.WriteArray(curBranch->m_rect.mMax, mDim);
-            
-            a_stream.Write(curBranch->m_data);
+            a_stream.Write(a_node->mData[index]);
         }
     }
-    
+
     return true; // Should do more error checking on I/O operations
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 void
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RemoveAll()
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RemoveAll()
 {
     // Delete all existing nodes
     Reset();
-    
+
     m_root = AllocNode();
     m_root->mLevel = 0;
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+// Return all nodes to the node pool at once instead of walking the tree.
+// Nodes are handed out again in address order, which keeps the nodes of a rebuilt tree close together.
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 void
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Reset()
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Reset()
 {
-#ifdef RTREE_DONT_USE_MEMPOOLS
-    // Delete all existing nodes
-    RemoveAllRec(m_root);
-#else // RTREE_DONT_USE_MEMPOOLS
-    // Just reset memory pools.  We are not using complex types
-    // EXAMPLE
-#endif // RTREE_DONT_USE_MEMPOOLS
+    m_freeNodes.clear();
+
+    for(int block = (int)m_nodeBlocks.size() - 1; block >= 0; --block)
+    {
+        for(int index = NODEBLOCKSIZE - 1; index >= 0; --index)
+        {
+            m_freeNodes.push_back(m_nodeBlocks[block] + index);
+        }
+    }
+
+    m_root = NULL;
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-void
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RemoveAllRec(Node* a_node)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+typename RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Node*
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::AllocNode()
 {
-    assert(a_node);
-    assert(a_node->mLevel >= 0);
-    
-    if(a_node->IsInternalNode()) // This is an internal node in the tree
+    if(m_freeNodes.empty())
     {
-        for(int index=0; index < a_node->mCount; ++index)
+        // value initialization zeroes the branch arrays, so that searches never test uninitialized slots
+        Node* block = new Node[NODEBLOCKSIZE]();
+        m_nodeBlocks.push_back(block);
+
+        for(int index = NODEBLOCKSIZE - 1; index >= 0; --index)
         {
-            RemoveAllRec(a_node->mBranch[index]->mChild);
+            m_freeNodes.push_back(block + index);
         }
     }
-    FreeNode(a_node);
-}
 
+    Node* newNode = m_freeNodes.back();
+    m_freeNodes.pop_back();
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-typename RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Node*
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::AllocNode()
-{
-    Node* newNode;
-#ifdef RTREE_DONT_USE_MEMPOOLS
-    newNode = new Node(mDim);
-#else // RTREE_DONT_USE_MEMPOOLS
-    // EXAMPLE
-#endif // RTREE_DONT_USE_MEMPOOLS
     InitNode(newNode);
     return newNode;
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 void
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::FreeNode(Node* a_node)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::FreeNode(Node* a_node)
 {
     assert(a_node);
-    
-#ifdef RTREE_DONT_USE_MEMPOOLS
-    delete a_node;
-#else // RTREE_DONT_USE_MEMPOOLS
-    // EXAMPLE
-#endif // RTREE_DONT_USE_MEMPOOLS
-}
 
-
-// Allocate space for a node in the list used in DeletRect to
-// store Nodes that are too empty.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-typename RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::ListNode*
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::AllocListNode()
-{
-#ifdef RTREE_DONT_USE_MEMPOOLS
-    return new ListNode(NULL, NULL);
-#else // RTREE_DONT_USE_MEMPOOLS
-    // EXAMPLE
-#endif // RTREE_DONT_USE_MEMPOOLS
-}
-
-
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-void
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::FreeListNode(ListNode* a_listNode)
-{
-#ifdef RTREE_DONT_USE_MEMPOOLS
-    delete a_listNode;
-#else // RTREE_DONT_USE_MEMPOOLS
-    // EXAMPLE
-#endif // RTREE_DONT_USE_MEMPOOLS
+    m_freeNodes.push_back(a_node);
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 void
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InitNode(Node* a_node)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InitNode(Node* a_node)
 {
     a_node->mCount = 0;
     a_node->mLevel = -1;
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 void
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InitRect(Rect* a_rect)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InitRect(Rect* a_rect)
 {
-    for(int index = 0; index < a_rect->mDim; ++index)
+    for(int index = 0; index < NUMDIMS; ++index)
     {
         a_rect->mMin[index] = (ELEMTYPE)0;
         a_rect->mMax[index] = (ELEMTYPE)0;
@@ -1171,41 +1286,40 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InitRect(Rect* a_
 // new_node to point to the new node.  Old node updated to become one of two.
 // The level argument specifies the number of steps up from the leaf
 // level to insert; e.g. a data rectangle goes in at level = 0.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 bool
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InsertRectRec(Rect* a_rect, const DATATYPE& a_id, Node* a_node, Node** a_newNode, int a_level)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InsertRectRec(const Branch& a_branch, Node* a_node, Node** a_newNode, int a_level)
 {
-    assert(a_rect && a_node && a_newNode);
+    assert(a_node && a_newNode);
     assert(a_level >= 0 && a_level <= a_node->mLevel);
-    
+
     int index;
-    Branch branch(mDim);
+    Branch branch;
+    Rect rect;
     Node* otherNode;
-    
+
     // Still above level for insertion, go down tree recursively
     if(a_node->mLevel > a_level)
     {
-        index = PickBranch(a_rect, a_node);
-        if (!InsertRectRec(a_rect, a_id, a_node->mBranch[index]->mChild, &otherNode, a_level))
+        index = PickBranch(&a_branch.mRect, a_node);
+        if (!InsertRectRec(a_branch, a_node->mChild[index], &otherNode, a_level))
         {
             // Child was not split
-            a_node->mBranch[index]->mRect = CombineRect( a_rect, &(a_node->mBranch[index]->mRect) );
+            a_node->GetRect(index, rect);
+            a_node->SetRect(index, CombineRect(&a_branch.mRect, &rect));
             return false;
         }
         else // Child was split
         {
-            a_node->mBranch[index]->mRect = NodeCover(a_node->mBranch[index]->mChild);
+            a_node->SetRect(index, NodeCover(a_node->mChild[index]));
             branch.mChild = otherNode;
             branch.mRect = NodeCover(otherNode);
             return AddBranch(&branch, a_node, a_newNode);
         }
     }
-    else if(a_node->level() == a_level) // Have reached level for insertion. Add rect, split if necessary
+    else if(a_node->mLevel == a_level) // Have reached level for insertion. Add rect, split if necessary
     {
-        branch.mRect = *a_rect;
-        branch.mChild = (Node*) a_id;
-        // Child field of leaves contains id of data record
-        return AddBranch(&branch, a_node, a_newNode);
+        return AddBranch(&a_branch, a_node, a_newNode);
     }
     else
     {
@@ -1223,18 +1337,18 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InsertRectRec(Rec
 // level to insert; e.g. a data rectangle goes in at level = 0.
 // InsertRect2 does the recursion.
 //
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 bool
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InsertRect(Rect* a_rect, const DATATYPE& a_id, Node** a_root, int a_level)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InsertRect(const Branch& a_branch, Node** a_root, int a_level)
 {
-    assert(a_rect && a_root);
-    assert(a_level >= 0 && a_level <= (*a_root)->level());
-    
+    assert(a_root);
+    assert(a_level >= 0 && a_level <= (*a_root)->mLevel);
+
     Node* newRoot;
     Node* newNode;
-    Branch branch(mDim);
-    
-    if(InsertRectRec(a_rect, a_id, *a_root, &newNode, a_level))  // Root split
+    Branch branch;
+
+    if(InsertRectRec(a_branch, *a_root, &newNode, a_level))  // Root split
     {
         newRoot = AllocNode();  // Grow tree taller and new root
         newRoot->mLevel = (*a_root)->mLevel + 1;
@@ -1247,35 +1361,40 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InsertRect(Rect*
         *a_root = newRoot;
         return true;
     }
-    
+
     return false;
 }
 
 
 // Find the smallest rectangle that includes all rectangles in branches of a node.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-typename RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Rect
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::NodeCover(Node* a_node)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+typename RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Rect
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::NodeCover(Node* a_node)
 {
     assert(a_node);
-    
-    int firstTime = true;
-    Rect rect(mDim);
+
+    Rect rect;
     InitRect(&rect);
-    
-    for(int index = 0; index < a_node->mCount; ++index)
+
+    if(a_node->mCount == 0) return rect;
+
+    for(int axis = 0; axis < NUMDIMS; ++axis)
     {
-        if(firstTime)
-        {
-            rect = a_node->mBranch[index]->mRect;
-            firstTime = false;
-        }
-        else
+        const ELEMTYPE* mins = a_node->mMin[axis];
+        const ELEMTYPE* maxs = a_node->mMax[axis];
+        ELEMTYPE coverMin = mins[0];
+        ELEMTYPE coverMax = maxs[0];
+
+        for(int index = 1; index < a_node->mCount; ++index)
         {
-            rect = CombineRect(&rect, &(a_node->mBranch[index]->mRect));
+            coverMin = std::min(coverMin, mins[index]);
+            coverMax = std::max(coverMax, maxs[index]);
         }
+
+        rect.mMin[axis] = coverMin;
+        rect.mMax[axis] = coverMax;
     }
-    
+
     return rect;
 }
 
@@ -1284,24 +1403,24 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::NodeCover(Node* a
 // Returns 0 if node not split.  Old node updated.
 // Returns 1 if node split, sets *new_node to address of new node.
 // Old node updated, becomes one of two.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 bool
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::AddBranch(Branch* a_branch, Node* a_node, Node** a_newNode)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::AddBranch(const Branch* a_branch, Node* a_node, Node** a_newNode)
 {
     assert(a_branch);
     assert(a_node);
-    
-    if(a_node->count() < MAXNODES)  // Split won't be necessary
+
+    if(a_node->mCount < MAXNODES)  // Split won't be necessary
     {
-        *(a_node->mBranch[a_node->mCount]) = *a_branch;
+        a_node->SetBranch(a_node->mCount, *a_branch);
         ++a_node->mCount;
-        
+
         return false;
     }
     else
     {
         assert(a_newNode);
-        
+
         SplitNode(a_node, a_branch, a_newNode);
         return true;
     }
@@ -1310,16 +1429,18 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::AddBranch(Branch*
 
 // Disconnect a dependent node.
 // Caller must return (or stop using iteration index) after this as count has changed
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 void
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::DisconnectBranch(Node* a_node, int a_index)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::DisconnectBranch(Node* a_node, int a_index)
 {
     assert(a_node && (a_index >= 0) && (a_index < MAXNODES));
     assert(a_node->mCount > 0);
-    
+
     // Remove element by swapping with the last element to prevent gaps in array
-    *(a_node->mBranch[a_index]) = *(a_node->mBranch[a_node->mCount - 1]);
-    
+    Branch lastBranch;
+    a_node->GetBranch(a_node->mCount - 1, lastBranch);
+    a_node->SetBranch(a_index, lastBranch);
+
     --a_node->mCount;
 }
 
@@ -1329,25 +1450,26 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::DisconnectBranch(
 // least total area for the covering rectangles in the current node.
 // In case of a tie, pick the one which was smaller before, to get
 // the best resolution when searching.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
 int
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::PickBranch(Rect* a_rect, Node* a_node)
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::PickBranch(const Rect* a_rect, Node* a_node)
 {
     assert(a_rect && a_node);
-    
+
     bool firstTime = true;
     ELEMTYPEREAL increase;
     ELEMTYPEREAL bestIncr = (ELEMTYPEREAL)-1;
     ELEMTYPEREAL area;
     ELEMTYPEREAL bestArea;
     int best;
-    Rect tempRect(mDim);
-    
-    for(int index=0; index < a_node->count(); ++index)
+    Rect curRect;
+    Rect tempRect;
+
+    for(int index=0; index < a_node->mCount; ++index)
     {
-        Rect* curRect = &( a_node->mBranch[index]->mRect );
-        area = CalcRectVolume(curRect);
-        tempRect = CombineRect(a_rect, curRect);
+        a_node->GetRect(index, curRect);
+        area = CalcRectVolume(&curRect);
+        tempRect = CombineRect(a_rect, &curRect);
         increase = CalcRectVolume(&tempRect) - area;
         if((increase < bestIncr) || firstTime)
         {
@@ -1368,20 +1490,20 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::PickBranch(Rect*
 
 
 // Combine two rectangles into larger one containing both
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-typename RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Rect
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::CombineRect(Rect* a_rectA, Rect* a_rectB)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+typename RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Rect
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::CombineRect(const Rect* a_rectA, const Rect* a_rectB)
 {
     assert(a_rectA && a_rectB);
-    
-    Rect newRect(mDim);
-    
-    for(int index = 0; index < newRect.mDim; ++index)
+
+    Rect newRect;
+
+    for(int index = 0; index < NUMDIMS; ++index)
     {
         newRect.mMin[index] = std::min(a_rectA->mMin[index], a_rectB->mMin[index]);
         newRect.mMax[index] = std::max(a_rectA->mMax[index], a_rectB->mMax[index]);
     }
-    
+
     return newRect;
 }
 
@@ -1391,128 +1513,128 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::CombineRect(Rect*
 // Divides the nodes branches and the extra one between two nodes.
 // Old node is one of the new ones, and one really new one is created.
 // Tries more than one method for choosing a partition, uses best result.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-void 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::SplitNode(Node* a_node, Branch* a_branch, Node** a_newNode)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+void
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::SplitNode(Node* a_node, const Branch* a_branch, Node** a_newNode)
 {
     assert(a_node);
     assert(a_branch);
-    
+
     // Could just use local here, but member or external is faster since it is reused
-    PartitionVars localVars(mDim);
+    PartitionVars localVars;
     PartitionVars* parVars = &localVars;
     int level;
-    
+
     // Load all the branches into a buffer, initialize old node
     level = a_node->mLevel;
     GetBranches(a_node, a_branch, parVars);
-    
+
     // Find partition
     ChoosePartition(parVars, MINNODES);
-    
+
     // Put branches from buffer into 2 nodes according to chosen partition
     *a_newNode = AllocNode();
     (*a_newNode)->mLevel = a_node->mLevel = level;
     LoadNodes(a_node, *a_newNode, parVars);
-    
+
     assert((a_node->mCount + (*a_newNode)->mCount) == parVars->mTotal);
 }
 
 
 // Calculate the n-dimensional volume of a rectangle
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-ELEMTYPEREAL 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RectVolume(Rect* a_rect)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+ELEMTYPEREAL
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RectVolume(const Rect* a_rect)
 {
     assert(a_rect);
-    
+
     ELEMTYPEREAL volume = (ELEMTYPEREAL)1;
-    
-    for(int index=0; index<a_rect->mDIm; ++index)
+
+    for(int index=0; index<NUMDIMS; ++index)
     {
         volume *= a_rect->mMax[index] - a_rect->mMin[index];
     }
-    
+
     assert(volume >= (ELEMTYPEREAL)0);
-    
+
     return volume;
 }
 
 
 // The exact volume of the bounding sphere for the given Rect
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-ELEMTYPEREAL 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RectSphericalVolume(Rect* a_rect)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+ELEMTYPEREAL
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RectSphericalVolume(const Rect* a_rect)
 {
     assert(a_rect);
-    
+
     ELEMTYPEREAL sumOfSquares = (ELEMTYPEREAL)0;
     ELEMTYPEREAL radius;
-    
-    for(int index=0; index < mDim; ++index) 
+
+    for(int index=0; index < NUMDIMS; ++index)
     {
         ELEMTYPEREAL halfExtent = ((ELEMTYPEREAL)a_rect->mMax[index] - (ELEMTYPEREAL)a_rect->mMin[index]) * 0.5f;
         sumOfSquares += halfExtent * halfExtent;
     }
-    
-    
+
+
     radius = (ELEMTYPEREAL)sqrt(sumOfSquares);
-    
+
     // Pow maybe slow, so test for common dims like 2,3 and just use x*x, x*x*x.
-    if(mDim == 3)
+    if(NUMDIMS == 3)
     {
         return (radius * radius * radius * m_unitSphereVolume);
     }
-    else if(mDim == 2)
+    else if(NUMDIMS == 2)
     {
         return (radius * radius * m_unitSphereVolume);
     }
     else
     {
-        return (ELEMTYPEREAL)(pow((ELEMTYPEREAL)radius, (ELEMTYPEREAL)mDim) * m_unitSphereVolume);
+        return (ELEMTYPEREAL)(pow((ELEMTYPEREAL)radius, (ELEMTYPEREAL)NUMDIMS) * m_unitSphereVolume);
     }
 }
 
 
 // Use one of the methods to calculate retangle volume
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-ELEMTYPEREAL 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::CalcRectVolume(Rect* a_rect)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+ELEMTYPEREAL
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::CalcRectVolume(const Rect* a_rect)
 {
 #ifdef RTREE_USE_SPHERICAL_VOLUME
     return RectSphericalVolume(a_rect); // Slower but helps certain merge cases
 #else // RTREE_USE_SPHERICAL_VOLUME
     return RectVolume(a_rect); // Faster but can cause poor merges
-#endif // RTREE_USE_SPHERICAL_VOLUME  
+#endif // RTREE_USE_SPHERICAL_VOLUME
 }
 
 
 // Load branch buffer with branches from full node plus the extra branch.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-void 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::GetBranches(Node* a_node, Branch* a_branch, PartitionVars* a_parVars)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+void
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::GetBranches(Node* a_node, const Branch* a_branch, PartitionVars* a_parVars)
 {
     assert(a_node);
     assert(a_branch);
-    
+
     assert(a_node->mCount == MAXNODES);
-    
+
     // Load the branch buffer
     for(int index=0; index < MAXNODES; ++index)
     {
-        *(a_parVars->mBranchBuf[index]) = *(a_node->mBranch[index]);
+        a_node->GetBranch(index, a_parVars->mBranchBuf[index]);
     }
-    *(a_parVars->mBranchBuf[MAXNODES]) = *a_branch;
+    a_parVars->mBranchBuf[MAXNODES] = *a_branch;
     a_parVars->mBranchCount = MAXNODES + 1;
-    
+
     // Calculate rect containing all in the set
-    a_parVars->mCoverSplit = a_parVars->mBranchBuf[0]->mRect;
+    a_parVars->mCoverSplit = a_parVars->mBranchBuf[0].mRect;
     for(int index=1; index < MAXNODES+1; ++index)
     {
-        a_parVars->mCoverSplit = CombineRect(&a_parVars->mCoverSplit, &a_parVars->mBranchBuf[index]->mRect);
+        a_parVars->mCoverSplit = CombineRect(&a_parVars->mCoverSplit, &a_parVars->mBranchBuf[index].mRect);
     }
     a_parVars->mCoverSplitArea = CalcRectVolume(&a_parVars->mCoverSplit);
-    
+
     InitNode(a_node);
 }
 
@@ -1528,18 +1650,18 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::GetBranches(Node*
 // If one group gets too full (more would force other group to violate min
 // fill requirement) then other group gets the rest.
 // These last are the ones that can go in either group most easily.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-void 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::ChoosePartition(PartitionVars* a_parVars, int a_minFill)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+void
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::ChoosePartition(PartitionVars* a_parVars, int a_minFill)
 {
     assert(a_parVars);
-    
+
     ELEMTYPEREAL biggestDiff;
     int group, chosen, betterGroup;
-    
+
     InitParVars(a_parVars, a_parVars->mBranchCount, a_minFill);
     PickSeeds(a_parVars);
-    
+
     while (((a_parVars->mCount[0] + a_parVars->mCount[1]) < a_parVars->mTotal)
            && (a_parVars->mCount[0] < (a_parVars->mTotal - a_parVars->mMinFill))
            && (a_parVars->mCount[1] < (a_parVars->mTotal - a_parVars->mMinFill)))
@@ -1549,9 +1671,9 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::ChoosePartition(P
         {
             if(!a_parVars->mTaken[index])
             {
-                Rect* curRect = &a_parVars->mBranchBuf[index]->mRect;
-                Rect rect0 = CombineRect(curRect, a_parVars->mCover[0]);
-                Rect rect1 = CombineRect(curRect, a_parVars->mCover[1]);
+                const Rect* curRect = &a_parVars->mBranchBuf[index].mRect;
+                Rect rect0 = CombineRect(curRect, &a_parVars->mCover[0]);
+                Rect rect1 = CombineRect(curRect, &a_parVars->mCover[1]);
                 ELEMTYPEREAL growth0 = CalcRectVolume(&rect0) - a_parVars->mArea[0];
                 ELEMTYPEREAL growth1 = CalcRectVolume(&rect1) - a_parVars->mArea[1];
                 ELEMTYPEREAL diff = growth1 - growth0;
@@ -1564,7 +1686,7 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::ChoosePartition(P
                     group = 1;
                     diff = -diff;
                 }
-                
+
                 if(diff > biggestDiff)
                 {
                     biggestDiff = diff;
@@ -1580,7 +1702,7 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::ChoosePartition(P
         }
         Classify(chosen, betterGroup, a_parVars);
     }
-    
+
     // If one group too full, put remaining rects in the other
     if((a_parVars->mCount[0] + a_parVars->mCount[1]) < a_parVars->mTotal)
     {
@@ -1600,45 +1722,45 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::ChoosePartition(P
             }
         }
     }
-    
+
     assert((a_parVars->mCount[0] + a_parVars->mCount[1]) == a_parVars->mTotal);
-    assert((a_parVars->mCount[0] >= a_parVars->mMinFill) && 
+    assert((a_parVars->mCount[0] >= a_parVars->mMinFill) &&
            (a_parVars->mCount[1] >= a_parVars->mMinFill));
 }
 
 
 // Copy branches from the buffer into two nodes according to the partition.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-void 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::LoadNodes(Node* a_nodeA, Node* a_nodeB, PartitionVars* a_parVars)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+void
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::LoadNodes(Node* a_nodeA, Node* a_nodeB, PartitionVars* a_parVars)
 {
     assert(a_nodeA);
     assert(a_nodeB);
     assert(a_parVars);
-    
+
     for(int index=0; index < a_parVars->mTotal; ++index)
     {
         assert(a_parVars->mPartition[index] == 0 || a_parVars->mPartition[index] == 1);
-        
+
         if(a_parVars->mPartition[index] == 0)
-        {	
-            AddBranch(a_parVars->mBranchBuf[index], a_nodeA, NULL);
+        {
+            AddBranch(&a_parVars->mBranchBuf[index], a_nodeA, NULL);
         }
         else if(a_parVars->mPartition[index] == 1)
         {
-            AddBranch(a_parVars->mBranchBuf[index], a_nodeB, NULL);
+            AddBranch(&a_parVars->mBranchBuf[index], a_nodeB, NULL);
         }
     }
 }
 
 
 // Initialize a PartitionVars structure.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-void 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InitParVars(PartitionVars* a_parVars, int a_maxRects, int a_minFill)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+void
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InitParVars(PartitionVars* a_parVars, int a_maxRects, int a_minFill)
 {
     assert(a_parVars);
-    
+
     a_parVars->mCount[0] = a_parVars->mCount[1] = 0;
     a_parVars->mArea[0] = a_parVars->mArea[1] = (ELEMTYPEREAL)0;
     a_parVars->mTotal = a_maxRects;
@@ -1651,25 +1773,25 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::InitParVars(Parti
 }
 
 
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-void 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::PickSeeds(PartitionVars* a_parVars)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+void
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::PickSeeds(PartitionVars* a_parVars)
 {
     int seed0, seed1;
     ELEMTYPEREAL worst, waste;
     ELEMTYPEREAL area[MAXNODES+1];
-    
+
     for(int index=0; index<a_parVars->mTotal; ++index)
     {
-        area[index] = CalcRectVolume(&a_parVars->mBranchBuf[index]->mRect);
+        area[index] = CalcRectVolume(&a_parVars->mBranchBuf[index].mRect);
     }
-    
+
     worst = -a_parVars->mCoverSplitArea - 1;
     for(int indexA=0; indexA < a_parVars->mTotal-1; ++indexA)
     {
         for(int indexB = indexA+1; indexB < a_parVars->mTotal; ++indexB)
         {
-            Rect oneRect = CombineRect(&a_parVars->mBranchBuf[indexA]->mRect, &a_parVars->mBranchBuf[indexB]->mRect);
+            Rect oneRect = CombineRect(&a_parVars->mBranchBuf[indexA].mRect, &a_parVars->mBranchBuf[indexB].mRect);
             waste = CalcRectVolume(&oneRect) - area[indexA] - area[indexB];
             if(waste > worst)
             {
@@ -1685,26 +1807,26 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::PickSeeds(Partiti
 
 
 // Put a branch in one of the groups.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-void 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Classify(int a_index, int a_group, PartitionVars* a_parVars)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+void
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Classify(int a_index, int a_group, PartitionVars* a_parVars)
 {
     assert(a_parVars);
     assert(!a_parVars->mTaken[a_index]);
-    
+
     a_parVars->mPartition[a_index] = a_group;
     a_parVars->mTaken[a_index] = true;
-    
+
     if (a_parVars->mCount[a_group] == 0)
     {
-        *(a_parVars->mCover[a_group]) = a_parVars->mBranchBuf[a_index]->mRect;
+        a_parVars->mCover[a_group] = a_parVars->mBranchBuf[a_index].mRect;
     }
     else
     {
-        *(a_parVars->mCover[a_group]) = CombineRect(&a_parVars->mBranchBuf[a_index]->mRect, a_parVars->mCover[a_group]);
+        a_parVars->mCover[a_group] = CombineRect(&a_parVars->mBranchBuf[a_index].mRect, &a_parVars->mCover[a_group]);
     }
-    
-    a_parVars->mArea[a_group] = CalcRectVolume( a_parVars->mCover[a_group] );
+
+    a_parVars->mArea[a_group] = CalcRectVolume( &a_parVars->mCover[a_group] );
     ++a_parVars->mCount[a_group];
 }
 
@@ -1713,44 +1835,41 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Classify(int a_in
 // Pass in a pointer to a Rect, the tid of the record, ptr to ptr to root node.
 // Returns 1 if record not found, 0 if success.
 // RemoveRect provides for eliminating the root.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-bool 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RemoveRect(Rect* a_rect, const DATATYPE& a_id, Node** a_root)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+bool
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RemoveRect(Rect* a_rect, const DATATYPE& a_id, Node** a_root)
 {
     assert(a_rect && a_root);
     assert(*a_root);
-    
+
     Node* tempNode;
-    ListNode* reInsertList = NULL;
-    
-    if(!RemoveRectRec(a_rect, a_id, *a_root, &reInsertList))
+    std::vector<Node*> reInsertList;
+
+    if(!RemoveRectRec(a_rect, a_id, *a_root, reInsertList))
     {
         // Found and deleted a data item
         // Reinsert any branches from eliminated nodes
-        while(reInsertList)
+        Branch branch;
+
+        while(reInsertList.empty() == false)
         {
-            tempNode = reInsertList->mNode;
-            
+            tempNode = reInsertList.back();
+            reInsertList.pop_back();
+
             for(int index = 0; index < tempNode->mCount; ++index)
             {
-                InsertRect(&(tempNode->mBranch[index]->mRect),
-                           tempNode->mBranch[index]->mData,
-                           a_root,
-                           tempNode->mLevel);
+                tempNode->GetBranch(index, branch);
+                InsertRect(branch, a_root, tempNode->mLevel);
             }
-            
-            ListNode* remLNode = reInsertList;
-            reInsertList = reInsertList->mNext;
-            
-            FreeNode(remLNode->mNode);
-            FreeListNode(remLNode);
+
+            FreeNode(tempNode);
         }
-        
+
         // Check for redundant root (not leaf, 1 child) and eliminate
         if((*a_root)->mCount == 1 && (*a_root)->IsInternalNode())
         {
-            tempNode = (*a_root)->mBranch[0]->mChild;
-            
+            tempNode = (*a_root)->mChild[0];
+
             assert(tempNode);
             FreeNode(*a_root);
             *a_root = tempNode;
@@ -1768,30 +1887,34 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RemoveRect(Rect*
 // Called by RemoveRect.  Descends tree recursively,
 // merges branches on the way back up.
 // Returns 1 if record not found, 0 if success.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-bool 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RemoveRectRec(Rect* a_rect, const DATATYPE& a_id, Node* a_node, ListNode** a_listNode)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+bool
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RemoveRectRec(Rect* a_rect, const DATATYPE& a_id, Node* a_node, std::vector<Node*>& a_reInsertList)
 {
-    assert(a_rect && a_node && a_listNode);
+    assert(a_rect && a_node);
     assert(a_node->mLevel >= 0);
-    
+
     if(a_node->IsInternalNode())  // not a leaf node
     {
+        Rect rect;
+
         for(int index = 0; index < a_node->mCount; ++index)
         {
-            if(Overlap(a_rect, &(a_node->mBranch[index]->mRect)))
+            a_node->GetRect(index, rect);
+
+            if(Overlap(a_rect, &rect))
             {
-                if(!RemoveRectRec(a_rect, a_id, a_node->mBranch[index]->mChild, a_listNode))
+                if(!RemoveRectRec(a_rect, a_id, a_node->mChild[index], a_reInsertList))
                 {
-                    if(a_node->mBranch[index]->mChild->mCount >= MINNODES)
+                    if(a_node->mChild[index]->mCount >= MINNODES)
                     {
                         // child removed, just resize parent rect
-                        a_node->mBranch[index]->mRect = NodeCover(a_node->mBranch[index]->mChild);
+                        a_node->SetRect(index, NodeCover(a_node->mChild[index]));
                     }
                     else
                     {
                         // child removed, not enough entries in node, eliminate node
-                        ReInsert(a_node->mBranch[index]->mChild, a_listNode);
+                        ReInsert(a_node->mChild[index], a_reInsertList);
                         DisconnectBranch(a_node, index); // Must return after this call as count has changed
                     }
                     return false;
@@ -1804,7 +1927,7 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RemoveRectRec(Rec
     {
         for(int index = 0; index < a_node->mCount; ++index)
         {
-            if(a_node->mBranch[index]->mChild == (Node*)a_id)
+            if(a_node->mData[index] == a_id)
             {
                 DisconnectBranch(a_node, index); // Must return after this call as count has changed
                 return false;
@@ -1816,13 +1939,13 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::RemoveRectRec(Rec
 
 
 // Decide whether two rectangles overlap.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-bool 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Overlap(Rect* a_rectA, Rect* a_rectB)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+bool
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Overlap(const Rect* a_rectA, const Rect* a_rectB)
 {
     assert(a_rectA && a_rectB);
-    
-    for(int index=0; index < mDim; ++index)
+
+    for(int index=0; index < NUMDIMS; ++index)
     {
         if (a_rectA->mMin[index] > a_rectB->mMax[index] ||
             a_rectB->mMin[index] > a_rectA->mMax[index])
@@ -1831,59 +1954,17 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Overlap(Rect* a_r
         }
     }
     return true;
-    
+
 }
 
 
 // Add a node to the reinsertion list.  All its branches will later
 // be reinserted into the index structure.
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-void 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::ReInsert(Node* a_node, ListNode** a_listNode)
-{
-    ListNode* newListNode;
-    
-    newListNode = AllocListNode();
-    newListNode->mNode = a_node;
-    newListNode->mNext = *a_listNode;
-    *a_listNode = newListNode;
-}
-
-template<class DATATYPE, class ELEMTYPE, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
-bool 
-RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Search(Node* a_node, Rect* a_rect, std::vector<DATATYPE>& pSearchResults)
+template<class DATATYPE, class ELEMTYPE, int NUMDIMS, class ELEMTYPEREAL, int TMAXNODES, int TMINNODES>
+void
+RTree<DATATYPE, ELEMTYPE, NUMDIMS, ELEMTYPEREAL, TMAXNODES, TMINNODES>::ReInsert(Node* a_node, std::vector<Node*>& a_reInsertList)
 {
-    assert(a_node);
-    assert(a_node->mLevel >= 0);
-    assert(a_rect);
-    
-    if(a_node->IsInternalNode()) // This is an internal node in the tree
-    {
-        for(int index=0; index < a_node->mCount; ++index)
-        {
-            if(Overlap(a_rect, &a_node->mBranch[index]->mRect))
-            {
-                if(!Search(a_node->mBranch[index]->mChild, a_rect, pSearchResults))
-                {
-                    return false; // Don't continue searching
-                }
-            }
-        }
-    }
-    else // This is a leaf node
-    {
-        for(int index=0; index < a_node->mCount; ++index)
-        {
-            if( Overlap( a_rect, &a_node->mBranch[index]->mRect ) )
-            {
-                DATATYPE& id = a_node->mBranch[index]->mData;
-                
-                pSearchResults.push_back(id);
-            }
-        }
-    }
-    
-    return true; // Continue searching	
+    a_reInsertList.push_back(a_node);
 }
 
 };
@@ -1892,4 +1973,3 @@ RTree<DATATYPE, ELEMTYPE, ELEMTYPEREAL, TMAXNODES, TMINNODES>::Search(Node* a_no
 
 
 #endif
-
@@ -4,13 +4,23 @@
 #include "dab_math_vec.h"
 #include "dab_space_shape.h"
 #include "dab_space_neighbors.h"
+#include <cmath>
+#include <limits>
 
 using namespace dab;
 using namespace dab::space;
 
+const glm::vec3 SpaceShape::sDOPDirections[SpaceShape::sDOPDirectionCount] =
+{
+    glm::vec3(1.0, 1.0, 1.0), glm::vec3(1.0, 1.0, -1.0), glm::vec3(1.0, -1.0, 1.0), glm::vec3(-1.0, 1.0, 1.0),
+    glm::vec3(1.0, 1.0, 0.0), glm::vec3(1.0, -1.0, 0.0), glm::vec3(1.0, 0.0, 1.0), glm::vec3(1.0, 0.0, -1.0), glm::vec3(0.0, 1.0, 1.0), glm::vec3(0.0, 1.0, -1.0)
+};
+
 SpaceShape::SpaceShape()
 : SpaceObject(3)
 , mGeometry(nullptr)
+, mGeometryModified(false)
+, mFeatureCaching(false)
 {}
 
 SpaceShape::SpaceShape( std::shared_ptr<geom::Geometry> pGeometry)
@@ -18,6 +28,8 @@ SpaceShape::SpaceShape( std::shared_ptr<geom::Geometry> pGeometry)
 , mGeometry(pGeometry)
 , mGeometryChanged(true)
 , mTransformChanged(true)
+, mGeometryModified(false)
+, mFeatureCaching(false)
 {}
 
 SpaceShape::~SpaceShape()
@@ -62,6 +74,7 @@ void
 SpaceShape::setGeometryChanged()
 {
     mGeometryChanged = true;
+    mGeometryModified = true;
 }
 
 void
@@ -74,6 +87,27 @@ void
 SpaceShape::setGeometry( std::shared_ptr<geom::Geometry> pGeometry )
 {
     mGeometry = pGeometry;
+    mGeometryChanged = true;
+}
+
+std::shared_ptr<SpaceTriangleMesh>
+SpaceShape::triangleMesh() const
+{
+    if(mTransformChanged == true || mGeometryChanged == true) const_cast<SpaceShape*>(this)->update();
+    
+    return mTriangleMesh;
+}
+
+bool
+SpaceShape::featureCaching() const
+{
+    return mFeatureCaching;
+}
+
+void
+SpaceShape::setFeatureCaching(bool pFeatureCaching)
+{
+    mFeatureCaching = pFeatureCaching;
 }
 
 void
@@ -118,6 +152,50 @@ SpaceShape::setScale(const Eigen::Vector3f& pScale)
     mTransformChanged = true;
 }
 
+void
+SpaceShape::setTransform(const float* pPosition, const float* pOrientation, const float* pScale)
+{
+    ofNode::setPosition(pPosition[0], pPosition[1], pPosition[2]);
+    if(pOrientation != nullptr) ofNode::setOrientation(ofQuaternion(pOrientation[0], pOrientation[1], pOrientation[2], pOrientation[3]));
+    if(pScale != nullptr) ofNode::setScale(pScale[0], pScale[1], pScale[2]);
+    
+    if(ofNode::getParent() != nullptr)
+    {
+        update();
+        return;
+    }
+    
+    const ofQuaternion& quat = ofNode::getOrientationQuat();
+    const glm::vec3& scale = ofNode::getScale();
+    Eigen::Matrix3f rotation = Eigen::Quaternionf(quat.w(), quat.x(), quat.y(), quat.z()).normalized().toRotationMatrix();
+    
+    // object2world = translation * rotation * scale, world2object = inverse scale * transposed rotation * inverse translation
+    for(int c=0; c<3; ++c)
+    {
+        for(int r=0; r<3; ++r)
+        {
+            mObject2WorldTransformMatrix[c][r] = rotation(r, c) * scale[c];
+            mWorld2ObjectTransformMatrix[c][r] = rotation(c, r) / scale[r];
+        }
+        
+        mObject2WorldTransformMatrix[c][3] = 0.0;
+        mWorld2ObjectTransformMatrix[c][3] = 0.0;
+    }
+    
+    mObject2WorldTransformMatrix[3] = glm::vec4(pPosition[0], pPosition[1], pPosition[2], 1.0);
+    
+    for(int r=0; r<3; ++r)
+    {
+        mWorld2ObjectTransformMatrix[3][r] = -( mWorld2ObjectTransformMatrix[0][r] * pPosition[0] + mWorld2ObjectTransformMatrix[1][r] * pPosition[1] + mWorld2ObjectTransformMatrix[2][r] * pPosition[2] );
+    }
+    
+    mWorld2ObjectTransformMatrix[3][3] = 1.0;
+    mTransformChanged = false;
+    
+    if(mGeometryChanged == true) update();
+    else updateAABB();
+}
+
 const geom::Cuboid&
 SpaceShape::AABB() const
 {
@@ -134,6 +212,22 @@ SpaceShape::ocAABB() const
     return mObjectAABB;
 }
 
+const float*
+SpaceShape::DOPMins() const
+{
+    if(mTransformChanged == true || mGeometryChanged == true) const_cast<SpaceShape*>(this)->update();
+    
+    return mDOPMins;
+}
+
+const float*
+SpaceShape::DOPMaxs() const
+{
+    if(mTransformChanged == true || mGeometryChanged == true) const_cast<SpaceShape*>(this)->update();
+    
+    return mDOPMaxs;
+}
+
 void
 SpaceShape::closestPoint(const glm::vec3& pRefPoint, glm::vec3& pResPoint)
 {
@@ -141,7 +235,30 @@ SpaceShape::closestPoint(const glm::vec3& pRefPoint, glm::vec3& pResPoint)
     
 	glm::vec3 refPosObject = world2object(pRefPoint);
 	glm::vec3 closestPosObject;
-    mGeometry->closestPoint(refPosObject, closestPosObject);
+    if(mTriangleMesh != nullptr) mTriangleMesh->closestPoint(refPosObject, closestPosObject);
+    else mGeometry->closestPoint(refPosObject, closestPosObject);
+    object2world(closestPosObject, pResPoint);
+}
+
+void
+SpaceShape::closestPoint(const glm::vec3& pRefPoint, glm::vec3& pResPoint, int& pFeature)
+{
+    if(mTransformChanged == true || mGeometryChanged == true) const_cast<SpaceShape*>(this)->update();
+    
+    if(mTriangleMesh == nullptr || mFeatureCaching == false)
+    {
+        closestPoint(pRefPoint, pResPoint);
+        pFeature = -1;
+        
+        return;
+    }
+    
+    glm::vec3 refPosObject = world2object(pRefPoint);
+    glm::vec3 closestPosObject;
+    
+    if(pFeature >= 0 && pFeature < static_cast<int>(mTriangleMesh->triangleCount())) pFeature = mTriangleMesh->closestPoint(refPosObject, pFeature, closestPosObject);
+    else pFeature = mTriangleMesh->closestPoint(refPosObject, closestPosObject);
+    
     object2world(closestPosObject, pResPoint);
 }
     
@@ -205,19 +322,22 @@ SpaceShape::info(int pPropagationLevel) const
 void
 SpaceShape::update()
 {
-    if(mTransformChanged == true)
+    if(mGeometryChanged == true)
     {
-        mTransformChanged = false;
+        mTriangleMesh = SpaceTriangleMesh::create(mGeometry, mGeometryModified);
         
-        updateMatrix();
-        updateAABB();
+        mGeometryChanged = false;
+        mGeometryModified = false;
     }
-    else if(mGeometryChanged == true)
+    
+    if(mTransformChanged == true)
     {
-        mGeometryChanged = false;
+        mTransformChanged = false;
         
-        updateAABB();
+        updateMatrix();
     }
+    
+    updateAABB();
 }
 
 void
@@ -227,7 +347,30 @@ SpaceShape::updateAABB()
     const glm::vec3& geomMaxPos = mGeometry->maxPos();
     
     mObjectAABB.set( geomMinPos, geomMaxPos );
-    mWorldAABB.set( object2world(geomMinPos), object2world(geomMaxPos) );
+    
+    // a rotated box can extend beyond its transformed minimum and maximum corners. its extent along any direction follows from the transformed center and the absolute projections of the transformed half axes, which bounds all eight corners at once
+    glm::vec3 center = ( geomMinPos + geomMaxPos ) * 0.5f;
+    glm::vec3 halfSize = ( geomMaxPos - geomMinPos ) * 0.5f;
+    glm::vec3 worldCenter = object2world(center);
+    glm::vec3 worldHalfAxes[3];
+    
+    for(int c=0; c<3; ++c) worldHalfAxes[c] = glm::vec3( mObject2WorldTransformMatrix[c][0], mObject2WorldTransformMatrix[c][1], mObject2WorldTransformMatrix[c][2] ) * halfSize[c];
+    
+    glm::vec3 worldHalfSize = glm::abs(worldHalfAxes[0]) + glm::abs(worldHalfAxes[1]) + glm::abs(worldHalfAxes[2]);
+    glm::vec3 worldMinPos = worldCenter - worldHalfSize;
+    glm::vec3 worldMaxPos = worldCenter + worldHalfSize;
+    
+    for(unsigned int d=0; d<sDOPDirectionCount; ++d)
+    {
+        const glm::vec3& direction = sDOPDirections[d];
+        float centerExtent = glm::dot(direction, worldCenter);
+        float halfExtent = std::abs( glm::dot(direction, worldHalfAxes[0]) ) + std::abs( glm::dot(direction, worldHalfAxes[1]) ) + std::abs( glm::dot(direction, worldHalfAxes[2]) );
+        
+        mDOPMins[d] = centerExtent - halfExtent;
+        mDOPMaxs[d] = centerExtent + halfExtent;
+    }
+    
+    mWorldAABB.set( worldMinPos, worldMaxPos );
 }
 
 void
@@ -11,6 +11,7 @@
 #include "dab_geom_geometry.h"
 #include "dab_geom_cuboid.h"
 #include "dab_space_object.h"
+#include "dab_space_triangle_mesh.h"
 
 namespace dab
 {
@@ -20,6 +21,8 @@ namespace space
 
 class SpaceShape : public SpaceObject, public ofNode
 {
+friend class SpaceShapeTools;
+    
 public:
     /**
      \brief create shape
@@ -48,6 +51,11 @@ public:
      */
     std::shared_ptr<geom::Geometry> geometry();
 
+    /**
+     \brief notify shape that its geometry has been modified
+     
+     the triangle mesh of a mesh geometry is rebuilt during the next update
+     */
     void setGeometryChanged();
     void setTransformChanged();
     
@@ -84,6 +92,16 @@ public:
      */
 	void setScale(const Eigen::Vector3f& pScale);
     
+    /**
+     \brief set position, orientation and scale at once and update transformation matrices and bounding volumes
+     \param pPosition position (3 values)
+     \param pOrientation orientation quaternion (4 values: x y z w, nullptr: orientation remains unchanged)
+     \param pScale scale (3 values, nullptr: scale remains unchanged)
+     
+     unless the shape has a parent node, the world to object matrix is obtained in closed form from the inverse scale and transposed rotation instead of a general matrix inversion. the shape is up to date afterwards, subsequent queries don't trigger a lazy update.
+     */
+    void setTransform(const float* pPosition, const float* pOrientation, const float* pScale);
+    
     /**
      \brief return axis aligned bounding box (in world coordinates)
      */
@@ -94,14 +112,62 @@ public:
      */
     const geom::Cuboid& ocAABB() const;
     
+    /**
+     \brief return minimum extents of shape along the diagonal directions of discrete oriented polytopes (in world coordinates)
+     \return minimum extents (sDOPDirectionCount values)
+     
+     together with the AABB, the extents along the first four directions form a 14-DOP and those along the remaining six directions an 18-DOP
+     */
+    const float* DOPMins() const;
+    
+    /**
+     \brief return maximum extents of shape along the diagonal directions of discrete oriented polytopes (in world coordinates)
+     \return maximum extents (sDOPDirectionCount values)
+     */
+    const float* DOPMaxs() const;
+    
+    static const unsigned int sDOPDirectionCount = 10; ///\brief number of diagonal directions of discrete oriented polytopes
+    static const glm::vec3 sDOPDirections[sDOPDirectionCount]; ///\brief diagonal directions, four corner diagonals (14-DOP) followed by six edge diagonals (18-DOP)
+    
     /**
      \brief return closest point
      \param pRefPoint reference point (in world coordinates)
      \param pResPoint result point (in world coordinates)
      \remarks fails if dimension of reference and result points don't match dimension of shape
+     
+     closest points on meshes are searched in the bounding volume hierarchy of the triangle mesh, which is shared by all shapes using the same geometry
      */
     void closestPoint(const glm::vec3& pRefPoint, glm::vec3& pResPoint);
     
+    /**
+     \brief return closest point, starting from the closest feature of a previous query
+     \param pRefPoint reference point (in world coordinates)
+     \param pResPoint result point (in world coordinates)
+     \param pFeature closest feature of a previous query by the same object, is replaced by the closest feature of this query (-1: none)
+     
+     with feature caching, the closest point on a mesh is first searched locally by descending from the previous closest triangle through adjacent triangles. the point found locally then bounds the search of the bounding volume hierarchy, which only visits the parts of the mesh that are closer. the result is exact, the search is cheaper than without a previous feature as long as the previous closest triangle stays close to the closest one.\n
+     without feature caching or for geometries other than meshes, the feature is ignored and set to -1.
+     */
+    void closestPoint(const glm::vec3& pRefPoint, glm::vec3& pResPoint, int& pFeature);
+    
+    /**
+     \brief return triangle mesh of geometry
+     \return triangle mesh (nullptr: geometry isn't a mesh)
+     */
+    std::shared_ptr<SpaceTriangleMesh> triangleMesh() const;
+    
+    /**
+     \brief return whether closest points on meshes are searched starting from the closest feature of a previous query
+     \return feature caching
+     */
+    bool featureCaching() const;
+    
+    /**
+     \brief set whether closest points on meshes are searched starting from the closest feature of a previous query
+     \param pFeatureCaching feature caching
+     */
+    void setFeatureCaching(bool pFeatureCaching);
+    
 	glm::vec3 world2object( const glm::vec3& pWorldPos ) const;
     void world2object( const glm::vec3& pWorldPos, glm::vec3& pObjectPos ) const;
 	glm::vec3 object2world( const glm::vec3& pObjectPos ) const;
@@ -139,7 +205,7 @@ protected:
     void update();
     
     /**
-     \brief update axis aligned bounding box of geometry
+     \brief update axis aligned bounding box and discrete oriented polytope extents of geometry
      */
 	void updateAABB();
     
@@ -151,9 +217,15 @@ protected:
     std::shared_ptr<geom::Geometry> mGeometry; /// \brief shape geometry
     geom::Cuboid mObjectAABB; /// \brief axis aligned bounding box (object space)
     geom::Cuboid mWorldAABB; /// \brief axis aligned bounding box (world space)
+    float mDOPMins[sDOPDirectionCount]; /// \brief minimum extents along diagonal directions (world space)
+    float mDOPMaxs[sDOPDirectionCount]; /// \brief maximum extents along diagonal directions (world space)
     
     bool mGeometryChanged;
     bool mTransformChanged;
+    bool mGeometryModified; /// \brief geometry has been modified in place, its triangle mesh needs to be rebuilt
+    
+    bool mFeatureCaching; /// \brief search closest points on meshes starting from previous closest features
+    std::shared_ptr<SpaceTriangleMesh> mTriangleMesh; /// \brief triangles of mesh geometry (nullptr: geometry isn't a mesh)
 
 	glm::mat4x4 mObject2WorldTransformMatrix;
 	glm::mat4x4 mWorld2ObjectTransformMatrix;
@@ -0,0 +1,70 @@
+/** \file dab_space_shape_tools.cpp
+ */
+
+#include "dab_space_shape_tools.h"
+#include "dab_space_shape.h"
+#include "dab_space_parallel.h"
+#include <algorithm>
+
+using namespace dab;
+using namespace dab::space;
+
+SpaceShapeTools::SpaceShapeTools()
+{}
+
+SpaceShapeTools::~SpaceShapeTools()
+{}
+
+void
+SpaceShapeTools::setTransforms(const std::vector<SpaceShape*>& pShapes, const float* pPositions, const float* pOrientations, const float* pScales) throw (Exception)
+{
+    try
+    {
+        unsigned int shapeCount = pShapes.size();
+        const unsigned int blockSize = 16;
+        unsigned int blockCount = ( shapeCount + blockSize - 1 ) / blockSize;
+        
+        SpaceParallelTools::get().run(blockCount, [&pShapes, pPositions, pOrientations, pScales, shapeCount, blockSize](unsigned int pTaskIndex, unsigned int)
+        {
+            unsigned int shapeEnd = std::min( (pTaskIndex + 1) * blockSize, shapeCount );
+            
+            for(unsigned int sI=pTaskIndex * blockSize; sI<shapeEnd; ++sI)
+            {
+                pShapes[sI]->setTransform( pPositions + sI * 3, pOrientations != nullptr ? pOrientations + sI * 4 : nullptr, pScales != nullptr ? pScales + sI * 3 : nullptr );
+            }
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to set shape transforms", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
+
+void
+SpaceShapeTools::update(const std::vector<SpaceShape*>& pShapes) throw (Exception)
+{
+    try
+    {
+        unsigned int shapeCount = pShapes.size();
+        const unsigned int blockSize = 16;
+        unsigned int blockCount = ( shapeCount + blockSize - 1 ) / blockSize;
+        
+        SpaceParallelTools::get().run(blockCount, [&pShapes, shapeCount, blockSize](unsigned int pTaskIndex, unsigned int)
+        {
+            unsigned int shapeEnd = std::min( (pTaskIndex + 1) * blockSize, shapeCount );
+            
+            for(unsigned int sI=pTaskIndex * blockSize; sI<shapeEnd; ++sI)
+            {
+                SpaceShape* shape = pShapes[sI];
+                
+                if(shape->mTransformChanged == true || shape->mGeometryChanged == true) shape->update();
+            }
+        });
+    }
+    catch(Exception& e)
+    {
+        e += Exception("SPACE ERROR: failed to update shapes", __FILE__, __FUNCTION__, __LINE__);
+        throw e;
+    }
+}
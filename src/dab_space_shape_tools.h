@@ -0,0 +1,60 @@
+/** \file dab_space_shape_tools.h
+ */
+
+#ifndef _dab_space_shape_tools_h_
+#define _dab_space_shape_tools_h_
+
+#include <iostream>
+#include <vector>
+#include "dab_exception.h"
+#include "dab_singleton.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+class SpaceShape;
+
+/**
+ \brief batch updates of many space shapes
+
+ moving shapes one by one through their ofNode interface only marks them as changed, their matrices and bounding volumes are recalculated lazily by whichever query touches them first. the batch functions instead bring all shapes up to date in parallel, so that the structure and neighbor updates of a space find them unchanged.
+ */
+class SpaceShapeTools : public Singleton<SpaceShapeTools>
+{
+friend class Singleton<SpaceShapeTools>;
+
+public:
+    /**
+     \brief set positions, orientations and scales of shapes and update their matrices and bounding volumes
+     \param pShapes shapes, each shape must appear only once
+     \param pPositions positions (3 values per shape)
+     \param pOrientations orientation quaternions (4 values per shape: x y z w, nullptr: orientations remain unchanged)
+     \param pScales scales (3 values per shape, nullptr: scales remain unchanged)
+     \exception Exception failed to update shapes
+
+     shapes are processed in parallel, see SpaceShape::setTransform. shapes whose parent node is moved within the same batch need to be updated in a separate batch afterwards
+     */
+    void setTransforms(const std::vector<SpaceShape*>& pShapes, const float* pPositions, const float* pOrientations = nullptr, const float* pScales = nullptr) throw (Exception);
+
+    /**
+     \brief update matrices and bounding volumes of shapes that have changed since their last update
+     \param pShapes shapes, each shape must appear only once
+     \exception Exception failed to update shapes
+
+     suited for shapes that have been moved through their ofNode interface, shapes are processed in parallel
+     */
+    void update(const std::vector<SpaceShape*>& pShapes) throw (Exception);
+
+protected:
+    SpaceShapeTools();
+    ~SpaceShapeTools();
+};
+
+};
+
+};
+
+#endif
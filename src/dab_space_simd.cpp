@@ -0,0 +1,723 @@
+/** \file dab_space_simd.cpp
+ */
+
+#include "dab_space_simd.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define DAB_SPACE_SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define DAB_SPACE_TARGET_AVX2
+#define DAB_SPACE_TARGET_AVX512
+#else
+#define DAB_SPACE_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define DAB_SPACE_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+#endif
+
+using namespace dab;
+using namespace dab::space;
+
+const unsigned int SpaceSimdTools::sPointAlignment = 16;
+const unsigned int SpaceSimdTools::sTriangleComponentCount = 16;
+
+namespace
+{
+
+void
+squaredDistancesScalar(const float* pQuery, const float* pPoints, unsigned int pPointStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDistances)
+{
+    unsigned int pointCount = pEndIndex - pBeginIndex;
+
+    for(unsigned int i=0; i<pointCount; ++i) pDistances[i] = 0.0;
+
+    for(unsigned int d=0; d<pDim; ++d)
+    {
+        const float* coords = pPoints + d * pPointStride + pBeginIndex;
+        float query = pQuery[d];
+
+        for(unsigned int i=0; i<pointCount; ++i)
+        {
+            float diff = coords[i] - query;
+            pDistances[i] += diff * diff;
+        }
+    }
+}
+
+void
+dotProductsScalar(const float* pVector, const float* pPoints, unsigned int pPointStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pProducts)
+{
+    unsigned int pointCount = pEndIndex - pBeginIndex;
+
+    for(unsigned int i=0; i<pointCount; ++i) pProducts[i] = 0.0;
+
+    for(unsigned int d=0; d<pDim; ++d)
+    {
+        const float* coords = pPoints + d * pPointStride + pBeginIndex;
+        float value = pVector[d];
+
+        for(unsigned int i=0; i<pointCount; ++i) pProducts[i] += coords[i] * value;
+    }
+}
+
+float
+vectorDistanceScalar(const float* pVector1, const float* pVector2, unsigned int pDim)
+{
+    float distance = 0.0;
+
+    for(unsigned int d=0; d<pDim; ++d)
+    {
+        float diff = pVector1[d] - pVector2[d];
+        distance += diff * diff;
+    }
+
+    return distance;
+}
+
+void
+closestBoxPointsScalar(const float* pQuery, const float* pMins, const float* pMaxs, unsigned int pBoxStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDirections, float* pDistances)
+{
+    unsigned int boxCount = pEndIndex - pBeginIndex;
+
+    for(unsigned int i=0; i<boxCount; ++i) pDistances[i] = 0.0;
+
+    for(unsigned int d=0; d<pDim; ++d)
+    {
+        const float* mins = pMins + d * pBoxStride + pBeginIndex;
+        const float* maxs = pMaxs + d * pBoxStride + pBeginIndex;
+        float* directions = pDirections + d * pBoxStride + pBeginIndex;
+        float query = pQuery[d];
+
+        for(unsigned int i=0; i<boxCount; ++i)
+        {
+            float diff = std::min( std::max(query, mins[i]), maxs[i] ) - query;
+            directions[i] = diff;
+            pDistances[i] += diff * diff;
+        }
+    }
+
+    for(unsigned int i=0; i<boxCount; ++i) pDistances[i] = std::sqrt(pDistances[i]);
+}
+
+void
+triangleDistancesScalar(const float* pQuery, const float* pTriangles, unsigned int pTriangleStride, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDistances)
+{
+    for(unsigned int i=pBeginIndex; i<pEndIndex; ++i)
+    {
+        const float* t = pTriangles + i;
+        unsigned int s = pTriangleStride;
+
+        float apX = pQuery[0] - t[0];
+        float apY = pQuery[1] - t[s];
+        float apZ = pQuery[2] - t[2 * s];
+        float ap2 = apX * apX + apY * apY + apZ * apZ;
+        float d1 = t[3 * s] * apX + t[4 * s] * apY + t[5 * s] * apZ;
+        float d2 = t[6 * s] * apX + t[7 * s] * apY + t[8 * s] * apZ;
+        float d00 = t[9 * s];
+        float d01 = t[10 * s];
+        float d11 = t[11 * s];
+        float invDen = t[15 * s];
+
+        // projection onto triangle plane, unnormalized barycentric coordinates
+        float v = d11 * d1 - d01 * d2;
+        float w = d00 * d2 - d01 * d1;
+        bool inside = invDen > 0.0 && v >= 0.0 && w >= 0.0 && v + w <= d00 * d11 - d01 * d01;
+        float planeDistance = ap2 - ( v * d1 + w * d2 ) * invDen;
+
+        // edges ab, ac and bc
+        float tAB = std::min( std::max( d1 * t[12 * s], 0.0f ), 1.0f );
+        float tAC = std::min( std::max( d2 * t[13 * s], 0.0f ), 1.0f );
+        float e = d2 - d1 - d01 + d00;
+        float bc2 = d00 + d11 - 2.0f * d01;
+        float tBC = std::min( std::max( e * t[14 * s], 0.0f ), 1.0f );
+        float edgeDistance = ap2 - tAB * ( 2.0f * d1 - tAB * d00 );
+        edgeDistance = std::min( edgeDistance, ap2 - tAC * ( 2.0f * d2 - tAC * d11 ) );
+        edgeDistance = std::min( edgeDistance, ap2 - 2.0f * d1 + d00 - tBC * ( 2.0f * e - tBC * bc2 ) );
+
+        pDistances[i - pBeginIndex] = std::max( inside ? planeDistance : edgeDistance, 0.0f );
+    }
+}
+
+#ifdef DAB_SPACE_SIMD_X86
+
+DAB_SPACE_TARGET_AVX2 float
+vectorDistanceAVX2(const float* pVector1, const float* pVector2, unsigned int pDim)
+{
+    __m256 sum0 = _mm256_setzero_ps();
+    __m256 sum1 = _mm256_setzero_ps();
+    unsigned int d = 0;
+
+    for(; d + 16 <= pDim; d += 16)
+    {
+        __m256 diff0 = _mm256_sub_ps(_mm256_loadu_ps(pVector1 + d), _mm256_loadu_ps(pVector2 + d));
+        __m256 diff1 = _mm256_sub_ps(_mm256_loadu_ps(pVector1 + d + 8), _mm256_loadu_ps(pVector2 + d + 8));
+        sum0 = _mm256_fmadd_ps(diff0, diff0, sum0);
+        sum1 = _mm256_fmadd_ps(diff1, diff1, sum1);
+    }
+
+    for(; d + 8 <= pDim; d += 8)
+    {
+        __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(pVector1 + d), _mm256_loadu_ps(pVector2 + d));
+        sum0 = _mm256_fmadd_ps(diff, diff, sum0);
+    }
+
+    // horizontal sum
+    __m256 sum = _mm256_add_ps(sum0, sum1);
+    __m128 sum128 = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    sum128 = _mm_add_ps(sum128, _mm_movehl_ps(sum128, sum128));
+    sum128 = _mm_add_ss(sum128, _mm_shuffle_ps(sum128, sum128, 1));
+
+    return _mm_cvtss_f32(sum128) + vectorDistanceScalar(pVector1 + d, pVector2 + d, pDim - d);
+}
+
+DAB_SPACE_TARGET_AVX512 float
+vectorDistanceAVX512(const float* pVector1, const float* pVector2, unsigned int pDim)
+{
+    __m512 sum0 = _mm512_setzero_ps();
+    __m512 sum1 = _mm512_setzero_ps();
+    unsigned int d = 0;
+
+    for(; d + 32 <= pDim; d += 32)
+    {
+        __m512 diff0 = _mm512_sub_ps(_mm512_loadu_ps(pVector1 + d), _mm512_loadu_ps(pVector2 + d));
+        __m512 diff1 = _mm512_sub_ps(_mm512_loadu_ps(pVector1 + d + 16), _mm512_loadu_ps(pVector2 + d + 16));
+        sum0 = _mm512_fmadd_ps(diff0, diff0, sum0);
+        sum1 = _mm512_fmadd_ps(diff1, diff1, sum1);
+    }
+
+    for(; d < pDim; d += 16)
+    {
+        unsigned int count = pDim - d < 16 ? pDim - d : 16;
+        __mmask16 mask = static_cast<__mmask16>( ( 1u << count ) - 1u );
+        __m512 diff = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, pVector1 + d), _mm512_maskz_loadu_ps(mask, pVector2 + d));
+        sum0 = _mm512_fmadd_ps(diff, diff, sum0);
+    }
+
+    return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+}
+
+DAB_SPACE_TARGET_AVX2 void
+squaredDistancesAVX2(const float* pQuery, const float* pPoints, unsigned int pPointStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDistances)
+{
+    unsigned int i = pBeginIndex;
+
+    // four independent accumulators hide the latency of the fused multiply add
+    for(; i + 32 <= pEndIndex; i += 32)
+    {
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+        __m256 sum2 = _mm256_setzero_ps();
+        __m256 sum3 = _mm256_setzero_ps();
+
+        for(unsigned int d=0; d<pDim; ++d)
+        {
+            const float* coords = pPoints + d * pPointStride + i;
+            __m256 query = _mm256_set1_ps(pQuery[d]);
+            __m256 diff0 = _mm256_sub_ps(_mm256_loadu_ps(coords), query);
+            __m256 diff1 = _mm256_sub_ps(_mm256_loadu_ps(coords + 8), query);
+            __m256 diff2 = _mm256_sub_ps(_mm256_loadu_ps(coords + 16), query);
+            __m256 diff3 = _mm256_sub_ps(_mm256_loadu_ps(coords + 24), query);
+            sum0 = _mm256_fmadd_ps(diff0, diff0, sum0);
+            sum1 = _mm256_fmadd_ps(diff1, diff1, sum1);
+            sum2 = _mm256_fmadd_ps(diff2, diff2, sum2);
+            sum3 = _mm256_fmadd_ps(diff3, diff3, sum3);
+        }
+
+        float* distances = pDistances + i - pBeginIndex;
+        _mm256_storeu_ps(distances, sum0);
+        _mm256_storeu_ps(distances + 8, sum1);
+        _mm256_storeu_ps(distances + 16, sum2);
+        _mm256_storeu_ps(distances + 24, sum3);
+    }
+
+    for(; i + 8 <= pEndIndex; i += 8)
+    {
+        __m256 sum = _mm256_setzero_ps();
+
+        for(unsigned int d=0; d<pDim; ++d)
+        {
+            __m256 diff = _mm256_sub_ps(_mm256_loadu_ps(pPoints + d * pPointStride + i), _mm256_set1_ps(pQuery[d]));
+            sum = _mm256_fmadd_ps(diff, diff, sum);
+        }
+
+        _mm256_storeu_ps(pDistances + i - pBeginIndex, sum);
+    }
+
+    if(i < pEndIndex) squaredDistancesScalar(pQuery, pPoints, pPointStride, pDim, i, pEndIndex, pDistances + i - pBeginIndex);
+}
+
+DAB_SPACE_TARGET_AVX2 void
+dotProductsAVX2(const float* pVector, const float* pPoints, unsigned int pPointStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pProducts)
+{
+    unsigned int i = pBeginIndex;
+
+    for(; i + 32 <= pEndIndex; i += 32)
+    {
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+        __m256 sum2 = _mm256_setzero_ps();
+        __m256 sum3 = _mm256_setzero_ps();
+
+        for(unsigned int d=0; d<pDim; ++d)
+        {
+            const float* coords = pPoints + d * pPointStride + i;
+            __m256 value = _mm256_set1_ps(pVector[d]);
+            sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(coords), value, sum0);
+            sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(coords + 8), value, sum1);
+            sum2 = _mm256_fmadd_ps(_mm256_loadu_ps(coords + 16), value, sum2);
+            sum3 = _mm256_fmadd_ps(_mm256_loadu_ps(coords + 24), value, sum3);
+        }
+
+        float* products = pProducts + i - pBeginIndex;
+        _mm256_storeu_ps(products, sum0);
+        _mm256_storeu_ps(products + 8, sum1);
+        _mm256_storeu_ps(products + 16, sum2);
+        _mm256_storeu_ps(products + 24, sum3);
+    }
+
+    for(; i + 8 <= pEndIndex; i += 8)
+    {
+        __m256 sum = _mm256_setzero_ps();
+
+        for(unsigned int d=0; d<pDim; ++d) sum = _mm256_fmadd_ps(_mm256_loadu_ps(pPoints + d * pPointStride + i), _mm256_set1_ps(pVector[d]), sum);
+
+        _mm256_storeu_ps(pProducts + i - pBeginIndex, sum);
+    }
+
+    if(i < pEndIndex) dotProductsScalar(pVector, pPoints, pPointStride, pDim, i, pEndIndex, pProducts + i - pBeginIndex);
+}
+
+DAB_SPACE_TARGET_AVX512 void
+squaredDistancesAVX512(const float* pQuery, const float* pPoints, unsigned int pPointStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDistances)
+{
+    unsigned int i = pBeginIndex;
+
+    for(; i + 64 <= pEndIndex; i += 64)
+    {
+        __m512 sum0 = _mm512_setzero_ps();
+        __m512 sum1 = _mm512_setzero_ps();
+        __m512 sum2 = _mm512_setzero_ps();
+        __m512 sum3 = _mm512_setzero_ps();
+
+        for(unsigned int d=0; d<pDim; ++d)
+        {
+            const float* coords = pPoints + d * pPointStride + i;
+            __m512 query = _mm512_set1_ps(pQuery[d]);
+            __m512 diff0 = _mm512_sub_ps(_mm512_loadu_ps(coords), query);
+            __m512 diff1 = _mm512_sub_ps(_mm512_loadu_ps(coords + 16), query);
+            __m512 diff2 = _mm512_sub_ps(_mm512_loadu_ps(coords + 32), query);
+            __m512 diff3 = _mm512_sub_ps(_mm512_loadu_ps(coords + 48), query);
+            sum0 = _mm512_fmadd_ps(diff0, diff0, sum0);
+            sum1 = _mm512_fmadd_ps(diff1, diff1, sum1);
+            sum2 = _mm512_fmadd_ps(diff2, diff2, sum2);
+            sum3 = _mm512_fmadd_ps(diff3, diff3, sum3);
+        }
+
+        float* distances = pDistances + i - pBeginIndex;
+        _mm512_storeu_ps(distances, sum0);
+        _mm512_storeu_ps(distances + 16, sum1);
+        _mm512_storeu_ps(distances + 32, sum2);
+        _mm512_storeu_ps(distances + 48, sum3);
+    }
+
+    // remaining points are processed with masked loads and stores
+    for(; i < pEndIndex; i += 16)
+    {
+        unsigned int count = pEndIndex - i < 16 ? pEndIndex - i : 16;
+        __mmask16 mask = static_cast<__mmask16>( ( 1u << count ) - 1u );
+        __m512 sum = _mm512_setzero_ps();
+
+        for(unsigned int d=0; d<pDim; ++d)
+        {
+            __m512 diff = _mm512_sub_ps(_mm512_maskz_loadu_ps(mask, pPoints + d * pPointStride + i), _mm512_set1_ps(pQuery[d]));
+            sum = _mm512_fmadd_ps(diff, diff, sum);
+        }
+
+        _mm512_mask_storeu_ps(pDistances + i - pBeginIndex, mask, sum);
+    }
+}
+
+DAB_SPACE_TARGET_AVX512 void
+dotProductsAVX512(const float* pVector, const float* pPoints, unsigned int pPointStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pProducts)
+{
+    unsigned int i = pBeginIndex;
+
+    for(; i + 64 <= pEndIndex; i += 64)
+    {
+        __m512 sum0 = _mm512_setzero_ps();
+        __m512 sum1 = _mm512_setzero_ps();
+        __m512 sum2 = _mm512_setzero_ps();
+        __m512 sum3 = _mm512_setzero_ps();
+
+        for(unsigned int d=0; d<pDim; ++d)
+        {
+            const float* coords = pPoints + d * pPointStride + i;
+            __m512 value = _mm512_set1_ps(pVector[d]);
+            sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(coords), value, sum0);
+            sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(coords + 16), value, sum1);
+            sum2 = _mm512_fmadd_ps(_mm512_loadu_ps(coords + 32), value, sum2);
+            sum3 = _mm512_fmadd_ps(_mm512_loadu_ps(coords + 48), value, sum3);
+        }
+
+        float* products = pProducts + i - pBeginIndex;
+        _mm512_storeu_ps(products, sum0);
+        _mm512_storeu_ps(products + 16, sum1);
+        _mm512_storeu_ps(products + 32, sum2);
+        _mm512_storeu_ps(products + 48, sum3);
+    }
+
+    for(; i < pEndIndex; i += 16)
+    {
+        unsigned int count = pEndIndex - i < 16 ? pEndIndex - i : 16;
+        __mmask16 mask = static_cast<__mmask16>( ( 1u << count ) - 1u );
+        __m512 sum = _mm512_setzero_ps();
+
+        for(unsigned int d=0; d<pDim; ++d) sum = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, pPoints + d * pPointStride + i), _mm512_set1_ps(pVector[d]), sum);
+
+        _mm512_mask_storeu_ps(pProducts + i - pBeginIndex, mask, sum);
+    }
+}
+
+DAB_SPACE_TARGET_AVX2 void
+closestBoxPointsAVX2(const float* pQuery, const float* pMins, const float* pMaxs, unsigned int pBoxStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDirections, float* pDistances)
+{
+    unsigned int i = pBeginIndex;
+
+    for(; i + 8 <= pEndIndex; i += 8)
+    {
+        __m256 sum = _mm256_setzero_ps();
+
+        for(unsigned int d=0; d<pDim; ++d)
+        {
+            unsigned int offset = d * pBoxStride + i;
+            __m256 query = _mm256_set1_ps(pQuery[d]);
+            __m256 closest = _mm256_min_ps(_mm256_max_ps(query, _mm256_loadu_ps(pMins + offset)), _mm256_loadu_ps(pMaxs + offset));
+            __m256 diff = _mm256_sub_ps(closest, query);
+            _mm256_storeu_ps(pDirections + offset, diff);
+            sum = _mm256_fmadd_ps(diff, diff, sum);
+        }
+
+        _mm256_storeu_ps(pDistances + i - pBeginIndex, _mm256_sqrt_ps(sum));
+    }
+
+    if(i < pEndIndex) closestBoxPointsScalar(pQuery, pMins, pMaxs, pBoxStride, pDim, i, pEndIndex, pDirections, pDistances + i - pBeginIndex);
+}
+
+DAB_SPACE_TARGET_AVX512 void
+closestBoxPointsAVX512(const float* pQuery, const float* pMins, const float* pMaxs, unsigned int pBoxStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDirections, float* pDistances)
+{
+    for(unsigned int i = pBeginIndex; i < pEndIndex; i += 16)
+    {
+        unsigned int count = pEndIndex - i < 16 ? pEndIndex - i : 16;
+        __mmask16 mask = static_cast<__mmask16>( ( 1u << count ) - 1u );
+        __m512 sum = _mm512_setzero_ps();
+
+        for(unsigned int d=0; d<pDim; ++d)
+        {
+            unsigned int offset = d * pBoxStride + i;
+            __m512 query = _mm512_set1_ps(pQuery[d]);
+            __m512 closest = _mm512_min_ps(_mm512_max_ps(query, _mm512_maskz_loadu_ps(mask, pMins + offset)), _mm512_maskz_loadu_ps(mask, pMaxs + offset));
+            __m512 diff = _mm512_sub_ps(closest, query);
+            _mm512_mask_storeu_ps(pDirections + offset, mask, diff);
+            sum = _mm512_fmadd_ps(diff, diff, sum);
+        }
+
+        _mm512_mask_storeu_ps(pDistances + i - pBeginIndex, mask, _mm512_sqrt_ps(sum));
+    }
+}
+
+DAB_SPACE_TARGET_AVX2 void
+triangleDistancesAVX2(const float* pQuery, const float* pTriangles, unsigned int pTriangleStride, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDistances)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 one = _mm256_set1_ps(1.0);
+    const __m256 two = _mm256_set1_ps(2.0);
+    const __m256 queryX = _mm256_set1_ps(pQuery[0]);
+    const __m256 queryY = _mm256_set1_ps(pQuery[1]);
+    const __m256 queryZ = _mm256_set1_ps(pQuery[2]);
+    unsigned int s = pTriangleStride;
+    unsigned int i = pBeginIndex;
+
+    for(; i + 8 <= pEndIndex; i += 8)
+    {
+        const float* t = pTriangles + i;
+
+        __m256 apX = _mm256_sub_ps(queryX, _mm256_loadu_ps(t));
+        __m256 apY = _mm256_sub_ps(queryY, _mm256_loadu_ps(t + s));
+        __m256 apZ = _mm256_sub_ps(queryZ, _mm256_loadu_ps(t + 2 * s));
+        __m256 ap2 = _mm256_fmadd_ps(apZ, apZ, _mm256_fmadd_ps(apY, apY, _mm256_mul_ps(apX, apX)));
+        __m256 d1 = _mm256_fmadd_ps(_mm256_loadu_ps(t + 5 * s), apZ, _mm256_fmadd_ps(_mm256_loadu_ps(t + 4 * s), apY, _mm256_mul_ps(_mm256_loadu_ps(t + 3 * s), apX)));
+        __m256 d2 = _mm256_fmadd_ps(_mm256_loadu_ps(t + 8 * s), apZ, _mm256_fmadd_ps(_mm256_loadu_ps(t + 7 * s), apY, _mm256_mul_ps(_mm256_loadu_ps(t + 6 * s), apX)));
+        __m256 d00 = _mm256_loadu_ps(t + 9 * s);
+        __m256 d01 = _mm256_loadu_ps(t + 10 * s);
+        __m256 d11 = _mm256_loadu_ps(t + 11 * s);
+        __m256 invDen = _mm256_loadu_ps(t + 15 * s);
+
+        // projection onto triangle plane, unnormalized barycentric coordinates
+        __m256 v = _mm256_fmsub_ps(d11, d1, _mm256_mul_ps(d01, d2));
+        __m256 w = _mm256_fmsub_ps(d00, d2, _mm256_mul_ps(d01, d1));
+        __m256 den = _mm256_fmsub_ps(d00, d11, _mm256_mul_ps(d01, d01));
+        __m256 inside = _mm256_and_ps( _mm256_and_ps( _mm256_cmp_ps(invDen, zero, _CMP_GT_OQ), _mm256_cmp_ps(v, zero, _CMP_GE_OQ) ), _mm256_and_ps( _mm256_cmp_ps(w, zero, _CMP_GE_OQ), _mm256_cmp_ps(_mm256_add_ps(v, w), den, _CMP_LE_OQ) ) );
+        __m256 planeDistance = _mm256_fnmadd_ps(_mm256_fmadd_ps(v, d1, _mm256_mul_ps(w, d2)), invDen, ap2);
+
+        // edges ab, ac and bc
+        __m256 tAB = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(d1, _mm256_loadu_ps(t + 12 * s)), zero), one);
+        __m256 tAC = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(d2, _mm256_loadu_ps(t + 13 * s)), zero), one);
+        __m256 e = _mm256_add_ps(_mm256_sub_ps(_mm256_sub_ps(d2, d1), d01), d00);
+        __m256 bc2 = _mm256_fnmadd_ps(two, d01, _mm256_add_ps(d00, d11));
+        __m256 tBC = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(e, _mm256_loadu_ps(t + 14 * s)), zero), one);
+        __m256 bp2 = _mm256_add_ps(_mm256_fnmadd_ps(two, d1, ap2), d00);
+        __m256 edgeDistance = _mm256_fnmadd_ps(tAB, _mm256_fnmadd_ps(tAB, d00, _mm256_mul_ps(two, d1)), ap2);
+        edgeDistance = _mm256_min_ps(edgeDistance, _mm256_fnmadd_ps(tAC, _mm256_fnmadd_ps(tAC, d11, _mm256_mul_ps(two, d2)), ap2));
+        edgeDistance = _mm256_min_ps(edgeDistance, _mm256_fnmadd_ps(tBC, _mm256_fnmadd_ps(tBC, bc2, _mm256_mul_ps(two, e)), bp2));
+
+        _mm256_storeu_ps(pDistances + i - pBeginIndex, _mm256_max_ps(_mm256_blendv_ps(edgeDistance, planeDistance, inside), zero));
+    }
+
+    if(i < pEndIndex) triangleDistancesScalar(pQuery, pTriangles, pTriangleStride, i, pEndIndex, pDistances + i - pBeginIndex);
+}
+
+DAB_SPACE_TARGET_AVX512 void
+triangleDistancesAVX512(const float* pQuery, const float* pTriangles, unsigned int pTriangleStride, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDistances)
+{
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 one = _mm512_set1_ps(1.0);
+    const __m512 two = _mm512_set1_ps(2.0);
+    const __m512 queryX = _mm512_set1_ps(pQuery[0]);
+    const __m512 queryY = _mm512_set1_ps(pQuery[1]);
+    const __m512 queryZ = _mm512_set1_ps(pQuery[2]);
+    unsigned int s = pTriangleStride;
+
+    for(unsigned int i = pBeginIndex; i < pEndIndex; i += 16)
+    {
+        unsigned int count = pEndIndex - i < 16 ? pEndIndex - i : 16;
+        __mmask16 mask = static_cast<__mmask16>( ( 1u << count ) - 1u );
+        const float* t = pTriangles + i;
+
+        __m512 apX = _mm512_sub_ps(queryX, _mm512_maskz_loadu_ps(mask, t));
+        __m512 apY = _mm512_sub_ps(queryY, _mm512_maskz_loadu_ps(mask, t + s));
+        __m512 apZ = _mm512_sub_ps(queryZ, _mm512_maskz_loadu_ps(mask, t + 2 * s));
+        __m512 ap2 = _mm512_fmadd_ps(apZ, apZ, _mm512_fmadd_ps(apY, apY, _mm512_mul_ps(apX, apX)));
+        __m512 d1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, t + 5 * s), apZ, _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, t + 4 * s), apY, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, t + 3 * s), apX)));
+        __m512 d2 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, t + 8 * s), apZ, _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, t + 7 * s), apY, _mm512_mul_ps(_mm512_maskz_loadu_ps(mask, t + 6 * s), apX)));
+        __m512 d00 = _mm512_maskz_loadu_ps(mask, t + 9 * s);
+        __m512 d01 = _mm512_maskz_loadu_ps(mask, t + 10 * s);
+        __m512 d11 = _mm512_maskz_loadu_ps(mask, t + 11 * s);
+        __m512 invDen = _mm512_maskz_loadu_ps(mask, t + 15 * s);
+
+        // projection onto triangle plane, unnormalized barycentric coordinates
+        __m512 v = _mm512_fmsub_ps(d11, d1, _mm512_mul_ps(d01, d2));
+        __m512 w = _mm512_fmsub_ps(d00, d2, _mm512_mul_ps(d01, d1));
+        __m512 den = _mm512_fmsub_ps(d00, d11, _mm512_mul_ps(d01, d01));
+        __mmask16 inside = _mm512_cmp_ps_mask(invDen, zero, _CMP_GT_OQ);
+        inside = _mm512_mask_cmp_ps_mask(inside, v, zero, _CMP_GE_OQ);
+        inside = _mm512_mask_cmp_ps_mask(inside, w, zero, _CMP_GE_OQ);
+        inside = _mm512_mask_cmp_ps_mask(inside, _mm512_add_ps(v, w), den, _CMP_LE_OQ);
+        __m512 planeDistance = _mm512_fnmadd_ps(_mm512_fmadd_ps(v, d1, _mm512_mul_ps(w, d2)), invDen, ap2);
+
+        // edges ab, ac and bc
+        __m512 tAB = _mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(d1, _mm512_maskz_loadu_ps(mask, t + 12 * s)), zero), one);
+        __m512 tAC = _mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(d2, _mm512_maskz_loadu_ps(mask, t + 13 * s)), zero), one);
+        __m512 e = _mm512_add_ps(_mm512_sub_ps(_mm512_sub_ps(d2, d1), d01), d00);
+        __m512 bc2 = _mm512_fnmadd_ps(two, d01, _mm512_add_ps(d00, d11));
+        __m512 tBC = _mm512_min_ps(_mm512_max_ps(_mm512_mul_ps(e, _mm512_maskz_loadu_ps(mask, t + 14 * s)), zero), one);
+        __m512 bp2 = _mm512_add_ps(_mm512_fnmadd_ps(two, d1, ap2), d00);
+        __m512 edgeDistance = _mm512_fnmadd_ps(tAB, _mm512_fnmadd_ps(tAB, d00, _mm512_mul_ps(two, d1)), ap2);
+        edgeDistance = _mm512_min_ps(edgeDistance, _mm512_fnmadd_ps(tAC, _mm512_fnmadd_ps(tAC, d11, _mm512_mul_ps(two, d2)), ap2));
+        edgeDistance = _mm512_min_ps(edgeDistance, _mm512_fnmadd_ps(tBC, _mm512_fnmadd_ps(tBC, bc2, _mm512_mul_ps(two, e)), bp2));
+
+        _mm512_mask_storeu_ps(pDistances + i - pBeginIndex, mask, _mm512_max_ps(_mm512_mask_blend_ps(inside, edgeDistance, planeDistance), zero));
+    }
+}
+
+#endif
+
+SpaceSimdTools::InstructionSet
+detectInstructionSet()
+{
+#if defined(DAB_SPACE_SIMD_X86)
+#if defined(_MSC_VER) && !defined(__clang__)
+    int cpuInfo[4];
+
+    __cpuid(cpuInfo, 0);
+    if(cpuInfo[0] < 7) return SpaceSimdTools::ScalarInstructionSet;
+
+    // operating system has to save the extended registers
+    __cpuid(cpuInfo, 1);
+    bool osxsave = ( cpuInfo[2] & ( 1 << 27 ) ) != 0;
+    bool fma = ( cpuInfo[2] & ( 1 << 12 ) ) != 0;
+    if(osxsave == false) return SpaceSimdTools::ScalarInstructionSet;
+
+    unsigned long long xcr0 = _xgetbv(0);
+    bool ymmState = ( xcr0 & 0x6 ) == 0x6;
+    bool zmmState = ( xcr0 & 0xe6 ) == 0xe6;
+
+    __cpuidex(cpuInfo, 7, 0);
+    bool avx2 = ( cpuInfo[1] & ( 1 << 5 ) ) != 0;
+    bool avx512 = ( cpuInfo[1] & ( 1 << 16 ) ) != 0;
+
+    if(avx512 == true && zmmState == true) return SpaceSimdTools::AVX512InstructionSet;
+    if(avx2 == true && fma == true && ymmState == true) return SpaceSimdTools::AVX2InstructionSet;
+#else
+    __builtin_cpu_init();
+
+    if(__builtin_cpu_supports("avx512f")) return SpaceSimdTools::AVX512InstructionSet;
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SpaceSimdTools::AVX2InstructionSet;
+#endif
+#endif
+
+    return SpaceSimdTools::ScalarInstructionSet;
+}
+
+}
+
+SpaceSimdTools::SpaceSimdTools()
+: mSupportedInstructionSet(detectInstructionSet())
+{
+    setInstructionSet(mSupportedInstructionSet);
+}
+
+SpaceSimdTools::~SpaceSimdTools()
+{}
+
+unsigned int
+SpaceSimdTools::pointStride(unsigned int pPointCount)
+{
+    return ( ( pPointCount + sPointAlignment - 1 ) / sPointAlignment ) * sPointAlignment;
+}
+
+void
+SpaceSimdTools::packTriangle(const float* pA, const float* pB, const float* pC, float* pTriangles, unsigned int pTriangleStride, unsigned int pIndex)
+{
+    float ab[3] = { pB[0] - pA[0], pB[1] - pA[1], pB[2] - pA[2] };
+    float ac[3] = { pC[0] - pA[0], pC[1] - pA[1], pC[2] - pA[2] };
+    float d00 = ab[0] * ab[0] + ab[1] * ab[1] + ab[2] * ab[2];
+    float d01 = ab[0] * ac[0] + ab[1] * ac[1] + ab[2] * ac[2];
+    float d11 = ac[0] * ac[0] + ac[1] * ac[1] + ac[2] * ac[2];
+    float bc2 = d00 + d11 - 2.0f * d01;
+    float den = d00 * d11 - d01 * d01;
+
+    // zero reciprocals disable the plane test for degenerate triangles and collapse degenerate edges to their start vertex
+    float components[16] =
+    {
+        pA[0], pA[1], pA[2],
+        ab[0], ab[1], ab[2],
+        ac[0], ac[1], ac[2],
+        d00, d01, d11,
+        d00 > 0.0f ? 1.0f / d00 : 0.0f,
+        d11 > 0.0f ? 1.0f / d11 : 0.0f,
+        bc2 > 0.0f ? 1.0f / bc2 : 0.0f,
+        den > 1.0e-6f * d00 * d11 ? 1.0f / den : 0.0f
+    };
+
+    for(unsigned int c=0; c<sTriangleComponentCount; ++c) pTriangles[ c * pTriangleStride + pIndex ] = components[c];
+}
+
+SpaceSimdTools::InstructionSet
+SpaceSimdTools::supportedInstructionSet() const
+{
+    return mSupportedInstructionSet;
+}
+
+SpaceSimdTools::InstructionSet
+SpaceSimdTools::instructionSet() const
+{
+    return mInstructionSet;
+}
+
+void
+SpaceSimdTools::setInstructionSet(InstructionSet pInstructionSet) throw (Exception)
+{
+    if(pInstructionSet > mSupportedInstructionSet) throw Exception("SPACE ERROR: instruction set " + instructionSetName(pInstructionSet) + " not supported by cpu", __FILE__, __FUNCTION__, __LINE__);
+
+    mInstructionSet = pInstructionSet;
+
+    switch(mInstructionSet)
+    {
+#ifdef DAB_SPACE_SIMD_X86
+        case AVX512InstructionSet:
+            mSquaredDistanceKernel = squaredDistancesAVX512;
+            mDotProductKernel = dotProductsAVX512;
+            mVectorDistanceKernel = vectorDistanceAVX512;
+            mClosestBoxPointKernel = closestBoxPointsAVX512;
+            mTriangleDistanceKernel = triangleDistancesAVX512;
+            break;
+        case AVX2InstructionSet:
+            mSquaredDistanceKernel = squaredDistancesAVX2;
+            mDotProductKernel = dotProductsAVX2;
+            mVectorDistanceKernel = vectorDistanceAVX2;
+            mClosestBoxPointKernel = closestBoxPointsAVX2;
+            mTriangleDistanceKernel = triangleDistancesAVX2;
+            break;
+#endif
+        default:
+            mSquaredDistanceKernel = squaredDistancesScalar;
+            mDotProductKernel = dotProductsScalar;
+            mVectorDistanceKernel = vectorDistanceScalar;
+            mClosestBoxPointKernel = closestBoxPointsScalar;
+            mTriangleDistanceKernel = triangleDistancesScalar;
+    }
+}
+
+std::string
+SpaceSimdTools::instructionSetName(InstructionSet pInstructionSet) const
+{
+    switch(pInstructionSet)
+    {
+        case AVX512InstructionSet:
+            return "AVX512";
+        case AVX2InstructionSet:
+            return "AVX2";
+        default:
+            return "Scalar";
+    }
+}
+
+void
+SpaceSimdTools::squaredDistances(const float* pQuery, const float* pPoints, unsigned int pPointStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDistances) const
+{
+    mSquaredDistanceKernel(pQuery, pPoints, pPointStride, pDim, pBeginIndex, pEndIndex, pDistances);
+}
+
+void
+SpaceSimdTools::dotProducts(const float* pVector, const float* pPoints, unsigned int pPointStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pProducts) const
+{
+    mDotProductKernel(pVector, pPoints, pPointStride, pDim, pBeginIndex, pEndIndex, pProducts);
+}
+
+float
+SpaceSimdTools::squaredDistance(const float* pVector1, const float* pVector2, unsigned int pDim) const
+{
+    return mVectorDistanceKernel(pVector1, pVector2, pDim);
+}
+
+void
+SpaceSimdTools::closestBoxPoints(const float* pQuery, const float* pMins, const float* pMaxs, unsigned int pBoxStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDirections, float* pDistances) const
+{
+    mClosestBoxPointKernel(pQuery, pMins, pMaxs, pBoxStride, pDim, pBeginIndex, pEndIndex, pDirections, pDistances);
+}
+
+void
+SpaceSimdTools::triangleSquaredDistances(const float* pQuery, const float* pTriangles, unsigned int pTriangleStride, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDistances) const
+{
+    mTriangleDistanceKernel(pQuery, pTriangles, pTriangleStride, pBeginIndex, pEndIndex, pDistances);
+}
+
+SpaceSimdTools::operator std::string() const
+{
+    return info();
+}
+
+std::string
+SpaceSimdTools::info() const
+{
+    std::stringstream stream;
+
+    stream << "supported instruction set: " << instructionSetName(mSupportedInstructionSet) << "\n";
+    stream << "instruction set: " << instructionSetName(mInstructionSet) << "\n";
+
+    return stream.str();
+}
@@ -0,0 +1,195 @@
+/** \file dab_space_simd.h
+ */
+
+#ifndef _dab_space_simd_h_
+#define _dab_space_simd_h_
+
+#include <iostream>
+#include "dab_exception.h"
+#include "dab_singleton.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+/**
+ \brief vectorized distance kernels
+
+ kernels operate on packed position buffers that store positions dimension by dimension:\n
+ coordinate d of point i is located at pPoints[ d * pPointStride + i ].\n
+ this layout allows the kernels to process several points per instruction independent of space dimension.\n
+ the instruction set is chosen at runtime depending on the capabilities of the cpu.
+ */
+class SpaceSimdTools : public Singleton<SpaceSimdTools>
+{
+friend class Singleton<SpaceSimdTools>;
+
+public:
+    enum InstructionSet
+    {
+        ScalarInstructionSet,
+        AVX2InstructionSet,
+        AVX512InstructionSet
+    };
+
+    static const unsigned int sPointAlignment; ///\brief number of points by which the stride of a packed position buffer should be divisible
+
+    /**
+     \brief return stride of packed position buffer
+     \param pPointCount number of points
+     \return point count rounded up to point alignment
+     */
+    static unsigned int pointStride(unsigned int pPointCount);
+
+    static const unsigned int sTriangleComponentCount; ///\brief number of values stored per triangle in a packed triangle buffer
+
+    /**
+     \brief store triangle in packed triangle buffer
+     \param pA first vertex (3 values)
+     \param pB second vertex (3 values)
+     \param pC third vertex (3 values)
+     \param pTriangles packed triangle buffer (sTriangleComponentCount * pTriangleStride values)
+     \param pTriangleStride stride of packed triangle buffer
+     \param pIndex triangle index
+
+     besides the first vertex and the two edges leaving it, the buffer holds the edge products and reciprocals the distance kernel would otherwise recompute for every query
+     */
+    static void packTriangle(const float* pA, const float* pB, const float* pC, float* pTriangles, unsigned int pTriangleStride, unsigned int pIndex);
+
+    /**
+     \brief return most capable instruction set supported by the cpu
+     \return instruction set
+     */
+    InstructionSet supportedInstructionSet() const;
+
+    /**
+     \brief return instruction set used by kernels
+     \return instruction set
+     */
+    InstructionSet instructionSet() const;
+
+    /**
+     \brief set instruction set used by kernels
+     \param pInstructionSet instruction set
+     \exception Exception instruction set not supported by cpu
+     */
+    void setInstructionSet(InstructionSet pInstructionSet) throw (Exception);
+
+    /**
+     \brief return name of instruction set
+     \param pInstructionSet instruction set
+     \return name
+     */
+    std::string instructionSetName(InstructionSet pInstructionSet) const;
+
+    /**
+     \brief calculate squared distances between a query position and a range of points
+     \param pQuery query position (pDim values)
+     \param pPoints packed position buffer
+     \param pPointStride stride of packed position buffer
+     \param pDim dimension
+     \param pBeginIndex index of first point
+     \param pEndIndex index after last point
+     \param pDistances resulting squared distances (pEndIndex - pBeginIndex values)
+     */
+    void squaredDistances(const float* pQuery, const float* pPoints, unsigned int pPointStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDistances) const;
+
+    /**
+     \brief calculate dot products between a vector and a range of points
+     \param pVector vector (pDim values)
+     \param pPoints packed position buffer
+     \param pPointStride stride of packed position buffer
+     \param pDim dimension
+     \param pBeginIndex index of first point
+     \param pEndIndex index after last point
+     \param pProducts resulting dot products (pEndIndex - pBeginIndex values)
+     */
+    void dotProducts(const float* pVector, const float* pPoints, unsigned int pPointStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pProducts) const;
+
+    /**
+     \brief calculate squared distance between two vectors stored contiguously
+     \param pVector1 first vector (pDim values)
+     \param pVector2 second vector (pDim values)
+     \param pDim dimension
+     \return squared distance
+
+     suited for high dimensional vectors, since the kernel processes several dimensions per instruction
+     */
+    float squaredDistance(const float* pVector1, const float* pVector2, unsigned int pDim) const;
+
+    /**
+     \brief calculate closest points of a query position on a range of axis aligned boxes
+     \param pQuery query position (pDim values)
+     \param pMins packed buffer of minimum box corners
+     \param pMaxs packed buffer of maximum box corners
+     \param pBoxStride stride of packed box buffers
+     \param pDim dimension
+     \param pBeginIndex index of first box
+     \param pEndIndex index after last box
+     \param pDirections packed buffer of resulting directions from query position to closest points (same layout and stride as box buffers)
+     \param pDistances resulting distances (pEndIndex - pBeginIndex values)
+
+     closest points are obtained by clamping the query position to the boxes, a query position inside a box is its own closest point
+     */
+    void closestBoxPoints(const float* pQuery, const float* pMins, const float* pMaxs, unsigned int pBoxStride, unsigned int pDim, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDirections, float* pDistances) const;
+
+    /**
+     \brief calculate squared distances between a three dimensional query position and a range of triangles
+     \param pQuery query position (3 values)
+     \param pTriangles packed triangle buffer filled by packTriangle
+     \param pTriangleStride stride of packed triangle buffer
+     \param pBeginIndex index of first triangle
+     \param pEndIndex index after last triangle
+     \param pDistances resulting squared distances (pEndIndex - pBeginIndex values)
+
+     the kernel is branchless: a query position whose projection falls inside a triangle takes its distance to the triangle plane, any other the smallest distance to the three edges. degenerate triangles are measured by their edges only.
+     */
+    void triangleSquaredDistances(const float* pQuery, const float* pTriangles, unsigned int pTriangleStride, unsigned int pBeginIndex, unsigned int pEndIndex, float* pDistances) const;
+
+    /**
+     \brief print simd information
+     */
+    operator std::string() const;
+
+    /**
+     \brief print simd information
+     */
+    std::string info() const;
+
+    /**
+     \brief retrieve textual simd info
+     \param pOstream output text stream
+     \param pTools simd tools
+     */
+    friend std::ostream& operator << ( std::ostream& pOstream, const SpaceSimdTools& pTools )
+    {
+        pOstream << pTools.info();
+
+        return pOstream;
+    };
+
+protected:
+    typedef void (*Kernel)(const float*, const float*, unsigned int, unsigned int, unsigned int, unsigned int, float*);
+    typedef float (*VectorKernel)(const float*, const float*, unsigned int);
+    typedef void (*BoxKernel)(const float*, const float*, const float*, unsigned int, unsigned int, unsigned int, unsigned int, float*, float*);
+    typedef void (*TriangleKernel)(const float*, const float*, unsigned int, unsigned int, unsigned int, float*);
+
+    SpaceSimdTools();
+    ~SpaceSimdTools();
+
+    InstructionSet mSupportedInstructionSet; ///\brief most capable instruction set supported by cpu
+    InstructionSet mInstructionSet; ///\brief instruction set used by kernels
+    Kernel mSquaredDistanceKernel; ///\brief squared distance kernel for current instruction set
+    Kernel mDotProductKernel; ///\brief dot product kernel for current instruction set
+    VectorKernel mVectorDistanceKernel; ///\brief squared distance kernel for contiguous vectors for current instruction set
+    BoxKernel mClosestBoxPointKernel; ///\brief box closest point kernel for current instruction set
+    TriangleKernel mTriangleDistanceKernel; ///\brief triangle distance kernel for current instruction set
+};
+
+};
+
+};
+
+#endif
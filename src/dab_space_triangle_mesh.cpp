@@ -0,0 +1,404 @@
+/** \file dab_space_triangle_mesh.cpp
+ */
+
+#include "dab_space_triangle_mesh.h"
+#include "dab_space_simd.h"
+#include "dab_geom_mesh.h"
+#include <limits>
+#include <numeric>
+
+using namespace dab;
+using namespace dab::space;
+
+const unsigned int SpaceTriangleMesh::sMaxLocalSteps = 8;
+const unsigned int SpaceTriangleMesh::sMaxLeafTriangles;
+const unsigned int SpaceTriangleMesh::sMaxTraversalDepth;
+std::mutex SpaceTriangleMesh::sMutex;
+std::unordered_map<const geom::Geometry*, SpaceTriangleMesh::Entry> SpaceTriangleMesh::sEntries;
+
+std::shared_ptr<SpaceTriangleMesh>
+SpaceTriangleMesh::create(const std::shared_ptr<geom::Geometry>& pGeometry, bool pRebuild)
+{
+    const geom::Mesh* mesh = dynamic_cast<const geom::Mesh*>(pGeometry.get());
+
+    if(mesh == nullptr) return nullptr;
+
+    std::lock_guard<std::mutex> lock(sMutex);
+
+    auto entryIter = sEntries.find(pGeometry.get());
+
+    if(pRebuild == false && entryIter != sEntries.end() && entryIter->second.mGeometry.lock() == pGeometry)
+    {
+        std::shared_ptr<SpaceTriangleMesh> triangleMesh = entryIter->second.mTriangleMesh.lock();
+
+        if(triangleMesh != nullptr) return triangleMesh;
+    }
+
+    std::shared_ptr<SpaceTriangleMesh> triangleMesh( new SpaceTriangleMesh( mesh->vertices(), mesh->indices() ) );
+
+    if(triangleMesh->triangleCount() == 0) triangleMesh = nullptr;
+
+    // forget triangle meshes no shape holds anymore
+    for(auto iter = sEntries.begin(); iter != sEntries.end(); )
+    {
+        if(iter->second.mGeometry.expired() == true || iter->second.mTriangleMesh.expired() == true) iter = sEntries.erase(iter);
+        else ++iter;
+    }
+
+    if(triangleMesh != nullptr) sEntries[pGeometry.get()] = { pGeometry, triangleMesh };
+
+    return triangleMesh;
+}
+
+SpaceTriangleMesh::SpaceTriangleMesh()
+: mPackedTriangleStride(0)
+{}
+
+SpaceTriangleMesh::SpaceTriangleMesh(const std::vector<glm::vec3>& pVertices, const std::vector<unsigned int>& pIndices)
+: mVertices(pVertices)
+, mIndices(pIndices)
+, mPackedTriangleStride(0)
+{
+    unsigned int vertexCount = mVertices.size();
+
+    if(mIndices.empty() == true)
+    {
+        for(unsigned int vI=0; vI + 2 < vertexCount; vI += 3) mIndices.insert( mIndices.end(), { vI, vI + 1, vI + 2 } );
+    }
+
+    // drop incomplete and invalid triangles
+    unsigned int triangleCount = 0;
+
+    for(unsigned int tI=0; tI + 2 < mIndices.size(); tI += 3)
+    {
+        if(mIndices[tI] >= vertexCount || mIndices[tI + 1] >= vertexCount || mIndices[tI + 2] >= vertexCount) continue;
+
+        std::copy(mIndices.begin() + tI, mIndices.begin() + tI + 3, mIndices.begin() + triangleCount * 3);
+        triangleCount++;
+    }
+
+    mIndices.resize(triangleCount * 3);
+
+    // triangles sharing each vertex
+    mVertexTriangleOffsets.assign(vertexCount + 1, 0);
+
+    for(unsigned int index : mIndices) mVertexTriangleOffsets[index + 1]++;
+    for(unsigned int vI=0; vI<vertexCount; ++vI) mVertexTriangleOffsets[vI + 1] += mVertexTriangleOffsets[vI];
+
+    std::vector<unsigned int> positions(mVertexTriangleOffsets.begin(), mVertexTriangleOffsets.end() - 1);
+    mVertexTriangles.resize(mIndices.size());
+
+    for(unsigned int iI=0; iI<mIndices.size(); ++iI) mVertexTriangles[ positions[ mIndices[iI] ]++ ] = iI / 3;
+
+    buildHierarchy();
+}
+
+void
+SpaceTriangleMesh::buildHierarchy()
+{
+    unsigned int triangleCount = mIndices.size() / 3;
+
+    if(triangleCount == 0) return;
+
+    std::vector<glm::vec3> centroids(triangleCount);
+
+    for(unsigned int tI=0; tI<triangleCount; ++tI) centroids[tI] = ( mVertices[ mIndices[tI * 3] ] + mVertices[ mIndices[tI * 3 + 1] ] + mVertices[ mIndices[tI * 3 + 2] ] ) / 3.0f;
+
+    mTriangleOrder.resize(triangleCount);
+    std::iota(mTriangleOrder.begin(), mTriangleOrder.end(), 0);
+
+    mNodes.clear();
+    mNodes.reserve( 2 * ( triangleCount / sMaxLeafTriangles + 1 ) );
+    mNodes.push_back(Node());
+    buildNode(0, 0, triangleCount, centroids);
+
+    // pack triangles in hierarchy order, so that the triangles of each leaf are adjacent
+    mPackedTriangleStride = SpaceSimdTools::pointStride(triangleCount);
+    mPackedTriangles.assign(SpaceSimdTools::sTriangleComponentCount * mPackedTriangleStride, 0.0);
+
+    for(unsigned int pI=0; pI<triangleCount; ++pI)
+    {
+        unsigned int triangle = mTriangleOrder[pI];
+
+        SpaceSimdTools::packTriangle( &mVertices[ mIndices[triangle * 3] ].x, &mVertices[ mIndices[triangle * 3 + 1] ].x, &mVertices[ mIndices[triangle * 3 + 2] ].x, mPackedTriangles.data(), mPackedTriangleStride, pI );
+    }
+}
+
+void
+SpaceTriangleMesh::buildNode(unsigned int pNode, unsigned int pFirst, unsigned int pCount, const std::vector<glm::vec3>& pCentroids)
+{
+    glm::vec3 minPos( std::numeric_limits<float>::max() );
+    glm::vec3 maxPos( std::numeric_limits<float>::lowest() );
+    glm::vec3 centroidMinPos( std::numeric_limits<float>::max() );
+    glm::vec3 centroidMaxPos( std::numeric_limits<float>::lowest() );
+
+    for(unsigned int pI=pFirst; pI<pFirst + pCount; ++pI)
+    {
+        unsigned int triangle = mTriangleOrder[pI];
+
+        for(int vI=0; vI<3; ++vI)
+        {
+            minPos = glm::min( minPos, mVertices[ mIndices[triangle * 3 + vI] ] );
+            maxPos = glm::max( maxPos, mVertices[ mIndices[triangle * 3 + vI] ] );
+        }
+
+        centroidMinPos = glm::min( centroidMinPos, pCentroids[triangle] );
+        centroidMaxPos = glm::max( centroidMaxPos, pCentroids[triangle] );
+    }
+
+    Node& node = mNodes[pNode];
+
+    for(int d=0; d<3; ++d)
+    {
+        node.mMin[d] = minPos[d];
+        node.mMax[d] = maxPos[d];
+    }
+
+    if(pCount <= sMaxLeafTriangles)
+    {
+        node.mFirst = pFirst;
+        node.mCount = pCount;
+
+        return;
+    }
+
+    glm::vec3 extent = centroidMaxPos - centroidMinPos;
+    int axis = 0;
+
+    if(extent[1] > extent[axis]) axis = 1;
+    if(extent[2] > extent[axis]) axis = 2;
+
+    unsigned int firstCount = pCount / 2;
+
+    std::nth_element( mTriangleOrder.begin() + pFirst, mTriangleOrder.begin() + pFirst + firstCount, mTriangleOrder.begin() + pFirst + pCount, [&pCentroids, axis](unsigned int pTriangle1, unsigned int pTriangle2) { return pCentroids[pTriangle1][axis] < pCentroids[pTriangle2][axis]; } );
+
+    unsigned int children = mNodes.size();
+
+    node.mFirst = children;
+    node.mCount = 0;
+
+    // node is invalidated by growing mNodes
+    mNodes.push_back(Node());
+    mNodes.push_back(Node());
+
+    buildNode(children, pFirst, firstCount, pCentroids);
+    buildNode(children + 1, pFirst + firstCount, pCount - firstCount, pCentroids);
+}
+
+unsigned int
+SpaceTriangleMesh::triangleCount() const
+{
+    return mIndices.size() / 3;
+}
+
+glm::vec3
+SpaceTriangleMesh::minPos() const
+{
+    return glm::vec3( mNodes[0].mMin[0], mNodes[0].mMin[1], mNodes[0].mMin[2] );
+}
+
+glm::vec3
+SpaceTriangleMesh::maxPos() const
+{
+    return glm::vec3( mNodes[0].mMax[0], mNodes[0].mMax[1], mNodes[0].mMax[2] );
+}
+
+glm::vec3
+SpaceTriangleMesh::triangleNormal(unsigned int pTriangle) const
+{
+    const glm::vec3& a = mVertices[ mIndices[pTriangle * 3] ];
+
+    return glm::cross( mVertices[ mIndices[pTriangle * 3 + 1] ] - a, mVertices[ mIndices[pTriangle * 3 + 2] ] - a );
+}
+
+float
+SpaceTriangleMesh::closestTrianglePoint(unsigned int pTriangle, const glm::vec3& pPoint, glm::vec3& pClosestPoint) const
+{
+    // region based closest point on triangle (Ericson, Real-Time Collision Detection, 5.1.5)
+    const glm::vec3& a = mVertices[ mIndices[pTriangle * 3] ];
+    const glm::vec3& b = mVertices[ mIndices[pTriangle * 3 + 1] ];
+    const glm::vec3& c = mVertices[ mIndices[pTriangle * 3 + 2] ];
+
+    glm::vec3 ab = b - a;
+    glm::vec3 ac = c - a;
+    glm::vec3 ap = pPoint - a;
+
+    float d1 = glm::dot(ab, ap);
+    float d2 = glm::dot(ac, ap);
+
+    if(d1 <= 0.0 && d2 <= 0.0)
+    {
+        pClosestPoint = a;
+    }
+    else
+    {
+        glm::vec3 bp = pPoint - b;
+        float d3 = glm::dot(ab, bp);
+        float d4 = glm::dot(ac, bp);
+
+        glm::vec3 cp = pPoint - c;
+        float d5 = glm::dot(ab, cp);
+        float d6 = glm::dot(ac, cp);
+
+        float vc = d1 * d4 - d3 * d2;
+        float vb = d5 * d2 - d1 * d6;
+        float va = d3 * d6 - d5 * d4;
+
+        // edge regions require a non zero edge length, so that degenerate edges fall through to the remaining regions
+        if(d3 >= 0.0 && d4 <= d3) pClosestPoint = b;
+        else if(d6 >= 0.0 && d5 <= d6) pClosestPoint = c;
+        else if(vc <= 0.0 && d1 >= 0.0 && d3 <= 0.0 && d1 > d3) pClosestPoint = a + ab * ( d1 / (d1 - d3) );
+        else if(vb <= 0.0 && d2 >= 0.0 && d6 <= 0.0 && d2 > d6) pClosestPoint = a + ac * ( d2 / (d2 - d6) );
+        else if(va <= 0.0 && (d4 - d3) >= 0.0 && (d5 - d6) >= 0.0 && (d4 - d3) + (d5 - d6) > 0.0) pClosestPoint = b + (c - b) * ( (d4 - d3) / ( (d4 - d3) + (d5 - d6) ) );
+        else if(va + vb + vc > 0.0)
+        {
+            float denom = 1.0 / (va + vb + vc);
+            pClosestPoint = a + ab * (vb * denom) + ac * (vc * denom);
+        }
+        else
+        {
+            // collinear vertices, closest point on the longest edge
+            glm::vec3 bc = c - b;
+            float ab2 = glm::dot(ab, ab);
+            float ac2 = glm::dot(ac, ac);
+            float bc2 = glm::dot(bc, bc);
+
+            if(ab2 >= ac2 && ab2 >= bc2) pClosestPoint = a + ab * glm::clamp( d1 / ab2, 0.0f, 1.0f );
+            else if(ac2 >= bc2) pClosestPoint = a + ac * glm::clamp( d2 / ac2, 0.0f, 1.0f );
+            else pClosestPoint = b + bc * glm::clamp( glm::dot(bc, bp) / bc2, 0.0f, 1.0f );
+        }
+    }
+
+    glm::vec3 offset = pClosestPoint - pPoint;
+
+    return glm::dot(offset, offset);
+}
+
+unsigned int
+SpaceTriangleMesh::closestPoint(const glm::vec3& pPoint, glm::vec3& pClosestPoint) const
+{
+    unsigned int triangle = closestTriangle(pPoint, mTriangleOrder[0], std::numeric_limits<float>::max());
+    closestTrianglePoint(triangle, pPoint, pClosestPoint);
+
+    return triangle;
+}
+
+unsigned int
+SpaceTriangleMesh::closestPoint(const glm::vec3& pPoint, unsigned int pStartTriangle, glm::vec3& pClosestPoint) const
+{
+    unsigned int localTriangle = localClosestPoint(pPoint, pStartTriangle, pClosestPoint);
+    glm::vec3 offset = pClosestPoint - pPoint;
+    unsigned int triangle = closestTriangle(pPoint, localTriangle, glm::dot(offset, offset));
+
+    if(triangle != localTriangle) closestTrianglePoint(triangle, pPoint, pClosestPoint);
+
+    return triangle;
+}
+
+unsigned int
+SpaceTriangleMesh::closestTriangle(const glm::vec3& pPoint, unsigned int pTriangle, float pSquaredDistance) const
+{
+    const SpaceSimdTools& simdTools = SpaceSimdTools::get();
+    float query[3] = { pPoint.x, pPoint.y, pPoint.z };
+    float distances[sMaxLeafTriangles];
+    unsigned int nodeStack[sMaxTraversalDepth];
+    float distanceStack[sMaxTraversalDepth];
+    unsigned int stackSize = 1;
+    unsigned int triangle = pTriangle;
+    float closestDistance = pSquaredDistance;
+
+    nodeStack[0] = 0;
+    distanceStack[0] = boxSquaredDistance(mNodes[0], pPoint);
+
+    while(stackSize > 0)
+    {
+        stackSize--;
+
+        if(distanceStack[stackSize] >= closestDistance) continue;
+
+        const Node& node = mNodes[ nodeStack[stackSize] ];
+
+        if(node.mCount > 0)
+        {
+            simdTools.triangleSquaredDistances(query, mPackedTriangles.data(), mPackedTriangleStride, node.mFirst, node.mFirst + node.mCount, distances);
+
+            for(unsigned int tI=0; tI<node.mCount; ++tI)
+            {
+                if(distances[tI] < closestDistance)
+                {
+                    closestDistance = distances[tI];
+                    triangle = mTriangleOrder[node.mFirst + tI];
+                }
+            }
+
+            continue;
+        }
+
+        // push farther child first so that the nearer child is visited next
+        unsigned int nearChild = node.mFirst;
+        unsigned int farChild = node.mFirst + 1;
+        float nearDistance = boxSquaredDistance(mNodes[nearChild], pPoint);
+        float farDistance = boxSquaredDistance(mNodes[farChild], pPoint);
+
+        if(farDistance < nearDistance)
+        {
+            std::swap(nearChild, farChild);
+            std::swap(nearDistance, farDistance);
+        }
+
+        if(farDistance < closestDistance)
+        {
+            nodeStack[stackSize] = farChild;
+            distanceStack[stackSize++] = farDistance;
+        }
+
+        if(nearDistance < closestDistance)
+        {
+            nodeStack[stackSize] = nearChild;
+            distanceStack[stackSize++] = nearDistance;
+        }
+    }
+
+    return triangle;
+}
+
+unsigned int
+SpaceTriangleMesh::localClosestPoint(const glm::vec3& pPoint, unsigned int pStartTriangle, glm::vec3& pClosestPoint) const
+{
+    unsigned int currentTriangle = pStartTriangle;
+    float currentDistance = closestTrianglePoint(currentTriangle, pPoint, pClosestPoint);
+    glm::vec3 trianglePoint;
+
+    for(unsigned int step=0; step<sMaxLocalSteps; ++step)
+    {
+        unsigned int nextTriangle = currentTriangle;
+
+        for(int vI=0; vI<3; ++vI)
+        {
+            unsigned int vertex = mIndices[currentTriangle * 3 + vI];
+            unsigned int trianglesEnd = mVertexTriangleOffsets[vertex + 1];
+
+            for(unsigned int tI=mVertexTriangleOffsets[vertex]; tI<trianglesEnd; ++tI)
+            {
+                unsigned int triangle = mVertexTriangles[tI];
+
+                if(triangle == currentTriangle) continue;
+
+                float distance = closestTrianglePoint(triangle, pPoint, trianglePoint);
+
+                if(distance < currentDistance)
+                {
+                    currentDistance = distance;
+                    nextTriangle = triangle;
+                    pClosestPoint = trianglePoint;
+                }
+            }
+        }
+
+        if(nextTriangle == currentTriangle) break;
+
+        currentTriangle = nextTriangle;
+    }
+
+    return currentTriangle;
+}
@@ -0,0 +1,203 @@
+/** \file dab_space_triangle_mesh.h
+ */
+
+#ifndef _dab_space_triangle_mesh_h_
+#define _dab_space_triangle_mesh_h_
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "ofNode.h"
+#include "dab_geom_geometry.h"
+
+namespace dab
+{
+
+namespace space
+{
+
+/**
+ \brief triangles of a mesh geometry with the adjacency needed for closest point queries
+
+ this is the only class that accesses the vertices and indices of geom::Mesh, the remaining classes of the library query meshes through it.\n
+ coordinates are object coordinates of the shape the geometry belongs to.\n
+ the triangles are organized in a bounding volume hierarchy that is built once per geometry and shared by all shapes using the geometry. leaves store their triangles in a packed buffer for the vectorized triangle distance kernel of SpaceSimdTools.
+ */
+class SpaceTriangleMesh
+{
+public:
+    /**
+     \brief return triangle mesh of geometry
+     \param pGeometry geometry
+     \param pRebuild rebuild triangle mesh even if one exists for the geometry, since the geometry has been modified
+     \return triangle mesh (nullptr: geometry isn't a mesh or has no triangles)
+
+     the triangle mesh is built on first request and reused as long as any shape holds it. a rebuilt triangle mesh replaces the previous one for subsequent requests, shapes that still hold the previous one keep using it until they request the triangle mesh again.
+     */
+    static std::shared_ptr<SpaceTriangleMesh> create(const std::shared_ptr<geom::Geometry>& pGeometry, bool pRebuild = false);
+
+    /**
+     \brief return number of triangles
+     \return triangle count
+     */
+    unsigned int triangleCount() const;
+
+    /**
+     \brief return minimum corner of bounding box of triangles
+     \return minimum position
+     */
+    glm::vec3 minPos() const;
+
+    /**
+     \brief return maximum corner of bounding box of triangles
+     \return maximum position
+     */
+    glm::vec3 maxPos() const;
+
+    /**
+     \brief return normal of triangle
+     \param pTriangle triangle index
+     \return normal following the vertex order of the triangle, unnormalized (zero vector: degenerate triangle)
+     */
+    glm::vec3 triangleNormal(unsigned int pTriangle) const;
+
+    /**
+     \brief calculate closest point on triangle
+     \param pTriangle triangle index
+     \param pPoint reference point
+     \param pClosestPoint resulting closest point
+     \return squared distance between reference point and closest point
+     */
+    float closestTrianglePoint(unsigned int pTriangle, const glm::vec3& pPoint, glm::vec3& pClosestPoint) const;
+
+    /**
+     \brief calculate closest point on mesh by traversing the bounding volume hierarchy
+     \param pPoint reference point
+     \param pClosestPoint resulting closest point
+     \return index of triangle containing closest point
+
+     child nodes are visited in order of the distance of their boxes, nodes whose box is farther away than the closest triangle found so far are skipped. the triangles of a leaf are tested together by the vectorized triangle distance kernel.
+     */
+    unsigned int closestPoint(const glm::vec3& pPoint, glm::vec3& pClosestPoint) const;
+
+    /**
+     \brief calculate closest point on mesh, starting from a triangle that is likely to be close
+     \param pPoint reference point
+     \param pStartTriangle start triangle, typically the closest triangle of a previous query
+     \param pClosestPoint resulting closest point
+     \return index of triangle containing closest point
+
+     the closest point found by localClosestPoint bounds the traversal of the bounding volume hierarchy, which then only visits nodes that are closer than this point. the result is the same as without a start triangle, the traversal is cheap if the start triangle is close to the closest one.
+     */
+    unsigned int closestPoint(const glm::vec3& pPoint, unsigned int pStartTriangle, glm::vec3& pClosestPoint) const;
+
+    /**
+     \brief calculate closest point among the triangles reached by descending from a start triangle through adjacent triangles
+     \param pPoint reference point
+     \param pStartTriangle start triangle
+     \param pClosestPoint resulting closest point
+     \return index of triangle containing closest point
+
+     each step moves to the closest of all triangles that share a vertex with the current triangle. the search stops when none of them is closer or after sMaxLocalSteps steps. the result is a local minimum of the distance, it can miss closer parts of the mesh that aren't connected to the start triangle by descending distance.
+     */
+    unsigned int localClosestPoint(const glm::vec3& pPoint, unsigned int pStartTriangle, glm::vec3& pClosestPoint) const;
+
+    static const unsigned int sMaxLocalSteps; ///\brief maximum number of steps of a local search
+    static const unsigned int sMaxLeafTriangles = 8; ///\brief maximum number of triangles in a leaf of the bounding volume hierarchy
+    static const unsigned int sMaxTraversalDepth = 64; ///\brief capacity of the node stack used during traversal
+
+protected:
+    /**
+     \brief node of bounding volume hierarchy
+     */
+    class Node
+    {
+    public:
+        float mMin[3]; ///\brief minimum corner of box enclosing the triangles of the node
+        float mMax[3]; ///\brief maximum corner of box enclosing the triangles of the node
+        unsigned int mFirst; ///\brief leaf: position of first triangle in hierarchy order, inner node: index of first of two consecutive children
+        unsigned int mCount; ///\brief number of triangles (0: inner node)
+    };
+
+    /**
+     \brief registered triangle mesh of a geometry
+     */
+    class Entry
+    {
+    public:
+        std::weak_ptr<geom::Geometry> mGeometry; ///\brief geometry, guards against a new geometry at the address of a destroyed one
+        std::weak_ptr<SpaceTriangleMesh> mTriangleMesh; ///\brief triangle mesh
+    };
+
+    SpaceTriangleMesh();
+
+    /**
+     \brief create triangle mesh from vertices and indices
+     \param pVertices vertices
+     \param pIndices vertex indices, three per triangle (empty: consecutive vertex triples form triangles)
+     */
+    SpaceTriangleMesh(const std::vector<glm::vec3>& pVertices, const std::vector<unsigned int>& pIndices);
+
+    /**
+     \brief build bounding volume hierarchy and packed triangle buffer
+     */
+    void buildHierarchy();
+
+    /**
+     \brief calculate box of node and split node at the median triangle centroid along the longest axis until leaves are small enough
+     \param pNode node index
+     \param pFirst position of first triangle of node in hierarchy order
+     \param pCount number of triangles of node
+     \param pCentroids triangle centroids
+     */
+    void buildNode(unsigned int pNode, unsigned int pFirst, unsigned int pCount, const std::vector<glm::vec3>& pCentroids);
+
+    /**
+     \brief search bounding volume hierarchy for the triangle closest to a point
+     \param pPoint reference point
+     \param pTriangle closest triangle known before the search
+     \param pSquaredDistance squared distance to closest triangle known before the search, nodes that aren't closer are skipped
+     \return index of closest triangle (pTriangle: no triangle is closer than pSquaredDistance)
+     */
+    unsigned int closestTriangle(const glm::vec3& pPoint, unsigned int pTriangle, float pSquaredDistance) const;
+
+    /**
+     \brief calculate squared distance between point and box of node
+     \param pNode node
+     \param pPoint point
+     \return squared distance (0: point lies inside box)
+     */
+    static inline float boxSquaredDistance(const Node& pNode, const glm::vec3& pPoint)
+    {
+        float distance = 0.0;
+
+        for(int d=0; d<3; ++d)
+        {
+            float diff = std::max( std::max( pNode.mMin[d] - pPoint[d], pPoint[d] - pNode.mMax[d] ), 0.0f );
+            distance += diff * diff;
+        }
+
+        return distance;
+    }
+
+    std::vector<glm::vec3> mVertices; ///\brief vertices
+    std::vector<unsigned int> mIndices; ///\brief vertex indices, three per triangle
+    std::vector<unsigned int> mVertexTriangleOffsets; ///\brief offset of the triangles of each vertex in mVertexTriangles
+    std::vector<unsigned int> mVertexTriangles; ///\brief triangles sharing each vertex, grouped by vertex
+
+    std::vector<Node> mNodes; ///\brief nodes of bounding volume hierarchy, root first
+    std::vector<unsigned int> mTriangleOrder; ///\brief triangle index at each position in hierarchy order
+    std::vector<float> mPackedTriangles; ///\brief packed triangle buffer in hierarchy order
+    unsigned int mPackedTriangleStride; ///\brief stride of packed triangle buffer
+
+    static std::mutex sMutex; ///\brief guards the registry of triangle meshes
+    static std::unordered_map<const geom::Geometry*, Entry> sEntries; ///\brief registered triangle mesh of each geometry
+};
+
+};
+
+};
+
+#endif
@@ -17,7 +17,17 @@ enum SpaceAlgType
     KDTreeAlgType,
     ANNAlgType,
     RTreeAlgType,
-    GridAlgType
+    GridAlgType,
+    BruteForceAlgType,
+    HNSWAlgType,
+    LSHAlgType,
+    PQAlgType,
+    VPTreeAlgType,
+    PCAProjectionAlgType,
+    NNDescentAlgType,
+    DelaunayAlgType,
+    AABBTreeAlgType,
+    SweepAndPruneAlgType
 };
     
 enum ClosestShapePointType
@@ -26,6 +36,13 @@ enum ClosestShapePointType
     ClosestPointShape
 };
     
+enum ShapeBoundsType
+{
+    BoundsAABB,
+    BoundsDOP14,
+    BoundsDOP18
+};
+    
 }
     
 }